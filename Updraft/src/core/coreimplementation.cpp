@@ -77,6 +77,12 @@ SettingInterface* CoreImplementation::addSetting(
     addSetting(settingId, description, initVal, type);
 }
 
+SettingInterface* CoreImplementation::findSetting(
+    const QString& settingId,
+    SettingsGroupType type) {
+  return updraft->settingsManager->findSetting(settingId, type);
+}
+
 osg::Group* CoreImplementation::getSimpleGroup() {
   return updraft->sceneManager->getSimpleGroup();
 }
@@ -90,6 +96,10 @@ osgEarth::Util::ElevationManager* CoreImplementation::getElevationManager() {
   return updraft->sceneManager->getElevationManager();
 }
 
+QString CoreImplementation::getElevationId() {
+  return updraft->sceneManager->getElevationId();
+}
+
 const osg::EllipsoidModel* CoreImplementation::getCurrentMapEllipsoid() {
   return updraft->sceneManager->getCurrentMapEllipsoid();
 }
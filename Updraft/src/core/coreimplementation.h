@@ -48,12 +48,18 @@ class CoreImplementation : public CoreInterface {
     QVariant initValue,
     SettingsGroupType type);
 
+  SettingInterface* findSetting(
+    const QString& settingId,
+    SettingsGroupType type);
+
   osg::Group* getSimpleGroup();
 
   void registerOsgNode(osg::Node* node, MapObject* mapObject);
 
   osgEarth::Util::ElevationManager* getElevationManager();
 
+  QString getElevationId();
+
   const osg::EllipsoidModel* getCurrentMapEllipsoid();
 
  private:
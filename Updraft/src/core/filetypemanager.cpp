@@ -60,6 +60,7 @@ bool FileTypeManager::openFile(const QString &path, bool showDialog) const {
   }
 
   if (showDialog && model.rowCount() > 1) {
+    describeOpenOptions(path, &model);
     FileRolesDialog dlg(updraft->mainWindow);
     dlg.setList(&model);
     if (!dlg.exec()) {
@@ -88,30 +89,135 @@ bool FileTypeManager::openFileInternal(const QString &path,
     FileOpenOption* option = static_cast<FileOpenOption*>(model->item(i));
 
     if (option->selected()) {
-      const FileRegistration &registration = option->registration;
+      if (!openFileWithRegistration(path, option->registration)) {
+        success = false;
+      }
+    }
+  }
+
+  return success;
+}
+
+/// Open a file using a single registration.
+/// Persistent files are imported first and the imported copy is removed
+/// again if the plugin fails to open it.
+/// \param path Path to the file to open.
+/// \param registration The way the file should be opened.
+/// \return true if opening was successful.
+bool FileTypeManager::openFileWithRegistration(const QString &path,
+  const FileRegistration &registration) const {
+  bool success = true;
+
+  // Path is changed for imported files.
+  QString changedPath(path);
+
+  // Import persistent file.
+  if (registration.category == CATEGORY_PERSISTENT) {
+    if (!importFile(&changedPath, registration.importDirectory, path)) {
+      success = false;
+    }
+  }
+
+  if (!registration.plugin->fileOpen(changedPath, registration.roleId)) {
+    qDebug() << "Plugin "
+      << registration.plugin->getName() << " failed to open file.";
+
+    QMessageBox::warning(updraft->mainWindow,
+      tr("Error"), tr("Could not open file."));
+    if (registration.category == CATEGORY_PERSISTENT) {
+      QFile importedFile(changedPath);
+      importedFile.remove();
+    }
+    success = false;
+  }
+
+  return success;
+}
+
+/// Open several files at once.
+/// Temporary files that are opened with the same role are handed to the
+/// plugin together, so that it can load them in parallel.
+/// Persistent files are imported and opened one by one.
+/// \param paths Paths to the files to open.
+/// \param showDialog If this is false, then all found options for opeing the
+///   files are used and no gui elements are displayed.
+/// \return true if opening of all files was successful.
+bool FileTypeManager::openFiles(const QStringList &paths,
+  bool showDialog) const {
+  if (paths.count() == 1) {
+    return openFile(paths[0], showDialog);
+  }
+
+  bool success = true;
+
+  // Temporary files grouped by the registration used to open them.
+  QList<FileRegistration> groupRegistrations;
+  QList<QStringList> groupPaths;
 
-      // Path is changed for imported files.
-      QString changedPath(path);
+  foreach(QString path, paths) {
+    QStandardItemModel model;
+
+    qDebug() << "Opening file " << path << ".";
+    getOpenOptions(path, &model);
+
+    if (!model.rowCount()) {
+      qDebug() << "No plugin can open this file.";
+      success = false;
+      continue;
+    }
+
+    if (showDialog && model.rowCount() > 1) {
+      describeOpenOptions(path, &model);
+      FileRolesDialog dlg(updraft->mainWindow);
+      dlg.setList(&model);
+      if (!dlg.exec()) {
+        qDebug() << "Open was canceled.";
+        success = false;
+        continue;
+      }
+    }
+
+    for (int i = 0; i < model.rowCount(); ++i) {
+      FileOpenOption* option = static_cast<FileOpenOption*>(model.item(i));
+      if (!option->selected()) {
+        continue;
+      }
+
+      const FileRegistration &registration = option->registration;
 
-      // Import persistent file.
       if (registration.category == CATEGORY_PERSISTENT) {
-        if (!importFile(&changedPath, registration.importDirectory, path)) {
+        if (!openFileWithRegistration(path, registration)) {
           success = false;
         }
+        continue;
       }
 
-      if (!registration.plugin->fileOpen(changedPath, registration.roleId)) {
-        qDebug() << "Plugin "
-          << registration.plugin->getName() << " failed to open file.";
+      int group = 0;
+      while (group < groupRegistrations.count() &&
+        (groupRegistrations[group].plugin != registration.plugin ||
+        groupRegistrations[group].roleId != registration.roleId)) {
+        ++group;
+      }
 
-        QMessageBox::warning(updraft->mainWindow,
-          tr("Error"), tr("Could not open file."));
-        if (registration.category == CATEGORY_PERSISTENT) {
-          QFile importedFile(changedPath);
-          importedFile.remove();
-        }
-        success = false;
+      if (group == groupRegistrations.count()) {
+        groupRegistrations.append(registration);
+        groupPaths.append(QStringList());
       }
+
+      groupPaths[group].append(path);
+    }
+  }
+
+  for (int i = 0; i < groupRegistrations.count(); ++i) {
+    const FileRegistration &registration = groupRegistrations[i];
+
+    if (!registration.plugin->filesOpen(groupPaths[i], registration.roleId)) {
+      qDebug() << "Plugin "
+        << registration.plugin->getName() << " failed to open some files.";
+
+      QMessageBox::warning(updraft->mainWindow,
+        tr("Error"), tr("Could not open some of the files."));
+      success = false;
     }
   }
 
@@ -186,6 +292,25 @@ void FileTypeManager::getOpenOptions(QString path,
   }
 }
 
+/// Ask the plugins to describe the file and show the descriptions
+/// as tool tips of the open options.
+/// \param path Path to the file.
+/// \param model Model filled by getOpenOptions().
+void FileTypeManager::describeOpenOptions(const QString &path,
+  QStandardItemModel* model) const {
+  for (int i = 0; i < model->rowCount(); ++i) {
+    FileOpenOption* option = static_cast<FileOpenOption*>(model->item(i));
+
+    QStringList description;
+    option->registration.plugin->fileIdentification(
+      &description, NULL, path);
+
+    if (!description.isEmpty()) {
+      option->setToolTip(description.join("\n"));
+    }
+  }
+}
+
 /// Display a file open dialog, and open the selected files.
 /// \param caption Title of the file open dialog.
 void FileTypeManager::openFileDialog(const QString &caption) {
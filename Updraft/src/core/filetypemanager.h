@@ -25,6 +25,8 @@ class FileTypeManager {
 
   bool openFile(const QString &path, bool showDialog = true) const;
 
+  bool openFiles(const QStringList &paths, bool showDialog = true) const;
+
   void openFileDialog(const QString &caption);
 
   QDir lastDirectory();
@@ -35,12 +37,18 @@ class FileTypeManager {
 
   void getOpenOptions(QString path, QStandardItemModel* out) const;
 
+  void describeOpenOptions(const QString &path,
+    QStandardItemModel* model) const;
+
   bool importFile(QString *newPath,
     const QString &importDirectory, const QString &srcPath) const;
 
   bool openFileInternal(const QString &path,
     QStandardItemModel const* model) const;
 
+  bool openFileWithRegistration(const QString &path,
+    const FileRegistration &registration) const;
+
   /// The list of known and registered files
   QList<FileRegistration> registered;
 
@@ -3,7 +3,9 @@
 #include <osgEarthUtil/ElevationManager>
 #include <osgEarth/Cache>
 #include <osgEarthDrivers/cache_filesystem/FileSystemCache>
+#include <QDateTime>
 #include <QDebug>
+#include <QFileInfo>
 #include <string>
 #include "updraft.h"
 
@@ -109,6 +111,13 @@ QString MapManager::getName() {
   return QString::fromStdString(map->getName());
 }
 
+QString MapManager::getElevationId() {
+  QDir dataDir = updraft->getDataDirectory();
+  QFileInfo info(dataDir.absoluteFilePath(earthFileName));
+  return earthFileName + " " +
+    QString::number(info.lastModified().toTime_t());
+}
+
 bool MapManager::hasElevation() {
   osgEarth::ElevationLayerVector outElevationLayers;
   map->getElevationLayers(outElevationLayers);
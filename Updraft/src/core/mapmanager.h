@@ -56,6 +56,10 @@ class MapManager {
   /// \return Whether the map has elevation data.
   bool hasElevation();
 
+  /// Identifies the elevation data of this map.
+  /// \return Name and modification time of the earth file.
+  QString getElevationId();
+
   /// Returns the MapObject representing this map.
   /// The MapObject is used for clicking into the map.
   /// \return MapObject that represents this map.
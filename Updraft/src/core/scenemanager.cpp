@@ -227,6 +227,16 @@ void SceneManager::unregisterOsgNode(osg::Node* node) {
   pickingMap.remove(node);
 }
 
+QString SceneManager::getElevationId() {
+  // the same map as in createElevationManager()
+  for (int i = 0; i < mapManagers.size(); i++) {
+    if (mapManagers[i]->hasElevation()) {
+      return mapManagers[i]->getElevationId();
+    }
+  }
+  return QString("none");
+}
+
 osgEarth::Util::ElevationManager* SceneManager::createElevationManager() {
   for (int i = 0; i < mapManagers.size(); i++) {
     if (mapManagers[i]->hasElevation()) {
@@ -80,6 +80,11 @@ class SceneManager: public QObject {
   /// \return pointer to the elevation manager object for the current map.
   osgEarth::Util::ElevationManager* getElevationManager();
 
+  /// Returns identification of the elevation data of the map used
+  /// by the elevation manager.
+  /// \return The identification, it changes with the map.
+  QString getElevationId();
+
   /// Returns the ellipsoid model associated with current
   /// active map.
   /// \return Ellipsoid model used for calculations on the current map.
@@ -13,6 +13,17 @@
 namespace Updraft {
 namespace Core {
 
+/// Return the group id with the suffix denoting the type of the group.
+static QString typedGroupId(const QString& groupId, SettingsGroupType type) {
+  if (type == GROUP_VISIBLE) {
+    return groupId + "_visible";
+  } else if (type == GROUP_HIDDEN) {
+    return groupId + "_hidden";
+  } else {
+    return groupId + "_advanced";
+  }
+}
+
 SettingsManager::SettingsManager()
   : dialog(NULL) {
   // Initialize id regexp for identifier pattern matching
@@ -60,13 +71,7 @@ SettingInterface* SettingsManager::addSetting(
   }
 
   // Fro which type of groups do we want the setting
-  if (type == GROUP_VISIBLE) {
-    groupIdPart = groupIdPart + "_visible";
-  } else if (type == GROUP_HIDDEN) {
-    groupIdPart = groupIdPart + "_hidden";
-  } else {
-    groupIdPart = groupIdPart + "_advanced";
-  }
+  groupIdPart = typedGroupId(groupIdPart, type);
 
   QModelIndex groupIndex = getGroup(groupIdPart);
   if (!groupIndex.isValid()) {
@@ -98,6 +103,32 @@ SettingInterface* SettingsManager::addSetting(
   return setting;
 }
 
+SettingInterface* SettingsManager::findSetting(
+  const QString& settingId,
+  SettingsGroupType type) {
+  QStringList identifiers = settingId.split(':');
+  if (identifiers.size() != 2) {
+    qDebug() <<
+    "There must be exactly two parts in the setting ID, separated by ':'";
+    return NULL;
+  }
+
+  QModelIndex groupIndex = getGroup(typedGroupId(identifiers[0], type));
+  if (!groupIndex.isValid()) {
+    return NULL;
+  }
+
+  QModelIndex settingIndex = getSetting(identifiers[1], groupIndex);
+  if (!settingIndex.isValid()) {
+    return NULL;
+  }
+
+  SettingsItem* settingItem = model->itemFromIndex(settingIndex);
+  BasicSetting* setting = new BasicSetting(settingItem, this);
+  registerSetting(settingItem, setting);
+  return setting;
+}
+
 void SettingsManager::addGroup(
   const QString& groupId,
   const QString& description,
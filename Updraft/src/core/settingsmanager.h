@@ -56,6 +56,18 @@ class SettingsManager: public QObject {
     QVariant defaultValue,
     SettingsGroupType type = GROUP_VISIBLE);
 
+  /// Finds a setting that was already added or loaded from the settings file.
+  /// Ownership of the setting interface is transfered to the caller of this
+  /// function.
+  /// \param settingId Identifier for the setting including the group
+  ///        identifier, as given to addSetting().
+  /// \param type Type of the group the setting resides in.
+  /// \return Interface for setting and reading the setting value, or NULL
+  ///         if the setting doesn't exist.
+  SettingInterface* findSetting(
+    const QString& settingId,
+    SettingsGroupType type = GROUP_VISIBLE);
+
   /// Adds a group into the settings dialog.
   /// If a setting group with the given ID already exists, its description
   /// and icon are changed to the new ones.
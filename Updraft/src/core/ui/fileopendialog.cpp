@@ -61,9 +61,7 @@ QString FileOpenDialog::openIt(const QString& caption, const QString& dir) {
     updraft->mainWindow, caption,
     dir, getFilters().join(";;"));
 
-  foreach(QString file, files) {
-    updraft->fileTypeManager->openFile(file, true);
-  }
+  updraft->fileTypeManager->openFiles(files, true);
 
   if (files.count()) {
     return files[0];
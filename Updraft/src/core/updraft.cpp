@@ -50,8 +50,8 @@ Updraft::Updraft(int argc, char** argv)
   pluginManager = new PluginManager();
 
   QStringList args = arguments();
-  for (int i = 1; i < args.count(); ++i) {
-    fileTypeManager->openFile(args[i]);
+  if (args.count() > 1) {
+    fileTypeManager->openFiles(args.mid(1));
   }
 
   stateSaver->load();
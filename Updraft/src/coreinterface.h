@@ -127,6 +127,19 @@ class CoreInterface {
     QVariant initValue,
     SettingsGroupType type = GROUP_VISIBLE) = 0;
 
+  /// Finds a setting added by addSetting(), e.g. by another plugin, without
+  /// adding it. Ownership of the setting interface is transfered to the
+  /// caller of this function.
+  /// \param settingId Identifier for the setting including the group
+  ///        identifier, as given to addSetting().
+  /// \param type Whether the setting resides in a visible, advanced or hidden
+  ///        group.
+  /// \return Interface for setting and reading the setting value, or NULL if
+  ///         the setting doesn't exist.
+  virtual SettingInterface* findSetting(
+    const QString& settingId,
+    SettingsGroupType type = GROUP_VISIBLE) = 0;
+
   /// Returns the pointer to the basic node group for drawing.
   virtual osg::Group* getSimpleGroup() = 0;
 
@@ -139,6 +152,10 @@ class CoreInterface {
   /// Returns an elevation manager for the scene, to request elevation data from.
   virtual osgEarth::Util::ElevationManager* getElevationManager() = 0;
 
+  /// Returns identification of the elevation data used by the elevation
+  /// manager. Data derived from the elevations can be cached under it.
+  virtual QString getElevationId() = 0;
+
   /// Returns the ellipsoid model associated with the active map.
   virtual const osg::EllipsoidModel* getCurrentMapEllipsoid() = 0;
 };
@@ -1,7 +1,6 @@
 #include "cup.h"
 
 #include <QDebug>
-#include <QFile>
 
 namespace Updraft {
 namespace Cup {
@@ -31,10 +30,9 @@ CupLoader::CupLoader()
 }
 
 CupFile* CupLoader::loadFile(const QString &name) {
-  QFile file(name);
-
-    // Open file
-  if (!file.open(QIODevice::ReadOnly)) {
+    // Open file, compressed files are decompressed while reading
+  QIODevice *file = Util::DecompressingDevice::openFile(name);
+  if (!file) {
     qDebug() << "CupLoader: Couldn't open " << name << ".";
     return NULL;
   }
@@ -46,13 +44,14 @@ CupFile* CupLoader::loadFile(const QString &name) {
   state = LOADING_HEADER;
 
     // Read file line by line
-  while (!file.atEnd()) {
-    QString strLine(file.readLine());
+  while (!file->atEnd()) {
+    QString strLine(file->readLine());
 
     if (strLine.length() == 0) {
       qDebug() << "CupLoader: Error reading file ("
-        << file.errorString() << ")";
+        << file->errorString() << ")";
       delete cupFile;
+      delete file;
       return NULL;
     }
 
@@ -61,10 +60,12 @@ CupFile* CupLoader::loadFile(const QString &name) {
     if (state == ERROR) {
       qDebug() << "CupLoader: Error parsing file " << name;
       delete cupFile;
+      delete file;
       return NULL;
     }
   }
 
+  delete file;
   state = DONE;
   return cupFile;
 }
@@ -93,27 +94,30 @@ void CupLoader::parseLine(const QString &strLine) {
   }
 }
 
-void CupLoader::parseLatitude(TPEntry &tp, const QString &latitude) {
+void CupLoader::parseLatitude(Util::Location *location,
+  const QString &latitude) {
   int degs = latitude.mid(0, 2).toInt();
   int mins = latitude.mid(2, 2).toInt();
   int rest = latitude.mid(5, 3).toInt();
   char sign = latitude.mid(8, 1).compare("S") == 0 ? 'S' : 'N';
-  tp.location.latFromDMS(degs, mins, 60.0*((qreal)rest)/1000.0, sign);
+  location->latFromDMS(degs, mins, 60.0*((qreal)rest)/1000.0, sign);
 }
 
-void CupLoader::parseLongitude(TPEntry &tp, const QString &longitude) {
+void CupLoader::parseLongitude(Util::Location *location,
+  const QString &longitude) {
   int degs = longitude.mid(0, 3).toInt();
   int mins = longitude.mid(3, 2).toInt();
   int rest = longitude.mid(6, 3).toInt();
   char sign = longitude.mid(9, 1).compare("W") == 0 ? 'W' : 'E';
-  tp.location.lonFromDMS(degs, mins, 60.0*((qreal)rest)/1000.0, sign);
+  location->lonFromDMS(degs, mins, 60.0*((qreal)rest)/1000.0, sign);
 }
 
-void CupLoader::parseElevation(TPEntry &tp, const QString &elevation) {
+void CupLoader::parseElevation(Util::Location *location,
+  const QString &elevation) {
   if (elevation.endsWith("m", Qt::CaseInsensitive)) {
-    tp.location.alt = elevation.left(elevation.length()-1).toDouble();
+    location->alt = elevation.left(elevation.length()-1).toDouble();
   } else if (elevation.endsWith("ft", Qt::CaseInsensitive)) {
-    tp.location.alt = Util::Units::feetToMeters(
+    location->alt = Util::Units::feetToMeters(
       elevation.left(elevation.length()-2).toDouble());
   }
 }
@@ -129,9 +133,11 @@ void CupLoader::parseTP(const QString &strLine) {
   tp.name = tpName;  // strLine.section(QChar(','), 0, 0);
   tp.code = strLine.section(QChar(','), 1, 1);
   tp.country = strLine.section(QChar(','), 2, 2);
-  parseLatitude(tp, strLine.section(QChar(','), 3, 3));
-  parseLongitude(tp, strLine.section(QChar(','), 4, 4));
-  parseElevation(tp, strLine.section(QChar(','), 5, 5));
+  Util::Location location;
+  parseLatitude(&location, strLine.section(QChar(','), 3, 3));
+  parseLongitude(&location, strLine.section(QChar(','), 4, 4));
+  parseElevation(&location, strLine.section(QChar(','), 5, 5));
+  tp.location = Util::PackedLocation(location);
   tp.style = strLine.section(QChar(','), 6, 6);
   tp.rwyDirection = strLine.section(QChar(','), 7, 7);
   tp.rwLength = strLine.section(QChar(','), 8, 8);
@@ -24,7 +24,7 @@ struct CUP_EXPORT TPEntry {
   QString name;
   QString code;
   QString country;
-  Util::Location location;
+  Util::PackedLocation location;
   QString style;
   QString rwyDirection;
   QString rwLength;
@@ -85,6 +85,7 @@ class CUP_EXPORT CupLoader {
   CupLoader();
 
   /// Loads file from disk.
+  /// Files compressed by gzip or zip are decompressed while reading.
   /// \param name a name of the file (with full path)
   /// \return Pointer to the new CupFile instance
   CupFile* loadFile(const QString &name);
@@ -108,19 +109,19 @@ class CUP_EXPORT CupLoader {
   void parseLine(const QString &strLine);
 
   /// Parses latitude entry.
-  /// \param tp destination instance of TPEntry
+  /// \param location destination location
   /// \param latitude a string storing latitude in cup format
-  void parseLatitude(TPEntry &tp, const QString &latitude);
+  void parseLatitude(Util::Location *location, const QString &latitude);
 
   /// Parses longitude entry.
-  /// \param tp destination instance of TPEntry
+  /// \param location destination location
   /// \param longitude a string storing longitude in cup format
-  void parseLongitude(TPEntry &tp, const QString &longitude);
+  void parseLongitude(Util::Location *location, const QString &longitude);
 
   /// Parses elevation entry. Supports both feets and meters.
-  /// \param tp destination instance of TPEntry
+  /// \param location destination location
   /// \param elevation a string storing elevation in cup format
-  void parseElevation(TPEntry &tp, const QString &elevation);
+  void parseElevation(Util::Location *location, const QString &elevation);
 
   /// Parses line containing turn-point definition.
   /// \param strLine a string storing one line of the file
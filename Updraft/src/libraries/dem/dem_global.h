@@ -0,0 +1,12 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_DEM_DEM_GLOBAL_H_
+#define UPDRAFT_SRC_LIBRARIES_DEM_DEM_GLOBAL_H_
+
+#include <QtGlobal>
+
+#ifdef UPDRAFT_DEM_INTERNAL
+  #define DEM_EXPORT Q_DECL_EXPORT
+#else
+  #define DEM_EXPORT Q_DECL_IMPORT
+#endif
+
+#endif  // UPDRAFT_SRC_LIBRARIES_DEM_DEM_GLOBAL_H_
@@ -0,0 +1,142 @@
+#include "sampler.h"
+
+#include <math.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStringList>
+
+#include "tile.h"
+
+namespace Updraft {
+namespace Dem {
+
+Sampler::Sampler(const QString &directory, int maxOpenTiles)
+  : maxOpenTiles(qMax(1, maxOpenTiles)) {
+  QDir dir(directory);
+  QStringList filters;
+  filters << "*.hgt" << "*.tif" << "*.tiff";
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  foreach(QString fileName, dir.entryList(filters, QDir::Files, QDir::Name)) {
+    QString path = dir.absoluteFilePath(fileName);
+    Tile tile;
+    if (!tile.open(path)) {
+      continue;
+    }
+
+    TileInfo info;
+    info.path = path;
+    info.north = tile.north();
+    info.south = tile.south();
+    info.west = tile.west();
+    info.east = tile.east();
+
+    int index = tiles.count();
+    tiles.append(info);
+
+    QFileInfo fileInfo(path);
+    hash.addData((fileName + " " + QString::number(fileInfo.size()) + " " +
+      QString::number(fileInfo.lastModified().toTime_t()) + "\n").toUtf8());
+
+    int south = static_cast<int>(floor(info.south));
+    int north = static_cast<int>(floor(info.north));
+    int west = static_cast<int>(floor(info.west));
+    int east = static_cast<int>(floor(info.east));
+    for (int lat = south; lat <= north; ++lat) {
+      for (int lon = west; lon <= east; ++lon) {
+        cells[cellIndex(lat, lon)].append(index);
+      }
+    }
+  }
+
+  tilesId = QString::fromAscii(hash.result().toHex());
+
+  qDebug() << "Found" << tiles.count() << "elevation tiles in" << directory;
+}
+
+Sampler::~Sampler() {}
+
+int Sampler::cellIndex(double lat, double lon) {
+  return (static_cast<int>(floor(lat)) + 90) * 360 +
+    static_cast<int>(floor(lon)) + 180;
+}
+
+int Sampler::findTile(double lat, double lon) const {
+  QHash<int, QVector<int> >::const_iterator it =
+    cells.constFind(cellIndex(lat, lon));
+  if (it == cells.constEnd()) {
+    return -1;
+  }
+
+  foreach(int index, it.value()) {
+    if (tiles[index].contains(lat, lon)) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+Sampler::TilePointer Sampler::acquire(int index) const {
+  QMutexLocker locker(&mutex);
+
+  for (int i = 0; i < openTiles.count(); ++i) {
+    if (openTiles[i].first == index) {
+      openTiles.move(i, 0);
+      return openTiles.first().second;
+    }
+  }
+
+  TilePointer tile(new Tile());
+  if (!tile->open(tiles[index].path)) {
+    return TilePointer();
+  }
+
+  openTiles.prepend(qMakePair(index, tile));
+  while (openTiles.count() > maxOpenTiles) {
+    openTiles.removeLast();
+  }
+
+  return tile;
+}
+
+bool Sampler::elevation(double lat, double lon, double *result) const {
+  double value;
+  if (!elevations(&lat, &lon, 1, &value)) {
+    return false;
+  }
+  *result = value;
+  return true;
+}
+
+int Sampler::elevations(const double *lat, const double *lon, int count,
+  double *result, double missing) const {
+  int found = 0;
+  int current = -1;
+  TilePointer tile;
+
+  for (int i = 0; i < count; ++i) {
+    if (current < 0 || !tiles[current].contains(lat[i], lon[i])) {
+      int index = findTile(lat[i], lon[i]);
+      if (index != current) {
+        current = index;
+        tile = index < 0 ? TilePointer() : acquire(index);
+      }
+    }
+
+    if (!tile.isNull() && tile->elevation(lat[i], lon[i], result + i)) {
+      ++found;
+    } else {
+      result[i] = missing;
+    }
+  }
+
+  return found;
+}
+
+}  // End namespace Dem
+}  // End namespace Updraft
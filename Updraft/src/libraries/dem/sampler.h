@@ -0,0 +1,104 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_DEM_SAMPLER_H_
+#define UPDRAFT_SRC_LIBRARIES_DEM_SAMPLER_H_
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include "dem_global.h"
+
+namespace Updraft {
+namespace Dem {
+
+class Tile;
+
+/// Terrain elevation from a directory of local tiles (see Tile for the
+/// supported formats).
+/// Works completely offline. The directory is scanned once when the sampler
+/// is created, tiles are mapped on first use and the least recently used
+/// ones are unmapped when more than maxOpenTiles are needed.
+/// All methods can be called from several threads at once.
+class DEM_EXPORT Sampler {
+ public:
+  /// \param directory Directory with the tiles, it is not searched
+  ///   recursively.
+  /// \param maxOpenTiles Number of tiles kept mapped.
+  explicit Sampler(const QString &directory, int maxOpenTiles = 16);
+  ~Sampler();
+
+  /// Return number of usable tiles found in the directory.
+  int tileCount() const { return tiles.count(); }
+
+  /// Return identification of the tiles.
+  /// It changes when a tile is added, removed or modified.
+  QString identity() const { return tilesId; }
+
+  /// Elevation of a single point.
+  /// \param [out] result Elevation in meters above the geoid.
+  /// \return false if no tile has data for the point.
+  bool elevation(double lat, double lon, double *result) const;
+
+  /// Elevations of an array of points.
+  /// Consecutive points are usually in the same tile, so the tiles are
+  /// only looked up when the point leaves the current one.
+  /// \param lat Array of count latitudes in degrees.
+  /// \param lon Array of count longitudes in degrees.
+  /// \param count Number of the points.
+  /// \param [out] result Array of count elevations in meters.
+  /// \param missing Value stored for points that have no data.
+  /// \return Number of points that have data.
+  int elevations(const double *lat, const double *lon, int count,
+    double *result, double missing = 0) const;
+
+ private:
+  Q_DISABLE_COPY(Sampler)
+
+  typedef QSharedPointer<Tile> TilePointer;
+
+  /// Bounds of a tile found in the directory.
+  struct TileInfo {
+    QString path;
+    double north;
+    double south;
+    double west;
+    double east;
+
+    bool contains(double lat, double lon) const {
+      return lat <= north && lat >= south && lon >= west && lon <= east;
+    }
+  };
+
+  /// Return index of the one degree cell containing the point.
+  static int cellIndex(double lat, double lon);
+
+  /// Return index of a tile containing the point or -1.
+  int findTile(double lat, double lon) const;
+
+  /// Return the mapped tile, open it if necessary.
+  /// The returned pointer keeps the tile mapped even if it gets evicted.
+  TilePointer acquire(int index) const;
+
+  QVector<TileInfo> tiles;
+
+  /// Hash of names, sizes and modification times of the tiles.
+  QString tilesId;
+
+  /// Indices of the tiles overlapping each one degree cell.
+  QHash<int, QVector<int> > cells;
+
+  int maxOpenTiles;
+
+  /// Protects openTiles.
+  mutable QMutex mutex;
+
+  /// Mapped tiles with their indices, the most recently used first.
+  mutable QList<QPair<int, TilePointer> > openTiles;
+};
+
+}  // End namespace Dem
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_DEM_SAMPLER_H_
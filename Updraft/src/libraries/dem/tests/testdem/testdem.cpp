@@ -0,0 +1,289 @@
+#include "testdem.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QtTest>
+#include <QVector>
+
+#include "sampler.h"
+#include "tile.h"
+
+namespace Updraft {
+namespace Dem {
+namespace Test {
+
+/// Samples along one side of a 3 arc second HGT tile.
+static const int HGT_SIZE = 1201;
+
+/// Elevation of the generated HGT tiles.
+/// It is linear in the position of the sample and continuous
+/// across the tiles in a row.
+static double hgtElevation(double lat, double lon) {
+  double row = (51 - lat) * (HGT_SIZE - 1);
+  double col = (lon - 14) * (HGT_SIZE - 1);
+  return row + 2 * col;
+}
+
+/// Write a HGT tile with the south west corner at 50N, west E.
+/// \param voidRow Row of the single void sample or -1.
+static void writeHgt(const QString &path, int west, int voidRow = -1) {
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out.setByteOrder(QDataStream::BigEndian);
+  for (int row = 0; row < HGT_SIZE; ++row) {
+    for (int col = 0; col < HGT_SIZE; ++col) {
+      qint16 value = row + 2 * (col + (west - 14) * (HGT_SIZE - 1));
+      if (row == voidRow && col == 0) {
+        value = -32768;
+      }
+      out << value;
+    }
+  }
+
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(bytes);
+}
+
+/// Write a directory entry with a single value or an offset.
+static void writeEntry(QDataStream *out, quint16 tag, quint16 type,
+  quint32 count, quint32 value) {
+  *out << tag << type << count;
+  if (type == 3 && count == 1) {
+    *out << static_cast<quint16>(value) << static_cast<quint16>(0);
+  } else {
+    *out << value;
+  }
+}
+
+/// Write a GeoTIFF with elevation 10 * row + col and PixelIsArea raster.
+static void writeTiff(const QString &path, bool bigEndian, bool floatSamples,
+  int rows, int cols, int rowsPerStrip, double west, double north,
+  double step) {
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out.setByteOrder(
+    bigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+
+  int sampleSize = floatSamples ? 4 : 2;
+  int stripCount = (rows + rowsPerStrip - 1) / rowsPerStrip;
+  quint32 stripsOffset = 8 + rows * cols * sampleSize;
+  quint32 scaleOffset = stripsOffset + 4 * stripCount;
+  quint32 tiepointOffset = scaleOffset + 3 * 8;
+  quint32 keysOffset = tiepointOffset + 6 * 8;
+  quint32 ifdOffset = keysOffset + 12 * 2;
+
+  out.writeRawData(bigEndian ? "MM" : "II", 2);
+  out << static_cast<quint16>(42) << ifdOffset;
+
+  out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+  for (int row = 0; row < rows; ++row) {
+    for (int col = 0; col < cols; ++col) {
+      if (floatSamples) {
+        out << static_cast<float>(10 * row + col);
+      } else {
+        out << static_cast<qint16>(10 * row + col);
+      }
+    }
+  }
+
+  for (int i = 0; i < stripCount; ++i) {
+    out << static_cast<quint32>(8 + i * rowsPerStrip * cols * sampleSize);
+  }
+
+  out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+  out << step << step << 0.0;
+  out << 0.0 << 0.0 << 0.0 << west << north << 0.0;
+
+  // Geographic model, pixel is area.
+  quint16 keys[] = {1, 1, 0, 2, 1024, 0, 1, 2, 1025, 0, 1, 1};
+  for (int i = 0; i < 12; ++i) {
+    out << keys[i];
+  }
+
+  out << static_cast<quint16>(11);
+  writeEntry(&out, 256, 3, 1, cols);
+  writeEntry(&out, 257, 3, 1, rows);
+  writeEntry(&out, 258, 3, 1, 8 * sampleSize);
+  writeEntry(&out, 259, 3, 1, 1);
+  writeEntry(&out, 273, 4, stripCount, stripCount == 1 ? 8 : stripsOffset);
+  writeEntry(&out, 277, 3, 1, 1);
+  writeEntry(&out, 278, 3, 1, rowsPerStrip);
+  writeEntry(&out, 339, 3, 1, floatSamples ? 3 : 2);
+  writeEntry(&out, 33550, 12, 3, scaleOffset);
+  writeEntry(&out, 33922, 12, 6, tiepointOffset);
+  writeEntry(&out, 34735, 3, 12, keysOffset);
+  out << static_cast<quint32>(0);
+
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(bytes);
+}
+
+void TestDem::initTestCase() {
+  dir = QDir::temp();
+  dir.mkpath("updraft_testdem");
+  QVERIFY(dir.cd("updraft_testdem"));
+
+  writeHgt(dir.absoluteFilePath("N50E014.hgt"), 14);
+  writeHgt(dir.absoluteFilePath("N50E015.hgt"), 15);
+  writeHgt(dir.absoluteFilePath("N50E020.hgt"), 14, 0);
+  writeTiff(dir.absoluteFilePath("float.tif"), false, true,
+    4, 3, 4, 10, 20, 0.5);
+  writeTiff(dir.absoluteFilePath("strips.tif"), true, false,
+    5, 4, 2, -5, -3, 0.25);
+}
+
+void TestDem::cleanupTestCase() {
+  foreach(QString fileName, dir.entryList(QDir::Files)) {
+    dir.remove(fileName);
+  }
+  dir.rmdir(dir.absolutePath());
+}
+
+void TestDem::testHgt() {
+  Tile tile;
+  QVERIFY(tile.open(dir.absoluteFilePath("N50E014.hgt")));
+  QCOMPARE(tile.north(), 51.0);
+  QCOMPARE(tile.south(), 50.0);
+  QCOMPARE(tile.west(), 14.0);
+  QCOMPARE(tile.east(), 15.0);
+
+  double lats[] = {50, 51, 50.5, 50.123456, 50.999};
+  double lons[] = {14, 15, 14.5, 14.987654, 14.001};
+  for (int i = 0; i < 5; ++i) {
+    double elevation;
+    QVERIFY(tile.elevation(lats[i], lons[i], &elevation));
+    QVERIFY(qAbs(elevation - hgtElevation(lats[i], lons[i])) < 1e-6);
+  }
+
+  double elevation;
+  QVERIFY(!tile.elevation(49.9, 14.5, &elevation));
+  QVERIFY(!tile.elevation(50.5, 15.1, &elevation));
+}
+
+void TestDem::testHgtVoid() {
+  Tile tile;
+  QVERIFY(tile.open(dir.absoluteFilePath("N50E020.hgt")));
+
+  double step = 1.0 / (HGT_SIZE - 1);
+  double elevation;
+
+  // Only the void sample contributes.
+  QVERIFY(!tile.elevation(51, 20, &elevation));
+
+  // Half way to the next row, the void sample is left out.
+  QVERIFY(tile.elevation(51 - 0.5 * step, 20, &elevation));
+  QVERIFY(qAbs(elevation - 1) < 1e-9);
+}
+
+void TestDem::testTiffFloat() {
+  Tile tile;
+  QVERIFY(tile.open(dir.absoluteFilePath("float.tif")));
+
+  // Samples are in the centres of the pixels.
+  QCOMPARE(tile.north(), 19.75);
+  QCOMPARE(tile.west(), 10.25);
+  QCOMPARE(tile.south(), 18.25);
+  QCOMPARE(tile.east(), 11.25);
+
+  double elevation;
+  QVERIFY(tile.elevation(19.75, 10.25, &elevation));
+  QCOMPARE(elevation, 0.0);
+  QVERIFY(tile.elevation(18.25, 11.25, &elevation));
+  QCOMPARE(elevation, 32.0);
+
+  // Row 1.5, column 0.5
+  QVERIFY(tile.elevation(19.0, 10.5, &elevation));
+  QVERIFY(qAbs(elevation - 15.5) < 1e-9);
+}
+
+void TestDem::testTiffStrips() {
+  Tile tile;
+  QVERIFY(tile.open(dir.absoluteFilePath("strips.tif")));
+
+  for (int row = 0; row < 5; ++row) {
+    for (int col = 0; col < 4; ++col) {
+      double elevation;
+      QVERIFY(tile.elevation(-3.125 - 0.25 * row, -4.875 + 0.25 * col,
+        &elevation));
+      QCOMPARE(elevation, 10.0 * row + col);
+    }
+  }
+
+  // Row 3.5 interpolates between the second and the third strip.
+  double elevation;
+  QVERIFY(tile.elevation(-3.125 - 0.25 * 3.5, -4.875, &elevation));
+  QCOMPARE(elevation, 35.0);
+}
+
+void TestDem::testSampler() {
+  Sampler sampler(dir.absolutePath());
+  QCOMPARE(sampler.tileCount(), 5);
+
+  // A track crossing from one tile to the other and leaving the data.
+  const int count = 200;
+  QVector<double> lat(count);
+  QVector<double> lon(count);
+  for (int i = 0; i < count; ++i) {
+    lat[i] = 50.2 + 0.003 * i;
+    lon[i] = 14.705 + 0.01 * i;
+  }
+
+  QVector<double> result(count);
+  int found = sampler.elevations(lat.constData(), lon.constData(), count,
+    result.data(), -1);
+
+  int expectedFound = 0;
+  for (int i = 0; i < count; ++i) {
+    if (lon[i] <= 16) {
+      ++expectedFound;
+      QVERIFY(qAbs(result[i] - hgtElevation(lat[i], lon[i])) < 1e-6);
+    } else {
+      QCOMPARE(result[i], -1.0);
+    }
+  }
+  QCOMPARE(found, expectedFound);
+
+  double elevation;
+  QVERIFY(sampler.elevation(19, 10.5, &elevation));
+  QVERIFY(!sampler.elevation(0, 0, &elevation));
+}
+
+void TestDem::testEviction() {
+  // Alternate between two tiles with only one of them kept open.
+  Sampler sampler(dir.absolutePath(), 1);
+
+  double lat[] = {50.5, 19, 50.5, 19};
+  double lon[] = {14.5, 10.5, 15.5, 10.5};
+  double result[4];
+  QCOMPARE(sampler.elevations(lat, lon, 4, result), 4);
+  QVERIFY(qAbs(result[0] - hgtElevation(50.5, 14.5)) < 1e-6);
+  QVERIFY(qAbs(result[1] - 15.5) < 1e-9);
+  QVERIFY(qAbs(result[2] - hgtElevation(50.5, 15.5)) < 1e-6);
+  QVERIFY(qAbs(result[3] - 15.5) < 1e-9);
+}
+
+void TestDem::benchmarkElevations() {
+  Sampler sampler(dir.absolutePath());
+
+  const int count = 100000;
+  QVector<double> lat(count);
+  QVector<double> lon(count);
+  for (int i = 0; i < count; ++i) {
+    lat[i] = 50.01 + 0.98 * i / count;
+    lon[i] = 14.01 + 1.98 * qAbs(((i * 7919) % count) - count / 2) / count;
+  }
+
+  QVector<double> result(count);
+  QBENCHMARK {
+    sampler.elevations(lat.constData(), lon.constData(), count,
+      result.data());
+  }
+}
+
+}  // End namespace Test
+}  // End namespace Dem
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Dem::Test::TestDem)
@@ -0,0 +1,37 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_DEM_TESTS_TESTDEM_TESTDEM_H_
+#define UPDRAFT_SRC_LIBRARIES_DEM_TESTS_TESTDEM_TESTDEM_H_
+
+#include <QDir>
+#include <QObject>
+
+namespace Updraft {
+namespace Dem {
+namespace Test {
+
+/// Read synthetic tiles with linear elevations, where the bilinear
+/// interpolation is exact.
+class TestDem: public QObject {
+  Q_OBJECT
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void testHgt();
+  void testHgtVoid();
+  void testTiffFloat();
+  void testTiffStrips();
+  void testSampler();
+  void testEviction();
+
+  void benchmarkElevations();
+
+ private:
+  /// Directory with the generated tiles.
+  QDir dir;
+};
+
+}  // End namespace Test
+}  // End namespace Dem
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_DEM_TESTS_TESTDEM_TESTDEM_H_
@@ -0,0 +1,453 @@
+#include "tile.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegExp>
+#include <QtEndian>
+
+namespace Updraft {
+namespace Dem {
+
+/// Value of the void samples in HGT files.
+static const double HGT_VOID = -32768;
+
+/// TIFF tags used by the reader.
+enum TiffTag {
+  TAG_IMAGE_WIDTH = 256,
+  TAG_IMAGE_LENGTH = 257,
+  TAG_BITS_PER_SAMPLE = 258,
+  TAG_COMPRESSION = 259,
+  TAG_STRIP_OFFSETS = 273,
+  TAG_SAMPLES_PER_PIXEL = 277,
+  TAG_ROWS_PER_STRIP = 278,
+  TAG_TILE_WIDTH = 322,
+  TAG_SAMPLE_FORMAT = 339,
+  TAG_MODEL_PIXEL_SCALE = 33550,
+  TAG_MODEL_TIEPOINT = 33922,
+  TAG_MODEL_TRANSFORMATION = 34264,
+  TAG_GEO_KEY_DIRECTORY = 34735,
+  TAG_GDAL_NODATA = 42113
+};
+
+/// GeoTIFF keys used by the reader.
+enum GeoKey {
+  KEY_MODEL_TYPE = 1024,
+  KEY_RASTER_TYPE = 1025
+};
+
+static const int MODEL_TYPE_PROJECTED = 1;
+static const int RASTER_PIXEL_IS_POINT = 2;
+
+static const int SAMPLE_FORMAT_INT = 2;
+static const int SAMPLE_FORMAT_FLOAT = 3;
+
+/// Reads the values of TIFF directory entries from the mapped file.
+class TiffReader {
+ public:
+  TiffReader(const uchar *data, qint64 size, bool bigEndian)
+    : data(data), size(size), bigEndian(bigEndian) {}
+
+  quint16 read16(qint64 offset) const {
+    return bigEndian ?
+      qFromBigEndian<quint16>(data + offset) :
+      qFromLittleEndian<quint16>(data + offset);
+  }
+
+  quint32 read32(qint64 offset) const {
+    return bigEndian ?
+      qFromBigEndian<quint32>(data + offset) :
+      qFromLittleEndian<quint32>(data + offset);
+  }
+
+  double readDouble(qint64 offset) const {
+    quint64 bits = bigEndian ?
+      qFromBigEndian<quint64>(data + offset) :
+      qFromLittleEndian<quint64>(data + offset);
+    double ret;
+    memcpy(&ret, &bits, sizeof(ret));
+    return ret;
+  }
+
+  /// Read the numeric values of the directory entry at offset.
+  /// \return false if the type is not numeric or the values are
+  ///   outside of the file.
+  bool values(qint64 entry, QVector<double> *result) const {
+    result->clear();
+    int type = read16(entry + 2);
+    quint32 count = read32(entry + 4);
+
+    int typeSize;
+    switch (type) {
+      case 1: typeSize = 1; break;  // BYTE
+      case 3: typeSize = 2; break;  // SHORT
+      case 4: typeSize = 4; break;  // LONG
+      case 12: typeSize = 8; break;  // DOUBLE
+      default: return false;
+    }
+
+    qint64 offset = entry + 8;
+    if (static_cast<qint64>(count) * typeSize > 4) {
+      offset = read32(entry + 8);
+    }
+    if (offset + static_cast<qint64>(count) * typeSize > size) {
+      return false;
+    }
+
+    result->resize(count);
+    for (quint32 i = 0; i < count; ++i) {
+      qint64 pos = offset + static_cast<qint64>(i) * typeSize;
+      switch (type) {
+        case 1: (*result)[i] = data[pos]; break;
+        case 3: (*result)[i] = read16(pos); break;
+        case 4: (*result)[i] = read32(pos); break;
+        default: (*result)[i] = readDouble(pos); break;
+      }
+    }
+    return true;
+  }
+
+  /// Read the ASCII value of the directory entry at offset.
+  bool string(qint64 entry, QByteArray *result) const {
+    if (read16(entry + 2) != 2) {
+      return false;
+    }
+    quint32 count = read32(entry + 4);
+    qint64 offset = count > 4 ? read32(entry + 8) : entry + 8;
+    if (offset + count > size) {
+      return false;
+    }
+    *result = QByteArray(reinterpret_cast<const char*>(data + offset), count);
+    int end = result->indexOf('\0');
+    if (end >= 0) {
+      result->truncate(end);
+    }
+    return true;
+  }
+
+ private:
+  const uchar *data;
+  qint64 size;
+  bool bigEndian;
+};
+
+Tile::Tile()
+  : data(NULL), size(0), type(SAMPLE_INT16), bigEndian(true),
+  rows(0), cols(0), lat0(0), lon0(0), latStep(1), lonStep(1),
+  rowsPerStrip(0), hasVoidValue(false), voidValue(0) {}
+
+Tile::~Tile() {
+  close();
+}
+
+bool Tile::open(const QString &path) {
+  close();
+
+  file.setFileName(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qDebug() << "Cannot open elevation tile" << path;
+    return false;
+  }
+
+  size = file.size();
+  data = file.map(0, size);
+  if (!data) {
+    qDebug() << "Cannot map elevation tile" << path;
+    file.close();
+    return false;
+  }
+
+  QString suffix = QFileInfo(path).suffix().toLower();
+  bool ok;
+  if (suffix == "hgt") {
+    ok = openHgt(path);
+  } else {
+    ok = openTiff();
+  }
+
+  if (!ok || rows < 2 || cols < 2) {
+    qDebug() << "Unsupported elevation tile" << path;
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void Tile::close() {
+  if (data) {
+    file.unmap(const_cast<uchar*>(data));
+    data = NULL;
+  }
+  file.close();
+  stripOffsets.clear();
+  rows = cols = 0;
+}
+
+bool Tile::openHgt(const QString &path) {
+  QRegExp name("^([NS])(\\d\\d)([EW])(\\d\\d\\d)", Qt::CaseInsensitive);
+  if (name.indexIn(QFileInfo(path).baseName()) < 0) {
+    return false;
+  }
+
+  int south = name.cap(2).toInt();
+  if (name.cap(1).toUpper() == "S") {
+    south = -south;
+  }
+  int west = name.cap(4).toInt();
+  if (name.cap(3).toUpper() == "W") {
+    west = -west;
+  }
+
+  int n = static_cast<int>(sqrt(size / 2.0) + 0.5);
+  if (static_cast<qint64>(n) * n * 2 != size) {
+    return false;
+  }
+
+  type = SAMPLE_INT16;
+  bigEndian = true;
+  rows = cols = n;
+  latStep = lonStep = 1.0 / (n - 1);
+  lat0 = south + 1;
+  lon0 = west;
+  stripOffsets.fill(0, 1);
+  rowsPerStrip = rows;
+  hasVoidValue = true;
+  voidValue = HGT_VOID;
+
+  return true;
+}
+
+bool Tile::openTiff() {
+  if (size < 8) {
+    return false;
+  }
+
+  if (data[0] == 'I' && data[1] == 'I') {
+    bigEndian = false;
+  } else if (data[0] == 'M' && data[1] == 'M') {
+    bigEndian = true;
+  } else {
+    return false;
+  }
+
+  TiffReader reader(data, size, bigEndian);
+  if (reader.read16(2) != 42) {
+    // BigTIFF is not supported.
+    return false;
+  }
+
+  qint64 ifd = reader.read32(4);
+  if (ifd + 2 > size) {
+    return false;
+  }
+  int entryCount = reader.read16(ifd);
+  if (ifd + 2 + 12 * entryCount > size) {
+    return false;
+  }
+
+  QHash<int, qint64> entries;
+  for (int i = 0; i < entryCount; ++i) {
+    qint64 entry = ifd + 2 + 12 * i;
+    entries.insert(reader.read16(entry), entry);
+  }
+
+  if (entries.contains(TAG_TILE_WIDTH) ||
+    entries.contains(TAG_MODEL_TRANSFORMATION)) {
+    return false;
+  }
+
+  QVector<double> values;
+  if (!entries.contains(TAG_IMAGE_WIDTH) ||
+    !entries.contains(TAG_IMAGE_LENGTH) ||
+    !entries.contains(TAG_STRIP_OFFSETS)) {
+    return false;
+  }
+
+  reader.values(entries[TAG_IMAGE_WIDTH], &values);
+  cols = values.isEmpty() ? 0 : static_cast<int>(values[0]);
+  reader.values(entries[TAG_IMAGE_LENGTH], &values);
+  rows = values.isEmpty() ? 0 : static_cast<int>(values[0]);
+
+  rowsPerStrip = rows;
+  if (entries.contains(TAG_ROWS_PER_STRIP) &&
+    reader.values(entries[TAG_ROWS_PER_STRIP], &values) &&
+    !values.isEmpty()) {
+    rowsPerStrip = qMin(rows, static_cast<int>(values[0]));
+  }
+
+  if (entries.contains(TAG_COMPRESSION) &&
+    (!reader.values(entries[TAG_COMPRESSION], &values) ||
+    values.isEmpty() || values[0] != 1)) {
+    return false;
+  }
+
+  if (entries.contains(TAG_SAMPLES_PER_PIXEL) &&
+    (!reader.values(entries[TAG_SAMPLES_PER_PIXEL], &values) ||
+    values.isEmpty() || values[0] != 1)) {
+    return false;
+  }
+
+  int bits = 1;
+  if (entries.contains(TAG_BITS_PER_SAMPLE) &&
+    reader.values(entries[TAG_BITS_PER_SAMPLE], &values) &&
+    !values.isEmpty()) {
+    bits = static_cast<int>(values[0]);
+  }
+  int format = 1;
+  if (entries.contains(TAG_SAMPLE_FORMAT) &&
+    reader.values(entries[TAG_SAMPLE_FORMAT], &values) &&
+    !values.isEmpty()) {
+    format = static_cast<int>(values[0]);
+  }
+
+  if (bits == 16 && format == SAMPLE_FORMAT_INT) {
+    type = SAMPLE_INT16;
+  } else if (bits == 32 && format == SAMPLE_FORMAT_FLOAT) {
+    type = SAMPLE_FLOAT32;
+  } else {
+    return false;
+  }
+
+  // Georeferencing
+  QVector<double> scale;
+  QVector<double> tiepoint;
+  if (!entries.contains(TAG_MODEL_PIXEL_SCALE) ||
+    !entries.contains(TAG_MODEL_TIEPOINT) ||
+    !reader.values(entries[TAG_MODEL_PIXEL_SCALE], &scale) ||
+    !reader.values(entries[TAG_MODEL_TIEPOINT], &tiepoint) ||
+    scale.size() < 2 || tiepoint.size() < 6 ||
+    scale[0] <= 0 || scale[1] <= 0) {
+    return false;
+  }
+
+  bool pixelIsPoint = false;
+  if (entries.contains(TAG_GEO_KEY_DIRECTORY) &&
+    reader.values(entries[TAG_GEO_KEY_DIRECTORY], &values) &&
+    values.size() >= 4) {
+    int keyCount = qMin(static_cast<int>(values[3]), values.size() / 4 - 1);
+    for (int i = 1; i <= keyCount; ++i) {
+      int key = static_cast<int>(values[4 * i]);
+      int value = static_cast<int>(values[4 * i + 3]);
+      if (values[4 * i + 1] != 0) {
+        // Not a short value stored in the directory itself.
+        continue;
+      }
+      if (key == KEY_MODEL_TYPE && value == MODEL_TYPE_PROJECTED) {
+        return false;
+      }
+      if (key == KEY_RASTER_TYPE) {
+        pixelIsPoint = value == RASTER_PIXEL_IS_POINT;
+      }
+    }
+  }
+
+  lonStep = scale[0];
+  latStep = scale[1];
+  lon0 = tiepoint[3] - tiepoint[0] * lonStep;
+  lat0 = tiepoint[4] + tiepoint[1] * latStep;
+  if (!pixelIsPoint) {
+    // The tiepoint is the corner of the pixel, samples are at the centres.
+    lon0 += lonStep / 2;
+    lat0 -= latStep / 2;
+  }
+
+  QByteArray noData;
+  hasVoidValue = entries.contains(TAG_GDAL_NODATA) &&
+    reader.string(entries[TAG_GDAL_NODATA], &noData);
+  if (hasVoidValue) {
+    voidValue = noData.trimmed().toDouble(&hasVoidValue);
+  }
+
+  // Strips
+  if (rows <= 0 || cols <= 0 || rowsPerStrip <= 0 ||
+    !reader.values(entries[TAG_STRIP_OFFSETS], &values)) {
+    return false;
+  }
+  int stripCount = (rows + rowsPerStrip - 1) / rowsPerStrip;
+  if (values.size() < stripCount) {
+    return false;
+  }
+  qint64 sampleSize = type == SAMPLE_INT16 ? 2 : 4;
+  stripOffsets.resize(stripCount);
+  for (int i = 0; i < stripCount; ++i) {
+    int stripRows = qMin(rowsPerStrip, rows - i * rowsPerStrip);
+    stripOffsets[i] = static_cast<qint64>(values[i]);
+    if (stripOffsets[i] + stripRows * cols * sampleSize > size) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Tile::contains(double lat, double lon) const {
+  return isOpen() &&
+    lat <= north() && lat >= south() && lon >= west() && lon <= east();
+}
+
+bool Tile::sample(int row, int col, double *result) const {
+  qint64 index = static_cast<qint64>(row % rowsPerStrip) * cols + col;
+  qint64 offset = stripOffsets[row / rowsPerStrip];
+
+  if (type == SAMPLE_INT16) {
+    const uchar *p = data + offset + 2 * index;
+    *result = static_cast<qint16>(bigEndian ?
+      qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p));
+  } else {
+    const uchar *p = data + offset + 4 * index;
+    quint32 bits = bigEndian ?
+      qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value != value) {
+      return false;
+    }
+    *result = value;
+  }
+
+  return !hasVoidValue || *result != voidValue;
+}
+
+bool Tile::elevation(double lat, double lon, double *result) const {
+  double y = (lat0 - lat) / latStep;
+  double x = (lon - lon0) / lonStep;
+
+  // Negated to also reject NaN.
+  if (!isOpen() || !(y >= 0 && y <= rows - 1 && x >= 0 && x <= cols - 1)) {
+    return false;
+  }
+
+  int row = qMin(static_cast<int>(y), rows - 2);
+  int col = qMin(static_cast<int>(x), cols - 2);
+  double fy = y - row;
+  double fx = x - col;
+
+  double weights[4] = {
+    (1 - fx) * (1 - fy), fx * (1 - fy),
+    (1 - fx) * fy, fx * fy
+  };
+
+  double sum = 0;
+  double weightSum = 0;
+  for (int i = 0; i < 4; ++i) {
+    double value;
+    if (sample(row + i / 2, col + i % 2, &value)) {
+      sum += weights[i] * value;
+      weightSum += weights[i];
+    }
+  }
+
+  if (weightSum <= 0) {
+    return false;
+  }
+
+  *result = sum / weightSum;
+  return true;
+}
+
+}  // End namespace Dem
+}  // End namespace Updraft
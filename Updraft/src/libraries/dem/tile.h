@@ -0,0 +1,100 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_DEM_TILE_H_
+#define UPDRAFT_SRC_LIBRARIES_DEM_TILE_H_
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "dem_global.h"
+
+namespace Updraft {
+namespace Dem {
+
+/// A single memory mapped elevation raster in geographic coordinates.
+/// Supported formats are SRTM HGT (1201x1201 or 3601x3601 big endian
+/// int16 samples, the bounds are taken from the file name like N50E014.hgt)
+/// and GeoTIFF with uncompressed strips of int16 or float32 samples in
+/// a geographic (lat/lon) coordinate system.
+/// The samples are read directly from the mapping, nothing is copied.
+/// Once opened, the tile is read only and can be queried from several
+/// threads at once.
+class DEM_EXPORT Tile {
+ public:
+  Tile();
+  ~Tile();
+
+  /// Open and map the file.
+  /// \return false if the file cannot be mapped or its format
+  ///   is not supported.
+  bool open(const QString &path);
+
+  /// Unmap the file.
+  void close();
+
+  /// Return true if the tile is open.
+  bool isOpen() const { return data != NULL; }
+
+  /// Bounds of the samples in degrees.
+  /// \{
+  double north() const { return lat0; }
+  double south() const { return lat0 - (rows - 1) * latStep; }
+  double west() const { return lon0; }
+  double east() const { return lon0 + (cols - 1) * lonStep; }
+  /// \}
+
+  /// Return true if the point lies within the bounds of the samples.
+  bool contains(double lat, double lon) const;
+
+  /// Bilinear interpolation of the elevation.
+  /// Void samples are left out of the interpolation.
+  /// \param [out] result Elevation in meters above the geoid.
+  /// \return false if the point is outside of the tile or all the
+  ///   surrounding samples are void.
+  bool elevation(double lat, double lon, double *result) const;
+
+ private:
+  Q_DISABLE_COPY(Tile)
+
+  enum SampleType {
+    SAMPLE_INT16,
+    SAMPLE_FLOAT32
+  };
+
+  bool openHgt(const QString &path);
+  bool openTiff();
+
+  /// Return sample at the given position or false if it is void.
+  bool sample(int row, int col, double *result) const;
+
+  QFile file;
+  const uchar *data;
+  qint64 size;
+
+  SampleType type;
+  bool bigEndian;
+
+  int rows;
+  int cols;
+
+  /// Position of the first sample and distance of the samples in degrees.
+  /// Rows go from north to south.
+  /// \{
+  double lat0;
+  double lon0;
+  double latStep;
+  double lonStep;
+  /// \}
+
+  /// Offsets of the strips from the start of the file.
+  /// A HGT file is a single strip.
+  QVector<qint64> stripOffsets;
+  int rowsPerStrip;
+
+  bool hasVoidValue;
+  double voidValue;
+};
+
+}  // End namespace Dem
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_DEM_TILE_H_
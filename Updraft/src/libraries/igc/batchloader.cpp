@@ -0,0 +1,136 @@
+#include "batchloader.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include "igc.h"
+
+namespace Updraft {
+namespace Igc {
+
+BatchItem::BatchItem(const QString &path)
+  : path_(path), file_(NULL), ok_(false) {
+}
+
+BatchItem::~BatchItem() {
+  delete file_;
+}
+
+IgcFile* BatchItem::takeFile() {
+  IgcFile* ret = file_;
+  file_ = NULL;
+  return ret;
+}
+
+bool BatchItem::load(IgcFile *file) {
+  return file->load(path_);
+}
+
+void BatchItem::run(SignatureVerifier *verifier) {
+  file_ = new IgcFile();
+  file_->setVerifier(verifier);
+
+  bool loaded = load(file_);
+  file_->setVerifier(NULL);
+
+  if (!loaded) {
+    qDebug() << "Loading IGC file" << path_ << "failed.";
+    delete file_;
+    file_ = NULL;
+    return;
+  }
+
+  ok_ = process();
+}
+
+/// Runnable that loads a single item and hands it back to the loader.
+class BatchLoader::Task : public QRunnable {
+ public:
+  Task(BatchLoader *loader, BatchItem *item,
+    QSharedPointer<SignatureVerifier> verifier)
+    : loader(loader), item(item), verifier(verifier) {}
+
+  void run() {
+    if (verifier) {
+      SignatureVerifier *own = verifier->clone();
+      item->run(own);
+      delete own;
+    } else {
+      item->run(NULL);
+    }
+    loader->complete(item);
+  }
+
+ private:
+  BatchLoader *loader;
+  BatchItem *item;
+  QSharedPointer<SignatureVerifier> verifier;
+};
+
+BatchLoader::BatchLoader(QObject *parent, int maxThreads)
+  : QObject(parent), pending_(0) {
+  if (maxThreads > 0) {
+    pool.setMaxThreadCount(maxThreads);
+  }
+}
+
+BatchLoader::~BatchLoader() {
+  pool.waitForDone();
+
+  foreach(BatchItem *item, completed) {
+    delete item;
+  }
+}
+
+void BatchLoader::setVerifier(SignatureVerifier *verifier) {
+  this->verifier = QSharedPointer<SignatureVerifier>(verifier);
+}
+
+void BatchLoader::start(const QList<BatchItem*> &items) {
+  pending_ += items.count();
+
+  foreach(BatchItem *item, items) {
+    pool.start(new Task(this, item, verifier));
+  }
+}
+
+void BatchLoader::waitForDone() {
+  pool.waitForDone();
+  deliverCompleted();
+}
+
+void BatchLoader::complete(BatchItem *item) {
+  {
+    QMutexLocker lock(&completedMutex);
+    completed.append(item);
+  }
+
+  // Wake up the owner thread. Several notifications may be merged into
+  // one delivery, the remaining ones then find the list empty.
+  QMetaObject::invokeMethod(this, "deliverCompleted", Qt::QueuedConnection);
+}
+
+void BatchLoader::deliverCompleted() {
+  QList<BatchItem*> items;
+  {
+    QMutexLocker lock(&completedMutex);
+    items.swap(completed);
+  }
+
+  if (items.isEmpty()) {
+    return;
+  }
+
+  foreach(BatchItem *item, items) {
+    --pending_;
+    emit itemLoaded(item);
+  }
+
+  if (pending_ == 0) {
+    emit finished();
+  }
+}
+
+}  // End namespace Igc
+}  // End namespace Updraft
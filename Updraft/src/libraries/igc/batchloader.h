@@ -0,0 +1,134 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_BATCHLOADER_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_BATCHLOADER_H_
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+
+#include "igc_global.h"
+
+namespace Updraft {
+namespace Igc {
+
+class IgcFile;
+class SignatureVerifier;
+
+/// A single file loaded by BatchLoader.
+/// Subclasses can do additional work on the worker thread (projection,
+/// statistics, ...) by overriding process().
+class IGC_EXPORT BatchItem {
+ public:
+  explicit BatchItem(const QString &path);
+  virtual ~BatchItem();
+
+  /// Return path of the file.
+  QString path() const { return path_; }
+
+  /// Return true if the file was loaded and processed successfully.
+  bool ok() const { return ok_; }
+
+  /// Return the loaded file, or NULL if it couldn't be loaded.
+  IgcFile* file() const { return file_; }
+
+  /// Return the loaded file and give up its ownership.
+  IgcFile* takeFile();
+
+ protected:
+  /// Called on a worker thread to load the file.
+  /// Can be overridden to get the file from somewhere else than by parsing
+  /// path(), for example from a FlightCache.
+  /// \return false if the file couldn't be loaded.
+  virtual bool load(IgcFile *file);
+
+  /// Called on a worker thread after the file was successfully loaded.
+  /// Must not touch any GUI objects.
+  /// \return false if the item should be reported as failed.
+  virtual bool process() { return true; }
+
+ private:
+  Q_DISABLE_COPY(BatchItem)
+
+  /// Load and process the file. Runs on a worker thread.
+  /// \param verifier Verifier of the signature used while parsing,
+  ///   or NULL.
+  void run(SignatureVerifier *verifier);
+
+  QString path_;
+  IgcFile* file_;
+  bool ok_;
+
+  friend class BatchLoader;
+};
+
+/// Loads many IGC files in parallel on a thread pool.
+/// Results are delivered through the itemLoaded() signal in the thread
+/// that owns the loader, in the order in which the files were finished.
+class IGC_EXPORT BatchLoader : public QObject {
+  Q_OBJECT
+
+ public:
+  /// \param maxThreads Maximal number of worker threads, or 0 to use
+  ///   one thread per core.
+  explicit BatchLoader(QObject *parent = NULL, int maxThreads = 0);
+
+  /// Wait for the running tasks and delete all undelivered items.
+  ~BatchLoader();
+
+  /// Start loading the items.
+  /// Can be called again while a previous batch is still running.
+  /// The loader owns the items until they are delivered by itemLoaded().
+  void start(const QList<BatchItem*> &items);
+
+  /// Check signatures of the files started from now on.
+  /// Each worker gets its own clone() of the verifier, so the signatures
+  /// are checked in parallel while the files are parsed. The results are
+  /// available from IgcFile::signatureStatus() of the delivered items.
+  /// \param verifier Prototype of the verifiers, or NULL to stop checking.
+  ///   Ownership is taken.
+  void setVerifier(SignatureVerifier *verifier);
+
+  /// Return number of items that were started, but not delivered yet.
+  int pending() const { return pending_; }
+
+  /// Block until all started items are loaded and delivered.
+  void waitForDone();
+
+ signals:
+  /// A file was loaded (or it failed to load).
+  /// The receiver takes ownership of the item.
+  void itemLoaded(Updraft::Igc::BatchItem* item);
+
+  /// All items started so far were delivered.
+  void finished();
+
+ private slots:
+  /// Emit itemLoaded() for all items completed so far.
+  void deliverCompleted();
+
+ private:
+  class Task;
+
+  /// Called from the worker threads when an item is done.
+  void complete(BatchItem *item);
+
+  QThreadPool pool;
+
+  /// Prototype of the verifiers for the worker threads, or NULL.
+  /// Tasks keep a reference, so it is only replaced, never modified.
+  QSharedPointer<SignatureVerifier> verifier;
+
+  /// Items done by the workers, but not yet delivered.
+  /// Protected by completedMutex.
+  QList<BatchItem*> completed;
+  QMutex completedMutex;
+
+  int pending_;
+};
+
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_BATCHLOADER_H_
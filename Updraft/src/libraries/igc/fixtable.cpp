@@ -0,0 +1,277 @@
+#include "fixtable.h"
+
+#include <string.h>
+
+#include <QtAlgorithms>
+
+#include "igcdecode.h"
+
+namespace Updraft {
+namespace Igc {
+
+static const qint32 SECONDS_PER_DAY = 24 * 3600;
+
+/// Orders row indices by the seconds column.
+/// Used with qStableSort, so rows with the same time keep the file order.
+class SecondsLessThan {
+ public:
+  explicit SecondsLessThan(const qint32 *seconds)
+    : seconds(seconds) {}
+
+  bool operator()(int i1, int i2) const {
+    return seconds[i1] < seconds[i2];
+  }
+
+ private:
+  const qint32 *seconds;
+};
+
+/// Allocate a copy of a column with a new capacity.
+template<class T>
+static T* growColumn(Util::Arena *arena, const T* old, int oldCount,
+  int newCapacity) {
+  T* ret = arena->allocateArray<T>(newCapacity);
+  if (oldCount) {
+    memcpy(ret, old, sizeof(T) * oldCount);
+  }
+  return ret;
+}
+
+FixTable::FixTable()
+  : count_(0), capacity_(0), startSecondsOfDay_(0),
+  seconds_(NULL), lat_(NULL), lon_(NULL), gpsAlt_(NULL), pressureAlt_(NULL),
+  valid_(NULL), extensionBytes_(NULL), extensionStride_(0) {
+}
+
+QTime FixTable::timestamp(int i) const {
+  return QTime(0, 0).addSecs((startSecondsOfDay_ + seconds_[i]) %
+    SECONDS_PER_DAY);
+}
+
+Util::Location FixTable::location(int i) const {
+  Util::Location ret;
+  ret.lat = latitude(i);
+  ret.lon = longitude(i);
+  ret.alt = gpsAlt_[i];
+  return ret;
+}
+
+int FixTable::extensionIndex(const QByteArray &code) const {
+  for (int i = 0; i < extensions_.count(); ++i) {
+    if (extensions_[i].code == code) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const qint32* FixTable::extensionData(int column) const {
+  QVector<qint32> &values = decoded_[column];
+  int first = values.count();
+  if (first == count_) {
+    return values.constData();
+  }
+
+  values.resize(count_);
+  qint32 *out = values.data();
+
+  const Extension &ext = extensions_[column];
+  const char *p = extensionBytes_ + first * extensionStride_ + ext.offset;
+  for (int i = first; i < count_; ++i, p += extensionStride_) {
+    int value;
+    out[i] = decodeSigned(p, ext.length, &value) ? value : 0;
+  }
+
+  return values.constData();
+}
+
+void FixTable::clear() {
+  count_ = 0;
+  capacity_ = 0;
+  startSecondsOfDay_ = 0;
+
+  seconds_ = lat_ = lon_ = gpsAlt_ = pressureAlt_ = NULL;
+  valid_ = NULL;
+
+  extensions_.clear();
+  extensionBytes_ = NULL;
+  extensionStride_ = 0;
+  decoded_.clear();
+}
+
+void FixTable::setExtensions(Util::Arena *arena,
+  const QList<Extension> &extensions, int stride) {
+  Q_ASSERT(count_ == 0);
+
+  extensions_ = extensions;
+  extensionStride_ = stride;
+  extensionBytes_ = NULL;
+  if (stride && capacity_) {
+    extensionBytes_ = arena->allocateArray<char>(capacity_ * stride);
+  }
+  decoded_.clear();
+  decoded_.resize(extensions.count());
+}
+
+void FixTable::reserve(Util::Arena *arena, int capacity) {
+  if (capacity <= capacity_) {
+    return;
+  }
+
+  int oldWords = (count_ + 31) / 32;
+  int newWords = (capacity + 31) / 32;
+
+  seconds_ = growColumn(arena, seconds_, count_, capacity);
+  lat_ = growColumn(arena, lat_, count_, capacity);
+  lon_ = growColumn(arena, lon_, count_, capacity);
+  gpsAlt_ = growColumn(arena, gpsAlt_, count_, capacity);
+  pressureAlt_ = growColumn(arena, pressureAlt_, count_, capacity);
+  valid_ = growColumn(arena, valid_, oldWords, newWords);
+  if (extensionStride_) {
+    extensionBytes_ = growColumn(arena, extensionBytes_,
+      count_ * extensionStride_, capacity * extensionStride_);
+  }
+
+  // append() only sets bits, so the new words have to start cleared.
+  memset(valid_ + oldWords, 0, sizeof(quint32) * (newWords - oldWords));
+
+  capacity_ = capacity;
+}
+
+void FixTable::append(Util::Arena *arena, qint32 secondsOfDay,
+  qint32 lat, qint32 lon, qint32 pressureAlt, qint32 gpsAlt, bool valid,
+  const char *ext, int extLength) {
+  if (count_ == capacity_) {
+    reserve(arena, qMax(2 * capacity_, 1024));
+  }
+
+  int i = count_;
+
+  seconds_[i] = secondsOfDay;
+  lat_[i] = lat;
+  lon_[i] = lon;
+  gpsAlt_[i] = gpsAlt;
+  pressureAlt_[i] = pressureAlt;
+  if (valid) {
+    valid_[i >> 5] |= 1u << (i & 31);
+  }
+
+  if (extensionStride_) {
+    // Short records are padded, the missing fields then fail to decode.
+    char *dst = extensionBytes_ + i * extensionStride_;
+    int copied = qBound(0, extLength, extensionStride_);
+    memcpy(dst, ext, copied);
+    memset(dst + copied, ' ', extensionStride_ - copied);
+  }
+
+  ++count_;
+}
+
+bool FixTable::appendInOrder(Util::Arena *arena, qint32 secondsOfDay,
+  qint32 lat, qint32 lon, qint32 pressureAlt, qint32 gpsAlt, bool valid,
+  const char *ext, int extLength) {
+  if (count_ == 0) {
+    startSecondsOfDay_ = secondsOfDay;
+    append(arena, 0, lat, lon, pressureAlt, gpsAlt, valid, ext, extLength);
+    return true;
+  }
+
+  qint32 previous = seconds_[count_ - 1];
+  qint32 t = secondsOfDay - startSecondsOfDay_;
+  while (t < previous - SECONDS_PER_DAY / 2) {
+    t += SECONDS_PER_DAY;
+  }
+
+  if (t < previous) {
+    return false;
+  }
+
+  append(arena, t, lat, lon, pressureAlt, gpsAlt, valid, ext, extLength);
+  return true;
+}
+
+void FixTable::finish(Util::Arena *arena) {
+  if (count_ == 0) {
+    return;
+  }
+
+  // Unwrap midnight crossings, so that the times are monotonic.
+  qint32 dayOffset = 0;
+  qint32 previous = seconds_[0];
+  bool sorted = true;
+  for (int i = 1; i < count_; ++i) {
+    qint32 t = seconds_[i] + dayOffset;
+    if (t < previous - SECONDS_PER_DAY / 2) {
+      dayOffset += SECONDS_PER_DAY;
+      t += SECONDS_PER_DAY;
+    }
+    if (t < previous) {
+      sorted = false;
+    }
+    seconds_[i] = t;
+    previous = t;
+  }
+
+  if (!sorted) {
+    QVector<int> order(count_);
+    for (int i = 0; i < count_; ++i) {
+      order[i] = i;
+    }
+    qStableSort(order.begin(), order.end(), SecondsLessThan(seconds_));
+    permute(arena, order);
+  }
+
+  qint32 start = seconds_[0];
+  for (int i = 0; i < count_; ++i) {
+    seconds_[i] -= start;
+  }
+  startSecondsOfDay_ = start % SECONDS_PER_DAY;
+}
+
+void FixTable::permute(Util::Arena *arena, const QVector<int> &order) {
+  // Unsorted files are rare, so we just take new columns from the arena
+  // and let the old ones be released with it.
+  qint32 *seconds = arena->allocateArray<qint32>(capacity_);
+  qint32 *lat = arena->allocateArray<qint32>(capacity_);
+  qint32 *lon = arena->allocateArray<qint32>(capacity_);
+  qint32 *gpsAlt = arena->allocateArray<qint32>(capacity_);
+  qint32 *pressureAlt = arena->allocateArray<qint32>(capacity_);
+  int words = (capacity_ + 31) / 32;
+  quint32 *valid = arena->allocateArray<quint32>(words);
+  memset(valid, 0, sizeof(quint32) * words);
+  char *extensionBytes = NULL;
+  if (extensionStride_) {
+    extensionBytes = arena->allocateArray<char>(capacity_ * extensionStride_);
+  }
+
+  for (int i = 0; i < count_; ++i) {
+    int j = order[i];
+    seconds[i] = seconds_[j];
+    lat[i] = lat_[j];
+    lon[i] = lon_[j];
+    gpsAlt[i] = gpsAlt_[j];
+    pressureAlt[i] = pressureAlt_[j];
+    if (this->valid(j)) {
+      valid[i >> 5] |= 1u << (i & 31);
+    }
+    if (extensionStride_) {
+      memcpy(extensionBytes + i * extensionStride_,
+        extensionBytes_ + j * extensionStride_, extensionStride_);
+    }
+  }
+
+  seconds_ = seconds;
+  lat_ = lat;
+  lon_ = lon;
+  gpsAlt_ = gpsAlt;
+  pressureAlt_ = pressureAlt;
+  valid_ = valid;
+  extensionBytes_ = extensionBytes;
+
+  for (int i = 0; i < decoded_.count(); ++i) {
+    decoded_[i].clear();
+  }
+}
+
+}  // End namespace Igc
+}  // End namespace Updraft
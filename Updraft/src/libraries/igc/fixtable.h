@@ -0,0 +1,186 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_FIXTABLE_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_FIXTABLE_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QTime>
+#include <QVector>
+
+#include "igc_global.h"
+#include "../util/util.h"
+
+namespace Updraft {
+namespace Igc {
+
+/// Fixes of an IGC file stored column-wise.
+/// Every column is a contiguous array allocated from the arena of the owning
+/// IgcFile (or mapped from a FlightCache entry), so that walking through
+/// a single value (altitudes for the barogram, times for a lookup) only
+/// touches the memory it needs.
+/// Latitude and longitude are kept in thousandths of arc minute, the unit
+/// used by B records, so the stored values are exactly what the file says.
+/// Rows are sorted by time.
+///
+/// Extension fields of the B records (engine noise, airspeed, ...) are kept
+/// as raw bytes and a column is only decoded when it is requested for the
+/// first time.
+class IGC_EXPORT FixTable {
+ public:
+  FixTable();
+
+  /// Return number of fixes in the table.
+  int count() const { return count_; }
+
+  /// Return true if there are no fixes.
+  bool isEmpty() const { return count_ == 0; }
+
+  /// Return number of seconds between the first fix and fix i.
+  /// This value is monotonic, also when the recording crosses midnight.
+  qint32 seconds(int i) const { return seconds_[i]; }
+
+  /// Return time of day of the first fix in seconds after midnight UTC.
+  qint32 startSecondsOfDay() const { return startSecondsOfDay_; }
+
+  /// Return time of day of fix i.
+  QTime timestamp(int i) const;
+
+  /// Return latitude of fix i in thousandths of arc minute.
+  /// Negative values go south.
+  qint32 rawLatitude(int i) const { return lat_[i]; }
+
+  /// Return longitude of fix i in thousandths of arc minute.
+  /// Negative values go west.
+  qint32 rawLongitude(int i) const { return lon_[i]; }
+
+  /// Return latitude of fix i in degrees.
+  qreal latitude(int i) const { return lat_[i] / 60000.0; }
+
+  /// Return longitude of fix i in degrees.
+  qreal longitude(int i) const { return lon_[i] / 60000.0; }
+
+  /// Return GNSS altitude of fix i in meters.
+  qint32 gpsAltitude(int i) const { return gpsAlt_[i]; }
+
+  /// Return pressure altitude of fix i in meters.
+  qint32 pressureAltitude(int i) const { return pressureAlt_[i]; }
+
+  /// Return true if fix i is a 3D fix (validity flag 'A').
+  bool valid(int i) const { return (valid_[i >> 5] >> (i & 31)) & 1; }
+
+  /// Return location of fix i with GNSS altitude.
+  Util::Location location(int i) const;
+
+  /// Return number of the extension columns described by the I record.
+  int extensionCount() const { return extensions_.count(); }
+
+  /// Return the three letter code of an extension column, e.g. "ENL".
+  QByteArray extensionCode(int column) const {
+    return extensions_[column].code;
+  }
+
+  /// Return index of the extension column with the given code,
+  /// or -1 if the file doesn't have it.
+  int extensionIndex(const QByteArray &code) const;
+
+  /// Return values of an extension column, count() items.
+  /// The column is decoded on the first call, fixes appended later are
+  /// decoded on the next call. Values that are missing in the record or
+  /// that are not numbers are 0.
+  /// The returned pointer is only valid until new fixes are appended.
+  /// \note Not thread safe, the first call modifies the table.
+  const qint32* extensionData(int column) const;
+
+  /// Return value of extension column for fix i.
+  qint32 extension(int column, int i) const {
+    return extensionData(column)[i];
+  }
+
+  /// Raw column arrays, count() items each.
+  /// \{
+  const qint32* secondsData() const { return seconds_; }
+  const qint32* latitudeData() const { return lat_; }
+  const qint32* longitudeData() const { return lon_; }
+  const qint32* gpsAltitudeData() const { return gpsAlt_; }
+  const qint32* pressureAltitudeData() const { return pressureAlt_; }
+  /// \}
+
+ private:
+  friend class IgcFile;
+  friend class FlightCache;
+
+  /// Forget all rows. Memory belongs to the arena and is not released.
+  void clear();
+
+  /// Make sure that there is space for at least capacity rows.
+  /// If the columns have to grow, they are copied to a new place in the
+  /// arena.
+  void reserve(Util::Arena *arena, int capacity);
+
+  /// Layout of an extension column inside the extension bytes of a row.
+  struct Extension {
+    QByteArray code;
+    int offset;
+    int length;
+  };
+
+  /// Set the extension columns.
+  /// Can only be called while the table is empty. Capacity reserved
+  /// before is kept.
+  /// \param arena Arena for the extension bytes.
+  /// \param extensions Extension columns.
+  /// \param stride Number of extension bytes stored for every row.
+  void setExtensions(Util::Arena *arena, const QList<Extension> &extensions,
+    int stride);
+
+  /// Add a row at the end of the table.
+  /// \param secondsOfDay Time of the fix as recorded in the file.
+  /// \param ext Extension bytes of the B record.
+  /// \param extLength Number of the extension bytes.
+  void append(Util::Arena *arena, qint32 secondsOfDay,
+    qint32 lat, qint32 lon, qint32 pressureAlt, qint32 gpsAlt, bool valid,
+    const char *ext, int extLength);
+
+  /// Add a row that follows the already finished rows.
+  /// Time is converted right away, crossing midnight is detected the same
+  /// way as in finish().
+  /// \return false if the fix would go back in time. Nothing is added then.
+  bool appendInOrder(Util::Arena *arena, qint32 secondsOfDay,
+    qint32 lat, qint32 lon, qint32 pressureAlt, qint32 gpsAlt, bool valid,
+    const char *ext, int extLength);
+
+  /// Convert times of day to seconds since the first fix and sort the rows.
+  /// A backward jump of more than 12 hours is treated as crossing midnight,
+  /// smaller jumps are considered to be out of order records.
+  void finish(Util::Arena *arena);
+
+  /// Reorder all columns according to the permutation.
+  void permute(Util::Arena *arena, const QVector<int> &order);
+
+  int count_;
+  int capacity_;
+
+  qint32 startSecondsOfDay_;
+
+  qint32 *seconds_;
+  qint32 *lat_;
+  qint32 *lon_;
+  qint32 *gpsAlt_;
+  qint32 *pressureAlt_;
+
+  /// Validity flags, one bit per row.
+  quint32 *valid_;
+
+  QList<Extension> extensions_;
+
+  /// Extension bytes of all rows, extensionStride_ bytes per row.
+  char *extensionBytes_;
+  int extensionStride_;
+
+  /// Extension columns decoded so far, indexed by the column.
+  mutable QVector<QVector<qint32> > decoded_;
+};
+
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_FIXTABLE_H_
@@ -0,0 +1,430 @@
+#include "flightcache.h"
+
+#include <string.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+#include "igc.h"
+
+namespace Updraft {
+namespace Igc {
+
+/// Increase when the layout of the entries changes.
+static const quint32 CACHE_VERSION = 4;
+
+static const char CACHE_MAGIC[8] = {'U', 'P', 'D', 'I', 'G', 'C', 'C', '\0'};
+
+/// Written in native byte order, entries from a machine with different
+/// endianness are then considered stale.
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+/// Sections of an entry start at multiples of this.
+static const qint64 SECTION_ALIGNMENT = 16;
+
+/// Type of the stored projected coordinates.
+typedef double Coordinate;
+
+/// Number of int32 columns of the fix table.
+static const int COLUMN_COUNT = 5;
+
+/// Fixed size header at the start of every entry.
+/// All offsets are in bytes from the start of the entry.
+struct EntryHeader {
+  char magic[8];
+  quint32 byteOrder;
+  quint32 version;
+
+  /// Identification of the source file.
+  /// \{
+  qint64 sourceSize;
+  qint64 sourceMtime;
+  quint64 sourceHash;
+  /// \}
+
+  /// Number of parsed bytes, it differs from sourceSize for compressed
+  /// files.
+  qint64 dataSize;
+
+  /// Headers, the projection name, the extension layout and the
+  /// unterminated last line of a followed file serialized with QDataStream.
+  qint64 metaOffset;
+  qint64 metaSize;
+
+  /// Five int32 columns followed by the validity bits.
+  qint64 columnsOffset;
+
+  /// Raw B record extensions, extensionStride bytes for every fix.
+  qint64 extensionsOffset;
+
+  /// Projected coordinates, six doubles for every valid fix.
+  qint64 projectionOffset;
+  qint32 projectionCount;
+
+  qint32 fixCount;
+  qint32 startSecondsOfDay;
+  qint32 extensionStride;
+};
+
+/// Identification of the content of a source file.
+struct SourceKey {
+  qint64 size;
+  qint64 mtime;
+  quint64 hash;
+
+  /// The file is gzip or zip compressed.
+  bool compressed;
+};
+
+static qint64 alignSection(qint64 offset) {
+  return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+/// Return size of a padded column with count int32 values.
+static qint64 columnBytes(int count) {
+  return alignSection(sizeof(qint32) * static_cast<qint64>(count));
+}
+
+/// Return size of the validity bits for count fixes.
+static qint64 validBytes(int count) {
+  return sizeof(quint32) * static_cast<qint64>((count + 31) / 32);
+}
+
+/// 64bit FNV-1a hash.
+/// Not cryptographic, it only has to notice that the file was changed.
+static quint64 hashData(const uchar *data, qint64 size) {
+  quint64 hash = Q_UINT64_C(14695981039346656037);
+  for (qint64 i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= Q_UINT64_C(1099511628211);
+  }
+  return hash;
+}
+
+/// Fill size and modification time of the source file.
+static bool statSource(const QString &path, SourceKey *key) {
+  QFileInfo info(path);
+  if (!info.isFile()) {
+    return false;
+  }
+
+  key->size = info.size();
+  key->mtime = info.lastModified().toTime_t();
+  return true;
+}
+
+/// Compute hash of the source file content.
+static bool hashSource(const QString &path, SourceKey *key) {
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  key->compressed = Util::DecompressingDevice::isCompressed(&f);
+
+  if (f.size() == 0) {
+    key->hash = hashData(NULL, 0);
+    return true;
+  }
+
+  uchar *mapped = f.map(0, f.size());
+  if (mapped) {
+    key->hash = hashData(mapped, f.size());
+    f.unmap(mapped);
+    return true;
+  }
+
+  QByteArray data = f.readAll();
+  key->hash = hashData(reinterpret_cast<const uchar*>(data.constData()),
+    data.size());
+  return true;
+}
+
+/// Write zero bytes up to the next section boundary.
+static void padSection(QIODevice *dev) {
+  static const char zeros[SECTION_ALIGNMENT] = {0};
+  qint64 pos = dev->pos();
+  dev->write(zeros, alignSection(pos) - pos);
+}
+
+FlightCache::FlightCache(const QDir &directory)
+  : dir(directory) {
+  if (!dir.exists()) {
+    dir.mkpath(".");
+  }
+}
+
+QString FlightCache::entryPath(const QString &path) const {
+  QByteArray key = QFileInfo(path).absoluteFilePath().toUtf8();
+  QByteArray name = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+  return dir.absoluteFilePath(QString::fromAscii(name.toHex()) + ".cache");
+}
+
+void FlightCache::remove(const QString &path) {
+  QFile::remove(entryPath(path));
+}
+
+bool FlightCache::load(const QString &path, IgcFile *file,
+  const QString &projection, QVector<double> *projected) {
+  if (projected) {
+    projected->clear();
+  }
+
+  if (file->verifier_) {
+    // Signatures can only be checked on the original records.
+    return false;
+  }
+
+  QString entry = entryPath(path);
+  QFile *f = new QFile(entry);
+  if (!f->open(QIODevice::ReadOnly)) {
+    delete f;
+    return false;
+  }
+
+  qint64 size = f->size();
+  const uchar *mapped = NULL;
+  if (size >= static_cast<qint64>(sizeof(EntryHeader))) {
+    mapped = f->map(0, size);
+  }
+  if (!mapped) {
+    delete f;
+    return false;
+  }
+
+  EntryHeader header;
+  memcpy(&header, mapped, sizeof(header));
+
+  bool valid =
+    memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+    header.byteOrder == BYTE_ORDER_MARK &&
+    header.version == CACHE_VERSION &&
+    header.fixCount >= 0 &&
+    header.projectionCount >= 0 &&
+    header.extensionStride >= 0 &&
+    header.dataSize >= 0 &&
+    header.metaOffset + header.metaSize <= size &&
+    header.columnsOffset + COLUMN_COUNT * columnBytes(header.fixCount) +
+      validBytes(header.fixCount) <= size &&
+    header.extensionsOffset + static_cast<qint64>(header.extensionStride) *
+      header.fixCount <= size &&
+    header.projectionOffset +
+      static_cast<qint64>(sizeof(Coordinate)) * header.projectionCount <= size;
+
+  // Size and time are checked first, so that a changed file doesn't
+  // have to be hashed.
+  SourceKey key;
+  valid = valid && statSource(path, &key) &&
+    key.size == header.sourceSize && key.mtime == header.sourceMtime &&
+    hashSource(path, &key) && key.hash == header.sourceHash;
+
+  QString storedPath;
+  QString storedProjection;
+  qreal altimeterSetting = 0;
+  QString competitionClass, competitionId, manufacturer, frType;
+  QString gliderId, gps, gliderType, pilot;
+  QDate date;
+  QList<FixTable::Extension> extensions;
+  QByteArray pendingLine;
+
+  if (valid) {
+    QByteArray meta = QByteArray::fromRawData(
+      reinterpret_cast<const char*>(mapped + header.metaOffset),
+      header.metaSize);
+    QDataStream stream(meta);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream >> storedPath >> storedProjection >> altimeterSetting >>
+      competitionClass >> competitionId >> date >> manufacturer >>
+      frType >> gliderId >> gps >> gliderType >> pilot;
+
+    qint32 extensionCount = 0;
+    stream >> extensionCount;
+    for (int i = 0; i < extensionCount && stream.status() == QDataStream::Ok;
+      ++i) {
+      FixTable::Extension ext;
+      qint32 offset, length;
+      stream >> ext.code >> offset >> length;
+      ext.offset = offset;
+      ext.length = length;
+      valid = valid && offset >= 0 && length > 0 &&
+        offset + length <= header.extensionStride;
+      extensions.append(ext);
+    }
+    stream >> pendingLine;
+
+    valid = valid && stream.status() == QDataStream::Ok &&
+      storedPath == QFileInfo(path).absoluteFilePath();
+  }
+
+  if (!valid) {
+    qDebug() << "Cache entry for" << path << "is stale.";
+    delete f;
+    QFile::remove(entry);
+    return false;
+  }
+
+  file->clear();
+  file->errorOffset_ = -1;
+  file->errorString_ = QString();
+
+  file->altimeterSetting_ = altimeterSetting;
+  file->competitionClass_ = competitionClass;
+  file->competitionId_ = competitionId;
+  file->date_ = date;
+  file->manufacturer_ = manufacturer;
+  file->frType_ = frType;
+  file->gliderId_ = gliderId;
+  file->gps_ = gps;
+  file->gliderType_ = gliderType;
+  file->pilot_ = pilot;
+
+  // The columns point directly into the mapping, they are never written
+  // to. Appending new fixes moves them to the arena first.
+  int count = header.fixCount;
+  qint32 *columns = reinterpret_cast<qint32*>(
+    const_cast<uchar*>(mapped + header.columnsOffset));
+  qint64 stride = columnBytes(count) / sizeof(qint32);
+
+  FixTable &table = file->fixTable;
+  table.setExtensions(&file->arena, extensions, header.extensionStride);
+  table.count_ = count;
+  table.capacity_ = count;
+  table.startSecondsOfDay_ = header.startSecondsOfDay;
+  table.seconds_ = columns;
+  table.lat_ = columns + stride;
+  table.lon_ = columns + 2 * stride;
+  table.gpsAlt_ = columns + 3 * stride;
+  table.pressureAlt_ = columns + 4 * stride;
+  table.valid_ = reinterpret_cast<quint32*>(columns + COLUMN_COUNT * stride);
+  if (header.extensionStride) {
+    table.extensionBytes_ = reinterpret_cast<char*>(
+      const_cast<uchar*>(mapped + header.extensionsOffset));
+  }
+
+  file->aRecordSeen = true;
+  file->dataSize_ = header.dataSize;
+  file->pendingLine = pendingLine;
+  file->cacheFile = f;
+
+  if (projected && header.projectionCount > 0 &&
+    storedProjection == projection) {
+    projected->resize(header.projectionCount);
+    memcpy(projected->data(), mapped + header.projectionOffset,
+      sizeof(Coordinate) * header.projectionCount);
+  }
+
+  return true;
+}
+
+bool FlightCache::store(const QString &path, const IgcFile &file,
+  const QString &projection, const QVector<double> &projected) {
+  SourceKey key;
+  if (!statSource(path, &key) || !hashSource(path, &key)) {
+    return false;
+  }
+
+  if (!key.compressed && key.size != file.dataSize()) {
+    // The file was changed since it was parsed.
+    return false;
+  }
+
+  QByteArray meta;
+  {
+    QDataStream stream(&meta, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << QFileInfo(path).absoluteFilePath() << projection <<
+      file.altimeterSetting() << file.competitionClass() <<
+      file.competitionId() << file.date() << file.manufacturer() <<
+      file.frType() << file.gliderId() << file.gps() << file.gliderType() <<
+      file.pilot();
+
+    stream << static_cast<qint32>(file.fixTable.extensions_.count());
+    foreach(FixTable::Extension ext, file.fixTable.extensions_) {
+      stream << ext.code << static_cast<qint32>(ext.offset) <<
+        static_cast<qint32>(ext.length);
+    }
+    stream << file.pendingLine;
+  }
+
+  const FixTable &table = file.fixes();
+  int count = table.count();
+  qint64 extensionBytes =
+    static_cast<qint64>(table.extensionStride_) * count;
+
+  EntryHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.byteOrder = BYTE_ORDER_MARK;
+  header.version = CACHE_VERSION;
+  header.sourceSize = key.size;
+  header.dataSize = file.dataSize();
+  header.sourceMtime = key.mtime;
+  header.sourceHash = key.hash;
+  header.metaOffset = alignSection(sizeof(header));
+  header.metaSize = meta.size();
+  header.columnsOffset = alignSection(header.metaOffset + header.metaSize);
+  header.extensionsOffset = alignSection(header.columnsOffset +
+    COLUMN_COUNT * columnBytes(count) + validBytes(count));
+  header.projectionOffset = alignSection(header.extensionsOffset +
+    extensionBytes);
+  header.projectionCount = projected.count();
+  header.fixCount = count;
+  header.startSecondsOfDay = table.startSecondsOfDay();
+  header.extensionStride = table.extensionStride_;
+
+  // Written to a temporary file first, so that a reader never sees
+  // a half written entry.
+  QTemporaryFile tmp(dir.absoluteFilePath("XXXXXX.tmp"));
+  if (!tmp.open()) {
+    qDebug() << "Couldn't create a cache entry for" << path;
+    return false;
+  }
+
+  tmp.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  padSection(&tmp);
+  tmp.write(meta);
+  padSection(&tmp);
+
+  const qint32 *columns[COLUMN_COUNT] = {
+    table.secondsData(), table.latitudeData(), table.longitudeData(),
+    table.gpsAltitudeData(), table.pressureAltitudeData()
+  };
+  for (int i = 0; i < COLUMN_COUNT; ++i) {
+    tmp.write(reinterpret_cast<const char*>(columns[i]),
+      sizeof(qint32) * count);
+    padSection(&tmp);
+  }
+  tmp.write(reinterpret_cast<const char*>(table.valid_), validBytes(count));
+  padSection(&tmp);
+
+  if (extensionBytes) {
+    tmp.write(table.extensionBytes_, extensionBytes);
+    padSection(&tmp);
+  }
+
+  tmp.write(reinterpret_cast<const char*>(projected.constData()),
+    sizeof(Coordinate) * projected.count());
+
+  if (tmp.error() != QFile::NoError) {
+    qDebug() << "Writing cache entry failed (" << tmp.errorString() << ")";
+    return false;
+  }
+
+  QString entry = entryPath(path);
+  tmp.close();
+  QFile::remove(entry);
+  if (!tmp.rename(entry)) {
+    return false;
+  }
+  tmp.setAutoRemove(false);
+
+  return true;
+}
+
+}  // End namespace Igc
+}  // End namespace Updraft
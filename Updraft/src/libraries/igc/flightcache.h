@@ -0,0 +1,73 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_FLIGHTCACHE_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_FLIGHTCACHE_H_
+
+#include <QDir>
+#include <QString>
+#include <QVector>
+
+#include "igc_global.h"
+
+namespace Updraft {
+namespace Igc {
+
+class IgcFile;
+
+/// On-disk cache of parsed IGC files.
+/// Every cached flight is stored in a single file holding the headers and
+/// the fix table columns exactly as they are laid out in memory, optionally
+/// followed by projected coordinates of the fixes. Loading an entry maps the
+/// file and points the fix table directly to it, so no fix is decoded.
+///
+/// Entries are keyed by the absolute path of the source file and validated
+/// against its size on disk, modification time and a hash of its content,
+/// so compressed files are cached too. Stale entries are removed when they
+/// are found, the caller is expected to parse the file again and store() it.
+///
+/// Different entries can be used from several threads at once.
+class IGC_EXPORT FlightCache {
+ public:
+  /// \param directory Directory with the cache entries. It is created if
+  ///   it doesn't exist.
+  explicit FlightCache(const QDir &directory);
+
+  /// Return the directory with the cache entries.
+  QDir directory() const { return dir; }
+
+  /// Load a flight from the cache.
+  /// \param path Path to the original IGC file.
+  /// \param file The file to load the cached data into.
+  /// \param projection Identification of the projection of the stored
+  ///   coordinates.
+  /// \param [out] projected If not NULL, it is filled with the stored
+  ///   coordinates if they were stored with the same projection, or
+  ///   cleared otherwise.
+  /// \return true if a valid entry was found. Always false if the file
+  ///   has a signature verifier set.
+  bool load(const QString &path, IgcFile *file,
+    const QString &projection = QString(), QVector<double> *projected = NULL);
+
+  /// Store a parsed flight to the cache.
+  /// \param path Path to the original IGC file, it must be the file that
+  ///   was loaded into file.
+  /// \param file The loaded file.
+  /// \param projection Identification of the projection of the coordinates.
+  /// \param projected Projected coordinates, may be empty.
+  /// \return true if the entry was written.
+  bool store(const QString &path, const IgcFile &file,
+    const QString &projection = QString(),
+    const QVector<double> &projected = QVector<double>());
+
+  /// Remove the cache entry of a file.
+  void remove(const QString &path);
+
+ private:
+  /// Return path of the entry for the given IGC file.
+  QString entryPath(const QString &path) const;
+
+  QDir dir;
+};
+
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_FLIGHTCACHE_H_
@@ -1,14 +1,48 @@
 #include "igc.h"
 
-#include <QtAlgorithms>
+#include <string.h>
+
+#include <QDateTime>
 #include <QDebug>
 #include <QFile>
 
+#include "igcdecode.h"
+
 namespace Updraft {
 namespace Igc {
 
+/// Minimal length of a B record. Everything after this offset
+/// is an extension described by the I record.
+static const int B_RECORD_LENGTH = 35;
+
+static inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+    c == '\v' || c == '\f';
+}
+
+/// Number of bytes read at once by load() from a device.
+static const int LOAD_CHUNK_SIZE = 64 * 1024;
+
+/// Number of bytes read from the beginning of a file by probe(), if the
+/// file can't be mapped. Headers are always much shorter.
+static const qint64 PROBE_HEAD_SIZE = 64 * 1024;
+
+/// Number of bytes read from the end of a file by probe(), if the file
+/// can't be mapped. This has to be enough to skip the security records.
+static const qint64 PROBE_TAIL_SIZE = 16 * 1024;
+
+IgcFile::IgcFile()
+  : eventListValid(false), activeCodec(NULL), aRecordSeen(false),
+  appending(false), dataSize_(0), cacheFile(NULL), recordOffset(0),
+  errorOffset_(-1), verifier_(NULL), signatureStatus_(SIGNATURE_NOT_CHECKED),
+  altimeterSetting_(0) {
+}
+
 /// Open a file with given path and
 /// load it.
+/// The file is mapped to memory and parsed without copying, if mapping
+/// is not possible, it is read in chunks.
+/// Compressed files are decompressed while reading.
 bool IgcFile::load(const QString& path, QTextCodec* codec) {
   QFile f(path);
 
@@ -17,41 +51,398 @@ bool IgcFile::load(const QString& path, QTextCodec* codec) {
     return false;
   }
 
+  if (Util::DecompressingDevice::isCompressed(&f)) {
+    Util::DecompressingDevice dev(&f);
+    if (!dev.open(QIODevice::ReadOnly)) {
+      qDebug() << "Couldn't decompress " << path << "(" <<
+        dev.errorString() << ")";
+      return false;
+    }
+    return load(&dev, codec);
+  }
+
+  if (f.size() > 0) {
+    uchar *mapped = f.map(0, f.size());
+    if (mapped) {
+      bool ret = load(reinterpret_cast<const char*>(mapped), f.size(), codec);
+      f.unmap(mapped);
+      return ret;
+    }
+  }
+
   return load(&f, codec);
 }
 
+/// The file is mapped, so that only the pages with the headers and the last
+/// fix are actually read.
+bool IgcFile::probe(const QString &path, FlightSummary *summary) {
+  clear();
+  errorOffset_ = -1;
+  errorString_ = QString();
+
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    qDebug() << "Couldn't open " << path << ".";
+    return false;
+  }
+
+  if (Util::DecompressingDevice::isCompressed(&f)) {
+    // The end of a compressed file can only be reached by decompressing
+    // all of it, but at least only the last chunks are kept.
+    Util::DecompressingDevice dev(&f);
+    if (!dev.open(QIODevice::ReadOnly)) {
+      qDebug() << "Couldn't decompress " << path << "(" <<
+        dev.errorString() << ")";
+      return false;
+    }
+
+    QByteArray head = dev.read(PROBE_HEAD_SIZE);
+    QByteArray tail = head;
+    QByteArray previous;
+    while (!dev.atEnd()) {
+      QByteArray chunk = dev.read(PROBE_TAIL_SIZE);
+      if (chunk.isEmpty()) {
+        break;
+      }
+      previous = tail;
+      tail = chunk;
+    }
+    if (tail.constData() != head.constData()) {
+      tail.prepend(previous.right(PROBE_TAIL_SIZE));
+    }
+
+    return probeData(head.constData(), head.size(),
+      tail.constData(), tail.size(), summary);
+  }
+
+  qint64 size = f.size();
+
+  if (size > 0) {
+    uchar *mapped = f.map(0, size);
+    if (mapped) {
+      const char *data = reinterpret_cast<const char*>(mapped);
+      bool ret = probeData(data, size, data, size, summary);
+      f.unmap(mapped);
+      return ret;
+    }
+  }
+
+  QByteArray head = f.read(PROBE_HEAD_SIZE);
+  QByteArray tail = head;
+  if (size > head.size()) {
+    f.seek(qMax(size - PROBE_TAIL_SIZE, qint64(head.size())));
+    tail = f.readAll();
+  }
+
+  return probeData(head.constData(), head.size(),
+    tail.constData(), tail.size(), summary);
+}
+
+bool IgcFile::probeData(const char *head, qint64 headSize,
+  const char *tail, qint64 tailSize, FlightSummary *summary) {
+  const char *end = head + headSize;
+
+  // Find the first B record, everything before it are headers.
+  const char *firstFix = NULL;
+  const char *headerEnd = head;
+  for (const char *lineStart = head; lineStart < end;) {
+    const char *lineEnd = static_cast<const char*>(
+      memchr(lineStart, '\n', end - lineStart));
+    if (!lineEnd) {
+      // Unterminated line at the end of a partially read head.
+      break;
+    }
+
+    const char *p = lineStart;
+    while (p < lineEnd && isSpace(*p)) {
+      ++p;
+    }
+    if (p < lineEnd && *p == 'B') {
+      firstFix = p;
+      break;
+    }
+
+    lineStart = lineEnd + 1;
+    headerEnd = lineStart;
+  }
+
+  if (!firstFix && tail == head && tailSize == headSize) {
+    // The whole file was available and has no fixes.
+    headerEnd = end;
+  }
+
+  if (!parseLines(head, headerEnd, 0)) {
+    clear();
+    return false;
+  }
+
+  if (!aRecordSeen) {
+    recordOffset = 0;
+    return fail("IGC file must start with A record.");
+  }
+
+  if (!summary) {
+    return true;
+  }
+
+  *summary = FlightSummary();
+
+  bool ok;
+  if (!firstFix || end - firstFix < B_RECORD_LENGTH) {
+    return true;
+  }
+  qint32 firstSeconds = parseTimestamp(firstFix + 1, &ok);
+  if (!ok) {
+    return true;
+  }
+
+  // Walk the tail backwards until a complete B record is found.
+  const char *lineEnd = tail + tailSize;
+  while (lineEnd > tail) {
+    const char *lineStart = lineEnd;
+    while (lineStart > tail && *(lineStart - 1) != '\n') {
+      --lineStart;
+    }
+
+    const char *p = lineStart;
+    while (p < lineEnd && isSpace(*p)) {
+      ++p;
+    }
+
+    if (lineEnd - p >= B_RECORD_LENGTH && *p == 'B' &&
+      (lineStart > tail || tail == head)) {
+      qint32 lastSeconds = parseTimestamp(p + 1, &ok);
+      if (ok) {
+        qint32 duration = lastSeconds - firstSeconds;
+        if (duration < 0) {
+          duration += 24 * 3600;
+        }
+
+        summary->firstFix = QTime(0, 0).addSecs(firstSeconds);
+        summary->lastFix = QTime(0, 0).addSecs(lastSeconds);
+        summary->duration = duration;
+        return true;
+      }
+    }
+
+    lineEnd = lineStart - 1;
+  }
+
+  // Only one fix was found.
+  summary->firstFix = summary->lastFix = QTime(0, 0).addSecs(firstSeconds);
+  return true;
+}
+
 /// Load a file from opened QIODevice.
+/// The data are read and parsed in chunks, only the unterminated line at
+/// the end of a chunk is kept for the next one.
 bool IgcFile::load(QIODevice *dev, QTextCodec* codec) {
   clear();
-
-  file = dev;
-  previousRecord = '\0';
+  errorOffset_ = -1;
+  errorString_ = QString();
 
   if (codec) {
     activeCodec = codec;
-  } else {
-    activeCodec = QTextCodec::codecForName("Latin1");
   }
 
-  if (!loadOneRecord()) {
+  QByteArray buffer;
+  qint64 offset = 0;
+
+  forever {
+    int pending = buffer.size();
+    buffer.resize(pending + LOAD_CHUNK_SIZE);
+    qint64 n = dev->read(buffer.data() + pending, LOAD_CHUNK_SIZE);
+    if (n < 0) {
+      qDebug() << "Error reading file (" << dev->errorString() << ")";
+      clear();
+      return false;
+    }
+    buffer.resize(pending + n);
+
+    if (n == 0) {
+      break;
+    }
+
+    const char *begin = buffer.constData();
+    const char *lastNewline = begin + buffer.size();
+    while (lastNewline > begin + pending && *(lastNewline - 1) != '\n') {
+      --lastNewline;
+    }
+
+    if (lastNewline == begin + pending) {
+      continue;
+    }
+
+    if (!parseLines(begin, lastNewline, offset)) {
+      clear();
+      return false;
+    }
+
+    int consumed = lastNewline - begin;
+    offset += consumed;
+    buffer.remove(0, consumed);
+  }
+
+  if (!parseLines(buffer.constData(), buffer.constData() + buffer.size(),
+    offset)) {
     clear();
     return false;
   }
 
-  if (previousRecord != 'A') {
-    qDebug() << "IGC file must start with A record.";
+  if (!aRecordSeen) {
+    recordOffset = 0;
+    return fail("IGC file must start with A record.");
+  }
+
+  fixTable.finish(&arena);
+  dataSize_ = offset + buffer.size();
+  checkSignature();
+
+  return true;
+}
+
+/// Split the buffer to records and parse them one by one.
+bool IgcFile::load(const char *data, qint64 size, QTextCodec* codec) {
+  clear();
+  errorOffset_ = -1;
+  errorString_ = QString();
+
+  if (codec) {
+    activeCodec = codec;
+  }
+
+  const char *end = data + size;
+
+  // Most lines of an IGC file are B records, so the number of lines is
+  // a good upper bound for the fix table size and the columns don't
+  // have to be moved while parsing.
+  int lineCount = 1;
+  for (const char *p = data; p < end; ++lineCount) {
+    p = static_cast<const char*>(memchr(p, '\n', end - p));
+    if (!p) {
+      break;
+    }
+    ++p;
+  }
+  fixTable.reserve(&arena, lineCount);
+
+  if (!parseLines(data, end, 0)) {
     clear();
     return false;
   }
 
-  while (!file->atEnd()) {
-    if (!loadOneRecord()) {
-      clear();
-      return false;
-    }
+  if (!aRecordSeen) {
+    recordOffset = 0;
+    return fail("IGC file must start with A record.");
   }
 
-  qSort(eventList.begin(), eventList.end(), eventLessThan);
+  fixTable.finish(&arena);
+  dataSize_ = size;
+  checkSignature();
+
+  return true;
+}
+
+/// Only complete lines are parsed, the unterminated rest of the data
+/// is kept in pendingLine until the next call.
+int IgcFile::appendData(const char *data, qint64 size) {
+  const char *end = data + size;
+
+  const char *lastNewline = end;
+  while (lastNewline > data && *(lastNewline - 1) != '\n') {
+    --lastNewline;
+  }
+
+  qint64 baseOffset = dataSize_ - pendingLine.size();
+  dataSize_ += size;
+
+  if (lastNewline == data) {
+    pendingLine.append(data, size);
+    return 0;
+  }
+
+  int oldCount = fixTable.count();
+
+  appending = true;
+  bool ok;
+  if (pendingLine.isEmpty()) {
+    // Parse directly from the caller's buffer.
+    ok = parseLines(data, lastNewline, baseOffset);
+  } else {
+    pendingLine.append(data, lastNewline - data);
+    ok = parseLines(pendingLine.constData(),
+      pendingLine.constData() + pendingLine.size(), baseOffset);
+  }
+  appending = false;
+
+  pendingLine = QByteArray(lastNewline, end - lastNewline);
+
+  if (!ok) {
+    return -1;
+  }
+
+  if (eventListValid) {
+    appendEvents(oldCount);
+  }
+
+  checkSignature();
+
+  return fixTable.count() - oldCount;
+}
+
+bool IgcFile::parseLines(const char *begin, const char *end,
+  qint64 baseOffset) {
+  if (!activeCodec) {
+    activeCodec = QTextCodec::codecForName("Latin1");
+  }
+
+  const char *lineStart = begin;
+
+  while (lineStart < end) {
+    const char *lineEnd = static_cast<const char*>(
+      memchr(lineStart, '\n', end - lineStart));
+    if (!lineEnd) {
+      lineEnd = end;
+    }
+
+    // Equivalent of QByteArray::trimmed() without the copy.
+    const char *recordStart = lineStart;
+    const char *recordEnd = lineEnd;
+    while (recordStart < recordEnd && isSpace(*recordStart)) {
+      ++recordStart;
+    }
+    while (recordEnd > recordStart && isSpace(*(recordEnd - 1))) {
+      --recordEnd;
+    }
+
+    recordOffset = baseOffset + (recordStart - begin);
+    int length = recordEnd - recordStart;
+
+    if (length > 0) {
+      if (!aRecordSeen) {
+        if (*recordStart != 'A') {
+          return fail("IGC file must start with A record.");
+        }
+        aRecordSeen = true;
+      }
+
+      if (verifier_) {
+        if (*recordStart == 'G') {
+          verifier_->addSignature(recordStart, length);
+        } else {
+          verifier_->addRecord(recordStart, length);
+        }
+      }
+
+      // When following a growing file, a damaged record shouldn't stop
+      // the rest of the flight from being read.
+      if (!parseOneRecord(recordStart, length) && !appending) {
+        return false;
+      }
+    }
+
+    lineStart = lineEnd + 1;
+  }
 
   return true;
 }
@@ -74,87 +465,116 @@ void IgcFile::clear() {
   }
 
   eventList.clear();
-}
+  eventListValid = false;
 
-bool IgcFile::loadOneRecord() {
-  buffer = file->readLine().trimmed();
+  fixTable.clear();
+  arena.clear();
 
-  if (buffer.size() == 0 && !file->atEnd()) {
-    qDebug() << "Error reading file (" << file->errorString() << ")";
-    return false;
+  activeCodec = NULL;
+  aRecordSeen = false;
+  appending = false;
+  dataSize_ = 0;
+  pendingLine = QByteArray();
+
+  // Closing the file also unmaps the columns.
+  delete cacheFile;
+  cacheFile = NULL;
+
+  signatureStatus_ = SIGNATURE_NOT_CHECKED;
+  if (verifier_) {
+    verifier_->reset();
   }
+}
 
-  bool ret = parseOneRecord();
+const IgcFile::EventList& IgcFile::events() const {
+  if (eventListValid) {
+    return eventList;
+  }
 
-  previousRecord = buffer[0];
+  appendEvents(0);
 
-  return ret;
+  eventListValid = true;
+  return eventList;
 }
 
-bool IgcFile::parseOneRecord() {
-  switch (buffer[0]) {
-    case 'B':
-      return processRecordB();
-    case 'H':
-      return processRecordH();
-    case 'L':
-      return processRecordL();
-    default:
-      /* We ignore unknown record types. */
-      return true;
+void IgcFile::appendEvents(int first) const {
+  for (int i = first; i < fixTable.count(); ++i) {
+    Fix* fix = new Fix;
+    eventList.append(fix);
+
+    fix->type = Event::FIX;
+    fix->timestamp = fixTable.timestamp(i);
+    fix->gpsLoc = fixTable.location(i);
+    fix->valid = fixTable.valid(i);
+    fix->pressureAlt = fixTable.pressureAltitude(i);
   }
 }
 
-QTime IgcFile::parseTimestamp(QByteArray bytes, bool* ok) {
-  if (bytes.size() != 6) {
-    *ok = false;
-    return QTime();
-  }
+qint64 IgcFile::startMsecsSinceEpoch() const {
+  QDate day = date_.isValid() ? date_ : QDate(1970, 1, 1);
+  QDateTime midnight(day, QTime(0, 0), Qt::UTC);
+  return midnight.toMSecsSinceEpoch() +
+    static_cast<qint64>(fixTable.startSecondsOfDay()) * 1000;
+}
 
-  int h = bytes.mid(0, 2).toInt(ok);
-  if (!*ok) {
-    return QTime();
+void IgcFile::checkSignature() {
+  if (verifier_) {
+    signatureStatus_ = verifier_->result();
   }
+}
 
-  int m = bytes.mid(2, 2).toInt(ok);
-  if (!*ok) {
-    return QTime();
-  }
+bool IgcFile::fail(const QString &message) {
+  errorOffset_ = recordOffset;
+  errorString_ = message;
 
-  int s = bytes.mid(4, 2).toInt(ok);
-  if (!*ok) {
-    return QTime();
-  }
+  qDebug() << "IGC error at byte" << recordOffset << ":" << message;
 
-  return QTime(h, m, s);
+  return false;
 }
 
-qreal IgcFile::parseLatLon(QByteArray bytes, bool* ok) {
-  if (bytes.size() != 8 && bytes.size() != 9) {
-    *ok = false;
-    return 0;
+bool IgcFile::parseOneRecord(const char *record, int length) {
+  switch (record[0]) {
+    case 'B':
+      return processRecordB(record, length);
+    case 'H':
+      return processRecordH(record, length);
+    case 'I':
+      return processRecordI(record, length);
+    case 'L':
+      return processRecordL(record, length);
+    default:
+      /* We ignore unknown record types. */
+      return true;
   }
+}
 
-  int degreesSize = (bytes.size() == 8) ? 2 : 3;
+qint32 IgcFile::parseTimestamp(const char *p, bool* ok) {
+  int h, m, s;
 
-  int d = bytes.mid(0, degreesSize).toInt(ok);
+  *ok = decodeDigits(p, 2, &h) &&
+    decodeDigits(p + 2, 2, &m) &&
+    decodeDigits(p + 4, 2, &s) &&
+    h < 24 && m < 60 && s < 60;
   if (!*ok) {
     return 0;
   }
 
-  int m = bytes.mid(degreesSize, 2).toInt(ok);
-  if (!*ok) {
-    return 0;
-  }
+  return h * 3600 + m * 60 + s;
+}
 
-  int mDecimal = bytes.mid(degreesSize + 2, 3).toInt(ok);
+qint32 IgcFile::parseLatLon(const char *p, int degreesSize, bool* ok) {
+  int d, m, mDecimal;
+
+  *ok = decodeDigits(p, degreesSize, &d) &&
+    decodeDigits(p + degreesSize, 2, &m) &&
+    decodeDigits(p + degreesSize + 2, 3, &mDecimal);
   if (!*ok) {
     return 0;
   }
 
-  qreal ret = d + m / 60.0 + mDecimal / 60000.0;
+  qint32 ret = (d * 60 + m) * 1000 + mDecimal;
 
-  char lastChar = bytes[bytes.size() - 1];
+  char lastChar = p[degreesSize + 5];
   if (lastChar == 'S' || lastChar == 'W') {
     return -ret;
   } else if (lastChar == 'N' || lastChar == 'E') {
@@ -211,48 +631,106 @@ QDate IgcFile::parseDate(QByteArray bytes, bool* ok) {
   return QDate(y, m, d);
 }
 
-bool IgcFile::processRecordB() {
-  bool ok = true;
-
-  Fix* ret = new Fix;
-  eventList.append(ret);
+/// B record layout (columns are zero based):
+/// 0 'B', 1-6 time HHMMSS, 7-14 latitude DDMMmmmN, 15-23 longitude DDDMMmmmE,
+/// 24 fix validity, 25-29 pressure altitude, 30-34 GNSS altitude.
+bool IgcFile::processRecordB(const char *record, int length) {
+  if (length < B_RECORD_LENGTH) {
+    return fail("B record is too short.");
+  }
 
-  ret->type = Event::FIX;
+  bool ok = true;
 
-  ret->timestamp = parseTimestamp(buffer.mid(1, 6), &ok);
+  qint32 secondsOfDay = parseTimestamp(record + 1, &ok);
   if (!ok) {
-    return false;
+    return fail("Invalid time in B record.");
   }
 
-  ret->gpsLoc.lat = parseLatLon(buffer.mid(7, 8), &ok);
+  qint32 lat = parseLatLon(record + 7, 2, &ok);
   if (!ok) {
-    return false;
+    return fail("Invalid latitude in B record.");
   }
 
-  ret->gpsLoc.lon = parseLatLon(buffer.mid(15, 9), &ok);
+  qint32 lon = parseLatLon(record + 15, 3, &ok);
   if (!ok) {
-    return false;
+    return fail("Invalid longitude in B record.");
   }
 
-  if (buffer[24] != 'A' && buffer[24] != 'V') {
-    return false;
+  char validity = record[24];
+  if (validity != 'A' && validity != 'V') {
+    return fail("Invalid fix validity in B record.");
   }
-  ret->valid = (buffer[24] == 'A');
 
-  ret->pressureAlt = buffer.mid(25, 5).toInt(&ok);
-  if (!ok) {
-    return false;
+  int pressureAlt, gpsAlt;
+  if (!decodeSigned(record + 25, 5, &pressureAlt)) {
+    return fail("Invalid pressure altitude in B record.");
   }
 
-  ret->gpsLoc.alt = buffer.mid(30, 5).toInt(&ok);
-  if (!ok) {
-    return false;
+  if (!decodeSigned(record + 30, 5, &gpsAlt)) {
+    return fail("Invalid GNSS altitude in B record.");
+  }
+
+  // Extensions are only copied here, see FixTable::extensionData().
+  const char *ext = record + B_RECORD_LENGTH;
+  int extLength = length - B_RECORD_LENGTH;
+
+  if (appending) {
+    if (!fixTable.appendInOrder(&arena, secondsOfDay, lat, lon,
+      pressureAlt, gpsAlt, validity == 'A', ext, extLength)) {
+      return fail("B record goes back in time.");
+    }
+  } else {
+    fixTable.append(&arena, secondsOfDay, lat, lon, pressureAlt, gpsAlt,
+      validity == 'A', ext, extLength);
   }
 
   return true;
 }
 
-bool IgcFile::processRecordH() {
+/// I record layout: 'I', number of extensions NN, and NN times SSFFCCC
+/// -- start and finish byte of the extension in the B record (one based,
+/// inclusive) and its three letter code.
+bool IgcFile::processRecordI(const char *record, int length) {
+  int count;
+  if (length < 3 || !decodeDigits(record + 1, 2, &count) ||
+    length < 3 + 7 * count) {
+    return fail("Invalid I record.");
+  }
+
+  if (fixTable.count() > 0) {
+    // The layout can't change for the fixes that were already stored.
+    qDebug() << "Ignoring I record after the first fix.";
+    return true;
+  }
+
+  QList<FixTable::Extension> extensions;
+  int stride = 0;
+  const char *p = record + 3;
+  for (int i = 0; i < count; ++i, p += 7) {
+    int start, finish;
+    if (!decodeDigits(p, 2, &start) || !decodeDigits(p + 2, 2, &finish) ||
+      start <= B_RECORD_LENGTH || finish < start) {
+      return fail("Invalid extension in I record.");
+    }
+
+    FixTable::Extension ext;
+    ext.code = QByteArray(p + 4, 3);
+    ext.offset = start - B_RECORD_LENGTH - 1;
+    ext.length = finish - start + 1;
+    extensions.append(ext);
+
+    stride = qMax(stride, finish - B_RECORD_LENGTH);
+  }
+
+  fixTable.setExtensions(&arena, extensions, stride);
+
+  return true;
+}
+
+bool IgcFile::processRecordH(const char *record, int length) {
+  // H records are rare, so we don't mind copying them.
+  QByteArray buffer(record, length);
+
   // char dataSource = buffer[1];
   QByteArray subtype = buffer.mid(2, 3);
   QByteArray data = buffer.mid(5);
@@ -268,7 +746,7 @@ bool IgcFile::processRecordH() {
     bool ok;
     altimeterSetting_ = parseDecimal(value, &ok);
     if (!ok) {
-      return false;
+      return fail("Invalid altimeter setting.");
     }
   } else if (subtype == "CCL") {
     competitionClass_ = activeCodec->toUnicode(value);
@@ -278,12 +756,11 @@ bool IgcFile::processRecordH() {
     bool ok;
     date_ = parseDate(data, &ok);
     if (!ok) {
-      return false;
+      return fail("Invalid date.");
     }
   } else if (subtype == "DTM") {
     if (data.left(3) != "100") {
-      qDebug() << "We only support WGS84!";
-      return false;
+      return fail("We only support WGS84!");
     }
   } else if (subtype == "FTY") {
     QList<QByteArray> list = value.split(',');
@@ -306,24 +783,17 @@ bool IgcFile::processRecordH() {
   return true;
 }
 
-bool IgcFile::processRecordL() {
-  if (buffer.mid(1, 4) == "CU::") {
+bool IgcFile::processRecordL(const char *record, int length) {
+  if (length > 5 && memcmp(record + 1, "CU::", 4) == 0) {
     // This is a special seeyou comment.
     // Causes the rest of line to be read as a new record.
     // Used for saving values from user interface (security record
     // disregard L records)
-    buffer = buffer.mid(5);
-    return parseOneRecord();
+    return parseOneRecord(record + 5, length - 5);
   }
 
   return true;
 }
 
-/// Comparator function for sorting events in the list according to timestamp.
-bool IgcFile::eventLessThan(Event const* e1, Event const* e2) {
-  return e1->timestamp < e2->timestamp;
-}
-
 }  // End namespace Igc
 }  // End namespace Updraft
-
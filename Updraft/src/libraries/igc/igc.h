@@ -3,6 +3,7 @@
 
 #include <QByteArray>
 #include <QDate>
+#include <QFile>
 #include <QIODevice>
 #include <QList>
 #include <QString>
@@ -11,11 +12,9 @@
 
 #include "../util/util.h"
 
-#ifdef UPDRAFT_IGC_INTERNAL
-  #define IGC_EXPORT Q_DECL_EXPORT
-#else
-  #define IGC_EXPORT Q_DECL_IMPORT
-#endif
+#include "igc_global.h"
+#include "fixtable.h"
+#include "signature.h"
 
 namespace Updraft {
 namespace Igc {
@@ -44,19 +43,97 @@ struct Fix : public Event {
 /// Pilot event.
 struct PilotEvent : public Event {};
 
+/// Cheap summary of a flight, filled by IgcFile::probe().
+struct FlightSummary {
+  FlightSummary() : duration(0) {}
+
+  /// Time of the first and the last B record.
+  /// Null if the file has no fixes.
+  /// \{
+  QTime firstFix;
+  QTime lastFix;
+  /// \}
+
+  /// Number of seconds between the first and the last fix.
+  /// Recordings over midnight are handled.
+  qint32 duration;
+};
+
 /// A class that loads an IGC file.
 class IGC_EXPORT IgcFile {
  public:
   typedef QList<Event const*> EventList;
   typedef QListIterator<Event const*> EventListIterator;
 
+  IgcFile();
   ~IgcFile() { clear(); }
 
+  /// Load a file with the given path.
+  /// The file is memory mapped if possible and parsed in place.
+  /// Files compressed by gzip or zip are decompressed while parsing.
   bool load(const QString &path, QTextCodec *codec = 0);
+
+  /// Load the whole remaining content of an opened device.
+  /// The device is read in chunks, it may be e.g. a
+  /// Util::DecompressingDevice.
   bool load(QIODevice *file, QTextCodec *codec = 0);
 
+  /// Parse IGC data that is already in memory.
+  /// \param data Pointer to the first byte of the file.
+  /// \param size Size of the data in bytes.
+  /// \param codec Codec for texts in H records. Latin1 is used if it is 0.
+  bool load(const char *data, qint64 size, QTextCodec *codec = 0);
+
+  /// Read only the headers of a file.
+  /// Parsing stops at the first B record, so the header accessors work,
+  /// but the fix table stays empty. Times of the first and the last fix
+  /// are found without parsing the fixes between them.
+  /// \param path Path to the file.
+  /// \param [out] summary If not NULL, it is filled with the times of the
+  ///   first and the last fix.
+  /// \return false if the file couldn't be read or doesn't start with
+  ///   valid headers.
+  bool probe(const QString &path, FlightSummary *summary = NULL);
+
+  /// Parse data that follow what was already loaded.
+  /// This is used to follow a file that is still being written. Only
+  /// complete lines are parsed, an unterminated line is kept until the
+  /// next call. Fixes are added to the end of the fix table without
+  /// sorting; records that go back in time or that can't be parsed are
+  /// skipped and reported through errorString().
+  /// Can also be called on an empty IgcFile to parse a file from the start.
+  /// \param data Pointer to the new bytes.
+  /// \param size Number of the new bytes.
+  /// \return Number of fixes added to the end of fixes(), or -1 if the data
+  ///   don't form a valid IGC file.
+  int appendData(const char *data, qint64 size);
+
+  /// Return number of bytes consumed by load() and appendData().
+  qint64 dataSize() const { return dataSize_; }
+
+  /// Delete all loaded data.
+  /// Doesn't reset the error information.
   void clear();
 
+  /// Return byte offset of the record that made the last load fail,
+  /// or -1 if there was no parse error.
+  qint64 errorOffset() const { return errorOffset_; }
+
+  /// Return description of the last error or null string.
+  QString errorString() const { return errorString_; }
+
+  /// Set verifier of the G records for the following loads.
+  /// Records are handed to the verifier while they are parsed, so
+  /// checking the signature doesn't need another pass over the data.
+  /// Files from a FlightCache can't be verified, the cache is not used
+  /// while a verifier is set.
+  /// \param verifier The verifier, or NULL to stop checking signatures.
+  ///   It is not owned and it must live until loading is finished.
+  void setVerifier(SignatureVerifier *verifier) { verifier_ = verifier; }
+
+  /// Return result of the signature check of the loaded data.
+  SignatureStatus signatureStatus() const { return signatureStatus_; }
+
   /// Return altimeter pressure setting in hectopascals or zero
   /// if it was not specified.
   /// This value doesn't affect altitudes returned in fixes in any way.
@@ -90,29 +167,58 @@ class IGC_EXPORT IgcFile {
   /// Return pilot name or null string.
   QString pilot() const { return pilot_; }
 
-  /// Return a const reference to the event map.
-  const EventList& events() const { return eventList; }
+  /// Return the table of all fixes.
+  const FixTable& fixes() const { return fixTable; }
 
- private:
-  /// Load record into the buffer and parse it.
-  /// \return True on success.
-  bool loadOneRecord();
+  /// Return time of the first fix (FixTable::seconds() == 0) in
+  /// milliseconds since 1970-01-01 00:00 UTC.
+  /// The day comes from the HFDTE header, which is the UTC date of the
+  /// first fix. Files without the header start at the epoch.
+  qint64 startMsecsSinceEpoch() const;
+
+  /// Return a list of events with a separately allocated object for every
+  /// fix.
+  /// The list is built from the fix table on the first call. It is kept for
+  /// compatibility, new code should use fixes().
+  const EventList& events() const;
 
-  /// Parse a single record stored in the buffer.
-  bool parseOneRecord();
+ private:
+  /// Parse all records between begin and end.
+  /// \param baseOffset Offset of begin in the whole file.
+  /// \return false if a record couldn't be parsed.
+  bool parseLines(const char *begin, const char *end, qint64 baseOffset);
+
+  /// Parse headers from the head of a file and find the first and
+  /// the last fix.
+  /// \param head The beginning of the file.
+  /// \param headSize Size of head. It doesn't have to end on a line end.
+  /// \param tail The end of the file. Can overlap with head.
+  /// \param tailSize Size of tail.
+  bool probeData(const char *head, qint64 headSize,
+    const char *tail, qint64 tailSize, FlightSummary *summary);
+
+  /// Add events for fixes starting at index first to the event list.
+  void appendEvents(int first) const;
+
+  /// Parse a single record.
+  /// \param record Pointer to the first character of the record.
+  /// \param length Length of the record without the line terminator.
+  bool parseOneRecord(const char *record, int length);
 
   /// Parse time from IGC encoding. The time is in the HHMMSS format.
-  /// \param bytes The byte array with the time to be parsed.
+  /// \param p Pointer to the six characters with the time.
   /// \param ok Set to true if parsing was successful, false otherwise.
-  QTime parseTimestamp(QByteArray bytes, bool* ok);
+  /// \return Number of seconds since midnight.
+  qint32 parseTimestamp(const char *p, bool* ok);
 
   /// Parse latitude or longitude from IGC encoding.
-  /// \param bytes The byte array with the latitude/longitude number to be
-  ///              parsed.
+  /// \param p Pointer to the first character of the latitude/longitude.
+  /// \param degreesSize Number of digits of degrees. 2 for latitude,
+  ///   3 for longitude.
   /// \param ok Set to true if parsing was successful, false otherwise.
-  /// \return Degrees. Negative values go south and west.
+  /// \return Thousandths of arc minute. Negative values go south and west.
   /// DDMMmmm[NS] or DDDMMmmm[EW]
-  qreal parseLatLon(QByteArray bytes, bool* ok);
+  qint32 parseLatLon(const char *p, int degreesSize, bool* ok);
 
   /// Parse a decimal number in igc format.
   /// \param bytes The byte array with the decimal number to be parsed.
@@ -124,25 +230,67 @@ class IGC_EXPORT IgcFile {
   /// \param ok Set to true if parsing was successful, false otherwise.
   QDate parseDate(QByteArray bytes, bool* ok);
 
-  /// Process a single record of type B (fix data) stored in buffer.
-  bool processRecordB();
+  /// Process a single record of type B (fix data).
+  /// All fields are decoded in place at their fixed column offsets.
+  bool processRecordB(const char *record, int length);
 
-  /// Process a single record of type H (headers) stored in buffer.
-  bool processRecordH();
+  /// Process a single record of type H (headers).
+  bool processRecordH(const char *record, int length);
 
-  /// Process a single record of type L (comments) stored in buffer.
-  bool processRecordL();
+  /// Process a single record of type I (B record extensions).
+  /// Only the layout is stored, extensions are decoded by the fix table.
+  bool processRecordI(const char *record, int length);
 
-  static bool eventLessThan(Event const* e1, Event const* e2);
+  /// Process a single record of type L (comments).
+  bool processRecordL(const char *record, int length);
 
-  EventList eventList;
+  /// Update signatureStatus_ from the verifier.
+  void checkSignature();
 
-  QByteArray buffer;
+  /// Store an error message together with offset of the current record.
+  /// \return Always false.
+  bool fail(const QString &message);
+
+  Q_DISABLE_COPY(IgcFile)
+
+  friend class FlightCache;
+
+  /// Memory for the fix table columns.
+  Util::Arena arena;
+
+  FixTable fixTable;
+
+  /// Events built on demand by events().
+  mutable EventList eventList;
+  mutable bool eventListValid;
 
-  char previousRecord;
-  QIODevice* file;
   QTextCodec *activeCodec;
 
+  /// Whether the first record was already parsed.
+  bool aRecordSeen;
+
+  /// True while parsing inside appendData().
+  bool appending;
+
+  /// Number of bytes consumed so far.
+  qint64 dataSize_;
+
+  /// Unterminated line at the end of the data given to appendData().
+  QByteArray pendingLine;
+
+  /// Mapped cache entry the fix table points to, or NULL.
+  QFile *cacheFile;
+
+  /// Byte offset of the record being parsed.
+  qint64 recordOffset;
+
+  qint64 errorOffset_;
+  QString errorString_;
+
+  /// Verifier of the G records, or NULL.
+  SignatureVerifier *verifier_;
+  SignatureStatus signatureStatus_;
+
   /// Data extracted from IGC headers.
   /// \{
   qreal altimeterSetting_;
@@ -0,0 +1,12 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_IGC_GLOBAL_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_IGC_GLOBAL_H_
+
+#include <QtGlobal>
+
+#ifdef UPDRAFT_IGC_INTERNAL
+  #define IGC_EXPORT Q_DECL_EXPORT
+#else
+  #define IGC_EXPORT Q_DECL_IMPORT
+#endif
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_IGC_GLOBAL_H_
@@ -0,0 +1,47 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_IGCDECODE_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_IGCDECODE_H_
+
+// Helpers for decoding the fixed width fields of IGC records.
+// Internal to the igc library.
+
+namespace Updraft {
+namespace Igc {
+
+/// Decode a fixed number of ASCII digits.
+/// This is used instead of QByteArray::toInt() to avoid creating
+/// a temporary byte array for every field of every B record.
+/// \param p Pointer to the first digit.
+/// \param count Number of digits to decode.
+/// \param [out] value The decoded number.
+/// \return false if any of the characters is not a digit.
+inline bool decodeDigits(const char *p, int count, int *value) {
+  int ret = 0;
+  unsigned bad = 0;
+  for (int i = 0; i < count; ++i) {
+    unsigned digit = static_cast<unsigned char>(p[i]) - '0';
+    // Collect the error flag without branching, so that the loop
+    // stays a simple multiply-add chain.
+    bad |= (digit > 9);
+    ret = ret * 10 + static_cast<int>(digit);
+  }
+  *value = ret;
+  return !bad;
+}
+
+/// Decode a fixed width, possibly negative, decimal number (altitudes).
+inline bool decodeSigned(const char *p, int count, int *value) {
+  if (p[0] == '-') {
+    if (!decodeDigits(p + 1, count - 1, value)) {
+      return false;
+    }
+    *value = -*value;
+    return true;
+  }
+
+  return decodeDigits(p, count, value);
+}
+
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_IGCDECODE_H_
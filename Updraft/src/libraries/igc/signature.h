@@ -0,0 +1,56 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_SIGNATURE_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_SIGNATURE_H_
+
+#include "igc_global.h"
+
+namespace Updraft {
+namespace Igc {
+
+/// Result of checking the security (G) records of a file.
+enum SignatureStatus {
+  /// No verifier was set when the file was loaded.
+  SIGNATURE_NOT_CHECKED,
+
+  /// The file has no G records.
+  SIGNATURE_MISSING,
+
+  SIGNATURE_VALID,
+  SIGNATURE_INVALID
+};
+
+/// Checks the signature of a file while it is being parsed.
+/// The parser hands every record to the verifier as soon as it is split
+/// from the data, so the file is only read once.
+/// The signing algorithms are specific to the logger manufacturers,
+/// each of them is implemented as a subclass. None is implemented here
+/// yet, the tests use a reference verifier.
+/// A verifier is used by one file at a time.
+class IGC_EXPORT SignatureVerifier {
+ public:
+  virtual ~SignatureVerifier() {}
+
+  /// Create a new verifier of the same kind and with the same keys.
+  /// Used to give each worker thread its own verifier, so it may be
+  /// called from several threads at once.
+  virtual SignatureVerifier* clone() const = 0;
+
+  /// Forget all records, a new file starts.
+  virtual void reset() = 0;
+
+  /// Process a record other than G, in the file order.
+  /// \param record The record without leading and trailing white space.
+  /// \param length Length of the record.
+  virtual void addRecord(const char *record, int length) = 0;
+
+  /// Process a G record.
+  virtual void addSignature(const char *record, int length) = 0;
+
+  /// Check the records added since the last reset().
+  /// Can be called repeatedly while records are being added.
+  virtual SignatureStatus result() const = 0;
+};
+
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_SIGNATURE_H_
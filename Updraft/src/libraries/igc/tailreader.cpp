@@ -0,0 +1,73 @@
+#include "tailreader.h"
+
+#include <QDebug>
+#include <QFile>
+
+#include "igc.h"
+
+namespace Updraft {
+namespace Igc {
+
+TailReader::TailReader(IgcFile *file, const QString &path, QObject *parent)
+  : QObject(parent), file(file), path(path) {
+  connect(&timer, SIGNAL(timeout()), this, SLOT(poll()));
+}
+
+void TailReader::start(int interval) {
+  timer.start(interval);
+}
+
+void TailReader::stop() {
+  timer.stop();
+}
+
+bool TailReader::canFollow(const QString &path) {
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  return !Util::DecompressingDevice::isCompressed(&f);
+}
+
+int TailReader::poll() {
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    qDebug() << "Couldn't open " << path << ".";
+    return -1;
+  }
+
+  if (Util::DecompressingDevice::isCompressed(&f)) {
+    qDebug() << "Compressed file " << path << " can't be followed.";
+    return -1;
+  }
+
+  qint64 offset = file->dataSize();
+  qint64 size = f.size();
+
+  if (size < offset) {
+    qDebug() << path << "got shorter, it is not being appended to.";
+    return -1;
+  }
+
+  if (size == offset) {
+    return 0;
+  }
+
+  if (!f.seek(offset)) {
+    return -1;
+  }
+
+  QByteArray data = f.read(size - offset);
+  int first = file->fixes().count();
+  int count = file->appendData(data.constData(), data.size());
+
+  if (count > 0) {
+    emit fixesAppended(first, count);
+  }
+
+  return count;
+}
+
+}  // End namespace Igc
+}  // End namespace Updraft
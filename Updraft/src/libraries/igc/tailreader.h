@@ -0,0 +1,65 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_TAILREADER_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_TAILREADER_H_
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "igc_global.h"
+
+namespace Updraft {
+namespace Igc {
+
+class IgcFile;
+
+/// Follows an IGC file that is still being written.
+/// Bytes appended to the file are periodically read and passed to
+/// IgcFile::appendData(), so each poll only costs time proportional to
+/// the new data.
+/// Compressed files are not supported.
+class IGC_EXPORT TailReader : public QObject {
+  Q_OBJECT
+
+ public:
+  /// \param file The file to append the new fixes to. It must outlive
+  ///   the reader. If it was already loaded, reading continues after
+  ///   the loaded data.
+  /// \param path Path to the file on disk.
+  TailReader(IgcFile *file, const QString &path, QObject *parent = NULL);
+
+  /// Start polling the file periodically.
+  /// \param interval Time between polls in milliseconds.
+  void start(int interval = 1000);
+
+  /// Stop the periodic polling.
+  void stop();
+
+  /// Return true if the reader is polling periodically.
+  bool isActive() const { return timer.isActive(); }
+
+  /// Return true if the file can be followed.
+  /// Compressed files can't, the loaded data size doesn't correspond
+  /// to an offset in the file.
+  static bool canFollow(const QString &path);
+
+ public slots:
+  /// Read the data appended since the last poll.
+  /// \return Number of the new fixes, or -1 on error.
+  int poll();
+
+ signals:
+  /// New fixes were added to the end of the fix table.
+  /// \param first Index of the first new fix.
+  /// \param count Number of the new fixes.
+  void fixesAppended(int first, int count);
+
+ private:
+  IgcFile *file;
+  QString path;
+  QTimer timer;
+};
+
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_TAILREADER_H_
@@ -0,0 +1,78 @@
+#include "batch.h"
+
+#include <QtTest>
+
+#include "igc.h"
+#include "batchloader.h"
+#include "../digestverifier.h"
+
+namespace Updraft {
+namespace Igc {
+namespace Test {
+
+/// Loads a few copies of the test file together with a broken one
+/// and checks that every file is delivered exactly once and that the
+/// signatures were checked.
+void Batch::testLoad() {
+  const int copies = 16;
+  const QString good = TEST_DATA_DIR "/../testigc/testigc.igc";
+  const QString bad = TEST_DATA_DIR "/../wrong/wrong_b_record.igc";
+
+  loaded.clear();
+  failed.clear();
+  finishedCount = 0;
+
+  BatchLoader loader(NULL, 4);
+  loader.setVerifier(new DigestVerifier());
+  connect(&loader, SIGNAL(itemLoaded(Updraft::Igc::BatchItem*)),
+    this, SLOT(itemLoaded(Updraft::Igc::BatchItem*)));
+  connect(&loader, SIGNAL(finished()),
+    this, SLOT(finished()));
+
+  QList<BatchItem*> items;
+  for (int i = 0; i < copies; ++i) {
+    items.append(new BatchItem(good));
+  }
+  items.append(new BatchItem(bad));
+
+  loader.start(items);
+  QCOMPARE(loader.pending(), copies + 1);
+
+  loader.waitForDone();
+
+  QCOMPARE(loader.pending(), 0);
+  QCOMPARE(loaded.count(), copies);
+  QCOMPARE(failed.count(), 1);
+  QCOMPARE(failed[0], bad);
+  QCOMPARE(finishedCount, 1);
+
+  // Queued notifications from the workers must not deliver anything again.
+  QCoreApplication::processEvents();
+  QCOMPARE(loaded.count(), copies);
+  QCOMPARE(finishedCount, 1);
+}
+
+void Batch::itemLoaded(BatchItem* item) {
+  if (item->ok()) {
+    QVERIFY(item->file() != NULL);
+    QCOMPARE(item->file()->fixes().count(), 15);
+    // The test file is not signed, but the verifier must have seen it.
+    QCOMPARE(item->file()->signatureStatus(), SIGNATURE_MISSING);
+    loaded.append(item->path());
+  } else {
+    QVERIFY(item->file() == NULL);
+    failed.append(item->path());
+  }
+
+  delete item;
+}
+
+void Batch::finished() {
+  ++finishedCount;
+}
+
+}  // End namespace Test
+}  // End namespace Igc
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Igc::Test::Batch)
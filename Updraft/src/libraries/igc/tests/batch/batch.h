@@ -0,0 +1,38 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_TESTS_BATCH_BATCH_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_TESTS_BATCH_BATCH_H_
+
+#include <QObject>
+#include <QStringList>
+
+namespace Updraft {
+namespace Igc {
+
+class BatchItem;
+
+namespace Test {
+
+/// Test loading of several files in parallel.
+class Batch: public QObject {
+  Q_OBJECT
+ public slots:
+  /// Collect the delivered items.
+  /// These are not private, so that QTest doesn't run them as tests.
+  /// \{
+  void itemLoaded(Updraft::Igc::BatchItem* item);
+  void finished();
+  /// \}
+
+ private slots:
+  void testLoad();
+
+ private:
+  QStringList loaded;
+  QStringList failed;
+  int finishedCount;
+};
+
+}  // End namespace Test
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_TESTS_BATCH_BATCH_H_
@@ -0,0 +1,76 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_TESTS_DIGESTVERIFIER_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_TESTS_DIGESTVERIFIER_H_
+
+#include <QByteArray>
+#include <QCryptographicHash>
+
+#include "signature.h"
+
+namespace Updraft {
+namespace Igc {
+namespace Test {
+
+/// Reference verifier for the tests of the verification stage.
+/// No logger signs its files this way, the G records simply contain
+/// a hexadecimal digest of the signed records, possibly split to several
+/// records. It only shows that the records reach the verifier in the
+/// file order and that the result comes back with the parsed file.
+/// All records except G are signed without their line ends, L records
+/// are only signed if they carry the manufacturer code of the A record.
+class DigestVerifier : public SignatureVerifier {
+ public:
+  DigestVerifier() : hash(QCryptographicHash::Md5) {}
+
+  SignatureVerifier* clone() const {
+    return new DigestVerifier();
+  }
+
+  void reset() {
+    hash.reset();
+    manufacturer.clear();
+    signature.clear();
+  }
+
+  void addRecord(const char *record, int length) {
+    if (record[0] == 'A' && manufacturer.isEmpty()) {
+      manufacturer = QByteArray(record + 1, qMin(length - 1, 3));
+    } else if (record[0] == 'L' && (length < 4 ||
+      manufacturer != QByteArray::fromRawData(record + 1, 3))) {
+      return;
+    }
+
+    hash.addData(record, length);
+  }
+
+  void addSignature(const char *record, int length) {
+    signature.append(record + 1, length - 1);
+  }
+
+  SignatureStatus result() const {
+    if (signature.isEmpty()) {
+      return SIGNATURE_MISSING;
+    }
+
+    // result() doesn't finalize the hash, more records can still follow.
+    if (signature.toLower() == hash.result().toHex()) {
+      return SIGNATURE_VALID;
+    } else {
+      return SIGNATURE_INVALID;
+    }
+  }
+
+ private:
+  QCryptographicHash hash;
+
+  /// Three letter manufacturer code from the A record.
+  QByteArray manufacturer;
+
+  /// Hexadecimal digest collected from the G records.
+  QByteArray signature;
+};
+
+}  // End namespace Test
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_TESTS_DIGESTVERIFIER_H_
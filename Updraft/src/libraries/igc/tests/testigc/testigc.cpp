@@ -2,8 +2,13 @@
 
 #include <math.h>
 
+#include <QCryptographicHash>
 #include <QtTest>
 
+#include "flightcache.h"
+#include "../digestverifier.h"
+#include "timeline.h"
+
 namespace Updraft {
 namespace Igc {
 namespace Test {
@@ -88,6 +93,340 @@ void TestIgc::testBRecords() {
   QVERIFY(!iterator.hasNext());
 }
 
+/// Checks that the fix table has the same content as the B records,
+/// in sorted order and with times relative to the first fix.
+void TestIgc::testFixTable() {
+  const FixTable& fixes = igc.fixes();
+
+  QCOMPARE(fixes.count(), 15);
+  QCOMPARE(fixes.startSecondsOfDay(), 1);
+
+  int value = 1;
+  for (int i = 0; i < fixes.count(); ++i) {
+    QCOMPARE(fixes.seconds(i), abs(value) - 1);
+    QCOMPARE(fixes.rawLatitude(i), value);
+    QCOMPARE(fixes.rawLongitude(i), value);
+    QCOMPARE(fixes.pressureAltitude(i), value);
+    QCOMPARE(fixes.gpsAltitude(i), abs(value));
+    QCOMPARE(fixes.valid(i), value > 0);
+
+    value *= -2;
+  }
+}
+
+/// Checks that a recording crossing midnight keeps its order and
+/// has monotonic times.
+void TestIgc::testMidnight() {
+  const char data[] =
+    "AXXXYYY\n"
+    "B2359580000001N00000001EA0000100001\n"
+    "B0000010000002N00000002EA0000200002\r\n"
+    "\n"
+    "B0000000000003N00000003EA0000300003\n";
+
+  IgcFile file;
+  QVERIFY(file.load(data, sizeof(data) - 1));
+
+  const FixTable& fixes = file.fixes();
+  QCOMPARE(fixes.count(), 3);
+  QCOMPARE(fixes.startSecondsOfDay(), 23 * 3600 + 59 * 60 + 58);
+
+  QCOMPARE(fixes.seconds(0), 0);
+  QCOMPARE(fixes.seconds(1), 2);
+  QCOMPARE(fixes.seconds(2), 3);
+
+  QCOMPARE(fixes.rawLatitude(1), 3);
+  QCOMPARE(fixes.rawLatitude(2), 2);
+
+  QCOMPARE(fixes.timestamp(2), QTime(0, 0, 1));
+}
+
+/// Test feeding a growing file in pieces that split the records.
+void TestIgc::testAppendData() {
+  const char part1[] =
+    "AXXXYYY\n"
+    "B2359580000001N00000001EA0000100001\n"
+    "B00000100";
+  const char part2[] =
+    "00002N00000002EA0000200002\n"
+    "B0000000000003N00000003EA0000300003\n"
+    "B0000020000004N00000004EA00004";
+  const char part3[] = "00004\n";
+
+  IgcFile file;
+  QCOMPARE(file.appendData(part1, sizeof(part1) - 1), 1);
+  QCOMPARE(file.appendData(part2, sizeof(part2) - 1), 1);
+  QCOMPARE(file.appendData(part3, sizeof(part3) - 1), 1);
+
+  QCOMPARE(file.dataSize(),
+    qint64(sizeof(part1) + sizeof(part2) + sizeof(part3) - 3));
+
+  // The record going back in time was skipped.
+  const FixTable& fixes = file.fixes();
+  QCOMPARE(fixes.count(), 3);
+  QCOMPARE(fixes.seconds(1), 3);
+  QCOMPARE(fixes.seconds(2), 4);
+  QCOMPARE(fixes.rawLatitude(2), 4);
+}
+
+/// Stores the test file to the flight cache, loads it back and checks
+/// that a changed file is not loaded from the cache.
+void TestIgc::testFlightCache() {
+  QDir tmp = QDir::temp();
+  QString cacheDir = tmp.absoluteFilePath("updraft_testigc_cache");
+  QString copy = tmp.absoluteFilePath("updraft_testigc_cache.igc");
+
+  QFile::remove(copy);
+  QVERIFY(QFile::copy(TEST_DATA_DIR "/testigc.igc", copy));
+
+  FlightCache cache(cacheDir);
+  cache.remove(copy);
+
+  IgcFile original;
+  QVERIFY(original.load(copy));
+
+  QVector<double> projected;
+  projected << 1 << 2 << 3;
+
+  IgcFile cached;
+  QVERIFY(!cache.load(copy, &cached));
+  QVERIFY(cache.store(copy, original, "test", projected));
+
+  QVector<double> cachedProjected;
+  QVERIFY(cache.load(copy, &cached, "test", &cachedProjected));
+  QCOMPARE(cachedProjected, projected);
+
+  QCOMPARE(cached.pilot(), original.pilot());
+  QCOMPARE(cached.date(), original.date());
+  QCOMPARE(cached.altimeterSetting(), original.altimeterSetting());
+  QCOMPARE(cached.dataSize(), original.dataSize());
+
+  const FixTable& a = original.fixes();
+  const FixTable& b = cached.fixes();
+  QCOMPARE(b.count(), a.count());
+  QCOMPARE(b.startSecondsOfDay(), a.startSecondsOfDay());
+  for (int i = 0; i < a.count(); ++i) {
+    QCOMPARE(b.seconds(i), a.seconds(i));
+    QCOMPARE(b.rawLatitude(i), a.rawLatitude(i));
+    QCOMPARE(b.rawLongitude(i), a.rawLongitude(i));
+    QCOMPARE(b.gpsAltitude(i), a.gpsAltitude(i));
+    QCOMPARE(b.pressureAltitude(i), a.pressureAltitude(i));
+    QCOMPARE(b.valid(i), a.valid(i));
+  }
+
+  // Different projection still loads the fixes.
+  QVERIFY(cache.load(copy, &cached, "other", &cachedProjected));
+  QVERIFY(cachedProjected.isEmpty());
+
+  // Changed file makes the entry stale.
+  QFile f(copy);
+  QVERIFY(f.open(QIODevice::Append));
+  f.write("LXXX comment\n");
+  f.close();
+
+  QVERIFY(!cache.load(copy, &cached));
+
+  // Compressed files are keyed by their size on disk, but keep the size
+  // of the decompressed data.
+  QString gz = TEST_DATA_DIR "/testigc.igc.gz";
+  IgcFile compressed;
+  QVERIFY(compressed.load(gz));
+  QVERIFY(cache.store(gz, compressed));
+  QVERIFY(cache.load(gz, &cached));
+  QCOMPARE(cached.dataSize(), compressed.dataSize());
+  QCOMPARE(cached.fixes().count(), compressed.fixes().count());
+
+  cached.clear();
+  cache.remove(gz);
+
+  // A followed file keeps its partial last record.
+  const char head[] =
+    "AXXXYYY\n"
+    "B0000010000001N00000001EA0000100001\n"
+    "B00000200";
+  const char tail[] = "00002N00000002EA0000200002\n";
+  QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+  f.write(head);
+  f.close();
+
+  IgcFile followed;
+  QCOMPARE(followed.appendData(head, sizeof(head) - 1), 1);
+  QVERIFY(cache.store(copy, followed));
+  QVERIFY(cache.load(copy, &cached));
+  QCOMPARE(cached.appendData(tail, sizeof(tail) - 1), 1);
+  QCOMPARE(cached.fixes().seconds(1), 2);
+
+  cached.clear();
+  cache.remove(copy);
+  QFile::remove(copy);
+}
+
+/// Checks that probing reads the headers and the times of the first
+/// and the last fix, but no fixes.
+void TestIgc::testProbe() {
+  IgcFile file;
+  QVERIFY(file.probe(TEST_DATA_DIR "/testigc.igc"));
+
+  QCOMPARE(file.pilot(), QString("15"));
+  QCOMPARE(file.date(), QDate(2013, 12, 11));
+  QCOMPARE(file.fixes().count(), 0);
+
+  QString path = QDir::temp().absoluteFilePath("updraft_testigc_probe.igc");
+  QFile f(path);
+  QVERIFY(f.open(QIODevice::WriteOnly));
+  f.write(
+    "AXXXYYY\n"
+    "HFPLTPILOTINCHARGE:Pilot\n"
+    "B2359580000001N00000001EA0000100001\n"
+    "B0000050000002N00000002EA0000200002\n"
+    "B0000100000003N00000003EA0000300003\n"
+    "GSECURITY\n"
+    "GRECORD\n");
+  f.close();
+
+  FlightSummary summary;
+  QVERIFY(file.probe(path, &summary));
+  QCOMPARE(file.pilot(), QString("Pilot"));
+  QCOMPARE(summary.firstFix, QTime(23, 59, 58));
+  QCOMPARE(summary.lastFix, QTime(0, 0, 10));
+  QCOMPARE(summary.duration, 12);
+
+  QFile::remove(path);
+}
+
+/// Checks the B record extensions described by the I record, including
+/// reordering of unsorted fixes and decoding of appended fixes.
+void TestIgc::testExtensions() {
+  const char part1[] =
+    "AXXXYYY\n"
+    "I023638FXA3941ENL\n"
+    "B0000050000002N00000002EA0000200002020-15\n"
+    "B0000000000001N00000001EA0000100001010250\n"
+    "B0000100000003N00000003EA0000300003030\n";
+  const char part2[] =
+    "B0000150000004N00000004EA0000400004040999\n";
+
+  IgcFile file;
+  QCOMPARE(file.appendData(part1, sizeof(part1) - 1), 2);
+
+  const FixTable& fixes = file.fixes();
+  QCOMPARE(fixes.extensionCount(), 2);
+  QCOMPARE(fixes.extensionCode(1), QByteArray("ENL"));
+  QCOMPARE(fixes.extensionIndex("FXA"), 0);
+  QCOMPARE(fixes.extensionIndex("TAS"), -1);
+
+  int enl = fixes.extensionIndex("ENL");
+  QCOMPARE(fixes.extension(enl, 0), -15);
+  // Missing field of a short record.
+  QCOMPARE(fixes.extension(enl, 1), 0);
+  QCOMPARE(fixes.extension(0, 1), 30);
+
+  QCOMPARE(file.appendData(part2, sizeof(part2) - 1), 1);
+  QCOMPARE(fixes.extension(enl, 2), 999);
+
+  QVERIFY(file.load(part1, sizeof(part1) - 1));
+  QCOMPARE(fixes.count(), 3);
+  QCOMPARE(fixes.rawLatitude(0), 1);
+  QCOMPARE(fixes.extension(0, 0), 10);
+  QCOMPARE(fixes.extension(enl, 0), 250);
+  QCOMPARE(fixes.extension(enl, 1), -15);
+}
+
+/// Checks that a gzipped copy of the test file loads the same as
+/// the plain file.
+void TestIgc::testCompressed() {
+  IgcFile file;
+  QVERIFY(file.load(TEST_DATA_DIR "/testigc.igc.gz"));
+
+  QCOMPARE(file.pilot(), igc.pilot());
+  QCOMPARE(file.date(), igc.date());
+
+  const FixTable& fixes = file.fixes();
+  QCOMPARE(fixes.count(), igc.fixes().count());
+  for (int i = 0; i < fixes.count(); ++i) {
+    QCOMPARE(fixes.seconds(i), igc.fixes().seconds(i));
+    QCOMPARE(fixes.rawLatitude(i), igc.fixes().rawLatitude(i));
+    QCOMPARE(fixes.valid(i), igc.fixes().valid(i));
+  }
+
+  IgcFile probed;
+  QVERIFY(probed.probe(TEST_DATA_DIR "/testigc.igc.gz"));
+  QCOMPARE(probed.pilot(), igc.pilot());
+}
+
+/// Checks the digest signature verifier on a signed file, a file with
+/// a modified fix and a file without G records.
+void TestIgc::testSignature() {
+  QByteArray signedRecords =
+    "AXXXYYY"
+    "HFPLTPILOTINCHARGE:Pilot"
+    "B0000010000001N00000001EA0000100001"
+    "LXXXSIGNED";
+  QByteArray digest =
+    QCryptographicHash::hash(signedRecords, QCryptographicHash::Md5).toHex();
+
+  QByteArray data =
+    "AXXXYYY\r\n"
+    "HFPLTPILOTINCHARGE:Pilot\r\n"
+    "B0000010000001N00000001EA0000100001\r\n"
+    "LXXXSIGNED\r\n"
+    "LOOOADDED LATER\r\n"
+    "G" + digest.left(16) + "\r\n"
+    "G" + digest.mid(16) + "\r\n";
+
+  IgcFile file;
+  QVERIFY(file.load(data.constData(), data.size()));
+  QCOMPARE(file.signatureStatus(), SIGNATURE_NOT_CHECKED);
+
+  DigestVerifier verifier;
+  file.setVerifier(&verifier);
+  QVERIFY(file.load(data.constData(), data.size()));
+  QCOMPARE(file.signatureStatus(), SIGNATURE_VALID);
+
+  QByteArray modified(data);
+  modified.replace("EA00001", "EA00002");
+  QVERIFY(file.load(modified.constData(), modified.size()));
+  QCOMPARE(file.signatureStatus(), SIGNATURE_INVALID);
+
+  QByteArray noSignature(data.left(data.indexOf("\r\nG") + 2));
+  QVERIFY(file.load(noSignature.constData(), noSignature.size()));
+  QCOMPARE(file.signatureStatus(), SIGNATURE_MISSING);
+}
+
+/// Builds a timeline of a flight over midnight and checks the lookups.
+void TestIgc::testTimeline() {
+  const char data[] =
+    "AXXXYYY\n"
+    "HFDTE311213\n"
+    "B2359580000001N00000001EA0000100001\n"
+    "B0000050000002N00000002EA0000200002\n"
+    "B0000100000003N00000003EA0000300003\n";
+
+  IgcFile file;
+  QVERIFY(file.load(data, sizeof(data) - 1));
+
+  qint64 start = file.startMsecsSinceEpoch();
+  QCOMPARE(QDateTime::fromMSecsSinceEpoch(start).toUTC(),
+    QDateTime(QDate(2013, 12, 31), QTime(23, 59, 58), Qt::UTC));
+
+  Timeline timeline;
+  const FixTable &fixes = file.fixes();
+  for (int i = 0; i < fixes.count(); ++i) {
+    timeline.append(start + fixes.seconds(i) * 1000);
+  }
+
+  QCOMPARE(timeline.count(), 3);
+  QCOMPARE(timeline.elapsed(2), Q_INT64_C(12000));
+  QCOMPARE(timeline.dateTime(1),
+    QDateTime(QDate(2014, 1, 1), QTime(0, 0, 5), Qt::UTC));
+  QCOMPARE(timeline.msecsOfDay(1), 5000);
+
+  QCOMPARE(timeline.indexOf(start + 7000), 1);
+  QCOMPARE(timeline.indexOf(start + 8000), -1);
+  QCOMPARE(timeline.indexAt(start - 1000), 0);
+  QCOMPARE(timeline.indexAt(start + 8000), 1);
+  QCOMPARE(timeline.indexAt(start + 100000), 2);
+}
 
 /// Test that the clean method really deletes all information
 /// and empties the eventList.
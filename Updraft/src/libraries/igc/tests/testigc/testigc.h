@@ -18,6 +18,15 @@ class TestIgc: public QObject {
 
   void testHRecords();
   void testBRecords();
+  void testFixTable();
+  void testMidnight();
+  void testAppendData();
+  void testFlightCache();
+  void testProbe();
+  void testExtensions();
+  void testCompressed();
+  void testSignature();
+  void testTimeline();
 
   void testClean();
 
@@ -1,5 +1,6 @@
 #include "wrong.h"
 
+#include <QFile>
 #include <QtTest>
 
 #include "igc.h"
@@ -18,6 +19,16 @@ void Wrong::b_record() {
   QVERIFY(!f.load(TEST_DATA_DIR "/wrong_b_record.igc"));
 }
 
+void Wrong::b_record_unterminated() {
+  Igc::IgcFile f;
+  QVERIFY(!f.load(TEST_DATA_DIR "/wrong_b_record_unterminated.igc"));
+  QVERIFY(f.errorOffset() > 0);
+
+  QFile file(TEST_DATA_DIR "/wrong_b_record_unterminated.igc");
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QVERIFY(!f.load(&file));
+}
+
 }  // End namespace Test
 }  // End namespace Igc
 }  // End namespace Updraft
@@ -13,6 +13,7 @@ class Wrong: public QObject {
  private slots:
   void a_record();
   void b_record();
+  void b_record_unterminated();
 };
 
 }  // End namespace Test
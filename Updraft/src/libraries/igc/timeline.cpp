@@ -0,0 +1,39 @@
+#include "timeline.h"
+
+#include <QtAlgorithms>
+
+namespace Updraft {
+namespace Igc {
+
+static const qint64 MSECS_PER_DAY = Q_INT64_C(24) * 3600 * 1000;
+
+QDateTime Timeline::dateTime(int i) const {
+  return QDateTime::fromMSecsSinceEpoch(times[i]).toUTC();
+}
+
+qint32 Timeline::msecsOfDay(int i) const {
+  qint64 ret = times[i] % MSECS_PER_DAY;
+  if (ret < 0) {
+    ret += MSECS_PER_DAY;
+  }
+  return ret;
+}
+
+int Timeline::indexAt(qint64 msecs) const {
+  Q_ASSERT(!times.isEmpty());
+  QVector<qint64>::const_iterator it =
+    qUpperBound(times.constBegin(), times.constEnd(), msecs);
+  return qMax(0, static_cast<int>(it - times.constBegin()) - 1);
+}
+
+int Timeline::indexOf(qint64 msecs) const {
+  QVector<qint64>::const_iterator it =
+    qLowerBound(times.constBegin(), times.constEnd(), msecs);
+  if (it == times.constEnd() || *it != msecs) {
+    return -1;
+  }
+  return it - times.constBegin();
+}
+
+}  // End namespace Igc
+}  // End namespace Updraft
@@ -0,0 +1,66 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_IGC_TIMELINE_H_
+#define UPDRAFT_SRC_LIBRARIES_IGC_TIMELINE_H_
+
+#include <QDateTime>
+#include <QVector>
+
+#include "igc_global.h"
+
+namespace Updraft {
+namespace Igc {
+
+/// Monotonic times of a sequence of fixes.
+/// Times are milliseconds since 1970-01-01 00:00 UTC, so comparing and
+/// subtracting them works across midnight without any special cases.
+/// Midnight crossings of the B records are resolved once when the file
+/// is loaded (see FixTable::finish()).
+class IGC_EXPORT Timeline {
+ public:
+  /// Remove all times.
+  void clear() { times.clear(); }
+
+  /// Make space for count times.
+  void reserve(int count) { times.reserve(count); }
+
+  /// Add time of the next fix.
+  /// \pre msecs is not before the last time.
+  void append(qint64 msecs) {
+    Q_ASSERT(times.isEmpty() || msecs >= times.last());
+    times.append(msecs);
+  }
+
+  /// Return number of the times.
+  int count() const { return times.count(); }
+
+  /// Return true if there are no times.
+  bool isEmpty() const { return times.isEmpty(); }
+
+  /// Return time of fix i in milliseconds since epoch.
+  qint64 at(int i) const { return times[i]; }
+
+  /// Return milliseconds from the first fix to fix i.
+  qint64 elapsed(int i) const { return times[i] - times[0]; }
+
+  /// Return time of fix i in UTC.
+  QDateTime dateTime(int i) const;
+
+  /// Return milliseconds since midnight UTC of fix i.
+  qint32 msecsOfDay(int i) const;
+
+  /// Return index of the last fix that is not later than msecs.
+  /// Times before the first fix give 0, the track must not be empty.
+  /// Runs in O(log n).
+  int indexAt(qint64 msecs) const;
+
+  /// Return index of the first fix with time exactly msecs, or -1.
+  /// Runs in O(log n).
+  int indexOf(qint64 msecs) const;
+
+ private:
+  QVector<qint64> times;
+};
+
+}  // End namespace Igc
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_IGC_TIMELINE_H_
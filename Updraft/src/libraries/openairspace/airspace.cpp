@@ -1,14 +1,10 @@
 #include "airspace.h"
 
-OpenAirspace::Position OpenAirspace::Airspace::X;
-bool OpenAirspace::Airspace::validX;
+#include "airspacetable.h"
 
 // Primary Airspace parser
 namespace OpenAirspace {
-  Airspace::Airspace(QTextStream* ts, bool* acOn) {
-    QString text("");
-
-    // init variables
+  void Airspace::Init() {
     this->AL        = NULL;
     this->AH        = NULL;
     this->AN        = NULL;
@@ -23,6 +19,13 @@ namespace OpenAirspace {
     this->CW        = true;
     this->Wi        = -1;
     this->Z         = -1;
+  }
+
+  Airspace::Airspace(QTextStream* ts, bool* acOn, Position* centre) {
+    QString text("");
+
+    // init variables
+    Init();
 
     // Viability check
     if (!acOn) {
@@ -160,8 +163,7 @@ namespace OpenAirspace {
 
         // center
         if (ch == 'X') {
-          X = ParseCoord(parse);
-          this->validX = true;
+          *centre = ParseCoord(parse);
 
         // direction
         } else if (ch == 'D') {
@@ -201,7 +203,7 @@ namespace OpenAirspace {
         parse = parse.right(parse.size() - i -1);
         double End = parse.toDouble();
         ArcI* arc = new
-          ArcI(X, R, this->CW, Start, End, this->Z);
+          ArcI(*centre, R, this->CW, Start, End, this->Z);
         this->geometry->push_back(arc);
 
       // Add arc type 2
@@ -213,14 +215,14 @@ namespace OpenAirspace {
         parse = parse.right(parse.size() - i -1);
         Position End = ParseCoord(parse);
         ArcII* arc = new
-          ArcII(X, Start, End, this->CW, this->Z);
+          ArcII(*centre, Start, End, this->CW, this->Z);
         this->geometry->push_back(arc);
 
       // Draw circle
       } else if (text == "DC") {
         if (!this->geometry)
           this->geometry = new QVector<Geometry*>();
-        Circle* cir = new Circle(X, parse.toDouble(), this->Z);
+        Circle* cir = new Circle(*centre, parse.toDouble(), this->Z);
         this->geometry->push_back(cir);
 
       // Add segment of airway
@@ -233,6 +235,72 @@ namespace OpenAirspace {
     }
   }
 
+  Airspace::Airspace(const AirspaceTable& table, int index) {
+    Init();
+
+    const AirspaceRecord& record = table.GetAirspace(index);
+    this->AC = record.type;
+    this->ACstring = new QString(record.className);
+    if (!record.name.isNull())
+      this->AN = new QString(record.name);
+    if (!record.floor.isNull())
+      this->AL = new QString(record.floor);
+    if (!record.ceiling.isNull())
+      this->AH = new QString(record.ceiling);
+    if (!record.terrainOpen.isNull())
+      this->TO = new QString(record.terrainOpen);
+    if (!record.terrainClosed.isNull())
+      this->TC = new QString(record.terrainClosed);
+    this->Wi = record.airwayWidth;
+
+    if (record.hasPen)
+      this->SP = new SP_str(record.pen);
+    if (record.hasBrush)
+      this->SB = new SB_str(record.brush);
+
+    if (record.labelCount) {
+      this->AT = new QVector<Position*>();
+      for (int i = 0; i < record.labelCount; ++i)
+        this->AT->push_back(
+          new Position(table.GetCoordinate(record.firstLabel + i)));
+    }
+
+    if (record.airwayCount) {
+      this->DY = new QVector<Position*>();
+      for (int i = 0; i < record.airwayCount; ++i)
+        this->DY->push_back(
+          new Position(table.GetCoordinate(record.firstAirway + i)));
+    }
+
+    if (!record.primitiveCount)
+      return;
+
+    this->geometry = new QVector<Geometry*>();
+    for (int i = 0; i < record.primitiveCount; ++i) {
+      const Primitive& p = table.GetPrimitive(record.firstPrimitive + i);
+      const Position& centre = table.GetCoordinate(p.first);
+      switch (p.type) {
+        case Primitive::POLYGON:
+          for (int j = 0; j < p.count; ++j)
+            this->geometry->push_back(
+              new Polygon(table.GetCoordinate(p.first + j), p.zoom));
+          break;
+        case Primitive::ARC_ANGLES:
+          this->geometry->push_back(
+            new ArcI(centre, p.radius, p.cw, p.start, p.end, p.zoom));
+          break;
+        case Primitive::ARC_POINTS:
+          this->geometry->push_back(new ArcII(centre,
+            table.GetCoordinate(p.first + 1), table.GetCoordinate(p.first + 2),
+            p.cw, p.zoom));
+          break;
+        case Primitive::CIRCLE:
+          this->geometry->push_back(new Circle(centre, p.radius, p.zoom));
+          break;
+      }
+    }
+  }
+
   // Method for parsing the coords from the string
   Position Airspace::ParseCoord(const QString& text) {
     Position cor;
@@ -348,42 +416,49 @@ namespace OpenAirspace {
 
 // Parse the height from string to feet
 int Airspace::ParseHeight(bool floor, bool* agl) {
-  // parse the string to number in ft
-  // if none of cond hit, return 0
-  int absoluteHeightInFt = 0;
   *agl = false;
-  QString* parsedString;
 
   // set the related parsed text
-  if (floor) {
-    if (this->AL)
-      parsedString = this->AL;
-    else
-      return 0;
-  } else {
-    if (this->AH)
-      parsedString = this->AH;
-    else
-      return 0;
-  }
+  const QString* parsedString = floor ? this->AL : this->AH;
+  if (!parsedString)
+    return 0;
+
+  return ParseHeight(*parsedString, agl);
+}
 
-  if (parsedString->contains("FL", Qt::CaseInsensitive)) {
-    // Compute the flight level = QNH1013.25 hPa MSL
-    int s = parsedString->indexOf(QRegExp("[0-9]"));
-    int e = parsedString->lastIndexOf(QRegExp("[0-9]"));
-    int FL = parsedString->mid(s, e - s + 1).toInt();
-    absoluteHeightInFt = FL * 100;
-  } else if (parsedString->contains("MSL", Qt::CaseInsensitive)) {
-    int s = parsedString->indexOf(QRegExp("[0-9]"));
-    int e = parsedString->lastIndexOf(QRegExp("[0-9]"));
-    absoluteHeightInFt = parsedString->mid(s, e - s + 1).toInt();
-  } else if (parsedString->contains("AGL", Qt::CaseInsensitive)) {
-    int s = parsedString->indexOf(QRegExp("[0-9]"));
-    int e = parsedString->lastIndexOf(QRegExp("[0-9]"));
-    absoluteHeightInFt = parsedString->mid(s, e - s + 1).toInt();
-    *agl = true;
+int Airspace::ParseHeight(const QString& text, bool* agl,
+  HeightType* type) {
+  // parse the string to number in ft
+  // if there is no number, return 0
+  int absoluteHeightInFt = 0;
+  HeightType parsedType = UNKNOWN;
+  *agl = false;
+  QString parsedString = text.trimmed().toUpper();
+
+  QRegExp number("[0-9]+");
+  if (number.indexIn(parsedString) >= 0) {
+    absoluteHeightInFt = number.cap(0).toInt();
+    parsedType = HEIGHT;
+
+    if (parsedString.contains("FL")) {
+      // Compute the flight level = QNH1013.25 hPa MSL
+      absoluteHeightInFt *= 100;
+    } else {
+      // A lone M after the number, not the M of MSL
+      if (parsedString.contains(QRegExp("[0-9]\\s*M\\b")))
+        absoluteHeightInFt = qRound(absoluteHeightInFt / 0.3048);
+
+      *agl = parsedString.contains("AGL") || parsedString.contains("GND") ||
+        parsedString.contains("SFC");
+    }
+  } else if (parsedString == "GND" || parsedString == "SFC") {
+    parsedType = GROUND;
+  } else if (parsedString.startsWith("UNL")) {
+    parsedType = UNLIMITED;
   }
 
+  if (type)
+    *type = parsedType;
   return absoluteHeightInFt;
 }
 }  // OpenAirspace
@@ -73,6 +73,8 @@ UserAirspace parser library.
 
 namespace OpenAirspace {
 
+class AirspaceTable;
+
 /// This class represents a single
 /// airspace in the OpenAir file.
 class OPENAIRSPACE_EXPORT Airspace {
@@ -90,6 +92,21 @@ class OPENAIRSPACE_EXPORT Airspace {
     *     W Wave Window */
     enum ACType { R, Q, P, A, B, C, D, E, GP, CTR, W, NA };
 
+    /// What the text of an AL or AH record describes.
+    enum HeightType {
+      /// A height in ft, m or a flight level.
+      HEIGHT,
+
+      /// GND or SFC without a height.
+      GROUND,
+
+      /// UNL, UNLTD or UNLIM.
+      UNLIMITED,
+
+      /// Missing or not understood.
+      UNKNOWN
+    };
+
     /// Pen style structure.
     struct SP_str {
       int style;
@@ -107,7 +124,15 @@ class OPENAIRSPACE_EXPORT Airspace {
     /// \param ts This takes the QTexttream in UseAir free
     /// format.
     /// \param acOn AC record read.
-    Airspace(QTextStream* ts, bool* acOn);
+    /// \param centre The centre set by the last V X= record,
+    /// used by the following arcs and circles. Updated by the V X= records
+    /// of this airspace.
+    Airspace(QTextStream* ts, bool* acOn, Position* centre);
+
+    /// Creates the airspace from a record of the flat table.
+    /// \param table The parsed airspaces.
+    /// \param index Index of the airspace in the table.
+    Airspace(const AirspaceTable& table, int index);
 
     /// \return The name of the AirSpace.
     inline const QString* const GetName() const { return this->AN; }
@@ -160,10 +185,6 @@ class OPENAIRSPACE_EXPORT Airspace {
     /// UserAirspace destructor code here.
     ~Airspace();
 
-    /// Coordinates of the center used by more airspaces.
-    static Position X;
-    static bool validX;
-
     /// Parse the height data from the text to feet.
     /// \param floor This parameter tells the routine
     /// whether it is processing the floor data.
@@ -172,7 +193,22 @@ class OPENAIRSPACE_EXPORT Airspace {
     /// \return The elevation in feet.
     int ParseHeight(bool floor, bool* agl);
 
+    /// Parse the height from the text of AL or AH record to feet.
+    /// Heights without FL, AGL, GND or SFC are above the mean sea level,
+    /// whether they are marked MSL, AMSL, ALT or not at all. Heights
+    /// in m are converted.
+    /// \param text The text of the record.
+    /// \param agl Returns true if the parsed height is
+    /// above the ground level or absolute.
+    /// \param type If not NULL, returns what the text describes.
+    /// \return The elevation in feet, 0 if it isn't a height.
+    static int ParseHeight(const QString& text, bool* agl,
+      HeightType* type = NULL);
+
   private :
+    /// Set all the members to the defaults.
+    void Init();
+
     /// Parses the WGS coordinates from string.
     /// \param parse The string from which the coordinates
     /// should be parsed.
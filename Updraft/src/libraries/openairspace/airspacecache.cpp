@@ -0,0 +1,410 @@
+#include "airspacecache.h"
+
+#include <string.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+namespace OpenAirspace {
+
+/// Increase when the layout of the entries changes.
+static const quint32 CACHE_VERSION = 2;
+
+static const char CACHE_MAGIC[8] = {'U', 'P', 'D', 'O', 'A', 'I', 'R', '\0'};
+
+/// Written in native byte order, entries from a machine with different
+/// endianness are then considered stale.
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+/// Sections of an entry start at multiples of this.
+static const qint64 SECTION_ALIGNMENT = 16;
+
+/// Type of the stored ground elevations.
+typedef double Elevation;
+
+/// Type of the stored tolerances of the levels of detail.
+typedef double Tolerance;
+
+/// Fixed size header at the start of every entry.
+/// All offsets are in bytes from the start of the entry.
+struct EntryHeader {
+  char magic[8];
+  quint32 byteOrder;
+  quint32 version;
+
+  /// Sizes of the stored structures, they differ between compilers.
+  quint32 primitiveSize;
+  quint32 positionSize;
+
+  /// Identification of the source file.
+  qint64 sourceSize;
+  qint64 sourceMtime;
+  quint64 sourceHash;
+
+  /// Path, identity and the airspace records serialized with QDataStream.
+  qint64 metaOffset;
+  qint64 metaSize;
+
+  /// Raw arrays and the numbers of their items.
+  qint64 primitivesOffset;
+  qint64 coordinatesOffset;
+  qint64 tolerancesOffset;
+  qint64 outlinesOffset;
+  qint64 verticesOffset;
+  qint64 groundOffset;
+  qint32 primitiveCount;
+  qint32 coordinateCount;
+  qint32 toleranceCount;
+  qint32 outlineCount;
+  qint32 vertexCount;
+  qint32 groundCount;
+};
+
+/// Identification of the content of a source file.
+struct SourceKey {
+  qint64 size;
+  qint64 mtime;
+  quint64 hash;
+};
+
+static qint64 AlignSection(qint64 offset) {
+  return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+/// 64bit FNV-1a hash.
+/// Not cryptographic, it only has to notice that the file was changed.
+static quint64 HashData(const uchar* data, qint64 size) {
+  quint64 hash = Q_UINT64_C(14695981039346656037);
+  for (qint64 i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= Q_UINT64_C(1099511628211);
+  }
+  return hash;
+}
+
+/// Fill size and modification time of the source file.
+static bool StatSource(const QString& path, SourceKey* key) {
+  QFileInfo info(path);
+  if (!info.isFile())
+    return false;
+
+  key->size = info.size();
+  key->mtime = info.lastModified().toTime_t();
+  return true;
+}
+
+/// Compute hash of the source file content.
+static bool HashSource(const QString& path, SourceKey* key) {
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return false;
+
+  if (f.size() == 0) {
+    key->hash = HashData(NULL, 0);
+    return true;
+  }
+
+  uchar* mapped = f.map(0, f.size());
+  if (mapped) {
+    key->hash = HashData(mapped, f.size());
+    f.unmap(mapped);
+    return true;
+  }
+
+  QByteArray data = f.readAll();
+  key->hash = HashData(reinterpret_cast<const uchar*>(data.constData()),
+    data.size());
+  return true;
+}
+
+/// Write zero bytes up to the next section boundary.
+static void PadSection(QIODevice* dev) {
+  static const char zeros[SECTION_ALIGNMENT] = {0};
+  qint64 pos = dev->pos();
+  dev->write(zeros, AlignSection(pos) - pos);
+}
+
+/// Write the items of the array followed by the padding.
+template <class T>
+static void WriteSection(QIODevice* dev, const QVector<T>& items) {
+  dev->write(reinterpret_cast<const char*>(items.constData()),
+    sizeof(T) * items.size());
+  PadSection(dev);
+}
+
+/// Copy count items from the mapped entry.
+template <class T>
+static void ReadSection(const uchar* mapped, qint64 offset, int count,
+  QVector<T>* items) {
+  items->resize(count);
+  if (count)
+    memcpy(items->data(), mapped + offset, sizeof(T) * count);
+}
+
+/// \return true if count items of size bytes at offset fit into the entry.
+static bool SectionFits(qint64 offset, qint32 count, qint64 size,
+  qint64 entrySize) {
+  return offset >= 0 && count >= 0 && offset + count * size <= entrySize;
+}
+
+static void WriteRecord(QDataStream* stream, const AirspaceRecord& r) {
+  *stream << static_cast<qint32>(r.type) << r.className << r.name <<
+    r.floor << r.ceiling << r.terrainOpen << r.terrainClosed <<
+    static_cast<qint32>(r.floorFt) << static_cast<qint32>(r.ceilingFt) <<
+    r.floorAgl << r.ceilingAgl <<
+    static_cast<qint32>(r.firstPrimitive) <<
+    static_cast<qint32>(r.primitiveCount) <<
+    static_cast<qint32>(r.firstLabel) << static_cast<qint32>(r.labelCount) <<
+    static_cast<qint32>(r.firstAirway) <<
+    static_cast<qint32>(r.airwayCount) << r.airwayWidth <<
+    r.hasPen << r.hasBrush;
+  if (r.hasPen) {
+    *stream << static_cast<qint32>(r.pen.style) <<
+      static_cast<qint32>(r.pen.width) << static_cast<qint32>(r.pen.R) <<
+      static_cast<qint32>(r.pen.G) << static_cast<qint32>(r.pen.B);
+  }
+  if (r.hasBrush) {
+    *stream << static_cast<qint32>(r.brush.R) <<
+      static_cast<qint32>(r.brush.G) << static_cast<qint32>(r.brush.B);
+  }
+}
+
+static void ReadRecord(QDataStream* stream, AirspaceRecord* record) {
+  AirspaceRecord& r = *record;
+  qint32 type, floorFt, ceilingFt, firstPrimitive, primitiveCount;
+  qint32 firstLabel, labelCount, firstAirway, airwayCount;
+  *stream >> type >> r.className >> r.name >> r.floor >> r.ceiling >>
+    r.terrainOpen >> r.terrainClosed >> floorFt >> ceilingFt >>
+    r.floorAgl >> r.ceilingAgl >> firstPrimitive >> primitiveCount >>
+    firstLabel >> labelCount >> firstAirway >> airwayCount >>
+    r.airwayWidth >> r.hasPen >> r.hasBrush;
+  r.type = static_cast<Airspace::ACType>(type);
+  r.floorFt = floorFt;
+  r.ceilingFt = ceilingFt;
+  r.firstPrimitive = firstPrimitive;
+  r.primitiveCount = primitiveCount;
+  r.firstLabel = firstLabel;
+  r.labelCount = labelCount;
+  r.firstAirway = firstAirway;
+  r.airwayCount = airwayCount;
+
+  if (r.hasPen) {
+    qint32 style, width, R, G, B;
+    *stream >> style >> width >> R >> G >> B;
+    r.pen.style = style;
+    r.pen.width = width;
+    r.pen.R = R;
+    r.pen.G = G;
+    r.pen.B = B;
+  }
+  if (r.hasBrush) {
+    qint32 R, G, B;
+    *stream >> R >> G >> B;
+    r.brush.R = R;
+    r.brush.G = G;
+    r.brush.B = B;
+  }
+}
+
+AirspaceCache::AirspaceCache(const QDir& directory)
+  : dir(directory) {
+  if (!dir.exists())
+    dir.mkpath(".");
+}
+
+QString AirspaceCache::EntryPath(const QString& path) const {
+  QByteArray key = QFileInfo(path).absoluteFilePath().toUtf8();
+  QByteArray name = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+  return dir.absoluteFilePath(QString::fromAscii(name.toHex()) + ".cache");
+}
+
+void AirspaceCache::Remove(const QString& path) {
+  QFile::remove(EntryPath(path));
+}
+
+bool AirspaceCache::Load(const QString& path, const QString& identity,
+  CompiledAirspaces* result) {
+  QString entry = EntryPath(path);
+  QFile f(entry);
+  if (!f.open(QIODevice::ReadOnly))
+    return false;
+
+  qint64 size = f.size();
+  const uchar* mapped = NULL;
+  if (size >= static_cast<qint64>(sizeof(EntryHeader)))
+    mapped = f.map(0, size);
+  if (!mapped)
+    return false;
+
+  EntryHeader header;
+  memcpy(&header, mapped, sizeof(header));
+
+  bool valid =
+    memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+    header.byteOrder == BYTE_ORDER_MARK &&
+    header.version == CACHE_VERSION &&
+    header.primitiveSize == sizeof(Primitive) &&
+    header.positionSize == sizeof(Position) &&
+    header.metaOffset >= 0 && header.metaSize >= 0 &&
+    header.metaOffset + header.metaSize <= size &&
+    SectionFits(header.primitivesOffset, header.primitiveCount,
+      sizeof(Primitive), size) &&
+    SectionFits(header.coordinatesOffset, header.coordinateCount,
+      sizeof(Position), size) &&
+    SectionFits(header.tolerancesOffset, header.toleranceCount,
+      sizeof(Tolerance), size) &&
+    SectionFits(header.outlinesOffset, header.outlineCount,
+      sizeof(qint32), size) &&
+    SectionFits(header.verticesOffset, header.vertexCount,
+      sizeof(Position), size) &&
+    SectionFits(header.groundOffset, header.groundCount,
+      sizeof(Elevation), size);
+
+  // Size and time are checked first, so that a changed file doesn't
+  // have to be hashed.
+  SourceKey key;
+  valid = valid && StatSource(path, &key) &&
+    key.size == header.sourceSize && key.mtime == header.sourceMtime &&
+    HashSource(path, &key) && key.hash == header.sourceHash;
+
+  QVector<AirspaceRecord> airspaces;
+  if (valid) {
+    QByteArray meta = QByteArray::fromRawData(
+      reinterpret_cast<const char*>(mapped + header.metaOffset),
+      header.metaSize);
+    QDataStream stream(meta);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    QString storedPath, storedIdentity;
+    qint32 count = 0;
+    stream >> storedPath >> storedIdentity >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+      AirspaceRecord record;
+      ReadRecord(&stream, &record);
+      airspaces.append(record);
+    }
+
+    valid = stream.status() == QDataStream::Ok &&
+      storedPath == QFileInfo(path).absoluteFilePath() &&
+      (identity.isNull() || storedIdentity == identity) &&
+      (header.outlineCount == 0 ||
+        header.outlineCount ==
+          header.toleranceCount * airspaces.size() + 1);
+  }
+
+  if (!valid) {
+    qDebug() << "Airspace cache entry for" << path << "is stale.";
+    f.close();
+    QFile::remove(entry);
+    return false;
+  }
+
+  AirspaceTable& table = result->table;
+  table.Clear();
+  table.airspaces = airspaces;
+  ReadSection(mapped, header.primitivesOffset, header.primitiveCount,
+    &table.primitives);
+  ReadSection(mapped, header.coordinatesOffset, header.coordinateCount,
+    &table.coordinates);
+  ReadSection(mapped, header.tolerancesOffset, header.toleranceCount,
+    &result->tolerances);
+  ReadSection(mapped, header.outlinesOffset, header.outlineCount,
+    &result->outlineStart);
+  ReadSection(mapped, header.verticesOffset, header.vertexCount,
+    &result->vertices);
+  ReadSection(mapped, header.groundOffset, header.groundCount,
+    &result->ground);
+
+  return true;
+}
+
+bool AirspaceCache::Store(const QString& path, const QString& identity,
+  const CompiledAirspaces& compiled) {
+  SourceKey key;
+  if (!StatSource(path, &key) || !HashSource(path, &key))
+    return false;
+
+  const AirspaceTable& table = compiled.table;
+  QByteArray meta;
+  {
+    QDataStream stream(&meta, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << QFileInfo(path).absoluteFilePath() << identity <<
+      static_cast<qint32>(table.airspaces.size());
+    foreach(const AirspaceRecord& record, table.airspaces)
+      WriteRecord(&stream, record);
+  }
+
+  EntryHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.byteOrder = BYTE_ORDER_MARK;
+  header.version = CACHE_VERSION;
+  header.primitiveSize = sizeof(Primitive);
+  header.positionSize = sizeof(Position);
+  header.sourceSize = key.size;
+  header.sourceMtime = key.mtime;
+  header.sourceHash = key.hash;
+  header.metaOffset = AlignSection(sizeof(header));
+  header.metaSize = meta.size();
+
+  header.primitiveCount = table.primitives.size();
+  header.coordinateCount = table.coordinates.size();
+  header.toleranceCount = compiled.tolerances.size();
+  header.outlineCount = compiled.outlineStart.size();
+  header.vertexCount = compiled.vertices.size();
+  header.groundCount = compiled.ground.size();
+
+  header.primitivesOffset =
+    AlignSection(header.metaOffset + header.metaSize);
+  header.coordinatesOffset = AlignSection(header.primitivesOffset +
+    sizeof(Primitive) * header.primitiveCount);
+  header.tolerancesOffset = AlignSection(header.coordinatesOffset +
+    sizeof(Position) * header.coordinateCount);
+  header.outlinesOffset = AlignSection(header.tolerancesOffset +
+    sizeof(Tolerance) * header.toleranceCount);
+  header.verticesOffset = AlignSection(header.outlinesOffset +
+    sizeof(qint32) * header.outlineCount);
+  header.groundOffset = AlignSection(header.verticesOffset +
+    sizeof(Position) * header.vertexCount);
+
+  // Written to a temporary file first, so that a reader never sees
+  // a half written entry.
+  QTemporaryFile tmp(dir.absoluteFilePath("XXXXXX.tmp"));
+  if (!tmp.open()) {
+    qDebug() << "Couldn't create an airspace cache entry for" << path;
+    return false;
+  }
+
+  tmp.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  PadSection(&tmp);
+  tmp.write(meta);
+  PadSection(&tmp);
+  WriteSection(&tmp, table.primitives);
+  WriteSection(&tmp, table.coordinates);
+  WriteSection(&tmp, compiled.tolerances);
+  WriteSection(&tmp, compiled.outlineStart);
+  WriteSection(&tmp, compiled.vertices);
+  WriteSection(&tmp, compiled.ground);
+
+  if (tmp.error() != QFile::NoError) {
+    qDebug() << "Writing airspace cache entry failed (" <<
+      tmp.errorString() << ")";
+    return false;
+  }
+
+  QString entry = EntryPath(path);
+  tmp.close();
+  QFile::remove(entry);
+  if (!tmp.rename(entry))
+    return false;
+  tmp.setAutoRemove(false);
+
+  return true;
+}
+}  // OpenAirspace
@@ -0,0 +1,96 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACECACHE_H_
+#define UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACECACHE_H_
+
+#include <QDir>
+#include <QString>
+#include <QVector>
+
+#include "openairspace_global.h"
+#include "airspacetable.h"
+
+namespace OpenAirspace {
+
+/// Subdirectory of the data directory with the cache of the airspaces
+/// plugin.
+static const char CACHE_DIRECTORY[] = "airspacecache";
+
+/// Setting of the airspaces plugin with the directory of offline elevation
+/// tiles, the ground of the compiled airspaces is sampled from them.
+static const char DEM_DIRECTORY_SETTING[] = "airspaces:demDirectory";
+
+/// Airspaces of one file prepared for drawing.
+struct OPENAIRSPACE_EXPORT CompiledAirspaces {
+  /// The parsed file.
+  AirspaceTable table;
+
+  /// Maximal error in m of each level of detail of the outlines,
+  /// the finest first.
+  QVector<double> tolerances;
+
+  /// Outline of the airspace i at the level of detail l are the vertices
+  /// from outlineStart[Outline(l, i)] to outlineStart[Outline(l, i) + 1].
+  /// The levels are stored one after another, so it has one item more
+  /// than the levels times the airspaces.
+  QVector<qint32> outlineStart;
+
+  /// Tessellated closed outlines of all the airspaces.
+  QVector<Position> vertices;
+
+  /// Ground elevation in m under every vertex, NaN if it was not needed.
+  QVector<double> ground;
+
+  /// \return Index of the outline of the airspace i at the level l
+  /// in outlineStart.
+  inline int Outline(int level, int i) const {
+    return level * table.size() + i; }
+};
+
+/// On-disk cache of compiled airspace files.
+/// Every file is stored in a single entry holding the table, the outlines
+/// of all levels of detail and the ground elevations as they are laid out
+/// in memory. Loading maps
+/// the entry and copies the arrays, nothing is parsed or tessellated.
+///
+/// Entries are keyed by the absolute path of the source file and validated
+/// against its size, modification time and a hash of its content, and
+/// against the identity of the data used to compile them (the tessellation
+/// settings, the elevation sources). Stale entries are removed when they are
+/// found, the caller is expected to compile the file again and Store() it.
+class OPENAIRSPACE_EXPORT AirspaceCache {
+ public:
+  /// \param directory Directory with the cache entries. It is created if
+  /// it doesn't exist.
+  explicit AirspaceCache(const QDir& directory);
+
+  /// \return The directory with the cache entries.
+  inline QDir Directory() const { return dir; }
+
+  /// Load compiled airspaces from the cache.
+  /// \param path Path to the OpenAir file.
+  /// \param identity Identity of the data the entry was compiled with,
+  /// or a null string to accept any, if the ground is not used.
+  /// \param [out] result The cached airspaces.
+  /// \return true if a valid entry was found.
+  bool Load(const QString& path, const QString& identity,
+    CompiledAirspaces* result);
+
+  /// Store compiled airspaces to the cache.
+  /// \param path Path to the OpenAir file the airspaces were parsed from.
+  /// \param identity Identity of the data the airspaces were compiled with.
+  /// \param compiled The airspaces.
+  /// \return true if the entry was written.
+  bool Store(const QString& path, const QString& identity,
+    const CompiledAirspaces& compiled);
+
+  /// Remove the cache entry of a file.
+  void Remove(const QString& path);
+
+ private:
+  /// \return Path of the entry for the given OpenAir file.
+  QString EntryPath(const QString& path) const;
+
+  QDir dir;
+};
+}  // OpenAirspace
+
+#endif  // UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACECACHE_H_
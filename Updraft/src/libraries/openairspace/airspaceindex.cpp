@@ -0,0 +1,491 @@
+#include "airspaceindex.h"
+
+#include <qnumeric.h>
+
+#include <QDebug>
+#include <QRunnable>
+#include <QThread>
+
+#include "outlinetessellator.h"
+#include "../dem/sampler.h"
+#include "../util/util.h"
+
+namespace OpenAirspace {
+
+/// Minimal number of fixes queried by one thread.
+static const int MIN_FIXES_PER_THREAD = 4096;
+
+/// Average number of edges in a band of an outline.
+static const int EDGES_PER_BAND = 8;
+
+/// Maximal number of bands of an outline.
+static const int MAX_BANDS = 1024;
+
+/// \return The limit given by the text of an AL or AH record.
+/// GND, SFC, UNL and missing records give no limit. Texts that
+/// Airspace::ParseHeight() doesn't understand give no limit either,
+/// but they are reported.
+static Limit MakeLimit(const QString& text, const QString& name) {
+  bool agl;
+  Airspace::HeightType type;
+  int feet = Airspace::ParseHeight(text, &agl, &type);
+
+  Limit limit;
+  limit.height = Updraft::Util::Units::feetToMeters(feet);
+  if (type != Airspace::HEIGHT)
+    limit.reference = Limit::NONE;
+  else if (agl)
+    limit.reference = Limit::AGL;
+  else if (text.contains("FL", Qt::CaseInsensitive))
+    limit.reference = Limit::FL;
+  else
+    limit.reference = Limit::MSL;
+
+  if (type == Airspace::UNKNOWN && !text.trimmed().isEmpty())
+    qDebug() << "Height" << text << "of airspace" << name <<
+      "is not recognized, it is ignored.";
+  return limit;
+}
+
+/// \return Height of the fix above the limit in m, negative if below.
+static double AboveLimit(const Limit& limit, const Fix& fix, double ground) {
+  switch (limit.reference) {
+    case Limit::AGL:
+      return fix.altitude - ground - limit.height;
+    case Limit::FL:
+      if (!qIsNaN(fix.pressureAltitude))
+        return fix.pressureAltitude - limit.height;
+      return fix.altitude - limit.height;
+    default:
+      return fix.altitude - limit.height;
+  }
+}
+
+/// \return The fix at t of the segment from a to b.
+static Fix Interpolate(const Fix& a, const Fix& b, double t) {
+  Fix fix;
+  fix.lat = a.lat + (b.lat - a.lat) * t;
+  fix.lon = a.lon + (b.lon - a.lon) * t;
+  fix.altitude = a.altitude + (b.altitude - a.altitude) * t;
+  fix.pressureAltitude = a.pressureAltitude +
+    (b.pressureAltitude - a.pressureAltitude) * t;
+  return fix;
+}
+
+/// \return t where the linear function with values f0 at 0 and f1 at 1
+/// changes sign, or -1 if it doesn't.
+static double Root(double f0, double f1) {
+  if ((f0 < 0) == (f1 < 0))
+    return -1;
+  return f0 / (f0 - f1);
+}
+
+/// Orders the crossings by t.
+static bool CrossingLess(const Crossing& a, const Crossing& b) {
+  return a.t < b.t;
+}
+
+/// Queries a range of fixes on a worker thread.
+class AirspaceIndex::QueryTask : public QRunnable {
+ public:
+  QueryTask(const AirspaceIndex* index, const Fix* fixes, int first,
+    int count, bool horizontally, QVector<Hit>* hits)
+    : index(index), fixes(fixes), first(first), count(count),
+    horizontally(horizontally), hits(hits) {}
+
+  void run() {
+    index->QueryRange(fixes, first, count, horizontally, hits);
+  }
+
+ private:
+  const AirspaceIndex* index;
+  const Fix* fixes;
+  int first;
+  int count;
+  bool horizontally;
+  QVector<Hit>* hits;
+};
+
+void AirspaceIndex::Build(const AirspaceTable& table,
+  const QVector<qint32>& outlineStart, const QVector<Position>& vertices) {
+  Clear();
+  this->table = table;
+  this->vertices = vertices;
+
+  floors.resize(table.size());
+  ceilings.resize(table.size());
+  outlines.resize(table.size());
+  for (int i = 0; i < table.size(); ++i) {
+    const AirspaceRecord& A = table.GetAirspace(i);
+    floors[i] = MakeLimit(A.floor, A.name);
+    ceilings[i] = MakeLimit(A.ceiling, A.name);
+
+    outlines[i].firstVertex = outlineStart[i];
+    outlines[i].vertexCount = outlineStart[i + 1] - outlineStart[i];
+  }
+
+  BuildIndex();
+}
+
+void AirspaceIndex::Build(const AirspaceTable& table, double tolerance) {
+  QVector<qint32> outlineStart;
+  QVector<Position> vertices;
+  OutlineTessellator tessellator(tolerance);
+  tessellator.Tessellate(table, &outlineStart, &vertices);
+
+  Build(table, outlineStart, vertices);
+}
+
+void AirspaceIndex::Clear() {
+  table.Clear();
+  floors.clear();
+  ceilings.clear();
+  outlines.clear();
+  vertices.clear();
+  bandStart.clear();
+  bandEdges.clear();
+  tree.clear();
+  treeAirspaces.clear();
+}
+
+void AirspaceIndex::BuildIndex() {
+  QVector<Tree::Box> boxes;
+  bandStart.append(0);
+
+  for (int i = 0; i < outlines.size(); ++i) {
+    Outline& outline = outlines[i];
+    outline.firstBand = bandStart.size() - 1;
+    outline.bandCount = 0;
+    outline.bandLat = 0;
+    outline.bandScale = 0;
+
+    // At least a triangle with the first vertex repeated
+    if (outline.vertexCount < 4)
+      continue;
+
+    const Position* v = vertices.constData() + outline.firstVertex;
+    int edges = outline.vertexCount - 1;
+
+    double point[2] = {v[0].lat, v[0].lon};
+    outline.box = Tree::Box::fromPoint(point);
+    for (int k = 1; k < outline.vertexCount; ++k) {
+      point[0] = v[k].lat;
+      point[1] = v[k].lon;
+      outline.box.extend(point);
+    }
+    boxes.append(outline.box);
+    treeAirspaces.append(i);
+
+    // Divide the outline into bands of the same height
+    double height = outline.box.high[0] - outline.box.low[0];
+    outline.bandCount = qBound(1, edges / EDGES_PER_BAND, MAX_BANDS);
+    outline.bandLat = outline.box.low[0];
+    outline.bandScale = height > 0 ? outline.bandCount / height : 0;
+
+    // Count the edges in each band, then fill them in
+    QVector<qint32> counts(outline.bandCount + 1, 0);
+    for (int k = 0; k < edges; ++k) {
+      int from = Band(outline, qMin(v[k].lat, v[k + 1].lat));
+      int to = Band(outline, qMax(v[k].lat, v[k + 1].lat));
+      for (int b = from; b <= to; ++b)
+        ++counts[b + 1];
+    }
+
+    int base = bandEdges.size();
+    for (int b = 0; b < outline.bandCount; ++b) {
+      counts[b + 1] += counts[b];
+      bandStart.append(base + counts[b + 1]);
+    }
+    bandEdges.resize(base + counts[outline.bandCount]);
+
+    for (int k = 0; k < edges; ++k) {
+      int from = Band(outline, qMin(v[k].lat, v[k + 1].lat));
+      int to = Band(outline, qMax(v[k].lat, v[k + 1].lat));
+      for (int b = from; b <= to; ++b)
+        bandEdges[base + counts[b]++] = outline.firstVertex + k;
+    }
+  }
+
+  tree.build(boxes);
+}
+
+int AirspaceIndex::Band(const Outline& outline, double lat) const {
+  int band = static_cast<int>((lat - outline.bandLat) * outline.bandScale);
+  return qBound(0, band, outline.bandCount - 1);
+}
+
+QVector<Position> AirspaceIndex::GetOutline(int i) const {
+  return vertices.mid(outlines[i].firstVertex, outlines[i].vertexCount);
+}
+
+bool AirspaceIndex::ContainsHorizontally(int i, double lat,
+  double lon) const {
+  const Outline& outline = outlines[i];
+  if (outline.bandCount == 0)
+    return false;
+
+  double point[2] = {lat, lon};
+  if (outline.box.distanceSquared(point) > 0)
+    return false;
+
+  // Count the edges crossing the ray to the east
+  int band = outline.firstBand + Band(outline, lat);
+  bool inside = false;
+  for (int k = bandStart[band]; k < bandStart[band + 1]; ++k) {
+    const Position& c = vertices[bandEdges[k]];
+    const Position& d = vertices[bandEdges[k] + 1];
+    if ((c.lat > lat) != (d.lat > lat)) {
+      double x = c.lon + (lat - c.lat) * (d.lon - c.lon) / (d.lat - c.lat);
+      if (x > lon)
+        inside = !inside;
+    }
+  }
+  return inside;
+}
+
+bool AirspaceIndex::ContainsVertically(int i, const Fix& fix,
+  double* ground) const {
+  const Limit& floor = floors[i];
+  const Limit& ceiling = ceilings[i];
+  if ((floor.reference == Limit::AGL || ceiling.reference == Limit::AGL) &&
+    qIsNaN(*ground)) {
+    *ground = Ground(fix.lat, fix.lon);
+  }
+
+  if (floor.reference != Limit::NONE && AboveLimit(floor, fix, *ground) < 0)
+    return false;
+  if (ceiling.reference != Limit::NONE &&
+    AboveLimit(ceiling, fix, *ground) > 0)
+    return false;
+  return true;
+}
+
+bool AirspaceIndex::Contains(int i, const Fix& fix) const {
+  double ground = qQNaN();
+  return ContainsVertically(i, fix, &ground) &&
+    ContainsHorizontally(i, fix.lat, fix.lon);
+}
+
+void AirspaceIndex::LimitAltitudes(int i, const Fix& fix, double* floor,
+  double* ceiling) const {
+  const Limit* limits[2] = {&floors[i], &ceilings[i]};
+  double* altitudes[2] = {floor, ceiling};
+  for (int k = 0; k < 2; ++k) {
+    const Limit& limit = *limits[k];
+    switch (limit.reference) {
+      case Limit::NONE:
+        *altitudes[k] = k == 0 ? Ground(fix.lat, fix.lon) : qInf();
+        break;
+      case Limit::AGL:
+        *altitudes[k] = Ground(fix.lat, fix.lon) + limit.height;
+        break;
+      case Limit::FL:
+        // Shifted by the difference of the GPS and pressure altitudes
+        *altitudes[k] = limit.height;
+        if (!qIsNaN(fix.pressureAltitude))
+          *altitudes[k] += fix.altitude - fix.pressureAltitude;
+        break;
+      default:
+        *altitudes[k] = limit.height;
+    }
+  }
+}
+
+double AirspaceIndex::Ground(double lat, double lon) const {
+  double ground;
+  if (terrain && terrain->elevation(lat, lon, &ground))
+    return ground;
+  return 0;
+}
+
+void AirspaceIndex::Query(const Fix& fix, QVector<int>* result) const {
+  QueryFix(fix, false, result);
+}
+
+void AirspaceIndex::QueryHorizontally(double lat, double lon,
+  QVector<int>* result) const {
+  Fix fix;
+  fix.lat = lat;
+  fix.lon = lon;
+  fix.altitude = 0;
+  fix.pressureAltitude = qQNaN();
+  QueryFix(fix, true, result);
+}
+
+void AirspaceIndex::QueryFix(const Fix& fix, bool horizontally,
+  QVector<int>* result) const {
+  result->clear();
+
+  QVector<int> candidates;
+  double point[2] = {fix.lat, fix.lon};
+  tree.intersecting(Tree::Box::fromPoint(point), &candidates);
+
+  double ground = qQNaN();
+  foreach(int candidate, candidates) {
+    int i = treeAirspaces[candidate];
+    if ((horizontally || ContainsVertically(i, fix, &ground)) &&
+      ContainsHorizontally(i, fix.lat, fix.lon)) {
+      result->append(i);
+    }
+  }
+  qSort(*result);
+}
+
+void AirspaceIndex::QueryRange(const Fix* fixes, int first, int count,
+  bool horizontally, QVector<Hit>* hits) const {
+  QVector<int> airspaces;
+  for (int j = first; j < first + count; ++j) {
+    QueryFix(fixes[j], horizontally, &airspaces);
+    foreach(int i, airspaces) {
+      Hit hit;
+      hit.fix = j;
+      hit.airspace = i;
+      hits->append(hit);
+    }
+  }
+}
+
+void AirspaceIndex::Query(const Fix* fixes, int count, QVector<Hit>* hits,
+  int threads) const {
+  QueryBatch(fixes, count, false, hits, threads);
+}
+
+void AirspaceIndex::QueryHorizontally(const Fix* fixes, int count,
+  QVector<Hit>* hits, int threads) const {
+  QueryBatch(fixes, count, true, hits, threads);
+}
+
+void AirspaceIndex::QueryBatch(const Fix* fixes, int count,
+  bool horizontally, QVector<Hit>* hits, int threads) const {
+  hits->clear();
+  if (threads <= 0)
+    threads = qMax(1, QThread::idealThreadCount());
+  int parts = qBound(1, count / MIN_FIXES_PER_THREAD, threads);
+
+  if (parts == 1) {
+    QueryRange(fixes, 0, count, horizontally, hits);
+    return;
+  }
+
+  // Split the fixes evenly, the parts are concatenated in order.
+  // The calling thread takes the last part itself.
+  QVector<QVector<Hit> > partHits(parts);
+  for (int i = 0; i < parts; ++i) {
+    int first = static_cast<qint64>(count) * i / parts;
+    int last = static_cast<qint64>(count) * (i + 1) / parts;
+    if (i == parts - 1)
+      QueryRange(fixes, first, last - first, horizontally, &partHits[i]);
+    else
+      pool.start(new QueryTask(this, fixes, first, last - first,
+        horizontally, &partHits[i]));
+  }
+  pool.waitForDone();
+
+  foreach(const QVector<Hit>& part, partHits) {
+    *hits += part;
+  }
+}
+
+void AirspaceIndex::Crossings(const Fix& from, const Fix& to,
+  QVector<Crossing>* result) const {
+  result->clear();
+
+  QVector<int> candidates;
+  double a[2] = {from.lat, from.lon};
+  double b[2] = {to.lat, to.lon};
+  tree.intersectingSegment(a, b, &candidates);
+  for (int j = 0; j < candidates.size(); ++j)
+    candidates[j] = treeAirspaces[candidates[j]];
+  qSort(candidates);
+
+  double groundFrom = qQNaN();
+  double groundTo = qQNaN();
+  double dLat = to.lat - from.lat;
+  double dLon = to.lon - from.lon;
+
+  QVector<double> ts;
+  foreach(int i, candidates) {
+    const Outline& outline = outlines[i];
+    const Limit& floor = floors[i];
+    const Limit& ceiling = ceilings[i];
+    bool agl = floor.reference == Limit::AGL ||
+      ceiling.reference == Limit::AGL;
+    if (agl && qIsNaN(groundFrom)) {
+      groundFrom = Ground(from.lat, from.lon);
+      groundTo = Ground(to.lat, to.lon);
+    }
+
+    // Where the segment crosses the edges of the outline
+    ts.clear();
+    int firstBand = outline.firstBand +
+      Band(outline, qMin(from.lat, to.lat));
+    int lastBand = outline.firstBand + Band(outline, qMax(from.lat, to.lat));
+    for (int k = bandStart[firstBand]; k < bandStart[lastBand + 1]; ++k) {
+      const Position& c = vertices[bandEdges[k]];
+      const Position& d = vertices[bandEdges[k] + 1];
+      double eLat = d.lat - c.lat;
+      double eLon = d.lon - c.lon;
+      double denom = dLat * eLon - dLon * eLat;
+      if (denom == 0)
+        continue;
+
+      double cLat = c.lat - from.lat;
+      double cLon = c.lon - from.lon;
+      double t = (cLat * eLon - cLon * eLat) / denom;
+      double s = (cLat * dLon - cLon * dLat) / denom;
+      if (t >= 0 && t <= 1 && s >= 0 && s <= 1)
+        ts.append(t);
+    }
+
+    // Where the altitude crosses the floor and the ceiling
+    if (floor.reference != Limit::NONE) {
+      ts.append(Root(AboveLimit(floor, from, groundFrom),
+        AboveLimit(floor, to, groundTo)));
+    }
+    if (ceiling.reference != Limit::NONE) {
+      ts.append(Root(AboveLimit(ceiling, from, groundFrom),
+        AboveLimit(ceiling, to, groundTo)));
+    }
+    ts.append(1);
+    qSort(ts);
+
+    // The containment is constant between the consecutive values of t
+    double ground = groundFrom;
+    bool inside = ContainsVertically(i, from, &ground) &&
+      ContainsHorizontally(i, from.lat, from.lon);
+    double previous = 0;
+    foreach(double t, ts) {
+      if (t <= previous)
+        continue;
+
+      double middle = (previous + t) / 2;
+      Fix fix = Interpolate(from, to, middle);
+      ground = groundFrom + (groundTo - groundFrom) * middle;
+      bool state = ContainsVertically(i, fix, &ground) &&
+        ContainsHorizontally(i, fix.lat, fix.lon);
+      if (state != inside) {
+        Crossing crossing;
+        crossing.airspace = i;
+        crossing.t = previous;
+        crossing.entering = state;
+        result->append(crossing);
+        inside = state;
+      }
+      previous = t;
+    }
+
+    ground = groundTo;
+    bool state = ContainsVertically(i, to, &ground) &&
+      ContainsHorizontally(i, to.lat, to.lon);
+    if (state != inside) {
+      Crossing crossing;
+      crossing.airspace = i;
+      crossing.t = 1;
+      crossing.entering = state;
+      result->append(crossing);
+    }
+  }
+
+  qStableSort(result->begin(), result->end(), CrossingLess);
+}
+}  // OpenAirspace
@@ -0,0 +1,255 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACEINDEX_H_
+#define UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACEINDEX_H_
+
+#include <QThreadPool>
+#include <QVector>
+
+#include "openairspace_global.h"
+#include "airspacetable.h"
+#include "../util/rtree.h"
+
+namespace Updraft {
+namespace Dem {
+  class Sampler;
+}
+}
+
+namespace OpenAirspace {
+
+/// Position of an aircraft for the containment queries.
+struct OPENAIRSPACE_EXPORT Fix {
+  double lat;
+  double lon;
+
+  /// Altitude in m above the mean sea level (GPS altitude).
+  double altitude;
+
+  /// Pressure altitude in m at 1013.25 hPa, compared to the flight
+  /// levels. NaN if it is not known, the altitude is used instead.
+  double pressureAltitude;
+};
+
+/// Floor or ceiling of an airspace.
+struct OPENAIRSPACE_EXPORT Limit {
+  /// What the height is measured from
+  enum Reference {
+    /// Mean sea level.
+    MSL,
+
+    /// Ground level under the aircraft.
+    AGL,
+
+    /// Flight level, the pressure altitude at 1013.25 hPa.
+    FL,
+
+    /// Floor at the ground or unlimited ceiling.
+    NONE
+  };
+
+  /// One of Reference.
+  quint8 reference;
+
+  /// Height in m.
+  double height;
+};
+
+/// Fix inside an airspace, result of the batch query.
+struct OPENAIRSPACE_EXPORT Hit {
+  /// Index of the fix.
+  qint32 fix;
+
+  /// Index of the airspace.
+  qint32 airspace;
+};
+
+/// Change of the containment along a segment between two fixes.
+struct OPENAIRSPACE_EXPORT Crossing {
+  /// Index of the airspace.
+  qint32 airspace;
+
+  /// Position of the crossing on the segment, 0 at the first fix
+  /// and 1 at the second one.
+  double t;
+
+  /// true if the segment enters the airspace, false if it leaves it.
+  bool entering;
+};
+
+/// Answers which airspaces contain an aircraft.
+/// A 2D R-tree over the bounding boxes of the tessellated outlines selects
+/// the candidates, the outlines are then tested exactly. Every outline is
+/// divided into latitude bands with the edges crossing them, so the point
+/// in polygon test only looks at a few edges even for circles with
+/// hundreds of vertices.
+/// The floors and ceilings are resolved per fix: MSL limits against the
+/// altitude, flight levels against the pressure altitude and AGL limits
+/// against the terrain under the fix from the terrain sampler.
+/// Outlines are treated as polygons in latitude and longitude, which is
+/// exact for the tessellated vertices and close enough for the edges.
+/// The index is read only once built, so queries may run on several
+/// threads at once.
+class OPENAIRSPACE_EXPORT AirspaceIndex {
+ public:
+  AirspaceIndex() : terrain(NULL) {}
+
+  /// Index the airspaces with already tessellated outlines.
+  /// \param table The airspaces, it is copied.
+  /// \param outlineStart Outline of the airspace i are the vertices from
+  /// outlineStart[i] to outlineStart[i + 1], see CompiledAirspaces.
+  /// \param vertices Closed outlines of all the airspaces.
+  void Build(const AirspaceTable& table, const QVector<qint32>& outlineStart,
+    const QVector<Position>& vertices);
+
+  /// Tessellate the outlines of the airspaces and index them.
+  /// \param tolerance Maximal distance of the arcs from the true curve in m.
+  void Build(const AirspaceTable& table, double tolerance);
+
+  /// Remove all airspaces.
+  void Clear();
+
+  /// Set the terrain for the AGL limits. Ground at the mean sea level
+  /// is used where the sampler has no data or if it is NULL.
+  /// The sampler must live as long as the index is queried.
+  inline void SetTerrain(const Updraft::Dem::Sampler* sampler) {
+    terrain = sampler; }
+
+  /// \return The number of airspaces.
+  inline int size() const { return table.size(); }
+
+  /// \return The indexed airspaces.
+  inline const AirspaceTable& GetTable() const { return table; }
+
+  /// \return The floor of the airspace i.
+  inline const Limit& GetFloor(int i) const { return floors[i]; }
+
+  /// \return The ceiling of the airspace i.
+  inline const Limit& GetCeiling(int i) const { return ceilings[i]; }
+
+  /// \return The closed outline of the airspace i.
+  QVector<Position> GetOutline(int i) const;
+
+  /// \return true if the point is inside the outline of the airspace i.
+  bool ContainsHorizontally(int i, double lat, double lon) const;
+
+  /// \return true if the fix is inside the airspace i.
+  bool Contains(int i, const Fix& fix) const;
+
+  /// Resolve the floor and ceiling of the airspace i above the fix
+  /// to the altitude scale of the fix (GPS altitude above MSL).
+  /// \param [out] floor The ground under the fix if the airspace
+  /// starts at the ground.
+  /// \param [out] ceiling Infinity if the airspace is unlimited.
+  void LimitAltitudes(int i, const Fix& fix, double* floor,
+    double* ceiling) const;
+
+  /// Find the airspaces containing the fix.
+  /// \param [out] result Indices of the airspaces in increasing order.
+  void Query(const Fix& fix, QVector<int>* result) const;
+
+  /// Find the airspaces containing each of the fixes.
+  /// Large arrays are split among several threads.
+  /// \param fixes Array of count fixes.
+  /// \param [out] hits The fixes inside the airspaces, ordered by the fix
+  /// and then by the airspace.
+  /// \param threads Maximal number of threads, 0 for one per core.
+  void Query(const Fix* fixes, int count, QVector<Hit>* hits,
+    int threads = 0) const;
+
+  /// Find the airspaces with the point inside the outline, at any height.
+  /// \param [out] result Indices of the airspaces in increasing order.
+  void QueryHorizontally(double lat, double lon, QVector<int>* result) const;
+
+  /// Find the airspaces above or below each of the fixes.
+  /// Same as Query() but the altitudes of the fixes are ignored.
+  void QueryHorizontally(const Fix* fixes, int count, QVector<Hit>* hits,
+    int threads = 0) const;
+
+  /// Find where the containment changes along the segment between two
+  /// fixes. The position, altitudes and ground are interpolated linearly.
+  /// The containment at the end fixes is the one given by Contains(), so
+  /// a change exactly at a fix is reported with t 0 or 1 and the crossings
+  /// of consecutive segments of a track don't repeat.
+  /// \param [out] result The crossings ordered by t.
+  void Crossings(const Fix& from, const Fix& to,
+    QVector<Crossing>* result) const;
+
+ private:
+  typedef Updraft::Util::RTree<2> Tree;
+
+  class QueryTask;
+
+  /// Outline of an airspace divided into latitude bands.
+  struct Outline {
+    /// Range of the closed outline in vertices.
+    qint32 firstVertex;
+    qint32 vertexCount;
+
+    /// Bounding box in latitude and longitude.
+    Tree::Box box;
+
+    /// Latitude of the southern edge of the first band and the number
+    /// of bands per degree.
+    double bandLat;
+    double bandScale;
+
+    /// Range of the bands in bandStart.
+    qint32 firstBand;
+    qint32 bandCount;
+  };
+
+  /// Divide the outlines into bands and build the tree.
+  void BuildIndex();
+
+  /// \return Index of the band of the outline containing the latitude.
+  int Band(const Outline& outline, double lat) const;
+
+  /// \return true if the fix is between the floor and ceiling.
+  /// \param ground Terrain elevation under the fix, NaN if it wasn't
+  /// sampled yet, it is sampled if needed.
+  bool ContainsVertically(int i, const Fix& fix, double* ground) const;
+
+  /// \return Terrain elevation in m.
+  double Ground(double lat, double lon) const;
+
+  /// Find the airspaces containing the fix, or only its position
+  /// if horizontally is true.
+  void QueryFix(const Fix& fix, bool horizontally,
+    QVector<int>* result) const;
+
+  /// Batch query shared by Query() and QueryHorizontally().
+  void QueryBatch(const Fix* fixes, int count, bool horizontally,
+    QVector<Hit>* hits, int threads) const;
+
+  /// Find the airspaces containing the fixes from first to first + count.
+  void QueryRange(const Fix* fixes, int first, int count, bool horizontally,
+    QVector<Hit>* hits) const;
+
+  AirspaceTable table;
+
+  QVector<Limit> floors;
+  QVector<Limit> ceilings;
+
+  QVector<Outline> outlines;
+  QVector<Position> vertices;
+
+  /// Start of each band in bandEdges, one item more than the bands.
+  QVector<qint32> bandStart;
+
+  /// Indices of the first vertices of the edges in the bands.
+  QVector<qint32> bandEdges;
+
+  /// Bounding boxes of the outlines in latitude and longitude.
+  Tree tree;
+
+  /// Index of the airspace of each entry of the tree, airspaces without
+  /// outline are not in the tree.
+  QVector<qint32> treeAirspaces;
+
+  const Updraft::Dem::Sampler* terrain;
+
+  /// Worker threads of the batch queries, kept between the queries.
+  mutable QThreadPool pool;
+};
+}  // OpenAirspace
+
+#endif  // UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACEINDEX_H_
@@ -0,0 +1,565 @@
+#include "airspacetable.h"
+
+#include <string.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include "scanner.h"
+#include "../util/util.h"
+
+namespace OpenAirspace {
+
+/// Smallest part of a file parsed by a separate thread.
+static const qint64 MIN_CHUNK_SIZE = 64 * 1024;
+
+/// Size of the blocks read from a compressed file.
+static const int LOAD_BLOCK_SIZE = 256 * 1024;
+
+/// Return true if the range [begin, end) equals to text.
+static bool Equals(const char* begin, const char* end, const char* text) {
+  int length = strlen(text);
+  return end - begin == length && memcmp(begin, text, length) == 0;
+}
+
+/// Return the range [begin, end) as a string.
+static QString ToString(const char* begin, const char* end) {
+  return QString::fromLocal8Bit(begin, end - begin);
+}
+
+/// Parse count comma separated numbers, the last one takes the rest
+/// of the range. Missing fields and fields that are not numbers are 0.
+static void ParseFields(const char* begin, const char* end,
+  double* fields, int count) {
+  for (int i = 0; i < count; ++i) {
+    const char* comma = begin;
+    while (i < count - 1 && comma < end && *comma != ',')
+      ++comma;
+    if (i == count - 1)
+      comma = end;
+    ParseNumber(begin, comma, &fields[i]);
+    begin = comma < end ? comma + 1 : end;
+  }
+}
+
+/// Return the airspace class given by the text of AC record.
+static Airspace::ACType ParseClass(const char* text, const char* textEnd) {
+  if (Equals(text, textEnd, "R")) return Airspace::R;
+  else if (Equals(text, textEnd, "Q")) return Airspace::Q;
+  else if (Equals(text, textEnd, "P")) return Airspace::P;
+  else if (Equals(text, textEnd, "A")) return Airspace::A;
+  else if (Equals(text, textEnd, "B")) return Airspace::B;
+  else if (Equals(text, textEnd, "C")) return Airspace::C;
+  else if (Equals(text, textEnd, "D")) return Airspace::D;
+  else if (Equals(text, textEnd, "E")) return Airspace::E;
+  else if (Equals(text, textEnd, "GP")) return Airspace::GP;
+  else if (Equals(text, textEnd, "CTR")) return Airspace::CTR;
+  else if (Equals(text, textEnd, "W")) return Airspace::W;
+  else
+    return Airspace::NA;
+}
+
+/// Return the start of the first AC record which starts at or after pos,
+/// or end if there is none.
+static const char* FindAirspaceStart(const char* begin, const char* pos,
+  const char* end) {
+  // Move to the start of the next line
+  if (pos > begin && pos[-1] != '\n') {
+    pos = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    pos = pos ? pos + 1 : end;
+  }
+
+  while (pos < end) {
+    const char* p = pos;
+    while (p < end && (*p == ' ' || *p == '\t'))
+      ++p;
+
+    // The key has to be exactly "AC", see LineScanner
+    if (end - p >= 2 && p[0] == 'A' && p[1] == 'C' &&
+      (end - p == 2 || strchr(" \t\r\v\f\n", p[2])))
+      return pos;
+
+    pos = static_cast<const char*>(memchr(p, '\n', end - p));
+    pos = pos ? pos + 1 : end;
+  }
+  return end;
+}
+
+/// Move the label and airway coordinates of a finished airspace
+/// behind its outline.
+static void FlushCoordinates(AirspaceRecord* record,
+  QVector<Position>* labels, QVector<Position>* airway,
+  QVector<Position>* coordinates) {
+  record->firstLabel = coordinates->size();
+  record->labelCount = labels->size();
+  *coordinates += *labels;
+  labels->resize(0);
+
+  record->firstAirway = coordinates->size();
+  record->airwayCount = airway->size();
+  *coordinates += *airway;
+  airway->resize(0);
+}
+
+/// Part of a file parsed by one thread.
+struct AirspaceTable::Chunk {
+  const char* data;
+  qint64 size;
+
+  /// The parsed airspaces.
+  AirspaceTable table;
+
+  /// The centre set by the last V X= record of the chunk.
+  Position centre;
+  bool centreSet;
+
+  /// Indices of the coordinates in the table, which use the centre
+  /// set before the chunk.
+  QVector<int> unresolved;
+};
+
+/// Parses a single chunk on a worker thread.
+class AirspaceTable::ChunkTask : public QRunnable {
+ public:
+  explicit ChunkTask(Chunk* chunk) : chunk(chunk) {}
+
+  void run() {
+    chunk->table.ParseChunk(chunk);
+  }
+
+ private:
+  Chunk* chunk;
+};
+
+/// Loads a single file on a worker thread.
+class AirspaceTable::FileTask : public QRunnable {
+ public:
+  FileTask(AirspaceTable* table, const QString& fileName, int threads)
+    : table(table), fileName(fileName), threads(threads) {}
+
+  void run() {
+    table->Load(fileName, threads);
+  }
+
+ private:
+  AirspaceTable* table;
+  QString fileName;
+  int threads;
+};
+
+bool AirspaceTable::Load(const QString& fileName, int threads) {
+  Clear();
+  QFile file(fileName);
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    qDebug("OpenAirspace file not found : ");
+    return false;
+  }
+
+  // Compressed files are parsed block by block as they are decompressed.
+  if (Updraft::Util::DecompressingDevice::isCompressed(&file)) {
+    Updraft::Util::DecompressingDevice dev(&file);
+    if (!dev.open(QIODevice::ReadOnly)) {
+      qDebug() << "Couldn't decompress " << fileName << "(" <<
+        dev.errorString() << ")";
+      return false;
+    }
+    return Parse(&dev);
+  }
+
+  if (file.size() > 0) {
+    uchar* mapped = file.map(0, file.size());
+    if (mapped) {
+      Parse(reinterpret_cast<const char*>(mapped), file.size(), threads);
+      file.unmap(mapped);
+      return true;
+    }
+  }
+
+  QByteArray data = file.readAll();
+  Parse(data.constData(), data.size(), threads);
+  return true;
+}
+
+void AirspaceTable::Parse(const char* data, qint64 size, int threads) {
+  Clear();
+  if (threads <= 0)
+    threads = qMax(1, QThread::idealThreadCount());
+  qint64 parts = qMin(size / MIN_CHUNK_SIZE, static_cast<qint64>(threads));
+  int count = qMax(1, static_cast<int>(parts));
+
+  // Split the data at the AC records close to the even parts
+  QVector<Chunk> chunks;
+  const char* begin = data;
+  for (int i = 1; i <= count; ++i) {
+    const char* end = data + size;
+    if (i < count)
+      end = FindAirspaceStart(data, qMax(begin, data + size * i / count),
+        data + size);
+    if (end == begin)
+      continue;
+
+    Chunk chunk;
+    chunk.data = begin;
+    chunk.size = end - begin;
+    chunks.append(chunk);
+    begin = end;
+  }
+
+  if (chunks.size() == 1) {
+    ParseChunk(&chunks[0]);
+  } else {
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int i = 0; i < chunks.size(); ++i)
+      pool.start(new ChunkTask(&chunks[i]));
+    pool.waitForDone();
+  }
+
+  // Merge the chunks in the file order, the arcs and circles before
+  // the first V X= of a chunk use the centre of the previous chunks
+  Position centre;
+  centre.valid = false;
+  centre.lat = centre.lon = 0;
+  for (int i = 0; i < chunks.size(); ++i) {
+    AirspaceTable* target = chunks.size() == 1 ? this : &chunks[i].table;
+    ResolveCentre(chunks[i], target, &centre);
+    if (target != this)
+      Append(*target);
+  }
+
+  if (airspaces.isEmpty())
+    qDebug("Not supported OpenAirspace format.");
+
+  airspaces.squeeze();
+  primitives.squeeze();
+  coordinates.squeeze();
+}
+
+bool AirspaceTable::Parse(QIODevice* device) {
+  Clear();
+
+  Position centre;
+  centre.valid = false;
+  centre.lat = centre.lon = 0;
+
+  QByteArray buffer;
+  forever {
+    int pending = buffer.size();
+    buffer.resize(pending + LOAD_BLOCK_SIZE);
+    qint64 n = device->read(buffer.data() + pending, LOAD_BLOCK_SIZE);
+    if (n < 0) {
+      qDebug() << "Error reading OpenAirspace file (" <<
+        device->errorString() << ")";
+      Clear();
+      return false;
+    }
+    buffer.resize(pending + n);
+
+    const char* data = buffer.constData();
+    const char* end = data + buffer.size();
+
+    // Parse up to the last AC record of the complete lines, the airspace
+    // after it may continue in the next block
+    const char* cut = end;
+    if (n > 0) {
+      const char* linesEnd = end;
+      while (linesEnd > data && linesEnd[-1] != '\n')
+        --linesEnd;
+
+      cut = data;
+      const char* p = data;
+      while (p < linesEnd) {
+        p = FindAirspaceStart(data, p + 1, linesEnd);
+        if (p < linesEnd)
+          cut = p;
+      }
+      if (cut == data)
+        continue;
+    }
+
+    Chunk chunk;
+    chunk.data = data;
+    chunk.size = cut - data;
+    chunk.table.ParseChunk(&chunk);
+    ResolveCentre(chunk, &chunk.table, &centre);
+    Append(chunk.table);
+
+    buffer.remove(0, cut - data);
+    if (n == 0)
+      break;
+  }
+
+  if (airspaces.isEmpty())
+    qDebug("Not supported OpenAirspace format.");
+
+  airspaces.squeeze();
+  primitives.squeeze();
+  coordinates.squeeze();
+  return true;
+}
+
+void AirspaceTable::ResolveCentre(const Chunk& chunk, AirspaceTable* table,
+  Position* centre) {
+  foreach(int index, chunk.unresolved)
+    table->coordinates[index] = *centre;
+  if (chunk.centreSet)
+    *centre = chunk.centre;
+}
+
+QVector<AirspaceTable> AirspaceTable::LoadFiles(
+  const QStringList& fileNames) {
+  QVector<AirspaceTable> tables(fileNames.size());
+
+  // Split the cores among the files
+  int threads = qMax(1, QThread::idealThreadCount() /
+    qMax(1, fileNames.size()));
+
+  QThreadPool pool;
+  for (int i = 0; i < fileNames.size(); ++i)
+    pool.start(new FileTask(&tables[i], fileNames[i], threads));
+  pool.waitForDone();
+
+  return tables;
+}
+
+void AirspaceTable::ParseChunk(Chunk* chunk) {
+  chunk->centreSet = false;
+  chunk->centre.valid = false;
+  chunk->centre.lat = chunk->centre.lon = 0;
+
+  LineScanner scanner(chunk->data, chunk->size);
+
+  bool acOn = false;
+  while (!acOn && scanner.Next())
+    acOn = scanner.KeyIs("AC");
+
+  if (!acOn)
+    return;
+
+  // Record type - terrain & airspace state, reset at every AC
+  bool cw = true;
+  float zoom = -1;
+
+  // Labels and airway of the current airspace, stored after the outline.
+  QVector<Position> labels;
+  QVector<Position> airway;
+
+  do {
+    const char* parse = scanner.Value();
+    const char* parseEnd = scanner.ValueEnd();
+
+    // Start of a new airspace
+    if (scanner.KeyIs("AC")) {
+      if (!airspaces.isEmpty())
+        FlushCoordinates(&airspaces.last(), &labels, &airway, &coordinates);
+
+      // The class is the first word of the AC record
+      const char* textEnd = parse;
+      while (textEnd < parseEnd && *textEnd != ' ' && *textEnd != '\t')
+        ++textEnd;
+
+      AirspaceRecord record;
+      record.type = ParseClass(parse, textEnd);
+      record.className = ToString(parse, textEnd);
+      record.firstPrimitive = primitives.size();
+      record.primitiveCount = 0;
+      record.airwayWidth = -1;
+      record.hasPen = false;
+      record.hasBrush = false;
+      airspaces.append(record);
+
+      cw = true;
+      zoom = -1;
+      continue;
+    }
+
+    AirspaceRecord* record = &airspaces.last();
+
+    // Airspace name, floor and ceiling
+    if (scanner.KeyIs("AN")) {
+      record->name = ToString(parse, parseEnd);
+    } else if (scanner.KeyIs("AL")) {
+      record->floor = ToString(parse, parseEnd);
+    } else if (scanner.KeyIs("AH")) {
+      record->ceiling = ToString(parse, parseEnd);
+
+    // Airspace label coord
+    } else if (scanner.KeyIs("AT")) {
+      labels.append(ParseCoordinate(parse, parseEnd));
+
+    // Terrain polygons
+    } else if (scanner.KeyIs("TO")) {
+      record->terrainOpen = ToString(parse, parseEnd);
+    } else if (scanner.KeyIs("TC")) {
+      record->terrainClosed = ToString(parse, parseEnd);
+
+    // Pen to be used
+    } else if (scanner.KeyIs("SP")) {
+      double fields[5];
+      ParseFields(parse, parseEnd, fields, 5);
+      record->hasPen = true;
+      record->pen.style = static_cast<int>(fields[0]);
+      record->pen.width = static_cast<int>(fields[1]);
+      record->pen.R = static_cast<int>(fields[2]);
+      record->pen.G = static_cast<int>(fields[3]);
+      record->pen.B = static_cast<int>(fields[4]);
+
+    // Brush to be used
+    } else if (scanner.KeyIs("SB")) {
+      double fields[3];
+      ParseFields(parse, parseEnd, fields, 3);
+      record->hasBrush = true;
+      record->brush.R = static_cast<int>(fields[0]);
+      record->brush.G = static_cast<int>(fields[1]);
+      record->brush.B = static_cast<int>(fields[2]);
+
+    // Variable assignment
+    } else if (scanner.KeyIs("V")) {
+      if (parse == parseEnd)
+        continue;
+      char ch = *parse;
+      const char* assigned = static_cast<const char*>(
+        memchr(parse, '=', parseEnd - parse));
+      if (assigned)
+        parse = assigned + 1;
+
+      // center
+      if (ch == 'X') {
+        chunk->centre = ParseCoordinate(parse, parseEnd);
+        chunk->centreSet = true;
+
+      // direction
+      } else if (ch == 'D') {
+        while (parse < parseEnd && (*parse == ' ' || *parse == '\t'))
+          ++parse;
+        cw = parse == parseEnd || *parse != '-';
+
+      // airway width
+      } else if (ch == 'W') {
+        ParseNumber(parse, parseEnd, &record->airwayWidth);
+
+      // visibility zoom lvl
+      } else if (ch == 'Z') {
+        double value;
+        ParseNumber(parse, parseEnd, &value);
+        zoom = value;
+      }
+
+    // Add polygon point, extend the current run if possible
+    } else if (scanner.KeyIs("DP")) {
+      Primitive* last = record->primitiveCount ? &primitives.last() : NULL;
+      if (last && last->type == Primitive::POLYGON && last->zoom == zoom &&
+        last->first + last->count == coordinates.size()) {
+        ++last->count;
+      } else {
+        AddPrimitive(Primitive::POLYGON, cw, zoom);
+      }
+      coordinates.append(ParseCoordinate(parse, parseEnd));
+
+    // Add arc type 1
+    } else if (scanner.KeyIs("DA")) {
+      double fields[3];
+      ParseFields(parse, parseEnd, fields, 3);
+      AddPrimitive(Primitive::ARC_ANGLES, cw, zoom, 1,
+        fields[0], fields[1], fields[2]);
+      AppendCentre(chunk);
+
+    // Add arc type 2
+    } else if (scanner.KeyIs("DB")) {
+      const char* comma = static_cast<const char*>(
+        memchr(parse, ',', parseEnd - parse));
+      AddPrimitive(Primitive::ARC_POINTS, cw, zoom, 3);
+      AppendCentre(chunk);
+      coordinates.append(ParseCoordinate(parse, comma ? comma : parseEnd));
+      coordinates.append(ParseCoordinate(comma ? comma + 1 : parse, parseEnd));
+
+    // Draw circle
+    } else if (scanner.KeyIs("DC")) {
+      double r;
+      ParseNumber(parse, parseEnd, &r);
+      AddPrimitive(Primitive::CIRCLE, cw, zoom, 1, r);
+      AppendCentre(chunk);
+
+    // Add segment of airway
+    } else if (scanner.KeyIs("DY")) {
+      airway.append(ParseCoordinate(parse, parseEnd));
+    }
+  } while (scanner.Next());
+
+  FlushCoordinates(&airspaces.last(), &labels, &airway, &coordinates);
+
+  // Resolve the heights once for all users of the table
+  for (int i = 0; i < airspaces.size(); ++i) {
+    AirspaceRecord* record = &airspaces[i];
+    record->floorFt = Airspace::ParseHeight(record->floor, &record->floorAgl);
+    record->ceilingFt =
+      Airspace::ParseHeight(record->ceiling, &record->ceilingAgl);
+  }
+}
+
+void AirspaceTable::AppendCentre(Chunk* chunk) {
+  if (!chunk->centreSet)
+    chunk->unresolved.append(coordinates.size());
+  coordinates.append(chunk->centre);
+}
+
+void AirspaceTable::Append(const AirspaceTable& other) {
+  int primitiveOffset = primitives.size();
+  int coordinateOffset = coordinates.size();
+
+  airspaces.reserve(airspaces.size() + other.airspaces.size());
+  foreach(AirspaceRecord record, other.airspaces) {
+    record.firstPrimitive += primitiveOffset;
+    record.firstLabel += coordinateOffset;
+    record.firstAirway += coordinateOffset;
+    airspaces.append(record);
+  }
+
+  primitives.reserve(primitives.size() + other.primitives.size());
+  foreach(Primitive primitive, other.primitives) {
+    primitive.first += coordinateOffset;
+    primitives.append(primitive);
+  }
+
+  coordinates += other.coordinates;
+}
+
+void AirspaceTable::Clear() {
+  airspaces.clear();
+  primitives.clear();
+  coordinates.clear();
+}
+
+qint64 AirspaceTable::MemoryUsage() const {
+  qint64 ret = sizeof(*this);
+  ret += airspaces.capacity() * sizeof(AirspaceRecord);
+  ret += primitives.capacity() * sizeof(Primitive);
+  ret += coordinates.capacity() * sizeof(Position);
+  foreach(const AirspaceRecord& record, airspaces) {
+    ret += (record.className.capacity() + record.name.capacity() +
+      record.floor.capacity() + record.ceiling.capacity() +
+      record.terrainOpen.capacity() + record.terrainClosed.capacity()) *
+      sizeof(QChar);
+  }
+  return ret;
+}
+
+void AirspaceTable::AddPrimitive(Primitive::Type type, bool cw, float zoom,
+  int count, double radius, double start, double end) {
+  Primitive p;
+  p.type = type;
+  p.cw = cw;
+  p.first = coordinates.size();
+  p.count = count;
+  p.zoom = zoom;
+  p.radius = radius;
+  p.start = start;
+  p.end = end;
+  primitives.append(p);
+  ++airspaces.last().primitiveCount;
+}
+}  // OpenAirspace
@@ -0,0 +1,197 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACETABLE_H_
+#define UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACETABLE_H_
+
+#include <QIODevice>
+#include <QStringList>
+
+#include "openairspace_global.h"
+#include "airspace.h"
+
+namespace OpenAirspace {
+
+/// One element of an airspace outline in AirspaceTable.
+/// The coordinates are indices into the shared coordinate array
+/// of the table.
+struct OPENAIRSPACE_EXPORT Primitive {
+  /// Primitive types
+  enum Type {
+    /// Run of consecutive DP points.
+    POLYGON,
+
+    /// DA arc given by the radius and the angles.
+    ARC_ANGLES,
+
+    /// DB arc given by the end points.
+    ARC_POINTS,
+
+    /// DC circle.
+    CIRCLE
+  };
+
+  /// Type of the primitive, one of Type.
+  quint8 type;
+
+  /// Arc direction.
+  bool cw;
+
+  /// Index of the first point of a polygon run, or of the centre
+  /// of an arc or circle. ARC_POINTS centre is followed by the start
+  /// and the end point.
+  qint32 first;
+
+  /// Number of coordinates used by the primitive.
+  qint32 count;
+
+  /// Zoom level the element is visible (V Z=), -1 if not set.
+  float zoom;
+
+  /// Radius in nm of ARC_ANGLES and CIRCLE.
+  double radius;
+
+  /// Start and end angles in deg of ARC_ANGLES.
+  double start;
+  double end;
+};
+
+/// One airspace in AirspaceTable.
+struct OPENAIRSPACE_EXPORT AirspaceRecord {
+  /// Airspace class.
+  Airspace::ACType type;
+
+  /// Texts of the AC, AN, AL and AH records.
+  QString className;
+  QString name;
+  QString floor;
+  QString ceiling;
+
+  /// Texts of the TO and TC terrain records.
+  QString terrainOpen;
+  QString terrainClosed;
+
+  /// Floor and ceiling in ft, see Airspace::ParseHeight().
+  int floorFt;
+  int ceilingFt;
+  bool floorAgl;
+  bool ceilingAgl;
+
+  /// Range of the outline primitives.
+  int firstPrimitive;
+  int primitiveCount;
+
+  /// Range of the AT label coordinates.
+  int firstLabel;
+  int labelCount;
+
+  /// Range of the DY airway coordinates.
+  int firstAirway;
+  int airwayCount;
+
+  /// Airway width in nm. -1 for not set.
+  double airwayWidth;
+
+  /// Pen and brush, if set.
+  bool hasPen;
+  bool hasBrush;
+  Airspace::SP_str pen;
+  Airspace::SB_str brush;
+};
+
+/// All airspaces of an OpenAir file in three flat arrays.
+/// The airspaces refer to ranges of outline primitives, the primitives
+/// refer to ranges of one shared array of coordinates. Iterating over
+/// the outlines needs no virtual calls and no pointer chasing, and the
+/// whole file takes a handful of allocations.
+/// Parser builds the Airspace objects of the original API from the table.
+/// Large files are split at the AC records and the parts are parsed
+/// in parallel. Tables don't share any state, so different files can be
+/// parsed at the same time too.
+class OPENAIRSPACE_EXPORT AirspaceTable {
+ public:
+  AirspaceTable() {}
+
+  /// Parse the file, replacing the current contents.
+  /// The file is mapped to memory and scanned in a single pass.
+  /// Compressed files are decompressed in blocks, only the airspace
+  /// crossing the end of a block is kept for the next one.
+  /// \param threads Maximal number of threads parsing parts of the file,
+  /// 0 for one thread per core.
+  /// \return false if the file cannot be read.
+  bool Load(const QString& fileName, int threads = 0);
+
+  /// Parse OpenAir data in memory, replacing the current contents.
+  /// \param threads See Load().
+  void Parse(const char* data, qint64 size, int threads = 0);
+
+  /// Load several files concurrently.
+  /// \return The tables in the order of fileNames. Tables of the files
+  /// which cannot be read are empty.
+  static QVector<AirspaceTable> LoadFiles(const QStringList& fileNames);
+
+  /// Remove all airspaces.
+  void Clear();
+
+  /// \return The number of airspaces.
+  inline int size() const { return airspaces.size(); }
+
+  /// \return The airspace i.
+  inline const AirspaceRecord& GetAirspace(int i) const {
+    return airspaces[i]; }
+
+  /// \return The primitive i.
+  inline const Primitive& GetPrimitive(int i) const {
+    return primitives[i]; }
+
+  /// \return The coordinate i.
+  inline const Position& GetCoordinate(int i) const {
+    return coordinates[i]; }
+
+  /// \return All the primitives of all airspaces.
+  inline const QVector<Primitive>& GetPrimitives() const {
+    return primitives; }
+
+  /// \return All the coordinates of all airspaces.
+  inline const QVector<Position>& GetCoordinates() const {
+    return coordinates; }
+
+  /// \return Approximate number of bytes allocated by the table.
+  qint64 MemoryUsage() const;
+
+ private:
+  friend class AirspaceCache;
+
+  struct Chunk;
+  class ChunkTask;
+  class FileTask;
+
+  /// Parse the data of the chunk into this table.
+  void ParseChunk(Chunk* chunk);
+
+  /// Parse OpenAir data read from the device in blocks, replacing
+  /// the current contents.
+  /// \return false if the device cannot be read.
+  bool Parse(QIODevice* device);
+
+  /// Set the coordinates of the table parsed from the chunk which use
+  /// the centre set before the chunk.
+  /// \param centre The centre set before the chunk, it is updated to
+  /// the centre set at the end of the chunk.
+  static void ResolveCentre(const Chunk& chunk, AirspaceTable* table,
+    Position* centre);
+
+  /// Append the current centre of the chunk to the coordinates.
+  void AppendCentre(Chunk* chunk);
+
+  /// Append the contents of other table.
+  void Append(const AirspaceTable& other);
+
+  /// Append a primitive to the current airspace.
+  void AddPrimitive(Primitive::Type type, bool cw, float zoom,
+    int count = 1, double radius = 0, double start = 0, double end = 0);
+
+  QVector<AirspaceRecord> airspaces;
+  QVector<Primitive> primitives;
+  QVector<Position> coordinates;
+};
+}  // OpenAirspace
+
+#endif  // UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_AIRSPACETABLE_H_
@@ -2,6 +2,7 @@
 #define UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_OPENAIRSPACE_H_
 
 #include "airspace.h"
+#include "airspacetable.h"
 
 namespace OpenAirspace {
 
@@ -9,10 +10,14 @@ namespace OpenAirspace {
   class OPENAIRSPACE_EXPORT Parser {
  public:
     /// OpenAirspace Parser Ctor
-    /// Parses the gven OpenAirspace file
+    /// Parses the gven OpenAirspace file into an AirspaceTable
+    /// and creates the airspace objects from it.
     /// \param fileName The file to be parsed
     explicit Parser(const QString& fileName);
 
+    /// \return The flat representation of the parsed airspaces.
+    inline const AirspaceTable& GetTable() const { return table; }
+
     /// \return Airspace.
     inline Airspace* at(const int i) {
       return this->allAirspaces->at(i);}
@@ -47,6 +52,9 @@ namespace OpenAirspace {
     ~Parser(void);
 
  private:
+    /// The parsed airspaces.
+    AirspaceTable table;
+
     /// OpenAirspace contains several airspaces.
     QVector<Airspace*>* allAirspaces;
   };  // Parser
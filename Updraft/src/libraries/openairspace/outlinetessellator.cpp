@@ -0,0 +1,168 @@
+#include "outlinetessellator.h"
+
+#include <math.h>
+
+#include "../util/util.h"
+
+namespace OpenAirspace {
+
+/// Nautical mile in m.
+static const double NM_TO_M = 1852;
+
+/// Length of a degree of latitude in m, on a sphere of the mean radius.
+static const double DEG_TO_M = 6371000 * M_PI / 180;
+
+/// Smallest outline that is still a polygon, a triangle and
+/// the closing vertex.
+static const int MIN_OUTLINE_SIZE = 4;
+
+/// Append the tessellated locations to the vertices.
+static void AppendLocations(
+  const QVector<Updraft::Util::Location>& locations,
+  QVector<Position>* vertices) {
+  vertices->reserve(vertices->size() + locations.size());
+  foreach(const Updraft::Util::Location& location, locations) {
+    Position position;
+    position.lat = location.lat;
+    position.lon = location.lon;
+    position.valid = true;
+    vertices->push_back(position);
+  }
+}
+
+OutlineTessellator::OutlineTessellator(double tolerance) {
+  wgs84 = new Updraft::Util::Ellipsoid("WGS84",
+    Updraft::Util::ELLIPSOID_WGS84);
+  tessellator = new Updraft::Util::GeodesicTessellator(*wgs84, tolerance);
+}
+
+OutlineTessellator::~OutlineTessellator() {
+  delete tessellator;
+  delete wgs84;
+}
+
+double OutlineTessellator::Tolerance() const {
+  return tessellator->tolerance();
+}
+
+void OutlineTessellator::Tessellate(const AirspaceTable& table,
+  const AirspaceRecord& A, QVector<Position>* vertices) const {
+  if (A.primitiveCount == 0)
+    return;
+
+  int first = vertices->size();
+  for (int j = 0; j < A.primitiveCount; ++j) {
+    const Primitive& p = table.GetPrimitive(A.firstPrimitive + j);
+    const Position* coords = table.GetCoordinates().constData() + p.first;
+
+    if (p.type == Primitive::POLYGON) {
+      for (int k = 0; k < p.count; ++k)
+        vertices->push_back(coords[k]);
+    } else if (p.type == Primitive::ARC_ANGLES) {
+      InsertArcI(p, coords, vertices);
+    } else if (p.type == Primitive::CIRCLE) {
+      InsertCircle(p, coords, vertices);
+    } else if (p.type == Primitive::ARC_POINTS) {
+      InsertArcII(p, coords, vertices);
+    }
+  }
+
+  // close the polygon if open
+  if (vertices->size() == first)
+    return;
+  Position start = vertices->at(first);
+  if (start.lat != vertices->last().lat ||
+    start.lon != vertices->last().lon) {
+    vertices->push_back(start);
+  }
+}
+
+void OutlineTessellator::Simplify(const QVector<Position>& outline,
+  const QVector<double>& tolerances, QVector<QVector<int> >* levels) {
+  levels->resize(tolerances.size());
+  if (outline.size() <= MIN_OUTLINE_SIZE) {
+    for (int l = 0; l < tolerances.size(); ++l) {
+      (*levels)[l].resize(outline.size());
+      for (int k = 0; k < outline.size(); ++k)
+        (*levels)[l][k] = k;
+    }
+    return;
+  }
+
+  // Local equirectangular projection in m, good enough for the size
+  // of an airspace. The outline stays on the ground, so the curvature
+  // of the Earth must not count as a deviation.
+  const Position& origin = outline.first();
+  double scale = cos(origin.lat * M_PI / 180);
+  QVector<double> xyz(3 * outline.size(), 0);
+  for (int k = 0; k < outline.size(); ++k) {
+    xyz[3 * k] = (outline[k].lon - origin.lon) * scale * DEG_TO_M;
+    xyz[3 * k + 1] = (outline[k].lat - origin.lat) * DEG_TO_M;
+  }
+
+  Updraft::Util::PolylineSimplification simplification;
+  simplification.build(xyz.constData(), outline.size());
+
+  for (int l = 0; l < tolerances.size(); ++l) {
+    QVector<int>* kept = &(*levels)[l];
+    simplification.extract(tolerances[l] * tolerances[l], kept);
+    if (kept->size() < MIN_OUTLINE_SIZE)
+      simplification.extractCount(MIN_OUTLINE_SIZE, kept);
+  }
+}
+
+void OutlineTessellator::Tessellate(const AirspaceTable& table,
+  QVector<qint32>* outlineStart, QVector<Position>* vertices) const {
+  outlineStart->clear();
+  vertices->clear();
+  outlineStart->reserve(table.size() + 1);
+  for (int i = 0; i < table.size(); ++i) {
+    outlineStart->push_back(vertices->size());
+    Tessellate(table, table.GetAirspace(i), vertices);
+  }
+  outlineStart->push_back(vertices->size());
+}
+
+void OutlineTessellator::InsertArcI(const Primitive& aa,
+  const Position* coords, QVector<Position>* vertices) const {
+  Updraft::Util::Location centre;
+  centre.lat = coords[0].lat;
+  centre.lon = coords[0].lon;
+
+  QVector<Updraft::Util::Location> arc;
+  tessellator->arc(centre, aa.radius * NM_TO_M, aa.start, aa.end, aa.cw,
+    &arc);
+  AppendLocations(arc, vertices);
+}
+
+void OutlineTessellator::InsertArcII(const Primitive& ab,
+  const Position* coords, QVector<Position>* vertices) const {
+  Updraft::Util::Location centre, start, end;
+  centre.lat = coords[0].lat;
+  centre.lon = coords[0].lon;
+  start.lat = coords[1].lat;
+  start.lon = coords[1].lon;
+  end.lat = coords[2].lat;
+  end.lon = coords[2].lon;
+
+  // compute the radius as mean of two distances (start/end to centre)
+  qreal a1, a2;
+  qreal r = (wgs84->distanceAzimuth(centre, start, &a1)
+    + wgs84->distanceAzimuth(centre, end, &a2)) * 0.5;
+
+  QVector<Updraft::Util::Location> arc;
+  tessellator->arc(centre, r, a1, a2, ab.cw, &arc);
+  AppendLocations(arc, vertices);
+}
+
+void OutlineTessellator::InsertCircle(const Primitive& cc,
+  const Position* coords, QVector<Position>* vertices) const {
+  Updraft::Util::Location centre;
+  centre.lat = coords[0].lat;
+  centre.lon = coords[0].lon;
+
+  QVector<Updraft::Util::Location> circle;
+  tessellator->circle(centre, cc.radius * NM_TO_M, &circle);
+  AppendLocations(circle, vertices);
+}
+}  // OpenAirspace
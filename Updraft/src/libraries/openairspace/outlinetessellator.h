@@ -0,0 +1,80 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_OUTLINETESSELLATOR_H_
+#define UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_OUTLINETESSELLATOR_H_
+
+#include <QVector>
+
+#include "openairspace_global.h"
+#include "airspacetable.h"
+
+namespace Updraft {
+namespace Util {
+  class Ellipsoid;
+  class GeodesicTessellator;
+}
+}
+
+namespace OpenAirspace {
+
+/// Maximal distance of the tessellated arcs from the true curve in m.
+static const double ARC_TOLERANCE = 20.0;
+
+/// Converts the outline primitives of airspaces to closed polygons.
+/// Arcs and circles are geodesic on WGS84, the chords stay within
+/// the tolerance from the true curves.
+/// Coarser levels of detail are simplifications of the tessellated
+/// outline, see Simplify().
+class OPENAIRSPACE_EXPORT OutlineTessellator {
+ public:
+  /// \param tolerance Maximal distance of a chord from the curve in m.
+  explicit OutlineTessellator(double tolerance);
+  ~OutlineTessellator();
+
+  /// \return Maximal distance of a chord from the curve in m.
+  double Tolerance() const;
+
+  /// Append the closed outline of an airspace to the vertices.
+  /// Nothing is appended for airspaces without primitives.
+  void Tessellate(const AirspaceTable& table, const AirspaceRecord& A,
+    QVector<Position>* vertices) const;
+
+  /// Tessellate the outlines of all airspaces of the table.
+  /// \param [out] outlineStart Outline of the airspace i are
+  /// the vertices from outlineStart[i] to outlineStart[i + 1].
+  /// \param [out] vertices The vertices of all outlines.
+  void Tessellate(const AirspaceTable& table, QVector<qint32>* outlineStart,
+    QVector<Position>* vertices) const;
+
+  /// Choose the vertices of a closed outline kept at coarser levels
+  /// of detail (Util::PolylineSimplification). Every level is a subset
+  /// of the outline, so data sampled at its vertices can be reused.
+  /// A vertex is dropped when its triangle with the neighbours is smaller
+  /// than the square of the tolerance, so edges longer than twice the
+  /// tolerance move by less than the tolerance.
+  /// \param outline The closed outline from Tessellate().
+  /// \param tolerances Tolerance in m of each level.
+  /// \param [out] levels Indices into the outline of the vertices kept
+  /// at each level, in the outline order.
+  static void Simplify(const QVector<Position>& outline,
+    const QVector<double>& tolerances, QVector<QVector<int> >* levels);
+
+ private:
+  /// Append the arc given by the radius and the angles.
+  void InsertArcI(const Primitive& aa, const Position* coords,
+    QVector<Position>* vertices) const;
+
+  /// Append the arc given by the end points.
+  void InsertArcII(const Primitive& ab, const Position* coords,
+    QVector<Position>* vertices) const;
+
+  /// Append the circle.
+  void InsertCircle(const Primitive& cc, const Position* coords,
+    QVector<Position>* vertices) const;
+
+  Updraft::Util::Ellipsoid* wgs84;
+  Updraft::Util::GeodesicTessellator* tessellator;
+
+  Q_DISABLE_COPY(OutlineTessellator)
+};
+}  // OpenAirspace
+
+#endif  // UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_OUTLINETESSELLATOR_H_
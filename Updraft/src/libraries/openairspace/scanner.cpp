@@ -0,0 +1,242 @@
+#include "scanner.h"
+
+#include <string.h>
+
+namespace OpenAirspace {
+
+/// Exact powers of ten used to scale the decimal digits.
+static const double POWERS_OF_TEN[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_EXACT_POWER = 22;
+
+static inline bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+/// Multiply value by 10^exponent.
+static double ScaleByPowerOfTen(double value, int exponent) {
+  while (exponent > MAX_EXACT_POWER) {
+    value *= POWERS_OF_TEN[MAX_EXACT_POWER];
+    exponent -= MAX_EXACT_POWER;
+  }
+  while (exponent < -MAX_EXACT_POWER) {
+    value /= POWERS_OF_TEN[MAX_EXACT_POWER];
+    exponent += MAX_EXACT_POWER;
+  }
+  if (exponent >= 0) {
+    return value * POWERS_OF_TEN[exponent];
+  } else {
+    return value / POWERS_OF_TEN[-exponent];
+  }
+}
+
+/// Return the first character from set in the range or NULL.
+static const char* FindAny(const char* begin, const char* end,
+  const char* set) {
+  for (const char* p = begin; p < end; ++p) {
+    if (strchr(set, *p)) {
+      return p;
+    }
+  }
+  return NULL;
+}
+
+/// Parse degrees with parts minutes (and seconds) separated by ':'.
+/// Fields that are not numbers count as 0.
+static double ParseAngle(const char* begin, const char* end, int parts) {
+  double fields[3] = {0, 0, 0};
+  for (int i = 0; i <= parts; ++i) {
+    const char* colon = static_cast<const char*>(
+      memchr(begin, ':', end - begin));
+    const char* fieldEnd = colon ? colon : end;
+    ParseNumber(begin, fieldEnd, &fields[i]);
+    begin = colon ? colon + 1 : end;
+  }
+
+  // Same order of operations as the QString parser.
+  switch (parts) {
+    case 0:
+      return fields[0];
+    case 1:
+      return fields[0] + fields[1] / 60;
+    default:
+      return fields[0] + (fields[1] + fields[2] / 60) / 60;
+  }
+}
+
+LineScanner::LineScanner(const char* data, qint64 size)
+  : pos(data), end(data + size),
+  key(data), keyEnd(data), value(data), valueEnd(data) {
+  // Skip the UTF-8 byte order mark
+  if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+    pos += 3;
+  }
+}
+
+bool LineScanner::Next() {
+  while (pos < end) {
+    const char* lineEnd = static_cast<const char*>(
+      memchr(pos, '\n', end - pos));
+    if (!lineEnd) {
+      lineEnd = end;
+    }
+
+    const char* p = pos;
+    pos = lineEnd < end ? lineEnd + 1 : end;
+
+    while (p < lineEnd && IsSpace(*p)) {
+      ++p;
+    }
+    if (p == lineEnd || *p == '*') {
+      continue;
+    }
+
+    key = p;
+    while (p < lineEnd && !IsSpace(*p)) {
+      ++p;
+    }
+    keyEnd = p;
+
+    while (p < lineEnd && IsSpace(*p)) {
+      ++p;
+    }
+    value = p;
+
+    // Delete end line comment
+    const char* comment = static_cast<const char*>(
+      memchr(value, '*', lineEnd - value));
+    valueEnd = comment ? comment : lineEnd;
+    if (!comment) {
+      // Line end is either "\n" or "\r\n".
+      while (valueEnd > value && valueEnd[-1] == '\r') {
+        --valueEnd;
+      }
+    }
+
+    return true;
+  }
+  return false;
+}
+
+bool LineScanner::KeyIs(const char* k) const {
+  int length = strlen(k);
+  return length == KeyLength() && memcmp(key, k, length) == 0;
+}
+
+bool ParseNumber(const char* begin, const char* end, double* result) {
+  *result = 0;
+
+  while (begin < end && IsSpace(*begin)) {
+    ++begin;
+  }
+  while (end > begin && IsSpace(end[-1])) {
+    --end;
+  }
+
+  const char* p = begin;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  // Collect up to 18 significant digits in an integer.
+  quint64 mantissa = 0;
+  int significant = 0;
+  int exponent = 0;
+  bool digits = false;
+  for (; p < end && IsDigit(*p); ++p) {
+    digits = true;
+    if (significant < 18) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa) {
+        ++significant;
+      }
+    } else {
+      ++exponent;
+    }
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    for (; p < end && IsDigit(*p); ++p) {
+      digits = true;
+      if (significant < 18) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa) {
+          ++significant;
+        }
+        --exponent;
+      }
+    }
+  }
+  if (!digits) {
+    return false;
+  }
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negativeExponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negativeExponent = *p == '-';
+      ++p;
+    }
+    if (p == end || !IsDigit(*p)) {
+      return false;
+    }
+    int e = 0;
+    for (; p < end && IsDigit(*p); ++p) {
+      if (e < 10000) {
+        e = e * 10 + (*p - '0');
+      }
+    }
+    exponent += negativeExponent ? -e : e;
+  }
+
+  if (p != end) {
+    return false;
+  }
+
+  double ret = ScaleByPowerOfTen(static_cast<double>(mantissa), exponent);
+  *result = negative ? -ret : ret;
+  return true;
+}
+
+Position ParseCoordinate(const char* begin, const char* end) {
+  Position cor;
+
+  // Find the deliminators
+  const char* ns = FindAny(begin, end, "NSns");
+  const char* ew = FindAny(begin, end, "EWew");
+  if (!ns || !ew) {
+    qWarning("Error parsing coords in Airspace file: N/S/E/W not found.");
+    cor.valid = false;
+    return cor;
+  }
+
+  int parts = 0;
+  for (const char* p = begin; p < ns; ++p) {
+    if (*p == ':') {
+      ++parts;
+    }
+  }
+  if (parts > 2) {
+    qWarning("Error parsing coordinates in Airspace file: ':' not found.");
+    cor.valid = false;
+    return cor;
+  }
+
+  cor.lat = ParseAngle(begin, ns, parts);
+  if (*ns == 'S' || *ns == 's') cor.lat *= -1;
+  cor.lon = ParseAngle(ns + 1, qMax(ns + 1, ew), parts);
+  if (*ew == 'W' || *ew == 'w') cor.lon *= -1;
+
+  cor.valid = true;
+  return cor;
+}
+}  // OpenAirspace
@@ -0,0 +1,66 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_SCANNER_H_
+#define UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_SCANNER_H_
+
+#include "openairspace_global.h"
+#include "geometry.h"
+
+namespace OpenAirspace {
+
+/// Splits an OpenAir file in memory into records without copying it.
+/// Every record is a single line with a key (AC, AN, DP, ...) followed
+/// by the value. Empty lines and comment lines starting with '*'
+/// are skipped.
+class OPENAIRSPACE_EXPORT LineScanner {
+ public:
+  /// \param data The file contents. It has to outlive the scanner.
+  /// \param size Size of the data in bytes.
+  LineScanner(const char* data, qint64 size);
+
+  /// Move to the next record.
+  /// \return false at the end of the data.
+  bool Next();
+
+  /// \return true if the key of the current record equals to key.
+  bool KeyIs(const char* key) const;
+
+  /// \return The key of the current record.
+  inline const char* Key() const { return key; }
+  inline int KeyLength() const { return keyEnd - key; }
+
+  /// \return The value of the current record.
+  /// It starts after the white space following the key and ends before
+  /// the end of line comment or the line end.
+  inline const char* Value() const { return value; }
+  inline const char* ValueEnd() const { return valueEnd; }
+
+ private:
+  /// Start of the next line.
+  const char* pos;
+  const char* end;
+
+  const char* key;
+  const char* keyEnd;
+  const char* value;
+  const char* valueEnd;
+};
+
+/// Parse a decimal number surrounded by optional white space.
+/// Only the C locale format is accepted, nothing is allocated.
+/// \param begin First character of the number.
+/// \param end Character after the number.
+/// \param [out] result The number, or 0 if the text is not a number.
+/// \return false if the text is not a number.
+OPENAIRSPACE_EXPORT bool ParseNumber(const char* begin, const char* end,
+  double* result);
+
+/// Parse the OpenAir coordinates without allocating anything.
+/// Accepts degrees, degrees:minutes and degrees:minutes:seconds,
+/// e.g. "50:05:30 N 014:25:00 E" or "50.0917N 14.4167E".
+/// \param begin First character of the coordinates.
+/// \param end Character after the coordinates.
+/// \return The coordinates, not valid if they cannot be parsed.
+OPENAIRSPACE_EXPORT Position ParseCoordinate(const char* begin,
+  const char* end);
+}  // OpenAirspace
+
+#endif  // UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_SCANNER_H_
@@ -0,0 +1,852 @@
+#include "testopenairspace.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <qnumeric.h>
+
+#include <QDir>
+#include <QtEndian>
+#include <QFile>
+#include <QSet>
+#include <QtTest>
+#include <QTextStream>
+#include <QVector>
+
+#include "openairspace.h"
+#include "airspacecache.h"
+#include "airspaceindex.h"
+#include "outlinetessellator.h"
+
+namespace OpenAirspace {
+namespace Test {
+
+static const char* CLASSES[] = {"R", "Q", "P", "C", "D", "CTR", "GP", "TMZ"};
+
+/// Format an angle as degrees, degrees:minutes or degrees:minutes:seconds.
+static QByteArray formatAngle(double angle, int parts, int width) {
+  double minutes = (angle - static_cast<int>(angle)) * 60;
+  switch (parts) {
+    case 0:
+      return QByteArray::number(angle, 'f', 5);
+    case 1:
+      return QByteArray::number(static_cast<int>(angle)).
+        rightJustified(width, '0') + ":" +
+        QByteArray::number(minutes, 'f', 3);
+    default:
+      return QByteArray::number(static_cast<int>(angle)).
+        rightJustified(width, '0') + ":" +
+        QByteArray::number(static_cast<int>(minutes)).
+        rightJustified(2, '0') + ":" +
+        QByteArray::number((minutes - static_cast<int>(minutes)) * 60,
+        'f', 1);
+  }
+}
+
+static QByteArray formatCoordinate(double lat, double lon, int parts) {
+  return formatAngle(lat, parts, 2) + " N " + formatAngle(lon, parts, 3) +
+    (parts == 1 ? "E" : " E");
+}
+
+/// Generate an OpenAir file with count airspaces of
+/// pointCount points each. Uses all the supported record types,
+/// coordinate formats and both line ends.
+static QByteArray generateFile(int count, int pointCount) {
+  QByteArray ret("* Synthetic airspaces\n\n");
+
+  for (int i = 0; i < count; ++i) {
+    const char* eol = i % 2 ? "\r\n" : "\n";
+    int parts = i % 3;
+    double lat = 45 + (i % 97) * 0.1;
+    double lon = 5 + (i % 89) * 0.15;
+
+    ret += "AC ";
+    ret += CLASSES[i % 8];
+    ret += eol;
+    ret += "AN Airspace " + QByteArray::number(i) + "  * comment" + eol;
+    ret += (i % 3 ? "AL FL 65" : "AL GND");
+    ret += eol;
+    ret += "AH " + QByteArray::number(1000 + i % 50 * 100) + "ft MSL" + eol;
+    ret += "AT " + formatCoordinate(lat, lon, parts) + eol;
+    ret += "SP 0, 1, " + QByteArray::number(i % 256) + ", 0, 255" + eol;
+    ret += "  * indented comment";
+    ret += eol;
+
+    if (i % 5 == 1) {
+      ret += "V D=-";
+      ret += eol;
+    }
+
+    for (int j = 0; j < pointCount; ++j) {
+      double angle = 2 * M_PI * j / pointCount;
+      ret += "DP " + formatCoordinate(lat + 0.05 * sin(angle),
+        lon + 0.08 * cos(angle), parts) + eol;
+    }
+
+    ret += "V X=" + formatCoordinate(lat, lon, parts) + eol;
+    switch (i % 4) {
+      case 1:
+        ret += "DA 5, 10, " + QByteArray::number(90 + i % 180) + eol;
+        break;
+      case 2:
+        ret += "DB " + formatCoordinate(lat + 0.05, lon, parts) + ", " +
+          formatCoordinate(lat, lon + 0.08, parts) + eol;
+        break;
+      case 3:
+        ret += "DC 3.5";
+        ret += eol;
+        break;
+    }
+    ret += eol;
+  }
+
+  return ret;
+}
+
+static QString writeFile(const QString &name, const QByteArray &data) {
+  QString path = QDir::temp().absoluteFilePath(name);
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    return QString();
+  }
+  file.write(data);
+  return path;
+}
+
+/// Wrap the data in a zip archive with a single stored entry.
+static QByteArray storedZip(const QByteArray &data) {
+  uchar header[30];
+  memset(header, 0, sizeof(header));
+  qToLittleEndian<quint32>(0x04034b50, header);
+  qToLittleEndian<quint16>(10, header + 4);
+  qToLittleEndian<quint32>(data.size(), header + 18);
+  qToLittleEndian<quint32>(data.size(), header + 22);
+  return QByteArray(reinterpret_cast<char*>(header), sizeof(header)) + data;
+}
+
+/// Parse the file token by token from a text stream.
+static QVector<Airspace*> parseStream(const QString &fileName) {
+  QVector<Airspace*> ret;
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return ret;
+  }
+
+  QTextStream ts(&file);
+  QString text;
+  while (text != "AC" && !ts.atEnd()) {
+    ts >> text;
+  }
+
+  bool acOn = true;
+  Position centre = {false, 0, 0};
+  while (!ts.atEnd()) {
+    ret.append(new Airspace(&ts, &acOn, &centre));
+  }
+  return ret;
+}
+
+static bool samePosition(const Position &a, const Position &b) {
+  return a.valid == b.valid &&
+    qAbs(a.lat - b.lat) < 1e-12 && qAbs(a.lon - b.lon) < 1e-12;
+}
+
+static bool sameString(const QString *a, const QString *b) {
+  if (!a || !b) {
+    return a == b;
+  }
+  return *a == *b;
+}
+
+static void compareTables(const AirspaceTable &a, const AirspaceTable &b) {
+  QCOMPARE(a.size(), b.size());
+  for (int i = 0; i < a.size(); ++i) {
+    const AirspaceRecord& ra = a.GetAirspace(i);
+    const AirspaceRecord& rb = b.GetAirspace(i);
+    QCOMPARE(ra.name, rb.name);
+    QCOMPARE(ra.firstPrimitive, rb.firstPrimitive);
+    QCOMPARE(ra.primitiveCount, rb.primitiveCount);
+    QCOMPARE(ra.firstLabel, rb.firstLabel);
+    QCOMPARE(ra.firstAirway, rb.firstAirway);
+    QCOMPARE(ra.ceilingFt, rb.ceilingFt);
+  }
+
+  QCOMPARE(a.GetPrimitives().size(), b.GetPrimitives().size());
+  for (int i = 0; i < a.GetPrimitives().size(); ++i) {
+    QCOMPARE(a.GetPrimitive(i).first, b.GetPrimitive(i).first);
+    QCOMPARE(a.GetPrimitive(i).count, b.GetPrimitive(i).count);
+  }
+
+  QCOMPARE(a.GetCoordinates().size(), b.GetCoordinates().size());
+  for (int i = 0; i < a.GetCoordinates().size(); ++i) {
+    QVERIFY(samePosition(a.GetCoordinate(i), b.GetCoordinate(i)));
+  }
+}
+
+static Fix makeFix(double lat, double lon, double altitude,
+  double pressureAltitude = qQNaN()) {
+  Fix fix = {lat, lon, altitude, pressureAltitude};
+  return fix;
+}
+
+/// Fixes of a long flight wandering over the generated airspaces.
+static QVector<Fix> generateTrack(int count) {
+  QVector<Fix> ret(count);
+  for (int i = 0; i < count; ++i) {
+    ret[i] = makeFix(45 + 9.7 * (0.5 + 0.5 * sin(i * 1e-4)),
+      5 + 13.3 * (0.5 + 0.5 * cos(i * 1.3e-4)),
+      1500 + 1400 * sin(i * 1e-3));
+  }
+  return ret;
+}
+
+/// A square and a circle in it with all kinds of limits.
+static const char INDEX_DATA[] =
+  "AC R\nAN Square\nAL 1000ft MSL\nAH FL 100\n"
+  "DP 50:00:00 N 014:00:00 E\nDP 50:00:00 N 015:00:00 E\n"
+  "DP 49:00:00 N 015:00:00 E\nDP 49:00:00 N 014:00:00 E\n\n"
+  "AC Q\nAN Circle\nAL 500ft AGL\nAH 3000ft MSL\n"
+  "V X=49:30:00 N 014:30:00 E\nDC 5\n";
+
+/// Rough heap usage of the airspace objects, including the allocator
+/// overhead of every new.
+static qint64 objectMemoryUsage(Parser *parser) {
+  const qint64 overhead = 16;
+  qint64 ret = 0;
+  for (size_t i = 0; i < parser->size(); ++i) {
+    const Airspace* a = parser->at(i);
+    ret += sizeof(Airspace) + overhead;
+    for (int j = 0; j < a->GetGeometrySize(); ++j) {
+      const Geometry* g = a->GetGeometry()[j];
+      ret += sizeof(g) + overhead;
+      switch (g->GetGType()) {
+        case Geometry::DAtype: ret += sizeof(ArcI); break;
+        case Geometry::DBtype: ret += sizeof(ArcII); break;
+        case Geometry::DCtype: ret += sizeof(Circle); break;
+        default: ret += sizeof(Polygon); break;
+      }
+    }
+  }
+  return ret;
+}
+
+void TestOpenAirspace::initTestCase() {
+  smallFile = writeFile("updraft_testopenairspace_small.txt",
+    generateFile(40, 6));
+  largeFile = writeFile("updraft_testopenairspace_large.txt",
+    generateFile(5000, 60));
+  QVERIFY(!smallFile.isEmpty());
+  QVERIFY(!largeFile.isEmpty());
+}
+
+void TestOpenAirspace::cleanupTestCase() {
+  QFile::remove(smallFile);
+  QFile::remove(largeFile);
+}
+
+void TestOpenAirspace::testNumber() {
+  const char* valid[] = {"0", " 12.5 ", "-3.25", "0.05", "1e3", "014", ".5"};
+  double expected[] = {0, 12.5, -3.25, 0.05, 1000, 14, 0.5};
+  for (int i = 0; i < 7; ++i) {
+    double result;
+    QVERIFY(ParseNumber(valid[i], valid[i] + strlen(valid[i]), &result));
+    QCOMPARE(result, expected[i]);
+  }
+
+  const char* invalid[] = {"", " ", "abc", "12a", "1.2.3", "-"};
+  for (int i = 0; i < 6; ++i) {
+    double result = 1;
+    QVERIFY(!ParseNumber(invalid[i], invalid[i] + strlen(invalid[i]),
+      &result));
+    QCOMPARE(result, 0.0);
+  }
+}
+
+void TestOpenAirspace::testCoordinate() {
+  const char* texts[] = {
+    "50:05:30 N 014:25:00 E",
+    "50:05.5N 14:25E",
+    "50.0916666666667 n 14.4166666666667 e",
+    "50:05:30 S 014:25:00 W"
+  };
+  for (int i = 0; i < 4; ++i) {
+    Position position = ParseCoordinate(texts[i], texts[i] + strlen(texts[i]));
+    double sign = i == 3 ? -1 : 1;
+    QVERIFY(position.valid);
+    QVERIFY(qAbs(position.lat - sign * (50 + 5.5 / 60)) < 1e-12);
+    QVERIFY(qAbs(position.lon - sign * (14 + 25.0 / 60)) < 1e-12);
+  }
+
+  const char* missing = "50:05:30 014:25:00 E";
+  QVERIFY(!ParseCoordinate(missing, missing + strlen(missing)).valid);
+}
+
+void TestOpenAirspace::testScanner() {
+  const char data[] =
+    "\xEF\xBB\xBF* header\r\n"
+    "AC R\r\n"
+    "AN Name with spaces *comment\r\n"
+    "\r\n"
+    "   DP   50:00:00 N 014:00:00 E\r\n"
+    "AC";
+
+  LineScanner scanner(data, strlen(data));
+  const char* keys[] = {"AC", "AN", "DP", "AC"};
+  const char* values[] = {"R", "Name with spaces ", "50:00:00 N 014:00:00 E",
+    ""};
+  for (int i = 0; i < 4; ++i) {
+    QVERIFY(scanner.Next());
+    QVERIFY(scanner.KeyIs(keys[i]));
+    QCOMPARE(QByteArray(scanner.Value(),
+      scanner.ValueEnd() - scanner.Value()), QByteArray(values[i]));
+  }
+  QVERIFY(!scanner.Next());
+}
+
+void TestOpenAirspace::testSameAirspaces() {
+  QVector<Airspace*> expected = parseStream(smallFile);
+  Parser parser(smallFile);
+
+  QCOMPARE(static_cast<int>(parser.size()), expected.size());
+  QCOMPARE(expected.size(), 40);
+
+  for (int i = 0; i < expected.size(); ++i) {
+    Airspace* a = parser.at(i);
+    Airspace* b = expected[i];
+
+    QCOMPARE(a->GetClass(), b->GetClass());
+    QCOMPARE(a->GetClassName(), b->GetClassName());
+    QVERIFY(sameString(a->GetName(), b->GetName()));
+    QVERIFY(sameString(a->GetFloor(), b->GetFloor()));
+    QVERIFY(sameString(a->GetCeiling(), b->GetCeiling()));
+
+    bool aglA, aglB;
+    QCOMPARE(a->ParseHeight(true, &aglA), b->ParseHeight(true, &aglB));
+    QCOMPARE(a->ParseHeight(false, &aglA), b->ParseHeight(false, &aglB));
+
+    QCOMPARE(a->GetPen()->R, b->GetPen()->R);
+    QCOMPARE(a->GetTagCoor().size(), b->GetTagCoor().size());
+    QVERIFY(samePosition(*a->GetTagCoor()[0], *b->GetTagCoor()[0]));
+
+    QCOMPARE(a->GetGeometrySize(), b->GetGeometrySize());
+    for (int j = 0; j < a->GetGeometrySize(); ++j) {
+      const Geometry* ga = a->GetGeometry()[j];
+      const Geometry* gb = b->GetGeometry()[j];
+      QCOMPARE(ga->GetGType(), gb->GetGType());
+      QVERIFY(samePosition(ga->Centre(), gb->Centre()));
+
+      if (ga->GetGType() == Geometry::DAtype) {
+        const ArcI* aa = static_cast<const ArcI*>(ga);
+        const ArcI* ab = static_cast<const ArcI*>(gb);
+        QCOMPARE(aa->R(), ab->R());
+        QCOMPARE(aa->Start(), ab->Start());
+        QCOMPARE(aa->End(), ab->End());
+        QCOMPARE(aa->CW(), ab->CW());
+      } else if (ga->GetGType() == Geometry::DBtype) {
+        const ArcII* aa = static_cast<const ArcII*>(ga);
+        const ArcII* ab = static_cast<const ArcII*>(gb);
+        QVERIFY(samePosition(aa->Start(), ab->Start()));
+        QVERIFY(samePosition(aa->End(), ab->End()));
+        QCOMPARE(aa->CW(), ab->CW());
+      } else if (ga->GetGType() == Geometry::DCtype) {
+        const Circle* ca = static_cast<const Circle*>(ga);
+        const Circle* cb = static_cast<const Circle*>(gb);
+        QCOMPARE(ca->R(), cb->R());
+      }
+    }
+  }
+
+  qDeleteAll(expected);
+}
+
+void TestOpenAirspace::testTable() {
+  AirspaceTable table;
+  QVERIFY(table.Load(smallFile));
+  QCOMPARE(table.size(), 40);
+
+  Parser parser(smallFile);
+  for (int i = 0; i < table.size(); ++i) {
+    const AirspaceRecord& a = table.GetAirspace(i);
+    QCOMPARE(a.className, QString(CLASSES[i % 8]));
+    QCOMPARE(a.name, QString("Airspace %1  ").arg(i));
+    QCOMPARE(a.floorFt, i % 3 ? 6500 : 0);
+    QCOMPARE(a.ceilingFt, 1000 + i % 50 * 100);
+    QVERIFY(!a.floorAgl);
+    QVERIFY(!a.ceilingAgl);
+    QCOMPARE(a.labelCount, 1);
+    QCOMPARE(a.airwayCount, 0);
+    QVERIFY(a.hasPen);
+    QVERIFY(!a.hasBrush);
+
+    // The points form a single run, followed by the arc or the circle
+    QCOMPARE(a.primitiveCount, i % 4 ? 2 : 1);
+    const Primitive& polygon = table.GetPrimitive(a.firstPrimitive);
+    QCOMPARE(static_cast<int>(polygon.type),
+      static_cast<int>(Primitive::POLYGON));
+    QCOMPARE(polygon.count, 6);
+    QCOMPARE(polygon.cw, i % 5 != 1);
+
+    if (i % 4) {
+      const Primitive& arc = table.GetPrimitive(a.firstPrimitive + 1);
+      static const int types[] = {0, Primitive::ARC_ANGLES,
+        Primitive::ARC_POINTS, Primitive::CIRCLE};
+      QCOMPARE(static_cast<int>(arc.type), types[i % 4]);
+      QCOMPARE(arc.count, i % 4 == 2 ? 3 : 1);
+    }
+
+    // Same geometry as the objects created from the table
+    const Airspace* b = parser.at(i);
+    QCOMPARE(b->GetGeometrySize(), 6 + (i % 4 ? 1 : 0));
+    for (int j = 0; j < polygon.count; ++j) {
+      QVERIFY(samePosition(table.GetCoordinate(polygon.first + j),
+        b->GetGeometry()[j]->Centre()));
+    }
+  }
+
+  Parser large(largeFile);
+  qDebug() << "Table" << large.GetTable().MemoryUsage() << "B, objects" <<
+    objectMemoryUsage(&large) << "B";
+}
+
+void TestOpenAirspace::testParallel() {
+  AirspaceTable sequential;
+  QVERIFY(sequential.Load(largeFile, 1));
+  QCOMPARE(sequential.size(), 5000);
+
+  for (int threads = 2; threads <= 8; threads *= 2) {
+    AirspaceTable parallel;
+    QVERIFY(parallel.Load(largeFile, threads));
+    compareTables(sequential, parallel);
+  }
+
+  // The circles in the later parts use the centre set in the first one
+  QByteArray data("AC R\nV X=50:00:00 N 014:00:00 E\nDC 1\n");
+  for (int i = 0; i < 20000; ++i) {
+    data += "AC Q\nAN Circle " + QByteArray::number(i) + "\nDC 2\n";
+  }
+  AirspaceTable circles;
+  circles.Parse(data.constData(), data.size(), 8);
+  QCOMPARE(circles.size(), 20001);
+  foreach(const Position& centre, circles.GetCoordinates()) {
+    QVERIFY(centre.valid);
+    QCOMPARE(centre.lat, 50.0);
+    QCOMPARE(centre.lon, 14.0);
+  }
+
+  // Files are independent
+  QVector<AirspaceTable> tables =
+    AirspaceTable::LoadFiles(QStringList() << smallFile << largeFile <<
+    QString("nonexistent.txt"));
+  QCOMPARE(tables.size(), 3);
+  QCOMPARE(tables[0].size(), 40);
+  compareTables(sequential, tables[1]);
+  QCOMPARE(tables[2].size(), 0);
+}
+
+/// Checks that a compressed file parsed block by block gives the same
+/// table as the plain file.
+void TestOpenAirspace::testCompressed() {
+  QFile plain(largeFile);
+  QVERIFY(plain.open(QIODevice::ReadOnly));
+  QString zipFile = writeFile("updraft_testopenairspace_large.zip",
+    storedZip(plain.readAll()));
+  QVERIFY(!zipFile.isEmpty());
+
+  AirspaceTable expected;
+  QVERIFY(expected.Load(largeFile, 1));
+  AirspaceTable compressed;
+  QVERIFY(compressed.Load(zipFile));
+  compareTables(expected, compressed);
+
+  // The circles in the later blocks use the centre set in the first one
+  QByteArray data("AC R\nV X=50:00:00 N 014:00:00 E\nDC 1\n");
+  for (int i = 0; i < 20000; ++i) {
+    data += "AC Q\nAN Circle " + QByteArray::number(i) + "\nDC 2\n";
+  }
+  QString circlesFile = writeFile("updraft_testopenairspace_circles.zip",
+    storedZip(data));
+  AirspaceTable circles;
+  QVERIFY(circles.Load(circlesFile));
+  QCOMPARE(circles.size(), 20001);
+  foreach(const Position& centre, circles.GetCoordinates()) {
+    QVERIFY(centre.valid);
+    QCOMPARE(centre.lat, 50.0);
+    QCOMPARE(centre.lon, 14.0);
+  }
+
+  QFile::remove(zipFile);
+  QFile::remove(circlesFile);
+}
+
+void TestOpenAirspace::testCache() {
+  // Outlines are just the coordinates of each airspace
+  CompiledAirspaces compiled;
+  QVERIFY(compiled.table.Load(smallFile));
+  compiled.tolerances.append(20.0);
+  for (int i = 0; i < compiled.table.size(); ++i) {
+    const AirspaceRecord& A = compiled.table.GetAirspace(i);
+    compiled.outlineStart.append(compiled.vertices.size());
+    for (int j = 0; j < A.primitiveCount; ++j) {
+      const Primitive& p = compiled.table.GetPrimitive(A.firstPrimitive + j);
+      for (int k = 0; k < p.count; ++k) {
+        compiled.vertices.append(compiled.table.GetCoordinate(p.first + k));
+        compiled.ground.append(i % 2 ? qQNaN() : 100.0 * k);
+      }
+    }
+  }
+  compiled.outlineStart.append(compiled.vertices.size());
+
+  QDir dir(QDir::temp().absoluteFilePath("updraft_testopenairspace_cache"));
+  AirspaceCache cache(dir);
+  QVERIFY(cache.Store(smallFile, "identity", compiled));
+
+  CompiledAirspaces loaded;
+  QVERIFY(cache.Load(smallFile, "identity", &loaded));
+  compareTables(compiled.table, loaded.table);
+  QCOMPARE(loaded.tolerances, compiled.tolerances);
+  QCOMPARE(loaded.outlineStart, compiled.outlineStart);
+  QCOMPARE(loaded.vertices.size(), compiled.vertices.size());
+  for (int i = 0; i < compiled.vertices.size(); ++i) {
+    QVERIFY(samePosition(loaded.vertices[i], compiled.vertices[i]));
+    QCOMPARE(qIsNaN(loaded.ground[i]), qIsNaN(compiled.ground[i]));
+    if (!qIsNaN(compiled.ground[i]))
+      QCOMPARE(loaded.ground[i], compiled.ground[i]);
+  }
+
+  // Compiled with different elevation data
+  QVERIFY(!cache.Load(smallFile, "other identity", &loaded));
+
+  cache.Remove(smallFile);
+  QVERIFY(!cache.Load(smallFile, "identity", &loaded));
+  dir.rmdir(dir.absolutePath());
+}
+
+void TestOpenAirspace::testLevelsOfDetail() {
+  // The square with a point every 0.1 degree on two sides and the circle
+  QString data = "AC R\nAN Square\nAL GND\nAH FL 100\n";
+  for (int k = 0; k < 10; ++k) {
+    data += QString("DP 50:00:00 N 014:%1:00 E\n").arg(
+      k * 6, 2, 10, QChar('0'));
+  }
+  data += "DP 50:00:00 N 015:00:00 E\n";
+  for (int k = 1; k < 10; ++k) {
+    data += QString("DP 49:%1:00 N 015:00:00 E\n").arg(
+      60 - k * 6, 2, 10, QChar('0'));
+  }
+  data += "DP 49:00:00 N 015:00:00 E\nDP 49:00:00 N 014:00:00 E\n\n";
+  data += "AC Q\nAN Circle\nAL GND\nAH 3000ft MSL\n"
+    "V X=49:30:00 N 014:30:00 E\nDC 5\n";
+  QByteArray bytes = data.toAscii();
+  AirspaceTable table;
+  table.Parse(bytes.constData(), bytes.size());
+  QCOMPARE(table.size(), 2);
+
+  QVector<double> tolerances;
+  tolerances << 50.0 << 500.0;
+
+  QVector<Position> fine;
+  QVector<QVector<int> > levels;
+  OutlineTessellator(20.0).Tessellate(table, table.GetAirspace(0), &fine);
+  OutlineTessellator::Simplify(fine, tolerances, &levels);
+  QCOMPARE(fine.size(), 23);
+  QCOMPARE(levels.size(), 2);
+  QCOMPARE(levels[1], QVector<int>() << 0 << 10 << 20 << 21 << 22);
+
+  // Smaller tolerance gives smoother arcs, simplification
+  // drops vertices of the circle, coarser levels are subsets
+  // of the finer ones
+  QVector<Position> smooth;
+  fine.clear();
+  OutlineTessellator(20.0).Tessellate(table, table.GetAirspace(1), &fine);
+  OutlineTessellator(5.0).Tessellate(table, table.GetAirspace(1), &smooth);
+  OutlineTessellator::Simplify(fine, tolerances, &levels);
+  QVERIFY(smooth.size() > fine.size());
+  QVERIFY(levels[0].size() <= fine.size());
+  QVERIFY(levels[1].size() < levels[0].size());
+  QVERIFY(levels[1].size() >= 5);
+  QCOMPARE(levels[1].first(), 0);
+  QCOMPARE(levels[1].last(), fine.size() - 1);
+  foreach(int k, levels[1])
+    QVERIFY(levels[0].contains(k));
+}
+
+void TestOpenAirspace::testIndex() {
+  AirspaceTable table;
+  table.Parse(INDEX_DATA, strlen(INDEX_DATA));
+  QCOMPARE(table.size(), 2);
+
+  AirspaceIndex index;
+  index.Build(table, 20.0);
+  QCOMPARE(index.size(), 2);
+  QCOMPARE(static_cast<int>(index.GetFloor(0).reference),
+    static_cast<int>(Limit::MSL));
+  QCOMPARE(static_cast<int>(index.GetCeiling(0).reference),
+    static_cast<int>(Limit::FL));
+  QCOMPARE(static_cast<int>(index.GetFloor(1).reference),
+    static_cast<int>(Limit::AGL));
+
+  QVector<int> result;
+  index.Query(makeFix(49.2, 14.2, 1000), &result);
+  QCOMPARE(result, QVector<int>() << 0);
+
+  // Above the circle, in both, below both
+  index.Query(makeFix(49.5, 14.5, 1000), &result);
+  QCOMPARE(result, QVector<int>() << 0);
+  index.Query(makeFix(49.5, 14.5, 500), &result);
+  QCOMPARE(result, QVector<int>() << 0 << 1);
+  index.Query(makeFix(49.5, 14.5, 100), &result);
+  QCOMPARE(result, QVector<int>());
+
+  // Flight levels use the pressure altitude if it is known
+  index.Query(makeFix(49.2, 14.2, 3000, 3100), &result);
+  QCOMPARE(result, QVector<int>());
+  index.Query(makeFix(49.2, 14.2, 3100, 3000), &result);
+  QCOMPARE(result, QVector<int>() << 0);
+  index.Query(makeFix(49.2, 14.2, 3100), &result);
+  QCOMPARE(result, QVector<int>());
+
+  index.Query(makeFix(50.5, 14.5, 1000), &result);
+  QCOMPARE(result, QVector<int>());
+  QVERIFY(!index.ContainsHorizontally(1, 49.4, 14.5));
+  QVERIFY(index.ContainsHorizontally(1, 49.45, 14.5));
+
+  // Airspaces above or below the position
+  index.QueryHorizontally(49.5, 14.5, &result);
+  QCOMPARE(result, QVector<int>() << 0 << 1);
+  index.QueryHorizontally(49.2, 14.2, &result);
+  QCOMPARE(result, QVector<int>() << 0);
+
+  // Limits in the GPS altitude, without terrain the ground is at 0 m
+  double floor;
+  double ceiling;
+  index.LimitAltitudes(0, makeFix(49.2, 14.2, 3000, 2900), &floor, &ceiling);
+  QVERIFY(fabs(floor - 304.8) < 1e-9);
+  QVERIFY(fabs(ceiling - 3148.0) < 1e-9);
+  index.LimitAltitudes(1, makeFix(49.5, 14.5, 3000), &floor, &ceiling);
+  QVERIFY(fabs(floor - 152.4) < 1e-9);
+  QVERIFY(fabs(ceiling - 914.4) < 1e-9);
+
+  // Zero heights are limits, GND and UNL are not
+  const char zero[] =
+    "AC R\nAN Zero\nAL 0ft MSL\nAH 0ft AGL\n"
+    "DP 50:00:00 N 014:00:00 E\nDP 50:00:00 N 015:00:00 E\n"
+    "DP 49:00:00 N 015:00:00 E\n\n"
+    "AC R\nAN Open\nAL GND\nAH UNL\n"
+    "DP 50:00:00 N 014:00:00 E\nDP 50:00:00 N 015:00:00 E\n"
+    "DP 49:00:00 N 015:00:00 E\n";
+  table.Parse(zero, strlen(zero));
+  index.Build(table, 20.0);
+  QCOMPARE(static_cast<int>(index.GetFloor(0).reference),
+    static_cast<int>(Limit::MSL));
+  QCOMPARE(static_cast<int>(index.GetCeiling(0).reference),
+    static_cast<int>(Limit::AGL));
+  QCOMPARE(static_cast<int>(index.GetFloor(1).reference),
+    static_cast<int>(Limit::NONE));
+  QCOMPARE(static_cast<int>(index.GetCeiling(1).reference),
+    static_cast<int>(Limit::NONE));
+  index.Query(makeFix(49.8, 14.8, 100), &result);
+  QCOMPARE(result, QVector<int>() << 1);
+
+  // Heights without a reference are above the mean sea level
+  const char forms[] =
+    "AC D\nAN Plain\nAL 3500 ALT\nAH 4500ft\n\n"
+    "AC D\nAN Metres\nAL 500 M AMSL\nAH 1500m\n\n"
+    "AC D\nAN Ground\nAL SFC\nAH 1000 ft GND\n\n"
+    "AC D\nAN Open\nAL 2000 MSL\nAH UNLTD\n\n"
+    "AC D\nAN Unknown\nAL FOO\nAH UNLIM\n";
+  table.Parse(forms, strlen(forms));
+  index.Build(table, 20.0);
+  QCOMPARE(index.size(), 5);
+
+  int references[][2] = {
+    {Limit::MSL, Limit::MSL}, {Limit::MSL, Limit::MSL},
+    {Limit::NONE, Limit::AGL}, {Limit::MSL, Limit::NONE},
+    {Limit::NONE, Limit::NONE}
+  };
+  double heights[][2] = {
+    {1066.8, 1371.6}, {499.9, 1499.9}, {0, 304.8}, {609.6, 0}, {0, 0}
+  };
+  for (int i = 0; i < 5; ++i) {
+    QCOMPARE(static_cast<int>(index.GetFloor(i).reference),
+      references[i][0]);
+    QCOMPARE(static_cast<int>(index.GetCeiling(i).reference),
+      references[i][1]);
+    QVERIFY(fabs(index.GetFloor(i).height - heights[i][0]) < 0.1);
+    QVERIFY(fabs(index.GetCeiling(i).height - heights[i][1]) < 0.1);
+  }
+}
+
+void TestOpenAirspace::testIndexBatch() {
+  AirspaceTable table;
+  QVERIFY(table.Load(largeFile));
+  AirspaceIndex index;
+  index.Build(table, 20.0);
+
+  // The tree and the bands against testing every airspace
+  QVector<Fix> fixes = generateTrack(20000);
+  QVector<int> result;
+  QVector<int> expected;
+  for (int j = 0; j < fixes.size(); j += 10) {
+    index.Query(fixes[j], &result);
+    expected.clear();
+    for (int i = 0; i < index.size(); ++i) {
+      if (index.Contains(i, fixes[j]))
+        expected.append(i);
+    }
+    QCOMPARE(result, expected);
+  }
+
+  // Batches split among threads give the same hits
+  QVector<Hit> sequential;
+  index.Query(fixes.constData(), fixes.size(), &sequential, 1);
+  QVERIFY(sequential.size() > 0);
+  QVector<Hit> parallel;
+  index.Query(fixes.constData(), fixes.size(), &parallel, 4);
+  QCOMPARE(parallel.size(), sequential.size());
+  for (int k = 0; k < sequential.size(); ++k) {
+    QCOMPARE(parallel[k].fix, sequential[k].fix);
+    QCOMPARE(parallel[k].airspace, sequential[k].airspace);
+  }
+}
+
+void TestOpenAirspace::testIndexCrossings() {
+  AirspaceTable table;
+  table.Parse(INDEX_DATA, strlen(INDEX_DATA));
+  AirspaceIndex index;
+  index.Build(table, 20.0);
+
+  // Through the square and the circle
+  QVector<Crossing> crossings;
+  index.Crossings(makeFix(49.5, 13.5, 500), makeFix(49.5, 15.5, 500),
+    &crossings);
+  QCOMPARE(crossings.size(), 4);
+  QCOMPARE(crossings[0].airspace, 0);
+  QVERIFY(crossings[0].entering);
+  QVERIFY(fabs(crossings[0].t - 0.25) < 1e-9);
+  QCOMPARE(crossings[1].airspace, 1);
+  QVERIFY(crossings[1].entering);
+  QVERIFY(fabs(crossings[1].t - 0.436) < 0.01);
+  QCOMPARE(crossings[2].airspace, 1);
+  QVERIFY(!crossings[2].entering);
+  QVERIFY(fabs(crossings[2].t - 0.564) < 0.01);
+  QCOMPARE(crossings[3].airspace, 0);
+  QVERIFY(!crossings[3].entering);
+  QVERIFY(fabs(crossings[3].t - 0.75) < 1e-9);
+
+  // Climbing through the floor
+  index.Crossings(makeFix(49.2, 14.2, 0), makeFix(49.2, 14.2, 1000),
+    &crossings);
+  QCOMPARE(crossings.size(), 1);
+  QVERIFY(crossings[0].entering);
+  QVERIFY(fabs(crossings[0].t - 0.3048) < 1e-9);
+
+  // Crossings of each segment of a track lead from the airspaces
+  // containing one fix to the airspaces containing the next one
+  AirspaceTable large;
+  QVERIFY(large.Load(largeFile));
+  index.Build(large, 20.0);
+  QVector<Fix> fixes = generateTrack(200000);
+  QVector<int> from;
+  QVector<int> to;
+  for (int j = 0; j + 100 < fixes.size(); j += 100) {
+    index.Query(fixes[j], &from);
+    index.Query(fixes[j + 100], &to);
+    index.Crossings(fixes[j], fixes[j + 100], &crossings);
+
+    QSet<int> inside = QSet<int>::fromList(from.toList());
+    foreach(const Crossing& crossing, crossings) {
+      QVERIFY(crossing.t >= 0 && crossing.t <= 1);
+      QCOMPARE(inside.contains(crossing.airspace), !crossing.entering);
+      if (crossing.entering)
+        inside.insert(crossing.airspace);
+      else
+        inside.remove(crossing.airspace);
+    }
+    QCOMPARE(inside, QSet<int>::fromList(to.toList()));
+  }
+}
+
+void TestOpenAirspace::benchmarkStream() {
+  QBENCHMARK {
+    QVector<Airspace*> airspaces = parseStream(largeFile);
+    QCOMPARE(airspaces.size(), 5000);
+    qDeleteAll(airspaces);
+  }
+}
+
+void TestOpenAirspace::benchmarkScanner() {
+  QBENCHMARK {
+    Parser parser(largeFile);
+    QCOMPARE(static_cast<int>(parser.size()), 5000);
+  }
+}
+
+void TestOpenAirspace::benchmarkSequential() {
+  QBENCHMARK {
+    AirspaceTable table;
+    table.Load(largeFile, 1);
+    QCOMPARE(table.size(), 5000);
+  }
+}
+
+void TestOpenAirspace::benchmarkParallel() {
+  QBENCHMARK {
+    AirspaceTable table;
+    table.Load(largeFile, 0);
+    QCOMPARE(table.size(), 5000);
+  }
+}
+
+void TestOpenAirspace::benchmarkIterateObjects() {
+  Parser parser(largeFile);
+  double sum = 0;
+  QBENCHMARK {
+    for (size_t i = 0; i < parser.size(); ++i) {
+      const Airspace* a = parser.at(i);
+      for (int j = 0; j < a->GetGeometrySize(); ++j) {
+        const Geometry* g = a->GetGeometry()[j];
+        if (g->GetGType() == Geometry::DPtype) {
+          sum += static_cast<const Polygon*>(g)->Centre().lat;
+        }
+      }
+    }
+  }
+  QVERIFY(sum > 0);
+}
+
+void TestOpenAirspace::benchmarkIterateTable() {
+  AirspaceTable table;
+  QVERIFY(table.Load(largeFile));
+  double sum = 0;
+  QBENCHMARK {
+    const Position* coordinates = table.GetCoordinates().constData();
+    for (int i = 0; i < table.GetPrimitives().size(); ++i) {
+      const Primitive& p = table.GetPrimitive(i);
+      if (p.type == Primitive::POLYGON) {
+        for (int j = 0; j < p.count; ++j) {
+          sum += coordinates[p.first + j].lat;
+        }
+      }
+    }
+  }
+  QVERIFY(sum > 0);
+}
+
+void TestOpenAirspace::benchmarkQuery() {
+  AirspaceTable table;
+  QVERIFY(table.Load(largeFile));
+  AirspaceIndex index;
+  index.Build(table, 20.0);
+  QVector<Fix> fixes = generateTrack(300000);
+
+  QVector<Hit> hits;
+  QBENCHMARK {
+    index.Query(fixes.constData(), fixes.size(), &hits);
+  }
+  qDebug() << fixes.size() << "fixes," << hits.size() << "hits";
+}
+
+}  // End namespace Test
+}  // End namespace OpenAirspace
+
+QTEST_MAIN(OpenAirspace::Test::TestOpenAirspace)
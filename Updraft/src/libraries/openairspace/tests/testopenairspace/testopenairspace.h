@@ -0,0 +1,49 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_TESTS_TESTOPENAIRSPACE_TESTOPENAIRSPACE_H_
+#define UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_TESTS_TESTOPENAIRSPACE_TESTOPENAIRSPACE_H_
+
+#include <QObject>
+#include <QString>
+
+namespace OpenAirspace {
+namespace Test {
+
+/// Compare the memory mapped parser with parsing from a text stream.
+class TestOpenAirspace: public QObject {
+  Q_OBJECT
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void testNumber();
+  void testCoordinate();
+  void testScanner();
+  void testSameAirspaces();
+  void testTable();
+  void testParallel();
+  void testCompressed();
+  void testCache();
+  void testLevelsOfDetail();
+  void testIndex();
+  void testIndexBatch();
+  void testIndexCrossings();
+
+  void benchmarkStream();
+  void benchmarkScanner();
+  void benchmarkSequential();
+  void benchmarkParallel();
+  void benchmarkIterateObjects();
+  void benchmarkIterateTable();
+  void benchmarkQuery();
+
+ private:
+  /// Small file with all the record types.
+  QString smallFile;
+
+  /// Europe sized file, 5000 airspaces with 300k points.
+  QString largeFile;
+};
+
+}  // End namespace Test
+}  // End namespace OpenAirspace
+
+#endif  // UPDRAFT_SRC_LIBRARIES_OPENAIRSPACE_TESTS_TESTOPENAIRSPACE_TESTOPENAIRSPACE_H_
@@ -0,0 +1,53 @@
+#include "arena.h"
+
+namespace Updraft {
+namespace Util {
+
+Arena::Arena(size_t blockSize)
+  : current(NULL), remaining(0), blockSize(blockSize), capacity_(0) {
+}
+
+Arena::~Arena() {
+  clear();
+}
+
+void* Arena::allocate(size_t size) {
+  // Round the size up, so that the next allocation stays aligned.
+  size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+  if (size > remaining) {
+    // Oversized requests get their own block. The rest of the current
+    // block is wasted, but that is at most one block per allocation.
+    size_t newSize = qMax(size, blockSize);
+
+    // new[] doesn't guarantee our alignment, so we allocate a little
+    // more and align the start manually.
+    char* block = new char[newSize + ALIGNMENT];
+    blocks.append(block);
+    capacity_ += newSize + ALIGNMENT;
+
+    size_t misalignment = reinterpret_cast<size_t>(block) & (ALIGNMENT - 1);
+    current = block + (misalignment ? ALIGNMENT - misalignment : 0);
+    remaining = newSize;
+  }
+
+  void* ret = current;
+  current += size;
+  remaining -= size;
+
+  return ret;
+}
+
+void Arena::clear() {
+  foreach(char* block, blocks) {
+    delete [] block;
+  }
+  blocks.clear();
+
+  current = NULL;
+  remaining = 0;
+  capacity_ = 0;
+}
+
+}  // End namespace Util
+}  // End namespace Updraft
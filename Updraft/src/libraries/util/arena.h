@@ -0,0 +1,63 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_ARENA_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_ARENA_H_
+
+#include <stddef.h>
+
+#include <QList>
+
+#include "util.h"
+
+namespace Updraft {
+namespace Util {
+
+/// Simple bump allocator.
+/// Memory is taken from large blocks and it is only released all at once
+/// by clear() or by the destructor, individual allocations can't be freed.
+/// This is intended for data that are loaded together and live as long as
+/// their owner (columns of a loaded file, ...).
+/// Only suitable for POD types, no constructors or destructors are called.
+class UTIL_EXPORT Arena {
+ public:
+  /// Alignment of all returned pointers.
+  static const size_t ALIGNMENT = 16;
+
+  /// \param blockSize Minimal size of a block allocated from the system.
+  explicit Arena(size_t blockSize = 64 * 1024);
+  ~Arena();
+
+  /// Allocate size bytes aligned to ALIGNMENT.
+  /// Returned memory is not initialized.
+  void* allocate(size_t size);
+
+  /// Allocate an uninitialized array of count items of type T.
+  template<class T>
+  T* allocateArray(int count) {
+    return static_cast<T*>(allocate(sizeof(T) * count));
+  }
+
+  /// Release all memory allocated from this arena.
+  void clear();
+
+  /// Return the total number of bytes obtained from the system.
+  size_t capacity() const { return capacity_; }
+
+ private:
+  Q_DISABLE_COPY(Arena)
+
+  /// Blocks obtained from the system.
+  QList<char*> blocks;
+
+  /// First free byte of the last block.
+  char* current;
+
+  /// Number of free bytes in the last block.
+  size_t remaining;
+
+  size_t blockSize;
+  size_t capacity_;
+};
+
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_ARENA_H_
@@ -0,0 +1,258 @@
+#include "decompressingdevice.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+namespace Updraft {
+namespace Util {
+
+/// Size of the chunks read from the source device.
+static const int INPUT_CHUNK_SIZE = 64 * 1024;
+
+static const int ZIP_LOCAL_HEADER_SIZE = 30;
+static const quint32 ZIP_LOCAL_HEADER_SIGNATURE = 0x04034b50;
+
+/// General purpose flag of a zip entry whose sizes follow the data.
+static const quint16 ZIP_FLAG_DATA_DESCRIPTOR = 0x0008;
+
+static const quint16 ZIP_METHOD_STORED = 0;
+static const quint16 ZIP_METHOD_DEFLATED = 8;
+
+static bool isGzipSignature(const QByteArray &head) {
+  return head.size() >= 2 &&
+    static_cast<uchar>(head[0]) == 0x1f && static_cast<uchar>(head[1]) == 0x8b;
+}
+
+static bool isZipSignature(const QByteArray &head) {
+  return head.size() >= 4 &&
+    qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(
+      head.constData())) == ZIP_LOCAL_HEADER_SIGNATURE;
+}
+
+DecompressingDevice::DecompressingDevice(QIODevice *source, QObject *parent)
+  : QIODevice(parent), source(source), format(GZIP), stream(NULL),
+  storedRemaining(0), finished(false) {
+}
+
+DecompressingDevice::~DecompressingDevice() {
+  close();
+}
+
+bool DecompressingDevice::isCompressed(QIODevice *source) {
+  QByteArray head = source->peek(4);
+  return isGzipSignature(head) || isZipSignature(head);
+}
+
+QIODevice* DecompressingDevice::openFile(const QString &path) {
+  QFile *file = new QFile(path);
+  if (!file->open(QIODevice::ReadOnly)) {
+    qDebug() << "Couldn't open " << path << ".";
+    delete file;
+    return NULL;
+  }
+
+  if (!isCompressed(file)) {
+    return file;
+  }
+
+  DecompressingDevice *dev = new DecompressingDevice(file);
+  file->setParent(dev);
+  if (!dev->open(QIODevice::ReadOnly)) {
+    qDebug() << "Couldn't decompress " << path << "(" <<
+      dev->errorString() << ")";
+    delete dev;
+    return NULL;
+  }
+
+  return dev;
+}
+
+QStringList DecompressingDevice::suffixes() {
+  return QStringList() << ".gz" << ".zip";
+}
+
+bool DecompressingDevice::open(OpenMode mode) {
+  if (mode & WriteOnly) {
+    setErrorString("Compressed data can only be read.");
+    return false;
+  }
+
+  if (!source->isOpen() && !source->open(QIODevice::ReadOnly)) {
+    setErrorString(source->errorString());
+    return false;
+  }
+
+  QByteArray head = source->peek(4);
+  if (isGzipSignature(head)) {
+    format = GZIP;
+  } else if (isZipSignature(head)) {
+    if (!readZipHeader()) {
+      return false;
+    }
+  } else {
+    setErrorString("Unknown compression format.");
+    return false;
+  }
+
+  input.clear();
+  finished = false;
+
+  if (format != ZIP_STORED) {
+    stream = new z_stream;
+    memset(stream, 0, sizeof(z_stream));
+
+    // Negative window bits select raw deflate data, adding 16 makes zlib
+    // handle the gzip header and trailer.
+    int windowBits = format == GZIP ? MAX_WBITS + 16 : -MAX_WBITS;
+    if (inflateInit2(stream, windowBits) != Z_OK) {
+      setErrorString("Couldn't initialize zlib.");
+      delete stream;
+      stream = NULL;
+      return false;
+    }
+  }
+
+  // Buffered, so that readLine() and getChar() don't run inflate
+  // for every byte. Large reads still go directly to the caller.
+  return QIODevice::open(mode);
+}
+
+void DecompressingDevice::close() {
+  if (stream) {
+    inflateEnd(stream);
+    delete stream;
+    stream = NULL;
+  }
+
+  input.clear();
+  QIODevice::close();
+}
+
+bool DecompressingDevice::atEnd() const {
+  return finished && QIODevice::atEnd();
+}
+
+bool DecompressingDevice::readZipHeader() {
+  QByteArray header = source->read(ZIP_LOCAL_HEADER_SIZE);
+  if (header.size() != ZIP_LOCAL_HEADER_SIZE) {
+    setErrorString("Truncated zip header.");
+    return false;
+  }
+
+  const uchar *p = reinterpret_cast<const uchar*>(header.constData());
+  quint16 flags = qFromLittleEndian<quint16>(p + 6);
+  quint16 method = qFromLittleEndian<quint16>(p + 8);
+  quint32 compressedSize = qFromLittleEndian<quint32>(p + 18);
+  quint16 nameLength = qFromLittleEndian<quint16>(p + 26);
+  quint16 extraLength = qFromLittleEndian<quint16>(p + 28);
+
+  // The file name and the extra field are not needed.
+  qint64 skip = nameLength + extraLength;
+  if (source->read(skip).size() != skip) {
+    setErrorString("Truncated zip header.");
+    return false;
+  }
+
+  if (method == ZIP_METHOD_DEFLATED) {
+    // The deflate stream marks its own end, the sizes are not needed.
+    format = ZIP_DEFLATED;
+    return true;
+  }
+
+  if (method == ZIP_METHOD_STORED && !(flags & ZIP_FLAG_DATA_DESCRIPTOR)) {
+    format = ZIP_STORED;
+    storedRemaining = compressedSize;
+    return true;
+  }
+
+  setErrorString("Unsupported zip compression method.");
+  return false;
+}
+
+bool DecompressingDevice::fillInput() {
+  if (stream->avail_in > 0) {
+    return true;
+  }
+
+  input.resize(INPUT_CHUNK_SIZE);
+  qint64 n = source->read(input.data(), INPUT_CHUNK_SIZE);
+  if (n <= 0) {
+    input.clear();
+    return false;
+  }
+
+  input.resize(n);
+  stream->next_in = reinterpret_cast<Bytef*>(input.data());
+  stream->avail_in = n;
+  return true;
+}
+
+qint64 DecompressingDevice::readData(char *data, qint64 maxSize) {
+  if (finished) {
+    return 0;
+  }
+
+  if (format == ZIP_STORED) {
+    return readStored(data, maxSize);
+  } else {
+    return readDeflated(data, maxSize);
+  }
+}
+
+qint64 DecompressingDevice::readStored(char *data, qint64 maxSize) {
+  qint64 n = source->read(data, qMin(maxSize, storedRemaining));
+  if (n < 0 || (n == 0 && storedRemaining > 0 && maxSize > 0)) {
+    setErrorString("Unexpected end of compressed data.");
+    return -1;
+  }
+
+  storedRemaining -= n;
+  finished = storedRemaining == 0;
+  return n;
+}
+
+qint64 DecompressingDevice::readDeflated(char *data, qint64 maxSize) {
+  // avail_out of zlib is only 32 bit.
+  maxSize = qMin(maxSize, qint64(INPUT_CHUNK_SIZE) * 16);
+
+  stream->next_out = reinterpret_cast<Bytef*>(data);
+  stream->avail_out = maxSize;
+
+  // The source is a file, so we can fill the whole output buffer
+  // without waiting for more data.
+  while (stream->avail_out > 0 && !finished) {
+    if (!fillInput()) {
+      setErrorString("Unexpected end of compressed data.");
+      return -1;
+    }
+
+    int ret = inflate(stream, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END) {
+      // Gzip files may consist of several concatenated members.
+      if (format == GZIP && (stream->avail_in > 0 || !source->atEnd())) {
+        inflateReset(stream);
+      } else {
+        finished = true;
+      }
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      setErrorString(stream->msg ? QString(stream->msg) :
+        QString("Corrupted compressed data."));
+      return -1;
+    }
+  }
+
+  return maxSize - stream->avail_out;
+}
+
+qint64 DecompressingDevice::writeData(const char *data, qint64 maxSize) {
+  Q_UNUSED(data);
+  Q_UNUSED(maxSize);
+  return -1;
+}
+
+}  // End namespace Util
+}  // End namespace Updraft
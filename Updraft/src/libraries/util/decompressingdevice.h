@@ -0,0 +1,92 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_DECOMPRESSINGDEVICE_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_DECOMPRESSINGDEVICE_H_
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+
+#include "util.h"
+
+struct z_stream_s;
+
+namespace Updraft {
+namespace Util {
+
+/// Read-only sequential device that decompresses gzip or zip data
+/// from another device on the fly.
+/// The compressed data are read in chunks of fixed size, so the memory
+/// used doesn't depend on the size of the archive.
+/// Only the first entry of a zip archive is read.
+class UTIL_EXPORT DecompressingDevice : public QIODevice {
+ public:
+  /// \param source Device with the compressed data. It is opened for
+  ///   reading in open() if it isn't open yet. Ownership is not taken.
+  explicit DecompressingDevice(QIODevice *source, QObject *parent = NULL);
+  ~DecompressingDevice();
+
+  /// Return true if the data at the current position of an opened device
+  /// start with gzip or zip signature. Nothing is consumed.
+  static bool isCompressed(QIODevice *source);
+
+  /// Open a file for reading, decompressing it if it is compressed.
+  /// \return Opened device that has to be deleted by the caller,
+  ///   or NULL if the file couldn't be opened.
+  static QIODevice* openFile(const QString &path);
+
+  /// Return file name suffixes of the supported compressed files,
+  /// e.g. ".gz".
+  static QStringList suffixes();
+
+  bool open(OpenMode mode);
+  void close();
+
+  bool isSequential() const { return true; }
+  bool atEnd() const;
+
+ protected:
+  qint64 readData(char *data, qint64 maxSize);
+  qint64 writeData(const char *data, qint64 maxSize);
+
+ private:
+  /// Layout of the compressed data.
+  enum Format {
+    GZIP,
+    ZIP_DEFLATED,
+    ZIP_STORED
+  };
+
+  /// Skip the local header of the first zip entry and find how is the
+  /// entry stored.
+  bool readZipHeader();
+
+  /// Read the next chunk of compressed data, if the previous one was
+  /// completely consumed.
+  /// \return false on error or at the end of the source.
+  bool fillInput();
+
+  /// Copy bytes of a stored zip entry.
+  qint64 readStored(char *data, qint64 maxSize);
+
+  /// Decompress bytes of a deflated stream.
+  qint64 readDeflated(char *data, qint64 maxSize);
+
+  QIODevice *source;
+  Format format;
+
+  z_stream_s *stream;
+  QByteArray input;
+
+  /// Remaining bytes of a stored zip entry.
+  qint64 storedRemaining;
+
+  /// True if the end of the compressed stream was reached.
+  bool finished;
+
+  Q_DISABLE_COPY(DecompressingDevice)
+};
+
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_DECOMPRESSINGDEVICE_H_
@@ -0,0 +1,90 @@
+#include "ecefprojector.h"
+
+#include <qmath.h>
+
+#include <osg/CoordinateSystemNode>
+
+namespace Updraft {
+namespace Util {
+
+/// Number of points processed in one pass of the inner loops.
+/// Temporary arrays of a block fit to the L1 cache.
+static const int BLOCK_SIZE = 256;
+
+EcefProjector::EcefProjector(qreal equatRadius, qreal polarRadius)
+  : equatRadius(equatRadius), polarRadius(polarRadius) {
+  eccentricitySquared = 1.0 -
+    (polarRadius * polarRadius) / (equatRadius * equatRadius);
+}
+
+EcefProjector::EcefProjector(const osg::EllipsoidModel *ellipsoid)
+  : equatRadius(ellipsoid->getRadiusEquator()),
+  polarRadius(ellipsoid->getRadiusPolar()) {
+  eccentricitySquared = 1.0 -
+    (polarRadius * polarRadius) / (equatRadius * equatRadius);
+}
+
+void EcefProjector::project(const double *lat, const double *lon,
+  const double *height, int count, double *xyz, double *ground,
+  int stride) const {
+  double sinLat[BLOCK_SIZE];
+  double cosLat[BLOCK_SIZE];
+  double sinLon[BLOCK_SIZE];
+  double cosLon[BLOCK_SIZE];
+
+  const double toRadians = M_PI / 180.0;
+
+  for (int first = 0; first < count; first += BLOCK_SIZE) {
+    int n = qMin(BLOCK_SIZE, count - first);
+    const double *blockLat = lat + first;
+    const double *blockLon = lon + first;
+    const double *blockHeight = height + first;
+    double *out = xyz + stride * first;
+
+    for (int i = 0; i < n; ++i) {
+      sinLat[i] = sin(blockLat[i] * toRadians);
+      cosLat[i] = cos(blockLat[i] * toRadians);
+    }
+    for (int i = 0; i < n; ++i) {
+      sinLon[i] = sin(blockLon[i] * toRadians);
+      cosLon[i] = cos(blockLon[i] * toRadians);
+    }
+
+    if (ground == NULL) {
+      for (int i = 0; i < n; ++i) {
+        double normal = equatRadius /
+          sqrt(1.0 - eccentricitySquared * sinLat[i] * sinLat[i]);
+        double r = (normal + blockHeight[i]) * cosLat[i];
+        out[stride * i] = r * cosLon[i];
+        out[stride * i + 1] = r * sinLon[i];
+        out[stride * i + 2] =
+          (normal * (1.0 - eccentricitySquared) + blockHeight[i]) * sinLat[i];
+      }
+    } else {
+      double *groundOut = ground + stride * first;
+      for (int i = 0; i < n; ++i) {
+        double normal = equatRadius /
+          sqrt(1.0 - eccentricitySquared * sinLat[i] * sinLat[i]);
+        double r = normal * cosLat[i];
+        double z = normal * (1.0 - eccentricitySquared) * sinLat[i];
+        groundOut[stride * i] = r * cosLon[i];
+        groundOut[stride * i + 1] = r * sinLon[i];
+        groundOut[stride * i + 2] = z;
+
+        r += blockHeight[i] * cosLat[i];
+        out[stride * i] = r * cosLon[i];
+        out[stride * i + 1] = r * sinLon[i];
+        out[stride * i + 2] = z + blockHeight[i] * sinLat[i];
+      }
+    }
+  }
+}
+
+QString EcefProjector::name() const {
+  return QString("ecef %1 %2")
+    .arg(equatRadius, 0, 'g', 17)
+    .arg(polarRadius, 0, 'g', 17);
+}
+
+}  // End namespace Util
+}  // End namespace Updraft
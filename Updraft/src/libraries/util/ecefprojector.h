@@ -0,0 +1,57 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_ECEFPROJECTOR_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_ECEFPROJECTOR_H_
+
+#include <QString>
+
+#include "util.h"
+
+namespace osg {
+  class EllipsoidModel;
+}
+
+namespace Updraft {
+namespace Util {
+
+/// Converts whole arrays of geodetic coordinates to earth centered,
+/// earth fixed cartesian coordinates.
+/// Gives the same results as osg::EllipsoidModel::convertLatLongHeightToXYZ,
+/// but the trigonometric functions are evaluated in tight loops over
+/// blocks of points, separately from the rest of the arithmetic, so that
+/// the compiler can vectorize them.
+class UTIL_EXPORT EcefProjector {
+ public:
+  EcefProjector(qreal equatRadius, qreal polarRadius);
+  explicit EcefProjector(const osg::EllipsoidModel *ellipsoid);
+
+  /// Project count points.
+  /// \param lat Latitudes in degrees.
+  /// \param lon Longitudes in degrees.
+  /// \param height Heights above the ellipsoid in meters.
+  /// \param count Number of the points.
+  /// \param [out] xyz Three coordinates for every point.
+  /// \param [out] ground If not NULL, three coordinates for every point
+  ///   moved to height 0. They share the computation with xyz, so this
+  ///   is much cheaper than a second projection.
+  /// \param stride Distance between the first coordinates of two
+  ///   consecutive points in xyz and ground, at least 3. Allows writing
+  ///   both outputs interleaved to a single array.
+  void project(const double *lat, const double *lon, const double *height,
+    int count, double *xyz, double *ground = NULL, int stride = 3) const;
+
+  /// Return identification of the ellipsoid for caches of projected
+  /// coordinates.
+  /// Coordinates projected with equally named projectors are equal.
+  QString name() const;
+
+ private:
+  qreal equatRadius;
+  qreal polarRadius;
+
+  /// Square of the first eccentricity.
+  qreal eccentricitySquared;
+};
+
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_ECEFPROJECTOR_H_
@@ -1,10 +1,195 @@
 #include <osg/CoordinateSystemNode>
+#include <QVector>
 #include "GeographicLib/Geodesic.hpp"
 #include "ellipsoid.h"
 
 namespace Updraft {
 namespace Util {
 
+/// Coordinates of an array of points prepared for the batch distance
+/// kernel.
+/// Kept as separate arrays so that the loops over them are plain
+/// arithmetic on contiguous data that the compiler can vectorize,
+/// and so that the trigonometric functions of each point are only
+/// evaluated once however many distances it takes part in.
+/// Sines and cosines of half angles are kept, the half sums and
+/// differences of the formulas are then expanded with the angle addition
+/// identities. Unlike 1 - cos, these stay accurate for short legs.
+struct PreparedPoints {
+  PreparedPoints(const Location *points, int count)
+    : sinHalfLat(count), cosHalfLat(count),
+    sinHalfLon(count), cosHalfLon(count),
+    sinLat(count), cosLat(count) {
+    for (int i = 0; i < count; ++i) {
+      qreal halfLat = points[i].lat_radians() / 2;
+      qreal halfLon = points[i].lon_radians() / 2;
+      sinHalfLat[i] = qSin(halfLat);
+      cosHalfLat[i] = qCos(halfLat);
+      sinHalfLon[i] = qSin(halfLon);
+      cosHalfLon[i] = qCos(halfLon);
+    }
+    for (int i = 0; i < count; ++i) {
+      sinLat[i] = 2 * sinHalfLat[i] * cosHalfLat[i];
+      cosLat[i] = cosHalfLat[i] * cosHalfLat[i] -
+        sinHalfLat[i] * sinHalfLat[i];
+    }
+  }
+
+  QVector<qreal> sinHalfLat;
+  QVector<qreal> cosHalfLat;
+  QVector<qreal> sinHalfLon;
+  QVector<qreal> cosHalfLon;
+  QVector<qreal> sinLat;
+  QVector<qreal> cosLat;
+};
+
+/// Count distances between count pairs of points with one of the
+/// approximate methods.
+/// Pair i is a[aFirst + i * aStride] and b[bFirst + i], so aStride 0
+/// measures from a single point and aStride 1 pairs the arrays
+/// element-wise.
+/// Indices of pairs that the method can't handle (nearly antipodal
+/// points) are appended to fallback and their distances are left unset.
+static void approximateDistances(
+  const PreparedPoints &a, int aFirst, int aStride,
+  const PreparedPoints &b, int bFirst, int count,
+  qreal equatRadius, qreal flattening, DistanceMethod method,
+  qreal *distances, qreal *azimuths, QVector<int> *fallback) {
+  const qreal *sinHalfLat1 = a.sinHalfLat.constData() + aFirst;
+  const qreal *cosHalfLat1 = a.cosHalfLat.constData() + aFirst;
+  const qreal *sinHalfLon1 = a.sinHalfLon.constData() + aFirst;
+  const qreal *cosHalfLon1 = a.cosHalfLon.constData() + aFirst;
+  const qreal *sin1 = a.sinLat.constData() + aFirst;
+  const qreal *cos1 = a.cosLat.constData() + aFirst;
+  const qreal *sinHalfLat2 = b.sinHalfLat.constData() + bFirst;
+  const qreal *cosHalfLat2 = b.cosHalfLat.constData() + bFirst;
+  const qreal *sinHalfLon2 = b.sinHalfLon.constData() + bFirst;
+  const qreal *cosHalfLon2 = b.cosHalfLon.constData() + bFirst;
+  const qreal *sin2 = b.sinLat.constData() + bFirst;
+  const qreal *cos2 = b.cosLat.constData() + bFirst;
+
+  if (method == DISTANCE_SPHERICAL) {
+    // Haversine formula on a sphere with the mean radius.
+    qreal radius = equatRadius * (3.0 - flattening) / 3.0;
+    for (int i = 0; i < count; ++i) {
+      int j = i * aStride;
+      qreal sinG = sinHalfLat1[j] * cosHalfLat2[i] -
+        cosHalfLat1[j] * sinHalfLat2[i];
+      qreal sinL = sinHalfLon1[j] * cosHalfLon2[i] -
+        cosHalfLon1[j] * sinHalfLon2[i];
+      qreal h = sinG * sinG + cos1[j] * cos2[i] * sinL * sinL;
+      distances[i] = 2 * radius * qAsin(qSqrt(qMin(h, qreal(1.0))));
+    }
+  } else {
+    // Andoyer-Lambert formula, as given by J. Meeus, Astronomical
+    // Algorithms, chapter 11.
+    // F, G and L are the half sum and half difference of latitudes
+    // and the half difference of longitudes.
+    for (int i = 0; i < count; ++i) {
+      int j = i * aStride;
+      qreal sinF = sinHalfLat1[j] * cosHalfLat2[i] +
+        cosHalfLat1[j] * sinHalfLat2[i];
+      qreal cosF = cosHalfLat1[j] * cosHalfLat2[i] -
+        sinHalfLat1[j] * sinHalfLat2[i];
+      qreal sinG = sinHalfLat1[j] * cosHalfLat2[i] -
+        cosHalfLat1[j] * sinHalfLat2[i];
+      qreal cosG = cosHalfLat1[j] * cosHalfLat2[i] +
+        sinHalfLat1[j] * sinHalfLat2[i];
+      qreal sinL = sinHalfLon1[j] * cosHalfLon2[i] -
+        cosHalfLon1[j] * sinHalfLon2[i];
+      qreal cosL = cosHalfLon1[j] * cosHalfLon2[i] +
+        sinHalfLon1[j] * sinHalfLon2[i];
+      qreal sinF2 = sinF * sinF, cosF2 = cosF * cosF;
+      qreal sinG2 = sinG * sinG, cosG2 = cosG * cosG;
+      qreal sinL2 = sinL * sinL, cosL2 = cosL * cosL;
+
+      qreal s = sinG2 * cosL2 + cosF2 * sinL2;
+      qreal c = cosG2 * cosL2 + sinF2 * sinL2;
+
+      if (s < 1e-24) {
+        distances[i] = 0;
+        continue;
+      }
+      if (c < 1e-12) {
+        fallback->append(i);
+        continue;
+      }
+
+      qreal omega = qAtan(qSqrt(s / c));
+      qreal r = qSqrt(s * c) / omega;
+      qreal h1 = (3 * r - 1) / (2 * c);
+      qreal h2 = (3 * r + 1) / (2 * s);
+
+      distances[i] = 2 * omega * equatRadius *
+        (1 + flattening * (h1 * sinF2 * cosG2 - h2 * cosF2 * sinG2));
+    }
+  }
+
+  if (azimuths == NULL) {
+    return;
+  }
+
+  // Initial bearing of the great circle.
+  for (int i = 0; i < count; ++i) {
+    int j = i * aStride;
+    // Double angle of the half difference of longitudes.
+    qreal sinL = sinHalfLon2[i] * cosHalfLon1[j] -
+      cosHalfLon2[i] * sinHalfLon1[j];
+    qreal cosL = cosHalfLon2[i] * cosHalfLon1[j] +
+      sinHalfLon2[i] * sinHalfLon1[j];
+    qreal sinDLon = 2 * sinL * cosL;
+    qreal cosDLon = cosL * cosL - sinL * sinL;
+    qreal y = sinDLon * cos2[i];
+    qreal x = cos1[j] * sin2[i] - sin1[j] * cos2[i] * cosDLon;
+    qreal azimuth = qAtan2(y, x) * 180.0 / M_PI;
+    azimuths[i] = azimuth < 0.0 ? azimuth + 360.0 : azimuth;
+  }
+}
+
+/// Count distances between count pairs of points using GeographicLib.
+/// Pairs are formed the same way as in approximateDistances().
+static void exactDistances(const GeographicLib::Geodesic *geodesic,
+  const Location *a, int aStride, const Location *b, int count,
+  qreal *distances, qreal *azimuths) {
+  for (int i = 0; i < count; ++i) {
+    const Location &l1 = a[i * aStride];
+    const Location &l2 = b[i];
+    GeographicLib::Math::real s12, azi1, azi2;
+    geodesic->Inverse(l1.lat, l1.lon, l2.lat, l2.lon, s12, azi1, azi2);
+
+    distances[i] = s12;
+    if (azimuths != NULL) {
+      azimuths[i] = azi1 < 0.0 ? azi1 + 360.0 : azi1;
+    }
+  }
+}
+
+/// Count distances of prepared points, falling back to the exact method
+/// where the approximation fails.
+/// aPoints and bPoints are the original points of the pairs, indexed
+/// the same way as a and b in exactDistances().
+static void batchDistances(const GeographicLib::Geodesic *geodesic,
+  qreal equatRadius, qreal flattening, DistanceMethod method,
+  const PreparedPoints &a, int aFirst, int aStride,
+  const PreparedPoints &b, int bFirst, int count,
+  const Location *aPoints, const Location *bPoints,
+  qreal *distances, qreal *azimuths) {
+  // Exact method is only sent here for a sphere. The Andoyer-Lambert
+  // correction vanishes there and the result is exact as well.
+  if (method == DISTANCE_EXACT) {
+    method = DISTANCE_ANDOYER_LAMBERT;
+  }
+
+  QVector<int> fallback;
+  approximateDistances(a, aFirst, aStride, b, bFirst, count,
+    equatRadius, flattening, method, distances, azimuths, &fallback);
+
+  foreach(int i, fallback) {
+    exactDistances(geodesic, aPoints + i * aStride, 0, bPoints + i, 1,
+      distances + i, NULL);
+  }
+}
+
 Ellipsoid::Ellipsoid(const QString& name_, EllipsoidType type_)
   : type(type_), name(name_) {
   switch (type_) {
@@ -105,5 +290,66 @@ qreal Ellipsoid::distanceAzimuth(const Location &l1, const Location &l2,
   return (qreal)s12;
 }
 
+void Ellipsoid::legDistances(const Location *points, int count,
+  qreal *distances, qreal *azimuths, DistanceMethod method) const {
+  if (count < 2) {
+    return;
+  }
+
+  if (method == DISTANCE_EXACT && flattening != 0.0) {
+    exactDistances(geodesic, points, 1, points + 1, count - 1,
+      distances, azimuths);
+    return;
+  }
+
+  PreparedPoints prepared(points, count);
+  batchDistances(geodesic, equatRadius, flattening, method,
+    prepared, 0, 1, prepared, 1, count - 1,
+    points, points + 1, distances, azimuths);
+}
+
+void Ellipsoid::distancesFrom(const Location &from, const Location *points,
+  int count, qreal *distances, qreal *azimuths,
+  DistanceMethod method) const {
+  if (count < 1) {
+    return;
+  }
+
+  if (method == DISTANCE_EXACT && flattening != 0.0) {
+    exactDistances(geodesic, &from, 0, points, count, distances, azimuths);
+    return;
+  }
+
+  PreparedPoints preparedFrom(&from, 1);
+  PreparedPoints prepared(points, count);
+  batchDistances(geodesic, equatRadius, flattening, method,
+    preparedFrom, 0, 0, prepared, 0, count,
+    &from, points, distances, azimuths);
+}
+
+void Ellipsoid::distanceMatrix(const Location *rows, int rowCount,
+  const Location *columns, int columnCount, qreal *distances,
+  DistanceMethod method) const {
+  if (rowCount < 1 || columnCount < 1) {
+    return;
+  }
+
+  if (method == DISTANCE_EXACT && flattening != 0.0) {
+    for (int i = 0; i < rowCount; ++i) {
+      exactDistances(geodesic, rows + i, 0, columns, columnCount,
+        distances + i * columnCount, NULL);
+    }
+    return;
+  }
+
+  PreparedPoints preparedRows(rows, rowCount);
+  PreparedPoints preparedColumns(columns, columnCount);
+  for (int i = 0; i < rowCount; ++i) {
+    batchDistances(geodesic, equatRadius, flattening, method,
+      preparedRows, i, 0, preparedColumns, 0, columnCount,
+      rows + i, columns, distances + i * columnCount, NULL);
+  }
+}
+
 }  // End namespace Util
 }  // End namespace Updraft
@@ -19,6 +19,22 @@ enum EllipsoidType {
   ELLIPSOID_FAI_SPHERE
 };
 
+/// Method used by the batch distance functions of Ellipsoid.
+/// On a sphere (FAI sphere) all of them give the exact result.
+enum DistanceMethod {
+  /// Geodesic computed by GeographicLib, accurate to nanometers.
+  DISTANCE_EXACT,
+
+  /// Andoyer-Lambert first order flattening correction of the spherical
+  /// distance. The error is in the order of f^2 of the distance (below
+  /// 0.01 %), azimuths are spherical.
+  DISTANCE_ANDOYER_LAMBERT,
+
+  /// Great circle on a sphere with the mean radius of the ellipsoid.
+  /// The error is up to 0.5 % on WGS84.
+  DISTANCE_SPHERICAL
+};
+
 class Location;
 
 /// Ellipsoid model of Earth
@@ -68,6 +84,40 @@ class UTIL_EXPORT Ellipsoid {
   qreal distanceAzimuth(const Location &l1, const Location &l2,
     qreal *azimuth) const;
 
+  /// Count distances of consecutive points of a path.
+  /// \param points Array of count points.
+  /// \param count Number of the points.
+  /// \param [out] distances Array of count - 1 distances in meters,
+  ///   distances[i] is between points[i] and points[i + 1].
+  /// \param [out] azimuths If not NULL, array of count - 1 azimuths
+  ///   at the first point of each leg, in degrees from north, 0 to 360.
+  /// \param method Accuracy of the computation.
+  void legDistances(const Location *points, int count, qreal *distances,
+    qreal *azimuths = NULL, DistanceMethod method = DISTANCE_EXACT) const;
+
+  /// Count distances from a single point to many points.
+  /// \param from The common first point.
+  /// \param points Array of count points.
+  /// \param count Number of the points.
+  /// \param [out] distances Array of count distances in meters.
+  /// \param [out] azimuths If not NULL, array of count azimuths at from.
+  /// \param method Accuracy of the computation.
+  void distancesFrom(const Location &from, const Location *points, int count,
+    qreal *distances, qreal *azimuths = NULL,
+    DistanceMethod method = DISTANCE_EXACT) const;
+
+  /// Count distances between all pairs of points from two sets.
+  /// \param rows Array of rowCount points.
+  /// \param rowCount Number of the row points.
+  /// \param columns Array of columnCount points.
+  /// \param columnCount Number of the column points.
+  /// \param [out] distances Row major matrix of rowCount * columnCount
+  ///   distances in meters.
+  /// \param method Accuracy of the computation.
+  void distanceMatrix(const Location *rows, int rowCount,
+    const Location *columns, int columnCount, qreal *distances,
+    DistanceMethod method = DISTANCE_EXACT) const;
+
   /// Counts flattening from equatorial radius and polar radius.
   /// \param rE equatorial radius
   /// \param rP polar radius
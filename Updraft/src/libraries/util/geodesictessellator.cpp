@@ -0,0 +1,113 @@
+#include "geodesictessellator.h"
+
+#include <qmath.h>
+
+#include "GeographicLib/Geodesic.hpp"
+#include "GeographicLib/GeodesicLine.hpp"
+#include "ellipsoid.h"
+#include "location.h"
+
+namespace Updraft {
+namespace Util {
+
+/// Segments of a full circle are never fewer than this, so that even
+/// the smallest circles don't degenerate into triangles.
+static const int MIN_CIRCLE_SEGMENTS = 12;
+
+GeodesicTessellator::GeodesicTessellator(const Ellipsoid &ellipsoid,
+  qreal tolerance)
+  : geodesic(new GeographicLib::Geodesic(ellipsoid.getEquatRadius(),
+    ellipsoid.getFlattening())),
+  tolerance_(tolerance) {
+}
+
+GeodesicTessellator::~GeodesicTessellator() {
+  delete geodesic;
+}
+
+int GeodesicTessellator::segmentCount(qreal radius, qreal sweep) const {
+  qreal sweepRadians = qAbs(sweep) * M_PI / 180.0;
+  int minimum = qMax(1, qCeil(MIN_CIRCLE_SEGMENTS * qAbs(sweep) / 360.0));
+  if (radius <= tolerance_) {
+    return minimum;
+  }
+
+  // Sagitta of a chord spanning angle a is r * (1 - cos(a / 2)).
+  qreal maxAngle = 2 * qAcos(1.0 - tolerance_ / radius);
+  return qMax(minimum, qCeil(sweepRadians / maxAngle));
+}
+
+void GeodesicTessellator::circle(const Location &centre, qreal radius,
+  QVector<Location> *result) const {
+  int first = result->count();
+  arc(centre, radius, 0, 360, true, result);
+
+  // Close the loop exactly, regardless of the rounding.
+  result->last() = result->at(first);
+}
+
+void GeodesicTessellator::arc(const Location &centre, qreal radius,
+  qreal from, qreal to, bool clockwise, QVector<Location> *result) const {
+  // Sweep of the arc in the direction of increasing azimuth.
+  qreal sweep = clockwise ? to - from : from - to;
+  while (sweep <= 0) {
+    sweep += 360;
+  }
+  while (sweep > 360) {
+    sweep -= 360;
+  }
+
+  int segments = segmentCount(radius, sweep);
+  qreal step = (clockwise ? sweep : -sweep) / segments;
+
+  result->reserve(result->count() + segments + 1);
+  for (int i = 0; i <= segments; ++i) {
+    // Each vertex lies on a different geodesic from the centre, only
+    // the position is computed.
+    GeographicLib::Math::real lat, lon;
+    geodesic->Direct(centre.lat, centre.lon, from + i * step, radius,
+      lat, lon);
+
+    Location vertex;
+    vertex.lat = lat;
+    vertex.lon = lon;
+    result->append(vertex);
+  }
+}
+
+void GeodesicTessellator::line(const Location &from, const Location &to,
+  qreal maxLength, QVector<Location> *result) const {
+  GeographicLib::Math::real length, azimuth, azimuth2;
+  geodesic->Inverse(from.lat, from.lon, to.lat, to.lon,
+    length, azimuth, azimuth2);
+
+  int segments = qMax(1, qCeil(length / maxLength));
+  result->reserve(result->count() + segments + 1);
+
+  Location first = from;
+  first.alt = 0;
+  result->append(first);
+
+  if (segments > 1) {
+    GeographicLib::GeodesicLine geodesicLine = geodesic->Line(
+      from.lat, from.lon, azimuth,
+      GeographicLib::Geodesic::LATITUDE | GeographicLib::Geodesic::LONGITUDE);
+
+    for (int i = 1; i < segments; ++i) {
+      GeographicLib::Math::real lat, lon;
+      geodesicLine.Position(length * i / segments, lat, lon);
+
+      Location vertex;
+      vertex.lat = lat;
+      vertex.lon = lon;
+      result->append(vertex);
+    }
+  }
+
+  Location last = to;
+  last.alt = 0;
+  result->append(last);
+}
+
+}  // End namespace Util
+}  // End namespace Updraft
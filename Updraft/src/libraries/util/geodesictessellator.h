@@ -0,0 +1,78 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_GEODESICTESSELLATOR_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_GEODESICTESSELLATOR_H_
+
+#include <QVector>
+
+#include "util.h"
+
+namespace GeographicLib {
+  class Geodesic;
+}
+
+namespace Updraft {
+namespace Util {
+
+class Ellipsoid;
+class Location;
+
+/// Generates vertices of geodesic circles, arcs and lines.
+/// Circles are the loci of points at a given geodesic distance from
+/// the centre, so they are correct on the ellipsoid at any size.
+/// The number of vertices adapts to the size of the shape: segments
+/// are as long as possible while the chords stay within the tolerance
+/// from the true curve.
+/// Altitude of the generated locations is 0.
+class UTIL_EXPORT GeodesicTessellator {
+ public:
+  /// \param ellipsoid Ellipsoid on which the shapes are defined.
+  /// \param tolerance Maximal distance of a chord from the curve
+  ///   in meters.
+  explicit GeodesicTessellator(const Ellipsoid &ellipsoid,
+    qreal tolerance = 10.0);
+  ~GeodesicTessellator();
+
+  /// Return maximal distance of a chord from the curve in meters.
+  qreal tolerance() const { return tolerance_; }
+
+  /// Set maximal distance of a chord from the curve in meters.
+  void setTolerance(qreal tolerance) { tolerance_ = tolerance; }
+
+  /// Return number of segments of an arc, at least one.
+  /// \param radius Radius of the arc in meters.
+  /// \param sweep Angle of the arc in degrees.
+  int segmentCount(qreal radius, qreal sweep) const;
+
+  /// Append vertices of a closed circle to result.
+  /// The first vertex (due north of the centre) is repeated at the end.
+  /// \param centre Centre of the circle.
+  /// \param radius Geodesic radius in meters.
+  void circle(const Location &centre, qreal radius,
+    QVector<Location> *result) const;
+
+  /// Append vertices of an arc to result, including both end points.
+  /// \param centre Centre of the arc.
+  /// \param radius Geodesic radius in meters.
+  /// \param from Azimuth of the first point in degrees from north.
+  /// \param to Azimuth of the last point in degrees from north.
+  /// \param clockwise Direction of the arc.
+  void arc(const Location &centre, qreal radius, qreal from, qreal to,
+    bool clockwise, QVector<Location> *result) const;
+
+  /// Append vertices of the geodesic between two points to result,
+  /// including both end points.
+  /// Long geodesics are divided so that no segment is longer than
+  /// maxLength, the points are taken along a single GeodesicLine.
+  void line(const Location &from, const Location &to, qreal maxLength,
+    QVector<Location> *result) const;
+
+ private:
+  GeographicLib::Geodesic *geodesic;
+  qreal tolerance_;
+
+  Q_DISABLE_COPY(GeodesicTessellator)
+};
+
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_GEODESICTESSELLATOR_H_
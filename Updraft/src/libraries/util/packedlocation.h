@@ -0,0 +1,112 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_PACKEDLOCATION_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_PACKEDLOCATION_H_
+
+#include <QVector>
+
+#include "util.h"
+#include "location.h"
+
+namespace Updraft {
+namespace Util {
+
+/// Location stored in fixed point, for large in-memory data sets.
+/// Latitude and longitude are kept in millionths of degree (about 11 cm
+/// on the equator), altitude in centimeters, which takes 12 bytes
+/// instead of 24 of Location.
+/// Converting a PackedLocation to Location and back is lossless,
+/// a Location is rounded to the nearest representable value.
+class PackedLocation {
+ public:
+  /// Fixed point units in one degree.
+  static const qint32 UNITS_PER_DEGREE = 1000000;
+
+  /// Fixed point units of altitude in one meter.
+  static const qint32 UNITS_PER_METER = 100;
+
+  PackedLocation() : lat_(0), lon_(0), alt_(0) {}
+
+  explicit PackedLocation(const Location &location)
+    : lat_(qRound(location.lat * UNITS_PER_DEGREE)),
+    lon_(qRound(location.lon * UNITS_PER_DEGREE)),
+    alt_(qRound(location.alt * UNITS_PER_METER)) {}
+
+  /// Return latitude in degrees.
+  qreal lat() const { return static_cast<qreal>(lat_) / UNITS_PER_DEGREE; }
+
+  /// Return longitude in degrees.
+  qreal lon() const { return static_cast<qreal>(lon_) / UNITS_PER_DEGREE; }
+
+  /// Return altitude in meters.
+  qreal alt() const { return static_cast<qreal>(alt_) / UNITS_PER_METER; }
+
+  /// Return raw fixed point values.
+  /// \{
+  qint32 rawLat() const { return lat_; }
+  qint32 rawLon() const { return lon_; }
+  qint32 rawAlt() const { return alt_; }
+  /// \}
+
+  /// Convert to Location.
+  Location toLocation() const {
+    Location ret;
+    ret.lat = lat();
+    ret.lon = lon();
+    ret.alt = alt();
+    return ret;
+  }
+
+  bool operator==(const PackedLocation &other) const {
+    return lat_ == other.lat_ && lon_ == other.lon_ && alt_ == other.alt_;
+  }
+
+  bool operator!=(const PackedLocation &other) const {
+    return !(*this == other);
+  }
+
+ private:
+  qint32 lat_;
+  qint32 lon_;
+  qint32 alt_;
+};
+
+/// Array of locations stored packed.
+/// Has the interface of a container of Location, values are converted
+/// on access, so code working with Location can switch the storage
+/// without changes.
+class PackedLocationArray {
+ public:
+  PackedLocationArray() {}
+  explicit PackedLocationArray(int count) : data(count) {}
+
+  int count() const { return data.count(); }
+  bool isEmpty() const { return data.isEmpty(); }
+  void clear() { data.clear(); }
+  void reserve(int count) { data.reserve(count); }
+  void resize(int count) { data.resize(count); }
+
+  void append(const Location &location) {
+    data.append(PackedLocation(location));
+  }
+
+  Location at(int i) const { return data[i].toLocation(); }
+  Location operator[](int i) const { return at(i); }
+  void set(int i, const Location &location) {
+    data[i] = PackedLocation(location);
+  }
+
+  /// Return the packed value of location i.
+  const PackedLocation& packed(int i) const { return data[i]; }
+
+  /// Return memory taken by the stored locations in bytes.
+  int byteSize() const { return data.capacity() * sizeof(PackedLocation); }
+
+ private:
+  QVector<PackedLocation> data;
+};
+
+}  // End namespace Util
+}  // End namespace Updraft
+
+Q_DECLARE_TYPEINFO(Updraft::Util::PackedLocation, Q_PRIMITIVE_TYPE);
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_PACKEDLOCATION_H_
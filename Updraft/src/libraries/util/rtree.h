@@ -0,0 +1,463 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_RTREE_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_RTREE_H_
+
+#include <qmath.h>
+
+#include <QPair>
+#include <QVarLengthArray>
+#include <QVector>
+#include <QtAlgorithms>
+
+namespace Updraft {
+namespace Util {
+
+/// Axis aligned box in DIM dimensions.
+template<int DIM>
+struct Box {
+  double low[DIM];
+  double high[DIM];
+
+  /// Return box containing a single point.
+  static Box fromPoint(const double *point) {
+    Box box;
+    for (int d = 0; d < DIM; ++d) {
+      box.low[d] = box.high[d] = point[d];
+    }
+    return box;
+  }
+
+  /// Return box of a line segment.
+  static Box fromSegment(const double *from, const double *to) {
+    Box box = fromPoint(from);
+    box.extend(to);
+    return box;
+  }
+
+  /// Enlarge the box to contain the point.
+  void extend(const double *point) {
+    for (int d = 0; d < DIM; ++d) {
+      low[d] = qMin(low[d], point[d]);
+      high[d] = qMax(high[d], point[d]);
+    }
+  }
+
+  /// Enlarge the box to contain the other box.
+  void extend(const Box &other) {
+    for (int d = 0; d < DIM; ++d) {
+      low[d] = qMin(low[d], other.low[d]);
+      high[d] = qMax(high[d], other.high[d]);
+    }
+  }
+
+  /// Return the center of the box in dimension d.
+  double center(int d) const { return (low[d] + high[d]) / 2; }
+
+  /// Return true if the boxes have at least one common point.
+  bool intersects(const Box &other) const {
+    for (int d = 0; d < DIM; ++d) {
+      if (other.high[d] < low[d] || other.low[d] > high[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Return true if the line segment has at least one common point
+  /// with the box.
+  bool intersectsSegment(const double *from, const double *to) const {
+    // Clip the parameter range of the segment by each pair of planes.
+    double t0 = 0.0;
+    double t1 = 1.0;
+    for (int d = 0; d < DIM; ++d) {
+      double delta = to[d] - from[d];
+      if (delta == 0.0) {
+        if (from[d] < low[d] || from[d] > high[d]) {
+          return false;
+        }
+        continue;
+      }
+
+      double tMin = (low[d] - from[d]) / delta;
+      double tMax = (high[d] - from[d]) / delta;
+      if (tMin > tMax) {
+        qSwap(tMin, tMax);
+      }
+      t0 = qMax(t0, tMin);
+      t1 = qMin(t1, tMax);
+      if (t0 > t1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Return squared distance from the point to the nearest point of
+  /// the box, 0 if the point is inside.
+  double distanceSquared(const double *point) const {
+    double ret = 0;
+    for (int d = 0; d < DIM; ++d) {
+      double delta = 0;
+      if (point[d] < low[d]) {
+        delta = low[d] - point[d];
+      } else if (point[d] > high[d]) {
+        delta = point[d] - high[d];
+      }
+      ret += delta * delta;
+    }
+    return ret;
+  }
+};
+
+/// Static R-tree over boxes in DIM dimensions.
+/// The tree is bulk loaded at once using the Sort-Tile-Recursive packing,
+/// all nodes are full and stored in flat arrays, so building is a few
+/// sorts and queries visit O(log n) nodes for small results.
+/// Entries are identified by their index in the array passed to build().
+/// Distances are Euclidean in the coordinates of the boxes. For
+/// geographic data in meters index ECEF coordinates (see EcefProjector)
+/// in RTree<3>; the chord distance grows with the great circle distance,
+/// so nearest neighbours and radius queries keep their meaning.
+/// RTree<2> over latitude and longitude boxes is suited for bounding box
+/// and segment queries of polylines and polygons.
+template<int DIM>
+class RTree {
+ public:
+  typedef Util::Box<DIM> Box;
+
+  /// Maximal number of children of a node.
+  static const int NODE_SIZE = 16;
+
+  RTree() : leafCount(0) {}
+
+  /// Build the tree over the given boxes, replacing the previous content.
+  void build(const QVector<Box> &boxes);
+
+  /// Remove all entries.
+  void clear() {
+    entryBoxes.clear();
+    entryIds.clear();
+    nodes.clear();
+    leafCount = 0;
+  }
+
+  /// Return number of the entries.
+  int count() const { return entryIds.count(); }
+
+  /// Return true if there are no entries.
+  bool isEmpty() const { return entryIds.isEmpty(); }
+
+  /// Append ids of the entries intersecting the box to result.
+  void intersecting(const Box &box, QVector<int> *result) const;
+
+  /// Append ids of the entries intersecting the line segment to result.
+  void intersectingSegment(const double *from, const double *to,
+    QVector<int> *result) const;
+
+  /// Append ids of the entries closer than radius to the point to result.
+  void within(const double *point, double radius,
+    QVector<int> *result) const;
+
+  /// Return id of the entry nearest to the point, or -1 if the tree is
+  /// empty.
+  /// \param [out] distanceSquared If not NULL, squared distance of
+  ///   the nearest entry.
+  int nearest(const double *point, double *distanceSquared = NULL) const;
+
+  /// Replace the content of result by ids of k entries nearest
+  /// to the point, sorted from the nearest one.
+  void nearest(const double *point, int k, QVector<int> *result) const;
+
+ private:
+  /// Node of the tree, covering a continuous range of its children.
+  struct Node {
+    Box box;
+
+    /// Index of the first child in entries for leaves, or in nodes
+    /// otherwise.
+    int first;
+    int count;
+  };
+
+  /// Candidate of a nearest neighbour search.
+  typedef QPair<double, int> Candidate;
+
+  /// Orders indices of boxes by their center in one dimension.
+  struct CenterLess {
+    CenterLess(const Box *boxes, int d) : boxes(boxes), d(d) {}
+    bool operator()(int a, int b) const {
+      return boxes[a].center(d) < boxes[b].center(d);
+    }
+    const Box *boxes;
+    int d;
+  };
+
+  /// Sort indices of count boxes into tiles of NODE_SIZE boxes
+  /// (Sort-Tile-Recursive), starting with dimension d.
+  static void tile(const Box *boxes, int *order, int count, int d);
+
+  /// Append nodes grouping each NODE_SIZE consecutive boxes.
+  /// \param offset Index of boxes[0] among the children.
+  void pack(const QVector<Box> &boxes, int offset);
+
+  bool isLeaf(int node) const { return node < leafCount; }
+
+  /// Continue the k nearest neighbour search in the given node.
+  void nearestVisit(int node, const double *point, int k,
+    QVector<Candidate> *best) const;
+
+  /// Boxes and ids of the entries in the order of the leaves.
+  QVector<Box> entryBoxes;
+  QVector<int> entryIds;
+
+  /// Leaves first, then each upper level, the root is the last node.
+  QVector<Node> nodes;
+
+  /// Number of leaf nodes.
+  int leafCount;
+};
+
+template<int DIM>
+const int RTree<DIM>::NODE_SIZE;
+
+template<int DIM>
+void RTree<DIM>::tile(const Box *boxes, int *order, int count, int d) {
+  qSort(order, order + count, CenterLess(boxes, d));
+  if (d == DIM - 1) {
+    return;
+  }
+
+  // Split to slabs so that each of the remaining dimensions
+  // gets the same number of tiles.
+  int pages = (count + NODE_SIZE - 1) / NODE_SIZE;
+  int slabs = qCeil(pow(static_cast<double>(pages), 1.0 / (DIM - d)));
+  int slabSize = NODE_SIZE * ((pages + slabs - 1) / slabs);
+  for (int i = 0; i < count; i += slabSize) {
+    tile(boxes, order + i, qMin(slabSize, count - i), d + 1);
+  }
+}
+
+template<int DIM>
+void RTree<DIM>::pack(const QVector<Box> &boxes, int offset) {
+  for (int i = 0; i < boxes.count(); i += NODE_SIZE) {
+    Node node;
+    node.box = boxes[i];
+    node.first = offset + i;
+    node.count = qMin(NODE_SIZE, boxes.count() - i);
+    for (int j = 1; j < node.count; ++j) {
+      node.box.extend(boxes[i + j]);
+    }
+    nodes.append(node);
+  }
+}
+
+template<int DIM>
+void RTree<DIM>::build(const QVector<Box> &boxes) {
+  clear();
+  int n = boxes.count();
+  if (n == 0) {
+    return;
+  }
+
+  QVector<int> order(n);
+  for (int i = 0; i < n; ++i) {
+    order[i] = i;
+  }
+  tile(boxes.constData(), order.data(), n, 0);
+
+  entryBoxes.resize(n);
+  entryIds = order;
+  for (int i = 0; i < n; ++i) {
+    entryBoxes[i] = boxes[order[i]];
+  }
+
+  nodes.reserve(2 * n / NODE_SIZE + 1);
+  pack(entryBoxes, 0);
+  leafCount = nodes.count();
+
+  // Pack the upper levels until a single root remains.
+  int levelFirst = 0;
+  while (nodes.count() - levelFirst > 1) {
+    int levelCount = nodes.count() - levelFirst;
+
+    QVector<Box> levelBoxes(levelCount);
+    for (int i = 0; i < levelCount; ++i) {
+      levelBoxes[i] = nodes[levelFirst + i].box;
+    }
+    QVector<int> levelOrder(levelCount);
+    for (int i = 0; i < levelCount; ++i) {
+      levelOrder[i] = i;
+    }
+    tile(levelBoxes.constData(), levelOrder.data(), levelCount, 0);
+
+    // Reorder the level, the children of the nodes stay where they are.
+    QVector<Node> level(levelCount);
+    for (int i = 0; i < levelCount; ++i) {
+      level[i] = nodes[levelFirst + levelOrder[i]];
+      levelBoxes[i] = level[i].box;
+    }
+    for (int i = 0; i < levelCount; ++i) {
+      nodes[levelFirst + i] = level[i];
+    }
+
+    int nextFirst = nodes.count();
+    pack(levelBoxes, levelFirst);
+    levelFirst = nextFirst;
+  }
+}
+
+template<int DIM>
+void RTree<DIM>::intersecting(const Box &box, QVector<int> *result) const {
+  if (nodes.isEmpty()) {
+    return;
+  }
+
+  QVarLengthArray<int, 64> stack;
+  stack.append(nodes.count() - 1);
+  while (stack.size() > 0) {
+    int index = stack[stack.size() - 1];
+    const Node &node = nodes[index];
+    stack.resize(stack.size() - 1);
+    if (!box.intersects(node.box)) {
+      continue;
+    }
+
+    for (int i = node.first; i < node.first + node.count; ++i) {
+      if (!isLeaf(index)) {
+        stack.append(i);
+      } else if (box.intersects(entryBoxes[i])) {
+        result->append(entryIds[i]);
+      }
+    }
+  }
+}
+
+template<int DIM>
+void RTree<DIM>::intersectingSegment(const double *from, const double *to,
+  QVector<int> *result) const {
+  if (nodes.isEmpty()) {
+    return;
+  }
+
+  QVarLengthArray<int, 64> stack;
+  stack.append(nodes.count() - 1);
+  while (stack.size() > 0) {
+    int index = stack[stack.size() - 1];
+    const Node &node = nodes[index];
+    stack.resize(stack.size() - 1);
+    if (!node.box.intersectsSegment(from, to)) {
+      continue;
+    }
+
+    for (int i = node.first; i < node.first + node.count; ++i) {
+      if (!isLeaf(index)) {
+        stack.append(i);
+      } else if (entryBoxes[i].intersectsSegment(from, to)) {
+        result->append(entryIds[i]);
+      }
+    }
+  }
+}
+
+template<int DIM>
+void RTree<DIM>::within(const double *point, double radius,
+  QVector<int> *result) const {
+  if (nodes.isEmpty()) {
+    return;
+  }
+
+  double radiusSquared = radius * radius;
+  QVarLengthArray<int, 64> stack;
+  stack.append(nodes.count() - 1);
+  while (stack.size() > 0) {
+    int index = stack[stack.size() - 1];
+    const Node &node = nodes[index];
+    stack.resize(stack.size() - 1);
+    if (node.box.distanceSquared(point) > radiusSquared) {
+      continue;
+    }
+
+    for (int i = node.first; i < node.first + node.count; ++i) {
+      if (!isLeaf(index)) {
+        stack.append(i);
+      } else if (entryBoxes[i].distanceSquared(point) <= radiusSquared) {
+        result->append(entryIds[i]);
+      }
+    }
+  }
+}
+
+template<int DIM>
+int RTree<DIM>::nearest(const double *point, double *distanceSquared) const {
+  QVector<Candidate> best;
+  if (!nodes.isEmpty()) {
+    nearestVisit(nodes.count() - 1, point, 1, &best);
+  }
+
+  if (best.isEmpty()) {
+    return -1;
+  }
+  if (distanceSquared != NULL) {
+    *distanceSquared = best[0].first;
+  }
+  return best[0].second;
+}
+
+template<int DIM>
+void RTree<DIM>::nearest(const double *point, int k,
+  QVector<int> *result) const {
+  result->clear();
+  if (nodes.isEmpty() || k <= 0) {
+    return;
+  }
+
+  QVector<Candidate> best;
+  best.reserve(k + 1);
+  nearestVisit(nodes.count() - 1, point, k, &best);
+  for (int i = 0; i < best.count(); ++i) {
+    result->append(best[i].second);
+  }
+}
+
+template<int DIM>
+void RTree<DIM>::nearestVisit(int index, const double *point, int k,
+  QVector<Candidate> *best) const {
+  const Node &node = nodes[index];
+
+  if (isLeaf(index)) {
+    for (int i = node.first; i < node.first + node.count; ++i) {
+      double distance = entryBoxes[i].distanceSquared(point);
+      if (best->count() == k && distance >= best->last().first) {
+        continue;
+      }
+
+      // Keep the candidates sorted, k is expected to be small.
+      Candidate candidate(distance, entryIds[i]);
+      best->insert(qUpperBound(best->begin(), best->end(), candidate),
+        candidate);
+      if (best->count() > k) {
+        best->resize(k);
+      }
+    }
+    return;
+  }
+
+  // Visit the closer children first, so that the farther ones are
+  // more likely to be pruned.
+  QVarLengthArray<Candidate, NODE_SIZE> children;
+  for (int i = node.first; i < node.first + node.count; ++i) {
+    children.append(Candidate(nodes[i].box.distanceSquared(point), i));
+  }
+  qSort(children.data(), children.data() + children.size());
+
+  for (int i = 0; i < children.size(); ++i) {
+    if (best->count() == k && children[i].first >= best->last().first) {
+      break;
+    }
+    nearestVisit(children[i].second, point, k, best);
+  }
+}
+
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_RTREE_H_
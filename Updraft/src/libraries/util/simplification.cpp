@@ -0,0 +1,193 @@
+#include "simplification.h"
+
+#include <qmath.h>
+#include <qnumeric.h>
+
+#include <QtAlgorithms>
+
+namespace Updraft {
+namespace Util {
+
+/// Return area of the triangle abc.
+static double triangleArea(const double *a, const double *b,
+  const double *c) {
+  double u[] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  double v[] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+  double x = u[1] * v[2] - u[2] * v[1];
+  double y = u[2] * v[0] - u[0] * v[2];
+  double z = u[0] * v[1] - u[1] * v[0];
+  return qSqrt(x * x + y * y + z * z) / 2;
+}
+
+/// Binary min-heap of vertices ordered by their current area.
+/// Keeps positions of the vertices, so that the area of a vertex
+/// can be changed when its neighbour is removed.
+class AreaHeap {
+ public:
+  AreaHeap(const QVector<double> &area, int count)
+    : area(area), position(count, -1) {
+  }
+
+  bool isEmpty() const { return heap.isEmpty(); }
+
+  void push(int vertex) {
+    position[vertex] = heap.count();
+    heap.append(vertex);
+    up(heap.count() - 1);
+  }
+
+  int pop() {
+    int top = heap[0];
+    int last = heap.last();
+    heap.resize(heap.count() - 1);
+    position[top] = -1;
+    if (!heap.isEmpty()) {
+      heap[0] = last;
+      position[last] = 0;
+      down(0);
+    }
+    return top;
+  }
+
+  /// Restore the order after area of the vertex changed.
+  void update(int vertex) {
+    up(position[vertex]);
+    down(position[vertex]);
+  }
+
+ private:
+  bool less(int i, int j) const {
+    return area[heap[i]] < area[heap[j]];
+  }
+
+  void swap(int i, int j) {
+    qSwap(heap[i], heap[j]);
+    position[heap[i]] = i;
+    position[heap[j]] = j;
+  }
+
+  void up(int i) {
+    while (i > 0 && less(i, (i - 1) / 2)) {
+      swap(i, (i - 1) / 2);
+      i = (i - 1) / 2;
+    }
+  }
+
+  void down(int i) {
+    for (;;) {
+      int smallest = i;
+      int left = 2 * i + 1;
+      int right = left + 1;
+      if (left < heap.count() && less(left, smallest)) {
+        smallest = left;
+      }
+      if (right < heap.count() && less(right, smallest)) {
+        smallest = right;
+      }
+      if (smallest == i) {
+        return;
+      }
+      swap(i, smallest);
+      i = smallest;
+    }
+  }
+
+  const QVector<double> &area;
+  QVector<int> heap;
+  QVector<int> position;
+};
+
+/// Orders vertex indices by decreasing significance.
+struct MoreSignificant {
+  explicit MoreSignificant(const QVector<double> &significance)
+    : significance(significance) {}
+  bool operator()(int a, int b) const {
+    if (significance[a] != significance[b]) {
+      return significance[a] > significance[b];
+    }
+    return a < b;
+  }
+  const QVector<double> &significance;
+};
+
+void PolylineSimplification::build(const double *xyz, int count,
+  int stride) {
+  significance_.fill(qInf(), count);
+
+  QVector<int> prev(count);
+  QVector<int> next(count);
+  for (int i = 0; i < count; ++i) {
+    prev[i] = i - 1;
+    next[i] = i + 1;
+  }
+
+  QVector<double> area(count, qInf());
+  AreaHeap heap(area, count);
+  for (int i = 1; i < count - 1; ++i) {
+    area[i] = triangleArea(xyz + stride * (i - 1), xyz + stride * i,
+      xyz + stride * (i + 1));
+    heap.push(i);
+  }
+
+  // Significance of a removed vertex is at least that of all vertices
+  // removed before it, so that every simplification is a subset of
+  // the finer ones.
+  double removed = 0;
+  while (!heap.isEmpty()) {
+    int vertex = heap.pop();
+    removed = qMax(removed, area[vertex]);
+    significance_[vertex] = removed;
+
+    int p = prev[vertex];
+    int n = next[vertex];
+    next[p] = n;
+    prev[n] = p;
+
+    if (p > 0) {
+      area[p] = triangleArea(xyz + stride * prev[p], xyz + stride * p,
+        xyz + stride * n);
+      heap.update(p);
+    }
+    if (n < count - 1) {
+      area[n] = triangleArea(xyz + stride * p, xyz + stride * n,
+        xyz + stride * next[n]);
+      heap.update(n);
+    }
+  }
+
+  ranked.resize(count);
+  for (int i = 0; i < count; ++i) {
+    ranked[i] = i;
+  }
+  qSort(ranked.begin(), ranked.end(), MoreSignificant(significance_));
+
+  rankedSignificance.resize(count);
+  for (int i = 0; i < count; ++i) {
+    rankedSignificance[i] = significance_[ranked[i]];
+  }
+}
+
+void PolylineSimplification::extract(double tolerance,
+  QVector<int> *result) const {
+  // Number of vertices with significance >= tolerance, the key is
+  // sorted in descending order.
+  QVector<double>::const_iterator it = qUpperBound(
+    rankedSignificance.constBegin(), rankedSignificance.constEnd(),
+    tolerance, qGreater<double>());
+  extractCount(it - rankedSignificance.constBegin(), result);
+}
+
+void PolylineSimplification::extractCount(int maxCount,
+  QVector<int> *result) const {
+  int k = qMin(maxCount, ranked.count());
+  if (k < 2) {
+    // Keep both ends of the line, whatever the limit is.
+    k = qMin(2, ranked.count());
+  }
+
+  *result = ranked.mid(0, k);
+  qSort(result->begin(), result->end());
+}
+
+}  // End namespace Util
+}  // End namespace Updraft
@@ -0,0 +1,67 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_SIMPLIFICATION_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_SIMPLIFICATION_H_
+
+#include <QVector>
+
+#include "util.h"
+
+namespace Updraft {
+namespace Util {
+
+/// Multi-resolution simplification of a polyline.
+/// All vertices are ranked at once by the Visvalingam-Whyatt algorithm:
+/// the vertex whose removal changes the line the least (the smallest
+/// triangle with its neighbours) is removed first, repeatedly.
+/// Significance of a vertex is the area of its triangle at the moment
+/// it was removed, so a simplification for any tolerance is just the
+/// vertices with significance above the tolerance, and it can be taken
+/// without ranking the line again.
+/// Coordinates are three dimensional, usually ECEF in meters, so the
+/// simplification doesn't depend on the map projection.
+class UTIL_EXPORT PolylineSimplification {
+ public:
+  /// Rank vertices of a polyline. Runs in O(n log n).
+  /// \param xyz Three coordinates of every vertex.
+  /// \param count Number of the vertices.
+  /// \param stride Distance between the first coordinates of two
+  ///   consecutive vertices, at least 3.
+  void build(const double *xyz, int count, int stride = 3);
+
+  /// Return number of the vertices.
+  int count() const { return significance_.count(); }
+
+  /// Return significance of vertex i, the area in square units of the
+  /// triangle that disappears when the vertex is left out.
+  /// The first and the last vertex are never left out, their
+  /// significance is infinite.
+  /// Significance never increases as vertices are removed, so each
+  /// simplification contains all coarser ones.
+  double significance(int i) const { return significance_[i]; }
+
+  /// Return vertices with significance at least tolerance.
+  /// Runs in O(k log k) for k returned vertices.
+  /// \param tolerance Minimal area in square units.
+  /// \param [out] result Indices of the vertices in the polyline order.
+  void extract(double tolerance, QVector<int> *result) const;
+
+  /// Return at most maxCount most significant vertices.
+  /// Runs in O(k log k) for k returned vertices.
+  /// \param [out] result Indices of the vertices in the polyline order.
+  void extractCount(int maxCount, QVector<int> *result) const;
+
+ private:
+  /// Significance of every vertex in the polyline order.
+  QVector<double> significance_;
+
+  /// Indices of the vertices from the most significant.
+  QVector<int> ranked;
+
+  /// Significance of the vertices in the order of ranked, as a key
+  /// for binary search (descending).
+  QVector<double> rankedSignificance;
+};
+
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_SIMPLIFICATION_H_
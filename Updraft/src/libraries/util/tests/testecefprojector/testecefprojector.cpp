@@ -0,0 +1,52 @@
+#include "testecefprojector.h"
+
+#include <qmath.h>
+
+#include <QtTest>
+#include <QVector>
+#include <osg/CoordinateSystemNode>
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+void TestEcefProjector::testProject() {
+  osg::EllipsoidModel ellipsoid;
+  EcefProjector projector(&ellipsoid);
+
+  // More points than one block of the projector.
+  int count = 1000;
+  QVector<double> lat(count);
+  QVector<double> lon(count);
+  QVector<double> height(count);
+  for (int i = 0; i < count; ++i) {
+    lat[i] = -89.0 + 178.0 * i / count;
+    lon[i] = -180.0 + 0.36 * i;
+    height[i] = 10.0 * i;
+  }
+
+  QVector<double> xyz(6 * count);
+  projector.project(lat.constData(), lon.constData(), height.constData(),
+    count, xyz.data(), xyz.data() + 3, 6);
+
+  for (int i = 0; i < count; ++i) {
+    double x, y, z;
+    ellipsoid.convertLatLongHeightToXYZ(
+      M_PI * lat[i] / 180.0, M_PI * lon[i] / 180.0, height[i], x, y, z);
+    QVERIFY(qAbs(xyz[6 * i] - x) < 1e-6);
+    QVERIFY(qAbs(xyz[6 * i + 1] - y) < 1e-6);
+    QVERIFY(qAbs(xyz[6 * i + 2] - z) < 1e-6);
+
+    ellipsoid.convertLatLongHeightToXYZ(
+      M_PI * lat[i] / 180.0, M_PI * lon[i] / 180.0, 0, x, y, z);
+    QVERIFY(qAbs(xyz[6 * i + 3] - x) < 1e-6);
+    QVERIFY(qAbs(xyz[6 * i + 4] - y) < 1e-6);
+    QVERIFY(qAbs(xyz[6 * i + 5] - z) < 1e-6);
+  }
+}
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Util::Test::TestEcefProjector)
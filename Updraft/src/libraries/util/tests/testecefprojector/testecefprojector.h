@@ -0,0 +1,23 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTECEFPROJECTOR_TESTECEFPROJECTOR_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTECEFPROJECTOR_TESTECEFPROJECTOR_H_
+
+#include <QObject>
+
+#include "ecefprojector.h"
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+/// Compare the batch projection with osg::EllipsoidModel.
+class TestEcefProjector: public QObject {
+  Q_OBJECT
+ private slots:
+  void testProject();
+};
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTECEFPROJECTOR_TESTECEFPROJECTOR_H_
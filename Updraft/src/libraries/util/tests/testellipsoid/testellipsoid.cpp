@@ -0,0 +1,164 @@
+#include "testellipsoid.h"
+
+#include <QtTest>
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+void TestEllipsoid::initTestCase() {
+  // Pseudo random track around central Europe with some long jumps,
+  // deterministic so that the benchmarks are comparable.
+  points.resize(10000);
+  qsrand(1);
+  for (int i = 0; i < points.count(); ++i) {
+    points[i].lat = 45.0 + 10.0 * qrand() / RAND_MAX;
+    points[i].lon = 5.0 + 20.0 * qrand() / RAND_MAX;
+    points[i].alt = 0;
+  }
+}
+
+void TestEllipsoid::testLegDistances() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  int count = 100;
+
+  QVector<qreal> distances(count - 1);
+  QVector<qreal> azimuths(count - 1);
+  wgs84.legDistances(points.constData(), count, distances.data(),
+    azimuths.data());
+
+  for (int i = 0; i < count - 1; ++i) {
+    qreal azimuth;
+    qreal distance = wgs84.distanceAzimuth(points[i], points[i + 1],
+      &azimuth);
+    QCOMPARE(distances[i], distance);
+    QCOMPARE(azimuths[i], azimuth);
+  }
+}
+
+void TestEllipsoid::testDistancesFrom() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  int count = 100;
+
+  QVector<qreal> distances(count);
+  wgs84.distancesFrom(points[0], points.constData() + 1, count,
+    distances.data());
+
+  for (int i = 0; i < count; ++i) {
+    QCOMPARE(distances[i], wgs84.distance(points[0], points[i + 1]));
+  }
+}
+
+void TestEllipsoid::testDistanceMatrix() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  int rows = 7;
+  int columns = 11;
+
+  QVector<qreal> distances(rows * columns);
+  wgs84.distanceMatrix(points.constData(), rows,
+    points.constData() + rows, columns, distances.data(),
+    DISTANCE_ANDOYER_LAMBERT);
+
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < columns; ++j) {
+      qreal exact = wgs84.distance(points[i], points[rows + j]);
+      QVERIFY(qAbs(distances[i * columns + j] - exact) < 1e-4 * exact);
+    }
+  }
+}
+
+void TestEllipsoid::testApproximations() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  int count = 1000;
+
+  QVector<qreal> andoyer(count - 1);
+  QVector<qreal> spherical(count - 1);
+  QVector<qreal> azimuths(count - 1);
+  wgs84.legDistances(points.constData(), count, andoyer.data(),
+    azimuths.data(), DISTANCE_ANDOYER_LAMBERT);
+  wgs84.legDistances(points.constData(), count, spherical.data(),
+    NULL, DISTANCE_SPHERICAL);
+
+  for (int i = 0; i < count - 1; ++i) {
+    qreal azimuth;
+    qreal exact = wgs84.distanceAzimuth(points[i], points[i + 1], &azimuth);
+    QVERIFY(qAbs(andoyer[i] - exact) < 1e-4 * exact);
+    QVERIFY(qAbs(spherical[i] - exact) < 5e-3 * exact);
+
+    qreal azimuthError = qAbs(azimuths[i] - azimuth);
+    QVERIFY(qMin(azimuthError, 360 - azimuthError) < 0.5);
+  }
+
+  // Identical and antipodal points.
+  Location l1, l2;
+  l1.lat = 10.0;
+  l1.lon = 20.0;
+  l2.lat = -10.0;
+  l2.lon = -160.0;
+  Location pair[] = {l1, l1, l2};
+  qreal distances[2];
+  wgs84.legDistances(pair, 3, distances, NULL, DISTANCE_ANDOYER_LAMBERT);
+  QCOMPARE(distances[0], 0.0);
+  QCOMPARE(distances[1], wgs84.distance(l1, l2));
+}
+
+void TestEllipsoid::testSphere() {
+  Ellipsoid sphere("FAI Sphere", ELLIPSOID_FAI_SPHERE);
+  int count = 100;
+
+  QVector<qreal> exact(count - 1);
+  QVector<qreal> spherical(count - 1);
+  sphere.legDistances(points.constData(), count, exact.data());
+  sphere.legDistances(points.constData(), count, spherical.data(),
+    NULL, DISTANCE_SPHERICAL);
+
+  for (int i = 0; i < count - 1; ++i) {
+    qreal distance = sphere.distance(points[i], points[i + 1]);
+    QVERIFY(qAbs(exact[i] - distance) < 1e-6);
+    QVERIFY(qAbs(spherical[i] - distance) < 1e-6);
+  }
+}
+
+void TestEllipsoid::benchmarkScalar() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  qreal sum = 0;
+  QBENCHMARK {
+    for (int i = 0; i < points.count() - 1; ++i) {
+      sum += wgs84.distance(points[i], points[i + 1]);
+    }
+  }
+  QVERIFY(sum > 0);
+}
+
+void TestEllipsoid::benchmarkLegs() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  QVector<qreal> distances(points.count() - 1);
+  QBENCHMARK {
+    wgs84.legDistances(points.constData(), points.count(),
+      distances.data());
+  }
+}
+
+void TestEllipsoid::benchmarkLegsAndoyer() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  QVector<qreal> distances(points.count() - 1);
+  QBENCHMARK {
+    wgs84.legDistances(points.constData(), points.count(),
+      distances.data(), NULL, DISTANCE_ANDOYER_LAMBERT);
+  }
+}
+
+void TestEllipsoid::benchmarkLegsSpherical() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  QVector<qreal> distances(points.count() - 1);
+  QBENCHMARK {
+    wgs84.legDistances(points.constData(), points.count(),
+      distances.data(), NULL, DISTANCE_SPHERICAL);
+  }
+}
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Util::Test::TestEllipsoid)
@@ -0,0 +1,40 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTELLIPSOID_TESTELLIPSOID_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTELLIPSOID_TESTELLIPSOID_H_
+
+#include <QObject>
+#include <QVector>
+
+#include "ellipsoid.h"
+#include "location.h"
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+/// Test the batch distance functions of Ellipsoid against the
+/// scalar ones and compare their speed.
+class TestEllipsoid: public QObject {
+  Q_OBJECT
+ private slots:
+  void initTestCase();
+
+  void testLegDistances();
+  void testDistancesFrom();
+  void testDistanceMatrix();
+  void testApproximations();
+  void testSphere();
+
+  void benchmarkScalar();
+  void benchmarkLegs();
+  void benchmarkLegsAndoyer();
+  void benchmarkLegsSpherical();
+
+ private:
+  QVector<Location> points;
+};
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTELLIPSOID_TESTELLIPSOID_H_
@@ -0,0 +1,93 @@
+#include "testlocation.h"
+
+#include <QtTest>
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+void TestLocation::testLat() {
+  Location l;
+
+  l.latFromDMS(0, 0, 0, 'N');
+  QCOMPARE(l.lat, 0.0);
+
+  l.latFromDMS(50, 6, 58.378, 'N');
+  QCOMPARE(l.lat, 50.116216111111115);
+
+  l.latFromDMS(50, 6, 58.378, 'S');
+  QCOMPARE(l.lat, -50.116216111111115);
+}
+
+void TestLocation::testLon() {
+  Location l;
+
+  l.lonFromDMS(0, 0, 0, 'E');
+  QCOMPARE(l.lon, 0.0);
+
+  l.lonFromDMS(50, 6, 58.378, 'E');
+  QCOMPARE(l.lon, 50.116216111111115);
+
+  l.lonFromDMS(50, 6, 58.378, 'W');
+  QCOMPARE(l.lon, -50.116216111111115);
+}
+
+void TestLocation::testPacked() {
+  QCOMPARE(sizeof(PackedLocation), static_cast<size_t>(12));
+
+  Location l;
+  l.latFromDMS(50, 6, 58.378, 'N');
+  l.lonFromDMS(14, 25, 1.5, 'E');
+  l.alt = 1234.567;
+
+  PackedLocation packed(l);
+  QCOMPARE(packed.rawLat(), 50116216);
+  QCOMPARE(packed.rawLon(), 14417083);
+  QCOMPARE(packed.rawAlt(), 123457);
+
+  // Rounded to the nearest representable value.
+  QVERIFY(qAbs(packed.lat() - l.lat) <= 0.5e-6);
+  QVERIFY(qAbs(packed.lon() - l.lon) <= 0.5e-6);
+  QVERIFY(qAbs(packed.alt() - l.alt) <= 0.005);
+
+  // Conversion of packed values is lossless.
+  QVERIFY(PackedLocation(packed.toLocation()) == packed);
+
+  l.lat = -89.999999;
+  l.lon = -179.999999;
+  l.alt = -400;
+  packed = PackedLocation(l);
+  QCOMPARE(packed.rawLat(), -89999999);
+  QCOMPARE(packed.rawLon(), -179999999);
+  QCOMPARE(packed.rawAlt(), -40000);
+  QVERIFY(PackedLocation(packed.toLocation()) == packed);
+}
+
+void TestLocation::testPackedArray() {
+  PackedLocationArray array;
+  for (int i = 0; i < 1000; ++i) {
+    Location l;
+    l.lat = i / 100.0;
+    l.lon = -i / 50.0;
+    l.alt = i;
+    array.append(l);
+  }
+
+  QCOMPARE(array.count(), 1000);
+  QCOMPARE(array[500].lat, 5.0);
+  QCOMPARE(array[500].lon, -10.0);
+  QCOMPARE(array.at(500).alt, 500.0);
+
+  Location l;
+  l.lat = 1.5;
+  array.set(1, l);
+  QCOMPARE(array[1].lat, 1.5);
+
+  QVERIFY(array.byteSize() < 1000 * static_cast<int>(sizeof(Location)));
+}
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Util::Test::TestLocation)
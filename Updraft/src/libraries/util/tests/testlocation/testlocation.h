@@ -1,9 +1,10 @@
-#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTLOCATION_H_
-#define UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTLOCATION_H_
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTLOCATION_TESTLOCATION_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTLOCATION_TESTLOCATION_H_
 
 #include <QObject>
 
 #include "location.h"
+#include "packedlocation.h"
 
 namespace Updraft {
 namespace Util {
@@ -15,11 +16,13 @@ class TestLocation: public QObject {
  private slots:
   void testLat();
   void testLon();
+  void testPacked();
+  void testPackedArray();
 };
 
 }  // End namespace Test
 }  // End namespace Util
 }  // End namespace Updraft
 
-#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTLOCATION_H_
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTLOCATION_TESTLOCATION_H_
 
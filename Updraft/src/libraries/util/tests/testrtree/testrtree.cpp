@@ -0,0 +1,165 @@
+#include "testrtree.h"
+
+#include <QtTest>
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+/// Return a pseudo random number from 0 to 1.
+static double randomValue() {
+  return static_cast<double>(qrand()) / RAND_MAX;
+}
+
+void TestRTree::initTestCase() {
+  qsrand(1);
+
+  points.resize(5000);
+  for (int i = 0; i < points.count(); ++i) {
+    double point[] = {randomValue(), randomValue(), randomValue()};
+    points[i] = RTree<3>::Box::fromPoint(point);
+  }
+
+  boxes.resize(5000);
+  for (int i = 0; i < boxes.count(); ++i) {
+    double from[] = {randomValue(), randomValue()};
+    double to[] = {from[0] + 0.02 * randomValue(),
+      from[1] + 0.02 * randomValue()};
+    boxes[i] = RTree<2>::Box::fromSegment(from, to);
+  }
+}
+
+void TestRTree::testEmpty() {
+  RTree<3> tree;
+  tree.build(QVector<RTree<3>::Box>());
+
+  double point[] = {0, 0, 0};
+  QVector<int> result;
+  QCOMPARE(tree.nearest(point), -1);
+  tree.within(point, 1, &result);
+  QVERIFY(result.isEmpty());
+}
+
+void TestRTree::testNearest() {
+  RTree<3> tree;
+  tree.build(points);
+  QCOMPARE(tree.count(), points.count());
+
+  for (int i = 0; i < 100; ++i) {
+    double point[] = {randomValue(), randomValue(), randomValue()};
+
+    QVector<double> distances;
+    for (int j = 0; j < points.count(); ++j) {
+      distances.append(points[j].distanceSquared(point));
+    }
+    qSort(distances);
+
+    double distance;
+    int nearest = tree.nearest(point, &distance);
+    QCOMPARE(distance, distances[0]);
+    QCOMPARE(points[nearest].distanceSquared(point), distances[0]);
+
+    QVector<int> result;
+    tree.nearest(point, 10, &result);
+    QCOMPARE(result.count(), 10);
+    for (int j = 0; j < result.count(); ++j) {
+      QCOMPARE(points[result[j]].distanceSquared(point), distances[j]);
+    }
+  }
+}
+
+void TestRTree::testWithin() {
+  RTree<3> tree;
+  tree.build(points);
+
+  for (int i = 0; i < 100; ++i) {
+    double point[] = {randomValue(), randomValue(), randomValue()};
+    double radius = 0.1;
+
+    QVector<int> expected;
+    for (int j = 0; j < points.count(); ++j) {
+      if (points[j].distanceSquared(point) <= radius * radius) {
+        expected.append(j);
+      }
+    }
+
+    QVector<int> result;
+    tree.within(point, radius, &result);
+    qSort(result);
+    QCOMPARE(result, expected);
+  }
+}
+
+void TestRTree::testIntersecting() {
+  RTree<2> tree;
+  tree.build(boxes);
+
+  for (int i = 0; i < 100; ++i) {
+    double from[] = {randomValue(), randomValue()};
+    double to[] = {from[0] + 0.1, from[1] + 0.1};
+    RTree<2>::Box box = RTree<2>::Box::fromSegment(from, to);
+
+    QVector<int> expected;
+    for (int j = 0; j < boxes.count(); ++j) {
+      if (boxes[j].intersects(box)) {
+        expected.append(j);
+      }
+    }
+
+    QVector<int> result;
+    tree.intersecting(box, &result);
+    qSort(result);
+    QCOMPARE(result, expected);
+  }
+}
+
+void TestRTree::testSegment() {
+  RTree<2> tree;
+  tree.build(boxes);
+
+  for (int i = 0; i < 100; ++i) {
+    double from[] = {randomValue(), randomValue()};
+    double to[] = {randomValue(), randomValue()};
+
+    QVector<int> expected;
+    for (int j = 0; j < boxes.count(); ++j) {
+      if (boxes[j].intersectsSegment(from, to)) {
+        expected.append(j);
+      }
+    }
+
+    QVector<int> result;
+    tree.intersectingSegment(from, to, &result);
+    qSort(result);
+    QCOMPARE(result, expected);
+  }
+}
+
+void TestRTree::benchmarkBuild() {
+  QVector<RTree<3>::Box> many;
+  for (int i = 0; i < 20; ++i) {
+    many += points;
+  }
+
+  RTree<3> tree;
+  QBENCHMARK {
+    tree.build(many);
+  }
+  QCOMPARE(tree.count(), many.count());
+}
+
+void TestRTree::benchmarkNearest() {
+  RTree<3> tree;
+  tree.build(points);
+
+  double point[] = {0.5, 0.5, 0.5};
+  QBENCHMARK {
+    tree.nearest(point);
+  }
+}
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Util::Test::TestRTree)
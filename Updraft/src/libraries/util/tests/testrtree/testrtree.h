@@ -0,0 +1,40 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTRTREE_TESTRTREE_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTRTREE_TESTRTREE_H_
+
+#include <QObject>
+#include <QVector>
+
+#include "rtree.h"
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+/// Compare queries of RTree with brute force search.
+class TestRTree: public QObject {
+  Q_OBJECT
+ private slots:
+  void initTestCase();
+
+  void testEmpty();
+  void testNearest();
+  void testWithin();
+  void testIntersecting();
+  void testSegment();
+
+  void benchmarkBuild();
+  void benchmarkNearest();
+
+ private:
+  /// Random point boxes in a unit cube.
+  QVector<RTree<3>::Box> points;
+
+  /// Random small boxes in a unit square.
+  QVector<RTree<2>::Box> boxes;
+};
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTRTREE_TESTRTREE_H_
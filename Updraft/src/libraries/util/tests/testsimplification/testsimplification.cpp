@@ -0,0 +1,86 @@
+#include "testsimplification.h"
+
+#include <qmath.h>
+
+#include <QtTest>
+#include <QVector>
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+void TestSimplification::testStraightLine() {
+  QVector<double> xyz;
+  for (int i = 0; i < 10; ++i) {
+    xyz << i << 2 * i << 0;
+  }
+
+  PolylineSimplification simplification;
+  simplification.build(xyz.constData(), 10);
+
+  QVector<int> result;
+  simplification.extract(1e-9, &result);
+  QCOMPARE(result, QVector<int>() << 0 << 9);
+}
+
+void TestSimplification::testNested() {
+  int count = 2000;
+  QVector<double> xyz;
+  for (int i = 0; i < count; ++i) {
+    xyz << i << 100 * qSin(i / 50.0) + (i % 7) << i % 3;
+  }
+
+  PolylineSimplification simplification;
+  simplification.build(xyz.constData(), count);
+  QCOMPARE(simplification.count(), count);
+
+  QVector<int> fine;
+  QVector<int> coarse;
+  simplification.extract(10, &fine);
+  simplification.extract(1000, &coarse);
+
+  QVERIFY(coarse.count() < fine.count());
+  QCOMPARE(fine.first(), 0);
+  QCOMPARE(fine.last(), count - 1);
+  QCOMPARE(coarse.first(), 0);
+  QCOMPARE(coarse.last(), count - 1);
+
+  // Coarser simplification is a subset of the finer one.
+  int j = 0;
+  foreach(int vertex, coarse) {
+    while (j < fine.count() && fine[j] != vertex) {
+      ++j;
+    }
+    QVERIFY(j < fine.count());
+  }
+
+  foreach(int vertex, fine) {
+    QVERIFY(simplification.significance(vertex) >= 10);
+  }
+}
+
+void TestSimplification::testCount() {
+  QVector<double> xyz;
+  for (int i = 0; i < 100; ++i) {
+    xyz << i << (i * i) % 17 << 0;
+  }
+
+  PolylineSimplification simplification;
+  simplification.build(xyz.constData(), 100);
+
+  QVector<int> result;
+  simplification.extractCount(20, &result);
+  QCOMPARE(result.count(), 20);
+  for (int i = 1; i < result.count(); ++i) {
+    QVERIFY(result[i - 1] < result[i]);
+  }
+
+  simplification.extractCount(0, &result);
+  QCOMPARE(result, QVector<int>() << 0 << 99);
+}
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Util::Test::TestSimplification)
@@ -0,0 +1,25 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTSIMPLIFICATION_TESTSIMPLIFICATION_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTSIMPLIFICATION_TESTSIMPLIFICATION_H_
+
+#include <QObject>
+
+#include "simplification.h"
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+/// Test ranking and extraction of simplified polylines.
+class TestSimplification: public QObject {
+  Q_OBJECT
+ private slots:
+  void testStraightLine();
+  void testNested();
+  void testCount();
+};
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTSIMPLIFICATION_TESTSIMPLIFICATION_H_
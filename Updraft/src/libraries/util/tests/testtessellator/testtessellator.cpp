@@ -0,0 +1,117 @@
+#include "testtessellator.h"
+
+#include <QtTest>
+#include <QVector>
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+void TestTessellator::testSegmentCount() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  GeodesicTessellator tessellator(wgs84, 10.0);
+
+  // Larger circles need more segments, tiny ones keep the minimum.
+  int small = tessellator.segmentCount(1000, 360);
+  int large = tessellator.segmentCount(100000, 360);
+  QVERIFY(small < large);
+  QCOMPARE(tessellator.segmentCount(1, 360), 12);
+  QCOMPARE(tessellator.segmentCount(1, 1), 1);
+
+  // Half of the sweep takes about half of the segments.
+  int half = tessellator.segmentCount(100000, 180);
+  QVERIFY(qAbs(2 * half - large) <= 2);
+}
+
+void TestTessellator::testCircle() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  GeodesicTessellator tessellator(wgs84, 10.0);
+
+  Location centre;
+  centre.lat = 50.1;
+  centre.lon = 14.25;
+  qreal radius = 9260;
+
+  QVector<Location> circle;
+  tessellator.circle(centre, radius, &circle);
+
+  QCOMPARE(circle.count(), tessellator.segmentCount(radius, 360) + 1);
+  QCOMPARE(circle.first().lat, circle.last().lat);
+  QCOMPARE(circle.first().lon, circle.last().lon);
+
+  for (int i = 0; i < circle.count(); ++i) {
+    QVERIFY(qAbs(wgs84.distance(centre, circle[i]) - radius) < 1e-3);
+  }
+
+  // Middle of each chord is closer to the centre by at most
+  // the tolerance (with some margin for the flat chord approximation).
+  for (int i = 1; i < circle.count(); ++i) {
+    Location middle;
+    middle.lat = (circle[i - 1].lat + circle[i].lat) / 2;
+    middle.lon = (circle[i - 1].lon + circle[i].lon) / 2;
+    QVERIFY(radius - wgs84.distance(centre, middle) < 10.5);
+  }
+}
+
+void TestTessellator::testArc() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  GeodesicTessellator tessellator(wgs84, 10.0);
+
+  Location centre;
+  centre.lat = -33.9;
+  centre.lon = 151.2;
+  qreal radius = 20000;
+
+  QVector<Location> clockwise;
+  tessellator.arc(centre, radius, 350, 10, true, &clockwise);
+  QVector<Location> counterClockwise;
+  tessellator.arc(centre, radius, 350, 10, false, &counterClockwise);
+
+  // 20 degrees one way, 340 degrees the other way.
+  QVERIFY(clockwise.count() < counterClockwise.count());
+
+  qreal azimuth;
+  wgs84.distanceAzimuth(centre, clockwise.first(), &azimuth);
+  QVERIFY(qAbs(azimuth - 350) < 1e-6);
+  wgs84.distanceAzimuth(centre, clockwise.last(), &azimuth);
+  QVERIFY(qAbs(azimuth - 10) < 1e-6);
+  wgs84.distanceAzimuth(centre, clockwise[1], &azimuth);
+  QVERIFY(azimuth > 350);
+
+  wgs84.distanceAzimuth(centre, counterClockwise[1], &azimuth);
+  QVERIFY(azimuth < 350 && azimuth > 10);
+  wgs84.distanceAzimuth(centre, counterClockwise.last(), &azimuth);
+  QVERIFY(qAbs(azimuth - 10) < 1e-6);
+}
+
+void TestTessellator::testLine() {
+  Ellipsoid wgs84("WGS84", ELLIPSOID_WGS84);
+  GeodesicTessellator tessellator(wgs84);
+
+  Location from, to;
+  from.lat = 50;
+  from.lon = 0;
+  to.lat = 50;
+  to.lon = 20;
+
+  QVector<Location> line;
+  tessellator.line(from, to, 100000, &line);
+
+  qreal length = wgs84.distance(from, to);
+  QCOMPARE(line.count(), qCeil(length / 100000) + 1);
+
+  // The geodesic bulges towards the pole.
+  QVERIFY(line[line.count() / 2].lat > 50.3);
+
+  qreal sum = 0;
+  for (int i = 1; i < line.count(); ++i) {
+    sum += wgs84.distance(line[i - 1], line[i]);
+  }
+  QVERIFY(qAbs(sum - length) < 1e-3);
+}
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+QTEST_MAIN(Updraft::Util::Test::TestTessellator)
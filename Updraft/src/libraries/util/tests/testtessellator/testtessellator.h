@@ -0,0 +1,28 @@
+#ifndef UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTTESSELLATOR_TESTTESSELLATOR_H_
+#define UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTTESSELLATOR_TESTTESSELLATOR_H_
+
+#include <QObject>
+
+#include "ellipsoid.h"
+#include "geodesictessellator.h"
+#include "location.h"
+
+namespace Updraft {
+namespace Util {
+namespace Test {
+
+/// Test geometry of the tessellated circles, arcs and lines.
+class TestTessellator: public QObject {
+  Q_OBJECT
+ private slots:
+  void testSegmentCount();
+  void testCircle();
+  void testArc();
+  void testLine();
+};
+
+}  // End namespace Test
+}  // End namespace Util
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_LIBRARIES_UTIL_TESTS_TESTTESSELLATOR_TESTTESSELLATOR_H_
@@ -10,9 +10,16 @@
 #endif
 
 #include "location.h"
+#include "packedlocation.h"
 #include "units.h"
 #include "gradient.h"
 #include "linearfunc.h"
 #include "ellipsoid.h"
+#include "ecefprojector.h"
+#include "geodesictessellator.h"
+#include "rtree.h"
+#include "simplification.h"
+#include "arena.h"
+#include "decompressingdevice.h"
 
 #endif  // UPDRAFT_SRC_LIBRARIES_UTIL_UTIL_H_
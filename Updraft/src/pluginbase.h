@@ -59,6 +59,31 @@ class PluginBase {
   virtual bool fileOpen(const QString &filename, int roleId) {
     return false; }
 
+  /// Callback to open several files with the same role at once.
+  /// Plugins that can load files in parallel should override this,
+  /// the default implementation calls fileOpen() for every file.
+  /// \return Was opening of all files successful?
+  /// \param filenames full paths to the files
+  /// \param roleId identification of role being opened
+  virtual bool filesOpen(const QStringList &filenames, int roleId) {
+    bool ret = true;
+    foreach(QString filename, filenames) {
+      if (!fileOpen(filename, roleId)) {
+        ret = false;
+      }
+    }
+    return ret;
+  }
+
+  /// Callback to describe a file before it is opened.
+  /// The description is shown to the user when choosing how to open the
+  /// file, so it should be fast and must not load the whole file.
+  /// \param roles Lines of the description are appended here.
+  /// \param importDirectory Unused, may be NULL.
+  /// \param filename full path to a file
+  virtual void fileIdentification(QStringList *roles,
+    QString *importDirectory, const QString &filename) {}
+
   /// Callback asking the plugin if closing all files is Ok.
   /// The plug-in may display a dialog box and ask the user.
   /// \return true if this plugin has no objections to closing the application.
@@ -1,5 +1,6 @@
 #include "airspaces.h"
 
+#include "util/util.h"
 
 namespace Updraft {
 namespace Airspaces {
@@ -9,6 +10,10 @@ namespace Airspaces {
 
 Airspaces::Airspaces() {
   mapLayerGroup = NULL;
+  demDirectorySetting = NULL;
+  dem = NULL;
+  cacheSetting = NULL;
+  cache = NULL;
 }
 
 QString Airspaces::getName() {
@@ -28,6 +33,40 @@ void Airspaces::initialize(CoreInterface *coreInterface) {
   OAirspaceFileReg.plugin = this;
   g_core->registerFiletype(OAirspaceFileReg);
 
+  // Compressed files are imported as they are and decompressed on loading.
+  foreach(QString suffix, Util::DecompressingDevice::suffixes()) {
+    FileRegistration compressed(OAirspaceFileReg);
+    compressed.extension += suffix;
+    g_core->registerFiletype(compressed);
+  }
+
+  // Offline terrain for the ground level of the airspaces,
+  // the elevation manager of the map is used if it is not set.
+  demDirectorySetting = g_core->addSetting(
+    OpenAirspace::DEM_DIRECTORY_SETTING,
+    tr("Directory with offline elevation tiles (HGT, GeoTIFF)"),
+    QVariant(QString()),
+    GROUP_ADVANCED);
+  demDirectorySetting->setNeedsRestart(true);
+
+  QString demDirectory = demDirectorySetting->get().toString();
+  if (!demDirectory.isEmpty() && QDir(demDirectory).exists()) {
+    dem = new Dem::Sampler(demDirectory);
+  }
+
+  cacheSetting = g_core->addSetting(
+    "airspaces:cache",
+    tr("Cache tessellated airspaces"),
+    QVariant(true),
+    GROUP_ADVANCED);
+  cacheSetting->setNeedsRestart(true);
+
+  if (cacheSetting->get().toBool()) {
+    QDir dir = g_core->getDataDirectory();
+    cache = new OpenAirspace::AirspaceCache(
+      dir.absoluteFilePath(OpenAirspace::CACHE_DIRECTORY));
+  }
+
   // Create map layers items in the left pane.
   mapLayerGroup = g_core->createMapLayerGroup(tr("Airspace"));
   mapLayerGroup->setId("airspaces");
@@ -52,41 +91,66 @@ void Airspaces::deinitialize() {
     delete mapLayerGroup;
     mapLayerGroup = NULL;
   }
+  delete dem;
+  dem = NULL;
+  delete cache;
+  cache = NULL;
+  delete cacheSetting;
+  cacheSetting = NULL;
+  delete demDirectorySetting;
+  demDirectorySetting = NULL;
   qDebug("airspaces unloaded");
 }
 
 bool Airspaces::fileOpen(const QString& fileName, int role) {
   switch (role) {
-    case IMPORT_OPENAIRSPACE_FILE:
-      oaEngine* engine = new oaEngine(mapLayerGroup, g_core);
+    case IMPORT_OPENAIRSPACE_FILE: {
+      OpenAirspace::CompiledAirspaces compiled;
+      if (!compiled.table.Load(fileName)) return false;
 
-      mapNodes = engine->Draw(fileName);
-      if (!mapNodes) return false;
+      oaEngine engine(mapLayerGroup, g_core, dem);
+      engine.Compile(&compiled);
+      if (cache)
+        cache->Store(fileName, engine.CacheIdentity(), compiled);
 
-      QFileInfo fileInfo(fileName);
-      MapLayerGroupInterface* fileGroup =
-        mapLayerGroup->createMapLayerGroup(fileInfo.fileName());
-      fileGroup->connectCheckedToVisibility();
-      fileGroup->connectSignalContextMenuRequested(this,
-        SLOT(contextMenuRequested(QPoint, MapLayerInterface*)));
-      fileGroup->setFilePath(fileName);
-
-      QPair<osg::Node*, QString> pair;
-      foreach(pair, *mapNodes) {
-        MapLayerInterface *layer =
-          fileGroup->createMapLayer(pair.first, pair.second);
-        layer->connectCheckedToVisibility();
-      }
+      return addAirspaces(fileName, compiled);
+      break;
+    }
+  }
+  return false;
+}
 
-      delete mapNodes;
+bool Airspaces::addAirspaces(const QString& fileName,
+  const OpenAirspace::CompiledAirspaces& compiled) {
+  oaEngine* engine = new oaEngine(mapLayerGroup, g_core, dem);
 
-      delete engine;
-      engine = NULL;
+  mapNodes = engine->Draw(compiled, fileName);
+  if (!mapNodes) {
+    delete engine;
+    return false;
+  }
 
-      return true;
-      break;
+  QFileInfo fileInfo(fileName);
+  MapLayerGroupInterface* fileGroup =
+    mapLayerGroup->createMapLayerGroup(fileInfo.fileName());
+  fileGroup->connectCheckedToVisibility();
+  fileGroup->connectSignalContextMenuRequested(this,
+    SLOT(contextMenuRequested(QPoint, MapLayerInterface*)));
+  fileGroup->setFilePath(fileName);
+
+  QPair<osg::Node*, QString> pair;
+  foreach(pair, *mapNodes) {
+    MapLayerInterface *layer =
+      fileGroup->createMapLayer(pair.first, pair.second);
+    layer->connectCheckedToVisibility();
   }
-  return false;
+
+  delete mapNodes;
+
+  delete engine;
+  engine = NULL;
+
+  return true;
 }
 
 void Airspaces::loadImportedFiles() {
@@ -96,10 +160,44 @@ void Airspaces::loadImportedFiles() {
   }
 
   QStringList filters("*" + OAirspaceFileReg.extension);
+  foreach(QString suffix, Util::DecompressingDevice::suffixes()) {
+    filters.append("*" + OAirspaceFileReg.extension + suffix);
+  }
   QStringList entries = dir.entryList(filters, QDir::Files, QDir::Time);
 
+  QStringList paths;
   foreach(QString fileName, entries) {
-    fileOpen(dir.absoluteFilePath(fileName), OAirspaceFileReg.roleId);
+    paths.append(dir.absoluteFilePath(fileName));
+  }
+
+  // Take the compiled airspaces from the cache where possible
+  oaEngine engine(mapLayerGroup, g_core, dem);
+  QString identity = engine.CacheIdentity();
+  QVector<OpenAirspace::CompiledAirspaces> compiled(paths.size());
+  QStringList missing;
+  QVector<int> missingIndices;
+  for (int i = 0; i < paths.size(); ++i) {
+    if (!cache || !cache->Load(paths[i], identity, &compiled[i])) {
+      missing.append(paths[i]);
+      missingIndices.append(i);
+    }
+  }
+
+  // Parse the rest of the files concurrently and compile them
+  QVector<OpenAirspace::AirspaceTable> tables =
+    OpenAirspace::AirspaceTable::LoadFiles(missing);
+  for (int i = 0; i < missing.size(); ++i) {
+    OpenAirspace::CompiledAirspaces& c = compiled[missingIndices[i]];
+    c.table = tables[i];
+    tables[i].Clear();
+    engine.Compile(&c);
+    if (cache && c.table.size())
+      cache->Store(missing[i], identity, c);
+  }
+
+  // Draw them one by one
+  for (int i = 0; i < paths.size(); ++i) {
+    addAirspaces(paths[i], compiled[i]);
   }
 }
 
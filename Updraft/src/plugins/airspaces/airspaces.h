@@ -54,6 +54,13 @@ class Q_DECL_EXPORT Airspaces: public QObject, public PluginBase {
     IMPORT_OPENAIRSPACE_FILE = 0
   };
 
+  /// Draws the compiled airspaces and adds them to the map.
+  /// \param fileName The file the airspaces come from.
+  /// \param compiled The airspaces with their outlines.
+  /// \return false if there is nothing to draw.
+  bool addAirspaces(const QString& fileName,
+    const OpenAirspace::CompiledAirspaces& compiled);
+
   /// Registration for loading Airspaces from OpenAirspace file.
   FileRegistration OAirspaceFileReg;
 
@@ -62,6 +69,18 @@ class Q_DECL_EXPORT Airspaces: public QObject, public PluginBase {
 
   /// Map layers.
   MapLayerGroupInterface* mapLayerGroup;
+
+  /// Directory with offline elevation tiles.
+  SettingInterface* demDirectorySetting;
+
+  /// Offline elevation tiles, NULL if the directory is not set.
+  Dem::Sampler* dem;
+
+  /// Whether the compiled airspaces are cached.
+  SettingInterface* cacheSetting;
+
+  /// Cache of the compiled airspaces, NULL if it is disabled.
+  OpenAirspace::AirspaceCache* cache;
 };
 
 }  // End namespace Airspaces
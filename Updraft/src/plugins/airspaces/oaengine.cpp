@@ -1,4 +1,7 @@
 #include "oaengine.h"
+
+#include <float.h>
+
 #include "../../core/maplayer.h"
 
 namespace Updraft {
@@ -8,8 +11,9 @@ namespace Airspaces {
   // CoreInterface *g_core = NULL;
 
 oaEngine::oaEngine(MapLayerGroupInterface* LG,
-  CoreInterface* g_core) {
+  CoreInterface* g_core, const Dem::Sampler* dem) {
   this->mapLayerGroup = LG;
+  this->dem = dem;
 
   // some defaults
   // Turn this on to compute the terrain elevation
@@ -41,10 +45,19 @@ oaEngine::oaEngine(MapLayerGroupInterface* LG,
   // init
   heightRefPoint  = NULL;
   mapLayers       = NULL;
+  OAGroup         = NULL;
   OAGeode         = NULL;
 
   // Init the elevation manager
   elevationMan = g_core->getElevationManager();
+  elevationId = g_core->getElevationId();
+
+  // Init the geodesic geometry
+  outlines = new OpenAirspace::OutlineTessellator(LOD_TOLERANCE[0]);
+}
+
+oaEngine::~oaEngine() {
+  delete outlines;
 }
 
 QVector<MapLayerInterface*>* oaEngine::DrawII(const QString& fileName) {
@@ -61,15 +74,127 @@ QVector<MapLayerInterface*>* oaEngine::DrawII(const QString& fileName) {
 }
 
 QVector<QPair<osg::Node*, QString> >* oaEngine::Draw(const QString& fileName) {
+  // Parse the file
+  OpenAirspace::AirspaceTable table;
+  if (!table.Load(fileName)) return NULL;
+
+  return Draw(table, fileName);
+}
+
+QVector<QPair<osg::Node*, QString> >* oaEngine::Draw(
+  const OpenAirspace::AirspaceTable& table, const QString& fileName) {
+  OpenAirspace::CompiledAirspaces compiled;
+  compiled.table = table;
+  Compile(&compiled);
+
+  return Draw(compiled, fileName);
+}
+
+QString oaEngine::CacheIdentity() const {
+  QStringList tolerances;
+  for (int l = 0; l < LOD_COUNT; ++l)
+    tolerances.append(QString::number(LOD_TOLERANCE[l]));
+
+  QString identity = QString("tolerance %1, resolution %2, pointwise %3, "
+    "underground %4, elevation %5").arg(tolerances.join(" ")).
+    arg(ELEV_TILE_RESOLUTION).arg(USE_POINTWISE_ELEVATION).
+    arg(DRAW_UNDERGROUND).arg(elevationId);
+  if (dem)
+    identity += ", dem " + dem->identity();
+  return identity;
+}
+
+void oaEngine::Compile(OpenAirspace::CompiledAirspaces* compiled) {
+  const OpenAirspace::AirspaceTable& table = compiled->table;
+  compiled->tolerances.clear();
+  compiled->outlineStart.clear();
+  compiled->vertices.clear();
+  compiled->ground.clear();
+  compiled->outlineStart.reserve(LOD_COUNT * table.size() + 1);
+  heightRefPoint = NULL;
+
+  for (int l = 0; l < LOD_COUNT; ++l)
+    compiled->tolerances.push_back(LOD_TOLERANCE[l]);
+  QVector<double> coarseTolerances = compiled->tolerances.mid(1);
+
+  // the levels of detail are stored one after another,
+  // see CompiledAirspaces, so they are collected separately first
+  QVector<QVector<qint32> > levelStart(LOD_COUNT);
+  QVector<QVector<Position> > levelVertices(LOD_COUNT);
+  QVector<QVector<double> > levelGround(LOD_COUNT);
+
+  for (int i = 0; i < table.size(); ++i) {
+    const OpenAirspace::AirspaceRecord& A = table.GetAirspace(i);
+    for (int l = 0; l < LOD_COUNT; ++l)
+      levelStart[l].push_back(levelVertices[l].size());
+    if (A.primitiveCount == 0)
+      continue;
+
+    // the closed outline to draw
+    QVector<Position> pointsWGS;
+    outlines->Tessellate(table, A, &pointsWGS);
+
+    // the centre of the first arc or circle
+    for (int j = 0; j < A.primitiveCount && !heightRefPoint; ++j) {
+      const OpenAirspace::Primitive& p =
+        table.GetPrimitive(A.firstPrimitive + j);
+      if (p.type != OpenAirspace::Primitive::POLYGON)
+        heightRefPoint = new Position(table.GetCoordinate(p.first));
+    }
+
+    // Sample the ground under the airspaces related to it
+    int floor, ceiling;
+    bool floorAgl, ceilingAgl;
+    GetHeights(A, &floor, &ceiling, &floorAgl, &ceilingAgl);
+
+    QVector<double> pointsGnd;
+    if (floorAgl || ceilingAgl) {
+      ComputeHeightData(heightRefPoint, table, A, &pointsWGS, &pointsGnd);
+    } else {
+      pointsGnd.fill(qQNaN(), pointsWGS.size());
+    }
+
+    delete heightRefPoint;
+    heightRefPoint = NULL;
+
+    levelVertices[0] += pointsWGS;
+    levelGround[0] += pointsGnd;
+
+    // the coarser levels are subsets of the finest outline,
+    // the ground under them is already sampled
+    QVector<QVector<int> > kept;
+    OpenAirspace::OutlineTessellator::Simplify(pointsWGS, coarseTolerances,
+      &kept);
+    for (int l = 1; l < LOD_COUNT; ++l) {
+      foreach(int k, kept[l - 1]) {
+        levelVertices[l].push_back(pointsWGS[k]);
+        levelGround[l].push_back(pointsGnd[k]);
+      }
+    }
+  }
+
+  for (int l = 0; l < LOD_COUNT; ++l) {
+    int levelOffset = compiled->vertices.size();
+    foreach(qint32 start, levelStart[l])
+      compiled->outlineStart.push_back(levelOffset + start);
+    compiled->vertices += levelVertices[l];
+    compiled->ground += levelGround[l];
+  }
+  compiled->outlineStart.push_back(compiled->vertices.size());
+}
+
+QVector<QPair<osg::Node*, QString> >* oaEngine::Draw(
+  const OpenAirspace::CompiledAirspaces& compiled, const QString& fileName) {
+  const OpenAirspace::AirspaceTable& table = compiled.table;
+
   // if valid maplayer proceed
   if (mapLayerGroup != NULL) {
-    // Parse the file
-    OpenAirspace::Parser AirspaceSet(fileName);
-    if (!AirspaceSet.size()) return NULL;
+    if (!table.size()) return NULL;
 
     // reset const
     heightRefPoint = NULL;
     mapLayers = NULL;
+    OAGroup = NULL;
     OAGeode = NULL;
 
     // set the defeault line width
@@ -90,183 +215,190 @@ QVector<QPair<osg::Node*, QString> >* oaEngine::Draw(const QString& fileName) {
 
     // Cycle through all the parsed airspaces
     // and draw the geometry
-    for (size_t i = 0; i < AirspaceSet.size(); ++i) {
+    for (int i = 0; i < table.size(); ++i) {
       // Process the Airspace
-      OpenAirspace::Airspace* A = AirspaceSet.at(i);
+      const OpenAirspace::AirspaceRecord& A = table.GetAirspace(i);
 
       // get the bundle of airspaces with the same name/class
-      QString aName = QString(A->GetClassName());
-      if (nameSuffix != aName) {
-        // if there is a geode initialized
+      const QString& aName = A.className;
+      if (!OAGroup || nameSuffix != aName) {
+        // if there is a group initialized
         // insert new into the array of layers
         // or find one of the same name
-        if (OAGeode)
-          PushLayer(OAGeode, nameSuffix);
+        if (OAGroup)
+          PushLayer(OAGroup, nameSuffix);
 
         // change the suffix to current one
         nameSuffix = aName;
 
         // try to find out if exists
-        OAGeode = FindLayer(nameSuffix);
+        OAGroup = FindLayer(nameSuffix);
 
         // if not found init the subscene
-        if (!OAGeode)
-          OAGeode = new osg::Geode();
+        if (!OAGroup)
+          OAGroup = new osg::Group();
       }
 
       // set the colour of the geometry if defined
       SetWidthAndColour(A);
 
       // Get the floor and ceiling of the airspace in ft msl
-      // set the height of the ground in ft msl
       // distinguish whether is the height value related to gnd level
-      bool floorAgl = false;
-      bool ceilingAgl = false;
-      // set the heights of the airspace in ft msl
-      int ceiling = A->ParseHeight(false, &ceilingAgl);
-      if (ceiling == 0) ceiling = ROOF;
-      int floor = A->ParseHeight(true, &floorAgl);
-      if (!DRAW_UNDERGROUND) {
-        if (floor == 0) floorAgl = true;
-      }
+      int floor, ceiling;
+      bool floorAgl, ceilingAgl;
+      GetHeights(A, &floor, &ceiling, &floorAgl, &ceilingAgl);
 
       // To destroy artefacts of two planes in one space
       double rnd = 0.05 * (qrand() % 100);
       floor += rnd;
       ceiling -= rnd;
 
-      // array of coords to draw
-      QVector<Position>* pointsWGS = new QVector<Position>();
-
-      // cycle through the geometry group
-      if (A->GetGeometrySize() > 0) {
-        for (int j = 0; j < A->GetGeometrySize(); ++j) {
-          // get the geometric primitive type
-          OpenAirspace::Geometry::GType gtype =
-            A->GetGeometry().at(j)->GetGType();
-
-          if  (gtype == OpenAirspace::Geometry::DPtype) {
-              OpenAirspace::Polygon* p =
-                (OpenAirspace::Polygon*)A->GetGeometry().at(j);
-              pointsWGS->push_back(p->Centre());
-          } else if (gtype == OpenAirspace::Geometry::DAtype) {
-              OpenAirspace::ArcI* aa =
-                (OpenAirspace::ArcI*)A->GetGeometry().at(j);
-              InsertArcI(*aa, pointsWGS);
-              if (!heightRefPoint)
-                heightRefPoint = new Position(aa->Centre());
-          } else if (gtype == OpenAirspace::Geometry::DCtype) {
-              OpenAirspace::Circle* c =
-                (OpenAirspace::Circle*)A->GetGeometry().at(j);
-              InsertCircle(*c, pointsWGS);
-              if (!heightRefPoint)
-                heightRefPoint = new Position(c->Centre());
-          } else if (gtype == OpenAirspace::Geometry::DBtype) {
-            OpenAirspace::ArcII* ab =
-              (OpenAirspace::ArcII*)A->GetGeometry().at(j);
-            InsertArcII(*ab, pointsWGS);
-            if (!heightRefPoint)
-                heightRefPoint = new Position(ab->Centre());
-          }
+      // the levels of detail are switched by the eye distance,
+      // each is drawn from where its chordal error is about a pixel
+      double visibleRange = VisibleRange(table, A);
+      int levels = compiled.tolerances.size();
+      osg::ref_ptr<osg::LOD> lod = new osg::LOD();
+      for (int l = 0; l < levels; ++l) {
+        float minRange = l == 0 ? 0 :
+          compiled.tolerances[l] * LOD_DISTANCE_PER_M;
+        float maxRange = l + 1 < levels ?
+          compiled.tolerances[l + 1] * LOD_DISTANCE_PER_M : FLT_MAX;
+        if (visibleRange >= 0) {
+          if (minRange >= visibleRange)
+            break;
+          maxRange = qMin(maxRange, static_cast<float>(visibleRange));
         }
 
-        // close the polygon if open :
-        if (pointsWGS) {
-          if ((pointsWGS->first().lat != pointsWGS->last().lat) ||
-            (pointsWGS->first().lon != pointsWGS->last().lon)) {
-            // qDebug("otevreny");
-            pointsWGS->push_back(pointsWGS->first());
-          }
-        }
+        // the compiled outline and the ground under it
+        int outline = compiled.Outline(l, i);
+        int start = compiled.outlineStart[outline];
+        int count = compiled.outlineStart[outline + 1] - start;
+        if (count == 0)
+          continue;
 
-        // Compute the height data
-        QVector<double>* pointsGnd = ComputeHeightData(
-          &floor, &ceiling, &floorAgl, &ceilingAgl,
-          heightRefPoint, A, pointsWGS);
+        QVector<Position> pointsWGS = compiled.vertices.mid(start, count);
+        QVector<double> pointsGnd = compiled.ground.mid(start, count);
 
         // Draw the geometry into the OpenGl Array
-        FillOGLArrays(pointsWGS, pointsGnd, floor, ceiling,
+        OAGeode = new osg::Geode();
+        FillOGLArrays(&pointsWGS, &pointsGnd, floor, ceiling,
           floorAgl, ceilingAgl);
+        lod->addChild(OAGeode, minRange, maxRange);
+      }
+      OAGeode = NULL;
 
-        delete pointsWGS;
-        pointsWGS = NULL;
-
-        delete heightRefPoint;
-        heightRefPoint = NULL;
-
-        if (pointsGnd) {
-          delete pointsGnd;
-          pointsGnd = NULL;
-        }
-      }  // cycle through geometry
+      if (lod->getNumChildren())
+        OAGroup->addChild(lod.get());
     }   // cycle through airspaces
 
-    if (OAGeode && OAGeode->getNumDrawables()) {
+    if (OAGroup && OAGroup->getNumChildren()) {
       // insert the created layer
-      PushLayer(OAGeode, nameSuffix);
+      PushLayer(OAGroup, nameSuffix);
     }
     return mapLayers;
   }
   return NULL;
 }
 
-QVector<double>* oaEngine::ComputeHeightData(
-  int* floor, int* ceiling,
-  bool* floorAgl, bool* ceilingAgl,
-  Position* heightRefPoint,
-  OpenAirspace::Airspace* A,
-  QVector<Position>* pointsWGS) {
+void oaEngine::GetHeights(const OpenAirspace::AirspaceRecord& A,
+  int* floor, int* ceiling, bool* floorAgl, bool* ceilingAgl) {
+  // set the heights of the airspace in ft msl
+  *ceiling = A.ceilingFt;
+  *ceilingAgl = A.ceilingAgl;
+  if (*ceiling == 0) *ceiling = ROOF;
+  *floor = A.floorFt;
+  *floorAgl = A.floorAgl;
+  if (!DRAW_UNDERGROUND) {
+    if (*floor == 0) *floorAgl = true;
+  }
+}
+
+void oaEngine::ComputeHeightData(
+  const Position* heightRefPoint,
+  const OpenAirspace::AirspaceTable& table,
+  const OpenAirspace::AirspaceRecord& A,
+  const QVector<Position>* pointsWGS,
+  QVector<double>* pointsGnd) {
   // Compute the ground level
-  QVector<double>* pointsGnd = NULL;
-  if (*floorAgl || *ceilingAgl) {
-    if (!heightRefPoint && A->GetGeometrySize() > 0) {
-      // compute the center of gravity
-      double sumLon = 0;
-      double sumLat = 0;
-      for (int m = 0; m < A->GetGeometrySize(); ++m) {
-        sumLon += A->GetGeometry().at(m)->Centre().lon;
-        sumLat += A->GetGeometry().at(m)->Centre().lat;
+  Position centre;
+  if (!heightRefPoint && A.primitiveCount > 0) {
+    // compute the center of gravity of the points and centres
+    double sumLon = 0;
+    double sumLat = 0;
+    int count = 0;
+    for (int m = 0; m < A.primitiveCount; ++m) {
+      const OpenAirspace::Primitive& p =
+        table.GetPrimitive(A.firstPrimitive + m);
+      int n = p.type == OpenAirspace::Primitive::POLYGON ? p.count : 1;
+      for (int k = 0; k < n; ++k) {
+        sumLon += table.GetCoordinate(p.first + k).lon;
+        sumLat += table.GetCoordinate(p.first + k).lat;
       }
-      sumLat /= A->GetGeometrySize();
-      sumLon /= A->GetGeometrySize();
-      heightRefPoint = new Position();
-      heightRefPoint->lat = sumLat;
-      heightRefPoint->lon = sumLon;
-      heightRefPoint->valid = true;
+      count += n;
     }
+    sumLat /= count;
+    sumLon /= count;
+    centre.lat = sumLat;
+    centre.lon = sumLon;
+    centre.valid = true;
+    heightRefPoint = &centre;
+  }
 
+  // Get the elevation data for whole airspace
+  // or for each and every point of the polygon
+  if (USE_POINTWISE_ELEVATION) {
+    GroundElevations(pointsWGS, pointsGnd);
+  } else {
     // use only one refpoint
-    double res = 0;
-    double addGnd;
+    pointsGnd->fill(GroundElevation(*heightRefPoint), pointsWGS->size());
+  }
+}
 
+double oaEngine::GroundElevation(const Position& point) {
+  double elevation;
+  if (!dem || !dem->elevation(point.lat, point.lon, &elevation)) {
     // query the elevation layer for the elev data
-    elevationMan->getElevation(
-        heightRefPoint->lon,
-        heightRefPoint->lat,
-        ELEV_TILE_RESOLUTION, 0,
-        addGnd, res);
-    if (addGnd < 0)
-      addGnd = 0;
-
-    // Get the elevation data for whole airspace
-    // or for each and every point of the polygon
-    if (USE_POINTWISE_ELEVATION) {
-      pointsGnd = new QVector<double>();
-      for (int k = 0; k < pointsWGS->size(); ++k) {
-        elevationMan->getElevation(
-          pointsWGS->at(k).lon,
-          pointsWGS->at(k).lat,
-          ELEV_TILE_RESOLUTION, 0, addGnd, res);
-        if (addGnd < 0)
-          addGnd = 0;
-        pointsGnd->push_back(addGnd);
-      }
-    } else {
-      if (*floorAgl) *floor += addGnd * M_TO_FT;
-      if (*ceilingAgl) *ceiling += addGnd * M_TO_FT;
+    double res = 0;
+    elevationMan->getElevation(point.lon, point.lat,
+      ELEV_TILE_RESOLUTION, 0, elevation, res);
+  }
+  if (elevation < 0)
+    elevation = 0;
+  return elevation;
+}
+
+void oaEngine::GroundElevations(const QVector<Position>* pointsWGS,
+  QVector<double>* pointsGnd) {
+  int count = pointsWGS->size();
+  pointsGnd->resize(count);
+
+  if (!dem) {
+    for (int k = 0; k < count; ++k) {
+      (*pointsGnd)[k] = GroundElevation(pointsWGS->at(k));
+    }
+    return;
+  }
+
+  QVector<double> lat(count);
+  QVector<double> lon(count);
+  for (int k = 0; k < count; ++k) {
+    lat[k] = pointsWGS->at(k).lat;
+    lon[k] = pointsWGS->at(k).lon;
+  }
+
+  // NaN marks the points without offline data.
+  double missing = qQNaN();
+  int found = dem->elevations(lat.constData(), lon.constData(), count,
+    pointsGnd->data(), missing);
+
+  for (int k = 0; k < count; ++k) {
+    double& elevation = (*pointsGnd)[k];
+    if (found < count && qIsNaN(elevation)) {
+      elevation = GroundElevation(pointsWGS->at(k));
+    } else if (elevation < 0) {
+      elevation = 0;
     }
   }
-  return pointsGnd;
 }
 
 void oaEngine::FillOGLArrays(
@@ -333,27 +465,41 @@ void oaEngine::FillOGLArrays(
   }
 }
 
-osg::Geode* oaEngine::FindLayer(const QString& name) {
+double oaEngine::VisibleRange(const OpenAirspace::AirspaceTable& table,
+  const OpenAirspace::AirspaceRecord& A) {
+  // the airspace is drawn as long as any of its elements is visible
+  double range = -1;
+  for (int j = 0; j < A.primitiveCount; ++j) {
+    const OpenAirspace::Primitive& p =
+      table.GetPrimitive(A.firstPrimitive + j);
+    if (p.zoom <= 0)
+      return -1;
+    range = qMax(range, p.zoom * ZOOM_TO_M);
+  }
+  return range;
+}
+
+osg::Group* oaEngine::FindLayer(const QString& name) {
   // find, remove from array and return the Node with name
-  osg::Geode* result = NULL;
+  osg::Group* result = NULL;
   if (!mapLayers) return NULL;
   QVector<QPair<osg::Node*, QString> >::iterator it;
   for (it = mapLayers->begin(); it < mapLayers->end(); ++it) {
     if ((*it).second == name) {
-      result = (osg::Geode*)(*it).first;
+      result = (osg::Group*)(*it).first;
       mapLayers->erase(it);
     }
   }
   return result;
 }
 
-void oaEngine::PushLayer(osg::Geode* OAGeode, const QString& displayName) {
+void oaEngine::PushLayer(osg::Group* OAGroup, const QString& displayName) {
   // change the thickness of the line
   osg::LineWidth* linewidth = new osg::LineWidth();
   linewidth->setWidth(width);
 
-  // set geode params
-  osg::StateSet* stateSet = OAGeode->getOrCreateStateSet();
+  // set group params
+  osg::StateSet* stateSet = OAGroup->getOrCreateStateSet();
   stateSet->setAttributeAndModes(linewidth,
     osg::StateAttribute::ON);
   stateSet->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
@@ -387,7 +533,7 @@ void oaEngine::PushLayer(osg::Geode* OAGeode, const QString& displayName) {
   while (it < mapLayers->end() && (*it).second < displayName)
     ++it;
 
-  mapLayers->insert(it, QPair<osg::Node*, QString>(OAGeode, displayName));
+  mapLayers->insert(it, QPair<osg::Node*, QString>(OAGroup, displayName));
 }
 
 osg::Geometry* oaEngine::DrawPolygon(
@@ -515,98 +661,6 @@ osg::Geometry* oaEngine::DrawPolygonSides(const QVector<Position>* pointsWGS,
   return geom;
 }
 
-double oaEngine::DistToAngle(double dInNauticalMiles) {
-  double dInMeters = NM_TO_M * dInNauticalMiles;
-  double angleRad = asin(dInMeters/EARTH_RADIUS_IN_METERS);
-  double angleDeg = angleRad * RAD_TO_DEG;
-  return angleDeg;
-}
-
-double oaEngine::ArcInRadians(const Position& from, const Position& to) {
-  double latitudeArc  = (from.lat - to.lat) * DEG_TO_RAD;
-  double longitudeArc = (from.lon - to.lon) * DEG_TO_RAD;
-  double latitudeH = sin(latitudeArc * 0.5);
-  latitudeH *= latitudeH;
-  double lontitudeH = sin(longitudeArc * 0.5);
-  lontitudeH *= lontitudeH;
-  double tmp = cos(from.lat*DEG_TO_RAD) * cos(to.lat*DEG_TO_RAD);
-  return 2.0 * asin(sqrt(latitudeH + tmp*lontitudeH));
-}
-
-double oaEngine::DistanceInMeters(const Position& from, const Position& to) {
-  return EARTH_RADIUS_IN_METERS*ArcInRadians(from, to);
-}
-
-void oaEngine::InsertArcI(const OpenAirspace::ArcI& aa,
-  QVector<Position>* vertexList) {
-  // init
-  const Position centre = aa.Centre();
-  const double fromAngle = aa.Start() * DEG_TO_RAD;
-  const double toAngle = aa.End() * DEG_TO_RAD;
-  const bool cw = aa.CW();
-  const double r = DistToAngle(aa.R());
-
-  // insert the Arc
-  InsertMidArc(centre, fromAngle, toAngle, cw, r, vertexList);
-}
-void oaEngine::InsertArcII(const OpenAirspace::ArcII& ab,
-  QVector<Position>* vertexList) {
-  // init:
-  const Position centre = ab.Centre();
-  const Position start = ab.Start();
-  const Position end = ab.End();
-  const bool cw = ab.CW();
-
-  // compute the radius as mean of two distances (start/end to centre)
-  double r = (DistToAngle(DistanceInMeters(start, centre) * M_TO_NM)
-    + DistToAngle(DistanceInMeters(end, centre) * M_TO_NM)) * 0.5;
-
-  // compute the angle of the arc
-  double a1 = AngleRad(centre, start);
-  double a2 = AngleRad(centre, end);
-
-  // insert arc points coordinates
-  // insert start
-  // vertexList->push_back(ab.Start());
-  vertexList->push_back(ComputeArcPoint(centre, r, a1));
-
-  // mid points
-  InsertMidArc(centre, a1, a2, cw, r, vertexList);
-
-  // insert end
-  vertexList->push_back(ComputeArcPoint(centre, r, a2));
-}
-
-void oaEngine::InsertCircle(const OpenAirspace::Circle &cc,
-  QVector<Position>* vertexList) {
-  const double r = DistToAngle(cc.R());
-  for (double k = 0; k < M_2PI; k += ARC_GRANULARITY) {
-    vertexList->push_back(ComputeArcPoint(cc.Centre(), r, k));
-  }
-  // close the loop
-  vertexList->push_back(ComputeArcPoint(cc.Centre(), r, 0));
-}
-
-void oaEngine::InsertMidArc(const Position& centre, double from,
-  double to, const bool cw, const double& r,
-  QVector<Position>* vertexList) {
-  if (cw) {
-    if (to < from) to += M_2PI;
-    for (double angle = from + ARC_GRANULARITY; angle < to;
-      angle += ARC_GRANULARITY) {
-      Position arcPoint = ComputeArcPoint(centre, r, angle);
-      vertexList->push_back(arcPoint);
-    }
-  } else {
-    if (from < to) from += M_2PI;
-    for (double angle = from - ARC_GRANULARITY; angle > to;
-      angle -= ARC_GRANULARITY) {
-      Position arcPoint = ComputeArcPoint(centre, r, angle);
-      vertexList->push_back(arcPoint);
-    }
-  }
-}
-
 double oaEngine::AngleRad(const Position& centre, const Position& point) {
   double lat = point.lat - centre.lat;
   double lon = (point.lon - centre.lon)*cos(point.lat*DEG_TO_RAD);
@@ -615,31 +669,21 @@ double oaEngine::AngleRad(const Position& centre, const Position& point) {
   return a;
 }
 
-Position oaEngine::ComputeArcPoint(const Position& centre, double r,
-  double partAngle) {
-  double lon = sin(partAngle) * r;
-  double lat = cos(partAngle) * r;
-  Position result;
-  result.lat = centre.lat + lat;
-  result.lon = centre.lon + lon / cos(result.lat*DEG_TO_RAD);
-  return result;
-}
-
-void oaEngine::SetWidthAndColour(const OpenAirspace::Airspace* A) {
-  if (A->GetBrush()) {
-    float r = A->GetBrush()->R/255.0f;
-    float g = A->GetBrush()->G/255.0f;
-    float b = A->GetBrush()->B/255.0f;
+void oaEngine::SetWidthAndColour(const OpenAirspace::AirspaceRecord& A) {
+  if (A.hasBrush) {
+    float r = A.brush.R/255.0f;
+    float g = A.brush.G/255.0f;
+    float b = A.brush.B/255.0f;
     if ( r >= 0 && g >= 0 && b >= 0)
       col.set(r, g, b, col.w());
   }
-  if (A->GetPen()) {
-    float r = A->GetPen()->R/255.0f;
-    float g = A->GetPen()->G/255.0f;
-    float b = A->GetPen()->B/255.0f;
+  if (A.hasPen) {
+    float r = A.pen.R/255.0f;
+    float g = A.pen.G/255.0f;
+    float b = A.pen.B/255.0f;
     if ( r >= 0 && g >= 0 && b >= 0)
       col.set(r, g, b, col.w());
-    this->width = A->GetPen()->width;
+    this->width = A.pen.width;
   }
 }
 
@@ -9,14 +9,19 @@
 #include <osg/PositionAttitudeTransform>
 #include <osg/Geometry>
 #include <osg/Depth>
+#include <osg/LOD>
 #include <QString>
 #include <QtGui>
 #include <osgEarthUtil/ElevationManager>
 
 #include "../../pluginbase.h"
 #include "../../libraries/openairspace/openairspace.h"
+#include "../../libraries/openairspace/airspacecache.h"
+#include "../../libraries/openairspace/outlinetessellator.h"
+#include "../../libraries/dem/sampler.h"
 #include "../../maplayerinterface.h"
 #include "../../core/maplayer.h"
+#include "util/util.h"
 
 
 
@@ -39,14 +44,25 @@ static const double M_TO_NM = 1./1852;
 static const double FT_TO_M = 0.3048;
 static const double M_TO_FT = 1/0.3048;
 
-/// Earth's quatratic mean radius for WGS-84
-static const double EARTH_RADIUS_IN_METERS = 6372797.560856;
-
 /// 2pi
 static const double M_2PI = 2*M_PI;
 
-/// airspace arcs granularity
-static const double ARC_GRANULARITY = 0.05;
+/// Number of the levels of detail of the airspace outlines
+static const int LOD_COUNT = 3;
+
+/// Maximal distance of the outlines from the true ones in m
+/// for each level of detail, the finest first. The finest level
+/// is the tessellation, the coarser ones are simplified from it.
+static const double LOD_TOLERANCE[LOD_COUNT] =
+  {OpenAirspace::ARC_TOLERANCE, 50.0, 500.0};
+
+/// Eye distance per metre of the tolerance from which a level is drawn,
+/// the chordal error then stays around a pixel
+static const double LOD_DISTANCE_PER_M = 1000.0;
+
+/// The V Z= zoom level is taken as the map scale in km,
+/// the element is drawn up to the eye distance of the same km
+static const double ZOOM_TO_M = 1000.0;
 
 /// Default line trnsparency
 static const float DEFAULT_TRANSPARENCY = 0.1f;
@@ -62,7 +78,11 @@ class oaEngine {
   /// Class constructor.
   /// \param LG The map pointer.
   /// \param g_core The core pointer.
-  oaEngine(MapLayerGroupInterface* LG, CoreInterface* g_core);
+  /// \param dem Offline elevation tiles used instead of the elevation
+  /// manager, can be NULL.
+  oaEngine(MapLayerGroupInterface* LG, CoreInterface* g_core,
+    const Dem::Sampler* dem = NULL);
+  ~oaEngine();
 
   /// The main airspace drawing routine.
   /// This routine calls the OpenAir parser and
@@ -73,6 +93,30 @@ class oaEngine {
   /// \return The array of nodes to be drawn.
   QVector<QPair<osg::Node*, QString> > * Draw(const QString& fileName);
 
+  /// Creates the geometry of already parsed airspaces.
+  /// \param table The parsed airspaces.
+  /// \param fileName The name of the file the airspaces come from.
+  /// \return The array of nodes to be drawn.
+  QVector<QPair<osg::Node*, QString> > * Draw(
+    const OpenAirspace::AirspaceTable& table, const QString& fileName);
+
+  /// Creates the geometry of compiled airspaces.
+  /// \param compiled The airspaces with their outlines, see Compile().
+  /// \param fileName The name of the file the airspaces come from.
+  /// \return The array of nodes to be drawn.
+  QVector<QPair<osg::Node*, QString> > * Draw(
+    const OpenAirspace::CompiledAirspaces& compiled, const QString& fileName);
+
+  /// Tessellates the outlines of the airspaces in compiled->table
+  /// at all levels of detail and samples the ground under
+  /// the airspaces related to it. The ground is only sampled
+  /// at the finest level, the coarser ones take it over.
+  void Compile(OpenAirspace::CompiledAirspaces* compiled);
+
+  /// Identification of the tessellation settings and the elevation
+  /// data used by Compile(), compiled airspaces are cached under it.
+  QString CacheIdentity() const;
+
   /// Airspace drawing routines.
   /// The same as the draw(), but returns the map layers.
   /// \return The array of map layers.
@@ -85,12 +129,21 @@ class oaEngine {
   /// The tree items.
   QVector<QTreeWidgetItem*> treeItems;
 
+  /// The layer of the current airspace class.
+  osg::Group* OAGroup;
+
   /// The osg node, to which the geometry os added.
   osg::Geode* OAGeode;
 
   /// The elevation manager for height data queries.
   osgEarth::Util::ElevationManager* elevationMan;
 
+  /// Offline elevation tiles, NULL if the elevation manager is used.
+  const Dem::Sampler* dem;
+
+  /// Identification of the elevation data of the elevation manager.
+  QString elevationId;
+
   /// Map Layers.
   QVector<QPair<osg::Node*, QString> > * mapLayers;
 
@@ -106,6 +159,10 @@ class oaEngine {
   /// where to take height
   Position* heightRefPoint;
 
+  /// Generates the geodesic arcs and circles of the outlines
+  /// at the finest level of detail
+  OpenAirspace::OutlineTessellator* outlines;
+
   /// Engine settings
   /// settings of how the drawing engine behaves
   /// Turn this on to read elevation data for each
@@ -143,18 +200,35 @@ class oaEngine {
   int ROOF;
 
 
-  /// Compute the height for given geometry.
-  /// \param floor The AS floor elevation.
-  /// \param ceiling The AS ceiling elevation.
+  /// Get the floor and ceiling to draw.
+  /// \param floor The AS floor elevation in ft.
+  /// \param ceiling The AS ceiling elevation in ft.
   /// \param floorAgl The flag telling if the height
   /// value is above the ground level or absolute.
   /// \param ceilingAgl See the floorAgl.
-  QVector<double>* ComputeHeightData(
-  int* floor, int* ceiling,
-  bool* floorAgl, bool* ceilingAgl,
-  Position* heightRefPoint,
-  OpenAirspace::Airspace* A,
-  QVector<Position>* pointsWGS);
+  void GetHeights(const OpenAirspace::AirspaceRecord& A,
+    int* floor, int* ceiling, bool* floorAgl, bool* ceilingAgl);
+
+  /// Compute the ground level for given geometry.
+  /// \param heightRefPoint The point to take the height of the whole
+  /// airspace at, the centre of the points is used if NULL.
+  /// \param pointsGnd Ground elevation in m under every point.
+  void ComputeHeightData(
+  const Position* heightRefPoint,
+  const OpenAirspace::AirspaceTable& table,
+  const OpenAirspace::AirspaceRecord& A,
+  const QVector<Position>* pointsWGS,
+  QVector<double>* pointsGnd);
+
+  /// Ground elevation in meters of a single point.
+  /// Uses the offline tiles if available, the elevation manager otherwise.
+  double GroundElevation(const Position& point);
+
+  /// Ground elevations in meters of all the polygon points.
+  /// The offline tiles are queried in one batch, points not covered by them
+  /// are queried from the elevation manager.
+  void GroundElevations(const QVector<Position>* pointsWGS,
+    QVector<double>* pointsGnd);
 
   /// Fill the OpenGL vertex arrays
   void FillOGLArrays(
@@ -163,11 +237,17 @@ class oaEngine {
   int floor, int ceiling,
   bool floorAgl, bool ceilingAgl);
 
+  /// Eye distance up to which the airspace is drawn
+  /// \return The distance in m given by the V Z= zoom of its elements,
+  /// or -1 if it is not limited.
+  double VisibleRange(const OpenAirspace::AirspaceTable& table,
+    const OpenAirspace::AirspaceRecord& A);
+
   /// Find the layer of particular name in Layer Group
-  osg::Geode* FindLayer(const QString& name);
+  osg::Group* FindLayer(const QString& name);
 
   /// Insert the geometry Layer into the array
-  void PushLayer(osg::Geode* geode, const QString& displayName);
+  void PushLayer(osg::Group* group, const QString& displayName);
 
   /// Draw polygon
   osg::Geometry* DrawPolygon(
@@ -186,30 +266,6 @@ class oaEngine {
     const int floor, const int ceiling,
     const bool floorAgl, const bool ceilingAgl);
 
-  /// compute the WGS angle given the distance in nm
-  double DistToAngle(double dist);
-
-  /// Compute the arc between two WGS coords
-  double ArcInRadians(const Position& from, const Position& to);
-
-  /// Compute the distance between two WGS coords
-  double DistanceInMeters(const Position& from, const Position& to);
-
-  /// Insert Arc into the OGL vertex array
-  void InsertArcI(const OpenAirspace::ArcI& aa,
-    QVector<Position>* vertexList);
-  void InsertArcII(const OpenAirspace::ArcII& aa,
-    QVector<Position>* vertexList);
-  // void InsertArcII(const Position& centre, const Position& start,
-  //   const Position& end, bool cw, QVector<Position>* vertexList);
-  void InsertCircle(const OpenAirspace::Circle& cc,
-    QVector<Position>* vertexList);
-
-  /// Insert middle of the arc - angles from/to in rads, r in degs, pos WGS
-  void InsertMidArc(const Position& centre, double from,
-    double to, const bool cw, const double& r,
-    QVector<Position>* vertexList);
-
   /// compute the circular coord angle given centre and point on circ 0 ontop
   /// return (-pi, +pi)
   double AngleRad(const Position& centre, const Position& point);
@@ -218,12 +274,10 @@ class oaEngine {
   /// return (0, 2pi)
   double AngleRadPos(const Position& centre, const Position& point);
 
-  /// Compute the point for given angle, centre and radius
-  Position ComputeArcPoint(const Position& centre, double r, double partAngle);
   // double Dot(const osg::Vec2d&, const osg::Vec2d&);
 
   /// Set the colour and width of the line if possible
-  void SetWidthAndColour(const OpenAirspace::Airspace* A);
+  void SetWidthAndColour(const OpenAirspace::AirspaceRecord& A);
 
   /// Get the orientation for given array of closed poly points
   bool IsPolyOrientationCW(QVector<Position>* pointsWGS);
@@ -0,0 +1,327 @@
+#include "airspacecheck.h"
+
+#include <qnumeric.h>
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QtAlgorithms>
+
+#include "dem/sampler.h"
+#include "trackdata.h"
+#include "util/util.h"
+
+namespace Updraft {
+namespace IgcViewer {
+
+/// Return true if flying into the airspace class is an infringement.
+static bool isChecked(OpenAirspace::Airspace::ACType type) {
+  return type == OpenAirspace::Airspace::R ||
+    type == OpenAirspace::Airspace::Q ||
+    type == OpenAirspace::Airspace::P ||
+    type == OpenAirspace::Airspace::CTR;
+}
+
+static bool entryLess(const Infringement &a, const Infringement &b) {
+  return a.entry < b.entry;
+}
+
+static bool firstFixLess(const AirspaceSection &a, const AirspaceSection &b) {
+  return a.firstFix < b.firstFix;
+}
+
+/// Runnable that checks a single flight.
+class AirspaceChecker::Task : public QRunnable {
+ public:
+  Task(AirspaceChecker *checker, const QString &path,
+    const QVector<OpenAirspace::Fix> &fixes, const QVector<qint64> &msecs)
+    : checker(checker), path(path), fixes(fixes), msecs(msecs) {}
+
+  void run() {
+    Result result;
+    result.path = path;
+    checker->find(fixes, msecs, &result.infringements, &result.sections);
+    checker->complete(result);
+  }
+
+ private:
+  AirspaceChecker *checker;
+  QString path;
+  QVector<OpenAirspace::Fix> fixes;
+  QVector<qint64> msecs;
+};
+
+AirspaceChecker::AirspaceChecker(const QDir &directory,
+  const QDir &cacheDirectory, const QString &demDirectory, QObject *parent)
+  : QObject(parent), directory(directory), cacheDirectory(cacheDirectory),
+  demDirectory(demDirectory), loaded(false), dem(NULL) {
+}
+
+AirspaceChecker::~AirspaceChecker() {
+  pool.waitForDone();
+
+  foreach(OpenAirspace::AirspaceIndex* index, indices) {
+    delete index;
+  }
+  delete dem;
+}
+
+void AirspaceChecker::check(const QString &path, const TrackData &track) {
+  // Copy the columns of the track, it belongs to the GUI thread.
+  bool hasPressure = false;
+  for (int i = 0; i < track.count() && !hasPressure; ++i) {
+    hasPressure = track.pressureAlt(i) != 0;
+  }
+
+  QVector<OpenAirspace::Fix> fixes(track.count());
+  QVector<qint64> msecs(track.count());
+  for (int i = 0; i < track.count(); ++i) {
+    Util::Location location = track.location(i);
+    fixes[i].lat = location.lat;
+    fixes[i].lon = location.lon;
+    fixes[i].altitude = track.alt(i);
+    fixes[i].pressureAltitude =
+      hasPressure ? track.pressureAlt(i) : qQNaN();
+    msecs[i] = track.timeline().at(i);
+  }
+
+  pool.start(new Task(this, path, fixes, msecs));
+}
+
+void AirspaceChecker::load() {
+  QMutexLocker lock(&loadMutex);
+  if (loaded) {
+    return;
+  }
+  loaded = true;
+
+  if (!demDirectory.isEmpty() && QDir(demDirectory).exists()) {
+    dem = new Dem::Sampler(demDirectory);
+  }
+
+  QStringList filters("*.txt");
+  foreach(QString suffix, Util::DecompressingDevice::suffixes()) {
+    filters.append("*.txt" + suffix);
+  }
+  QStringList paths;
+  foreach(QString fileName, directory.entryList(filters, QDir::Files)) {
+    paths.append(directory.absoluteFilePath(fileName));
+  }
+
+  // Outlines compiled by the airspaces plugin are taken from its cache,
+  // the ground elevations in it are not needed.
+  QVector<OpenAirspace::CompiledAirspaces> compiled(paths.count());
+  QStringList missing;
+  QVector<int> missingIndices;
+  if (cacheDirectory.exists()) {
+    OpenAirspace::AirspaceCache cache(cacheDirectory);
+    for (int i = 0; i < paths.count(); ++i) {
+      if (!cache.Load(paths[i], QString(), &compiled[i])) {
+        missing.append(paths[i]);
+        missingIndices.append(i);
+      }
+    }
+  } else {
+    missing = paths;
+    for (int i = 0; i < paths.count(); ++i) {
+      missingIndices.append(i);
+    }
+  }
+
+  QVector<OpenAirspace::AirspaceTable> tables =
+    OpenAirspace::AirspaceTable::LoadFiles(missing);
+  for (int i = 0; i < missing.count(); ++i) {
+    compiled[missingIndices[i]].table = tables[i];
+  }
+  tables.clear();
+
+  foreach(const OpenAirspace::CompiledAirspaces &c, compiled) {
+    const OpenAirspace::AirspaceTable &table = c.table;
+    if (table.size() == 0) {
+      continue;
+    }
+
+    OpenAirspace::AirspaceIndex* index = new OpenAirspace::AirspaceIndex();
+    if (c.outlineStart.isEmpty()) {
+      index->Build(table, OpenAirspace::ARC_TOLERANCE);
+    } else {
+      // The finest level of detail comes first.
+      index->Build(table, c.outlineStart,
+        c.vertices.mid(0, c.outlineStart[table.size()]));
+    }
+    index->SetTerrain(dem);
+    indices.append(index);
+  }
+
+  qDebug() << "Airspaces for checking flights loaded from" <<
+    paths.count() << "files," << paths.count() - missing.count() <<
+    "of them from the cache";
+}
+
+void AirspaceChecker::find(const QVector<OpenAirspace::Fix> &fixes,
+  const QVector<qint64> &msecs, QList<Infringement> *infringements,
+  QList<AirspaceSection> *sections) {
+  load();
+
+  infringements->clear();
+  sections->clear();
+  foreach(const OpenAirspace::AirspaceIndex* index, indices) {
+    find(*index, fixes, msecs, infringements);
+    findSections(*index, fixes, sections);
+  }
+  qStableSort(infringements->begin(), infringements->end(), entryLess);
+  qStableSort(sections->begin(), sections->end(), firstFixLess);
+}
+
+void AirspaceChecker::find(const OpenAirspace::AirspaceIndex &index,
+  const QVector<OpenAirspace::Fix> &fixes, const QVector<qint64> &msecs,
+  QList<Infringement> *result) const {
+  if (fixes.isEmpty()) {
+    return;
+  }
+
+  // The flights are checked in parallel, so one thread per flight.
+  QVector<OpenAirspace::Hit> hits;
+  index.Query(fixes.constData(), fixes.count(), &hits, 1);
+
+  // Sweep the fixes with the airspaces containing them.
+  // Entries and exits are looked up on the segment where they happened.
+  QMap<int, Infringement> open;
+  QVector<int> previous;
+  QVector<int> current;
+  QVector<OpenAirspace::Crossing> crossings;
+  int h = 0;
+  for (int j = 0; j <= fixes.count(); ++j) {
+    current.clear();
+    for (; h < hits.count() && hits[h].fix == j; ++h) {
+      const OpenAirspace::AirspaceRecord &A =
+        index.GetTable().GetAirspace(hits[h].airspace);
+      if (isChecked(A.type)) {
+        current.append(hits[h].airspace);
+      }
+    }
+    if (current == previous) {
+      continue;
+    }
+
+    if (j > 0 && j < fixes.count()) {
+      index.Crossings(fixes[j - 1], fixes[j], &crossings);
+    } else {
+      crossings.clear();
+    }
+
+    foreach(int airspace, previous + current) {
+      bool entering = current.contains(airspace);
+      if (entering == previous.contains(airspace)) {
+        continue;
+      }
+
+      // Position of the change, at the fix if it isn't on a segment
+      // (start and end of the track). The earliest entry and the latest
+      // exit are taken if the segment crosses the airspace repeatedly.
+      int fix = qMin(j, fixes.count() - 1);
+      qreal position = fix;
+      qint64 time = msecs[fix];
+      for (int k = 0; k < crossings.count(); ++k) {
+        const OpenAirspace::Crossing &crossing =
+          crossings[entering ? k : crossings.count() - 1 - k];
+        if (crossing.airspace == airspace && crossing.entering == entering) {
+          qreal t = crossing.t;
+          position = j - 1 + t;
+          time = msecs[j - 1] + qRound64(t * (msecs[j] - msecs[j - 1]));
+          break;
+        }
+      }
+
+      if (entering) {
+        const OpenAirspace::AirspaceRecord &A =
+          index.GetTable().GetAirspace(airspace);
+        Infringement infringement;
+        infringement.name = A.name;
+        infringement.className = A.className;
+        infringement.floor = A.floor;
+        infringement.ceiling = A.ceiling;
+        infringement.entry = position;
+        infringement.entryMsecs = time;
+        open.insert(airspace, infringement);
+      } else {
+        Infringement infringement = open.take(airspace);
+        infringement.exit = position;
+        infringement.exitMsecs = time;
+        result->append(infringement);
+      }
+    }
+
+    previous = current;
+  }
+}
+
+void AirspaceChecker::findSections(const OpenAirspace::AirspaceIndex &index,
+  const QVector<OpenAirspace::Fix> &fixes,
+  QList<AirspaceSection> *result) const {
+  QVector<OpenAirspace::Hit> hits;
+  index.QueryHorizontally(fixes.constData(), fixes.count(), &hits, 1);
+
+  // Sections of the airspaces over the current fix, by the airspace.
+  QMap<int, AirspaceSection> open;
+  QVector<int> current;
+  int h = 0;
+  for (int j = 0; j <= fixes.count(); ++j) {
+    current.clear();
+    for (; h < hits.count() && hits[h].fix == j; ++h) {
+      current.append(hits[h].airspace);
+    }
+
+    foreach(int airspace, current) {
+      if (!open.contains(airspace)) {
+        AirspaceSection section;
+        section.firstFix = j;
+        section.restricted =
+          isChecked(index.GetTable().GetAirspace(airspace).type);
+        open.insert(airspace, section);
+      }
+
+      double floor;
+      double ceiling;
+      index.LimitAltitudes(airspace, fixes[j], &floor, &ceiling);
+      AirspaceSection &section = open[airspace];
+      section.floor.append(floor);
+      section.ceiling.append(ceiling);
+    }
+
+    // Sections of the airspaces the flight left end at the previous fix.
+    QMap<int, AirspaceSection>::iterator it = open.begin();
+    while (it != open.end()) {
+      if (current.contains(it.key())) {
+        ++it;
+      } else {
+        result->append(it.value());
+        it = open.erase(it);
+      }
+    }
+  }
+}
+
+void AirspaceChecker::complete(const Result &result) {
+  {
+    QMutexLocker lock(&completedMutex);
+    completed.append(result);
+  }
+
+  QMetaObject::invokeMethod(this, "deliverCompleted", Qt::QueuedConnection);
+}
+
+void AirspaceChecker::deliverCompleted() {
+  QList<Result> results;
+  {
+    QMutexLocker lock(&completedMutex);
+    results.swap(completed);
+  }
+
+  foreach(const Result &result, results) {
+    emit checked(result.path, result.infringements, result.sections);
+  }
+}
+
+}  // End namespace IgcViewer
+}  // End namespace Updraft
@@ -0,0 +1,165 @@
+#ifndef UPDRAFT_SRC_PLUGINS_IGCVIEWER_AIRSPACECHECK_H_
+#define UPDRAFT_SRC_PLUGINS_IGCVIEWER_AIRSPACECHECK_H_
+
+#include <QDir>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include "openairspace/airspacecache.h"
+#include "openairspace/airspaceindex.h"
+#include "openairspace/outlinetessellator.h"
+
+namespace Updraft {
+
+namespace Dem {
+  class Sampler;
+}
+
+namespace IgcViewer {
+
+class TrackData;
+
+/// Time interval a flight spent inside an airspace.
+struct Infringement {
+  /// Texts of the AN, AC, AL and AH records of the airspace.
+  QString name;
+  QString className;
+  QString floor;
+  QString ceiling;
+
+  /// Entry and exit as positions on the track, the integer part is
+  /// the index of a fix and the fractional part the part of the way
+  /// to the next fix.
+  qreal entry;
+  qreal exit;
+
+  /// Time of the entry and exit in milliseconds since epoch, see
+  /// Igc::Timeline.
+  qint64 entryMsecs;
+  qint64 exitMsecs;
+};
+
+/// Airspace above or below a run of consecutive fixes of a flight,
+/// a band of the cross-section under the barogram.
+struct AirspaceSection {
+  /// Index of the first fix under the airspace.
+  int firstFix;
+
+  /// Floor and ceiling of the airspace over each fix of the run, in the
+  /// altitude scale of the fixes. The ceiling is infinite if unlimited.
+  QVector<qreal> floor;
+  QVector<qreal> ceiling;
+
+  /// Flying into the airspace is an infringement.
+  bool restricted;
+};
+
+/// Finds where flights entered restricted, danger and prohibited airspaces
+/// and CTRs imported by the airspaces plugin, and the cross-section of
+/// all the airspaces along their ground path.
+/// The airspaces are indexed on the first check. Their outlines are taken
+/// from the cache of the airspaces plugin, files missing there are parsed
+/// and tessellated. Each
+/// flight is checked on a thread of the pool: the fixes are queried
+/// against the index in one batch and then swept in order, the entry
+/// and exit are interpolated on the segments where the set of airspaces
+/// containing the fixes changes. The cross-section comes from a second
+/// batch query ignoring the altitude of the fixes.
+/// Results are delivered through the checked() signal in the thread
+/// that owns the checker.
+class AirspaceChecker : public QObject {
+  Q_OBJECT
+
+ public:
+  /// \param directory Directory with the OpenAir files.
+  /// \param cacheDirectory Directory of the OpenAirspace::AirspaceCache
+  ///   with the compiled airspaces.
+  /// \param demDirectory Directory with elevation tiles for the AGL
+  ///   limits, or an empty string.
+  AirspaceChecker(const QDir& directory, const QDir& cacheDirectory,
+    const QString& demDirectory, QObject* parent = NULL);
+
+  /// Wait for the running checks and drop the undelivered results.
+  ~AirspaceChecker();
+
+  /// Start checking the flight.
+  /// The fixes are copied, the track may be destroyed in the meantime.
+  /// \param path Path of the flight, passed to checked().
+  void check(const QString& path, const TrackData& track);
+
+  /// Find the infringements of a flight in the calling thread.
+  /// \param fixes The fixes of the track.
+  /// \param msecs Time of each fix in ms since epoch, from the timeline
+  ///   of the track.
+  /// \param [out] infringements The infringements ordered by the entry.
+  /// \param [out] sections The cross-section ordered by the first fix.
+  void find(const QVector<OpenAirspace::Fix>& fixes,
+    const QVector<qint64>& msecs, QList<Infringement>* infringements,
+    QList<AirspaceSection>* sections);
+
+ signals:
+  /// Checking a flight is finished.
+  void checked(const QString& path,
+    const QList<Updraft::IgcViewer::Infringement>& infringements,
+    const QList<Updraft::IgcViewer::AirspaceSection>& sections);
+
+ private slots:
+  /// Emit checked() for all flights checked so far.
+  void deliverCompleted();
+
+ private:
+  class Task;
+
+  /// Airspaces of one flight waiting for delivery.
+  struct Result {
+    QString path;
+    QList<Infringement> infringements;
+    QList<AirspaceSection> sections;
+  };
+
+  /// Load and index the airspace files if it wasn't done yet.
+  void load();
+
+  /// Find the infringements of the airspaces of one index.
+  void find(const OpenAirspace::AirspaceIndex& index,
+    const QVector<OpenAirspace::Fix>& fixes, const QVector<qint64>& msecs,
+    QList<Infringement>* result) const;
+
+  /// Find the cross-section of the airspaces of one index.
+  void findSections(const OpenAirspace::AirspaceIndex& index,
+    const QVector<OpenAirspace::Fix>& fixes,
+    QList<AirspaceSection>* result) const;
+
+  /// Called from the worker threads when a flight is checked.
+  void complete(const Result& result);
+
+  QDir directory;
+  QDir cacheDirectory;
+  QString demDirectory;
+
+  /// Protects loaded, indices and dem while they are loaded.
+  QMutex loadMutex;
+  bool loaded;
+
+  /// Index of every airspace file.
+  QList<OpenAirspace::AirspaceIndex*> indices;
+
+  /// Terrain for the AGL limits, or NULL.
+  Dem::Sampler* dem;
+
+  QThreadPool pool;
+
+  /// Results done by the workers, but not yet delivered.
+  /// Protected by completedMutex.
+  QList<Result> completed;
+  QMutex completedMutex;
+};
+
+}  // End namespace IgcViewer
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_PLUGINS_IGCVIEWER_AIRSPACECHECK_H_
@@ -10,8 +10,13 @@ DefaultColoring::DefaultColoring(const FixInfo *info,
   : info(info), gradient(gradient) {}
 
 QColor DefaultColoring::color(int i) {
-  qreal scaled = (info->value(i) - info->globalRobustMin()) /
-    (info->globalRobustMax() - info->globalRobustMin());
+  qreal range = info->globalRobustMax() - info->globalRobustMin();
+  if (range <= 0) {
+    // Constant values, e.g. an extension that is not recorded.
+    return gradient->get(0);
+  }
+
+  qreal scaled = (info->value(i) - info->globalRobustMin()) / range;
   return gradient->get(scaled);
 }
 
@@ -12,17 +12,49 @@ namespace IgcViewer {
 /// \todo Right now the value is just a wild guess. Measure it.
 qreal OUTLIERS_SKIP_RANGE = 0.03;
 
-void FixInfo::init(const QList<TrackFix> *fixList) {
-  this->fixList = fixList;
+void FixInfo::init(const TrackData *track) {
+  this->track = track;
 
-  if (fixList->count() < 1) {
+  if (track->count() < 2) {
     min_ = max_ = robustMin_ = robustMax_ = 0;
+    scaledCount = track->count();
     resetGlobalScale();
     return;
   }
 
+  updateScale();
+  resetGlobalScale();
+}
+
+void FixInfo::append(int first) {
+  if (count() < 2) {
+    return;
+  }
+
+  if (2 * scaledCount <= count() || scaledCount < 2) {
+    // The outlier-free bounds need the whole sorted track, so they are
+    // only recomputed when the track doubles. This keeps the cost of
+    // appending amortized linear in the number of new fixes.
+    updateScale();
+  } else {
+    // Value of the previously last fix may have changed as well
+    // (speeds are averaged over the neighbouring segments).
+    for (int i = qMax(first - 1, 1); i < count(); ++i) {
+      qreal v = value(i);
+      min_ = qMin(min_, v);
+      max_ = qMax(max_, v);
+    }
+  }
+
+  globalMin_ = qMin(globalMin_, min_);
+  globalMax_ = qMax(globalMax_, max_);
+  globalRobustMin_ = qMin(globalRobustMin_, robustMin_);
+  globalRobustMax_ = qMax(globalRobustMax_, robustMax_);
+}
+
+void FixInfo::updateScale() {
   QList<qreal> values;
-  for (int i = 1; i < fixList->count(); ++i) {
+  for (int i = 1; i < track->count(); ++i) {
     values.append(this->value(i));
   }
   qSort(values);
@@ -32,36 +64,18 @@ void FixInfo::init(const QList<TrackFix> *fixList) {
   min_ = values[0];
   max_ = values[values.count() - 1];
 
-  qDebug() << values[values.count() - 1] << " " << values[values.count() - 2]
-    << " " << values[values.count() - 3] << " " << values[values.count() - 4];
-
   robustMin_ = values[skipCount];
   robustMax_ = values[values.count() - 1 - skipCount];
 
-  resetGlobalScale();
+  scaledCount = track->count();
 }
 
 qreal FixInfo::time(int i) const {
-  if (i == 0) {
-    return 0;
-  }
-
-  qreal ret = fixList->at(0).timestamp.secsTo(fixList->at(i).timestamp);
-
-  if (ret < 0) {
-    return ret + 24 * 3600;
-  } else {
-    return ret;
-  }
+  return track->time(i);
 }
 
 qreal FixInfo::absoluteMinTime() {
-  int hrs = fixList->at(0).timestamp.hour();
-  int mins = fixList->at(0).timestamp.minute();
-  int secs = fixList->at(0).timestamp.second();
-
-  int time = hrs*3600 + mins*60 + secs;
-  return time;
+  return track->startSecondsOfDay();
 }
 
 qreal FixInfo::absoluteTime(int i) {
@@ -69,23 +83,14 @@ qreal FixInfo::absoluteTime(int i) {
     return -1;
   }
 
-  int hrs = fixList->at(i).timestamp.hour();
-  int mins = fixList->at(i).timestamp.minute();
-  int secs = fixList->at(i).timestamp.second();
-
-  qreal time = hrs*3600 + mins*60 + secs;
-
-  if (time < absoluteMinTime()) {
-    return time + 24 * 3600;
-  } else {
-    return time;
-  }
+  // Track times are monotonic, so this also works over midnight.
+  return absoluteMinTime() + track->time(i);
 }
 
 QTime FixInfo::timestamp(int i) {
   QTime time;
-  if ((i < 0) || (i > count())) return time;
-  return fixList->at(i).timestamp;
+  if ((i < 0) || (i >= count())) return time;
+  return track->timestamp(i);
 }
 
 qreal FixInfo::absoluteMaxTime() {
@@ -106,28 +111,23 @@ void FixInfo::addGlobalScale(const FixInfo* other) {
   globalRobustMax_ = qMax(other->globalRobustMax_, globalRobustMax_);
 }
 
-int FixInfo::indexOfTime(QTime time) {
-  for (int i = 0; i < count(); i++) {
-    if (fixList->at(i).timestamp == time) {
-      return i;
-    }
-  }
-  return -1;
+int FixInfo::indexOfTime(qint64 msecs) {
+  return track->timeline().indexOf(msecs);
 }
 
 qreal AltitudeFixInfo::value(int i) const {
-  return fixList->at(i).location.alt;
+  return track->alt(i);
 }
 
 qreal SpeedFixInfo::value(int i) const {
-  if (fixList->count() < 2) {
+  if (track->count() < 2) {
     // This is a protection against malicious IGC files.
     return 0;
   }
 
   if (i == 0) {
     return speedBefore(1);
-  } else if (i == fixList->count() - 1) {
+  } else if (i == track->count() - 1) {
     return speedBefore(i);
   } else {
     return (speedBefore(i + 1) + speedBefore(i)) / 2;
@@ -139,29 +139,26 @@ qreal GroundSpeedFixInfo::value(int i) const {
 }
 
 qreal SpeedFixInfo::speedBefore(int i) const {
-  int seconds = fixList->at(i - 1).timestamp.secsTo(fixList->at(i).timestamp);
+  qreal seconds = track->time(i) - track->time(i - 1);
 
   if (seconds <= 0) {
-    // Since only time and not date is stored, it's possible that we cross
-    // midnight and get negative value here. Improbable, though.
-    seconds += 24 * 3600;
+    // Track times are monotonic, this only happens for duplicate fixes.
+    return 0;
   }
     // The speed in m/s:
   return (this->distanceBefore(i) / seconds);
 }
 
 qreal GroundSpeedFixInfo::distanceBefore(int i) const {
-  const TrackFix &f1 = fixList->at(i - 1);
-  const TrackFix &f2 = fixList->at(i);
+  qreal dx = track->x(i) - track->x(i - 1);
+  qreal dy = track->y(i) - track->y(i - 1);
+  qreal dz = track->z(i) - track->z(i - 1);
 
-  return qSqrt(
-    (f2.x - f1.x) * (f2.x - f1.x) +
-    (f2.y - f1.y) * (f2.y - f1.y) +
-    (f2.z - f1.z) * (f2.z - f1.z));
+  return qSqrt(dx * dx + dy * dy + dz * dz);
 }
 
 qreal VerticalSpeedFixInfo::distanceBefore(int i) const {
-  return fixList->at(i).location.alt - fixList->at(i - 1).location.alt;
+  return track->alt(i) - track->alt(i - 1);
 }
 
 TrackIdFixInfo::TrackIdFixInfo(int id)
@@ -171,43 +168,72 @@ qreal TrackIdFixInfo::value(int i) const {
   return id;
 }
 
-void TimeFixInfo::init(const QList<TrackFix> *fixList) {
-  this->fixList = fixList;
+void TimeFixInfo::init(const TrackData *track) {
+  this->track = track;
 
-  if (fixList->count() >= 1) {
+  if (track->count() >= 1) {
     min_ = robustMin_ = 0;
-    max_ = robustMax_ = value(fixList->count() - 1);
+    max_ = robustMax_ = value(track->count() - 1);
   }
 
   resetGlobalScale();
 }
 
+void TimeFixInfo::append(int first) {
+  if (track->count() < 1) {
+    return;
+  }
+
+  max_ = robustMax_ = value(track->count() - 1);
+  globalMax_ = qMax(globalMax_, max_);
+  globalRobustMax_ = qMax(globalRobustMax_, robustMax_);
+}
+
 qreal TimeFixInfo::value(int i) const {
-  int ret = fixList->at(0).timestamp.secsTo(fixList->at(i).timestamp);
+  return track->time(i);
+}
 
-  if (ret < 0) {
-    return ret + 24 * 3600;
-  } else {
-    return ret;
+ExtensionFixInfo::ExtensionFixInfo(const QByteArray &code, qreal scale)
+  : code(code), scale(scale), column(-1) {
+}
+
+void ExtensionFixInfo::init(const TrackData *track) {
+  column = track->extensionIndex(code);
+  if (column >= 0) {
+    FixInfo::init(track);
+    return;
+  }
+
+  // The extension is not recorded, all values are 0 and there is
+  // nothing to decode or sort.
+  this->track = track;
+  min_ = max_ = robustMin_ = robustMax_ = 0;
+  resetGlobalScale();
+}
+
+void ExtensionFixInfo::append(int first) {
+  if (column >= 0) {
+    FixInfo::append(first);
   }
 }
 
-void SegmentInfo::init(const QList<TrackFix>* fixList_) {
-  fixList = fixList_;
+qreal ExtensionFixInfo::value(int i) const {
+  if (column < 0) {
+    return 0;
+  }
+
+  return track->extension(column, i) * scale;
+}
+
+void SegmentInfo::init(const TrackData* track_) {
+  track = track_;
 }
 
 qreal SegmentInfo::avgSpeed(int startIndex, int endIndex) {
   if (endIndex <= startIndex) return 0;
-  Util::Location startLocation = fixList->at(startIndex).location;
-  Util::Location endLocation = fixList->at(endIndex).location;
-  QTime start = fixList->at(startIndex).timestamp;
-  QTime end = fixList->at(endIndex).timestamp;
-
-  int startSecs = start.hour()*3600 + start.minute()*60 + start.second();
-  int endSecs = end.hour()*3600 + end.minute()*60 + end.second();
-
-  if (endSecs < startSecs) endSecs += 24*3600;
-  qreal timeDiff = endSecs - startSecs;
+  Util::Location startLocation = track->location(startIndex);
+  Util::Location endLocation = track->location(endIndex);
+  qreal timeDiff = track->time(endIndex) - track->time(startIndex);
 
   qreal distance = g_core->getEllipsoid()->
     distance(startLocation, endLocation);
@@ -216,24 +242,17 @@ qreal SegmentInfo::avgSpeed(int startIndex, int endIndex) {
 
 qreal SegmentInfo::avgRise(int startIndex, int endIndex) {
   if (endIndex <= startIndex) return 0;
-  qreal startHeight = fixList->at(startIndex).location.alt;
-  qreal endHeight = fixList->at(endIndex).location.alt;
-  QTime start = fixList->at(startIndex).timestamp;
-  QTime end = fixList->at(endIndex).timestamp;
-
-  int startSecs = start.hour()*3600 + start.minute()*60 + start.second();
-  int endSecs = end.hour()*3600 + end.minute()*60 + end.second();
-
-  if (endSecs < startSecs) endSecs += 24*3600;
-  qreal timeDiff = endSecs - startSecs;
+  qreal startHeight = track->alt(startIndex);
+  qreal endHeight = track->alt(endIndex);
+  qreal timeDiff = track->time(endIndex) - track->time(startIndex);
 
   return ((endHeight - startHeight) / timeDiff);
 }
 
 qreal SegmentInfo::distance(int startIndex, int endIndex) {
   if (endIndex <= startIndex) return 0;
-  Util::Location startLocation = fixList->at(startIndex).location;
-  Util::Location endLocation = fixList->at(endIndex).location;
+  Util::Location startLocation = track->location(startIndex);
+  Util::Location endLocation = track->location(endIndex);
 
   qreal dist = g_core->getEllipsoid()->
     distance(startLocation, endLocation);
@@ -243,12 +262,16 @@ qreal SegmentInfo::distance(int startIndex, int endIndex) {
 
 qreal SegmentInfo::heightDifference(int startIndex, int endIndex) {
   if (endIndex <= startIndex) return 0;
-  return fixList->at(endIndex).location.alt -
-    fixList->at(startIndex).location.alt;
+  return track->alt(endIndex) - track->alt(startIndex);
+}
+
+qreal SegmentInfo::duration(int startIndex, int endIndex) {
+  if (endIndex <= startIndex) return 0;
+  return track->time(endIndex) - track->time(startIndex);
 }
 
 QTime SegmentInfo::timestamp(int index) {
-  return fixList->at(index).timestamp;
+  return track->timestamp(index);
 }
 
 }  // End namespace IgcViewer
@@ -5,30 +5,11 @@
 #include <QList>
 
 #include "util/util.h"
+#include "trackdata.h"
 
 namespace Updraft {
 namespace IgcViewer {
 
-/// Structure representing a single point of the igc recording,
-/// already projected and prepared for displaying.
-struct TrackFix {
-  TrackFix(QTime timestamp, Util::Location location,
-    double x, double y, double z, qreal terrainHeight) :
-    timestamp(timestamp), location(location), x(x), y(y), z(z),
-    terrainHeight(terrainHeight) {}
-
-  QTime timestamp;
-
-  /// Location of the fix
-  Util::Location location;
-
-  /// Projected location of the fix
-  qreal x, y, z;
-
-  /// Terrain height at the position of the fix.
-  qreal terrainHeight;
-};
-
 /// Base for track computing values and scales from igc recording.
 /// For multiple opened tracks the colorings can scale together,
 /// this is called global scale in the code.
@@ -37,15 +18,22 @@ class FixInfo {
   virtual ~FixInfo() {}
 
   /// Initialize the coloring.
-  /// \param fixList List of fixes, usable for scaling, smoothing, ...
-  virtual void init(const QList<TrackFix> *fixList);
+  /// \param track Fixes of the track, usable for scaling, smoothing, ...
+  virtual void init(const TrackData *track);
+
+  /// Update the scales after fixes were appended to the track.
+  /// The global scales are only extended, call addGlobalScale()
+  /// to propagate them to the other tracks.
+  /// \param first Index of the first new fix.
+  virtual void append(int first);
 
   /// Get the raw value of item number i.
   /// \pre i >= 0 && i < this->count()
   virtual qreal value(int i) const = 0;
 
-  /// Return the index of the item with the given timestamp.
-  virtual int indexOfTime(QTime time);
+  /// Return the index of the item with the given time, or -1.
+  /// \param msecs Milliseconds since epoch, see Igc::Timeline.
+  virtual int indexOfTime(qint64 msecs);
 
   //// Get the relative time in seconds of item i.
   //// \pre i >= 0 && i < this->count()
@@ -73,8 +61,8 @@ class FixInfo {
   /// Propagate the global scales from the other igc info.
   virtual void addGlobalScale(const FixInfo* other);
 
-  /// Number of items in the underlying fix list.
-  int count() const { return fixList->count(); }
+  /// Number of items in the underlying track.
+  int count() const { return track->count(); }
 
   /// Return the minimal value of this track.
   qreal min() const { return min_; }
@@ -105,11 +93,18 @@ class FixInfo {
   qreal globalRobustMax() const { return globalRobustMax_; }
 
  protected:
-  const QList<TrackFix> *fixList;
+  const TrackData *track;
   qreal min_, max_;
   qreal robustMin_, robustMax_;
   qreal globalMin_, globalMax_;
   qreal globalRobustMin_, globalRobustMax_;
+
+ private:
+  /// Compute min, max and the outlier-free bounds from all values.
+  void updateScale();
+
+  /// Number of fixes when the scale was fully computed last time.
+  int scaledCount;
 };
 
 /// Returns altitude.
@@ -162,25 +157,50 @@ class TrackIdFixInfo : public FixInfo {
 /// 0 is first fix, maximum is number of seconds of the recording.
 class TimeFixInfo : public FixInfo {
  public:
-  void init(const QList<TrackFix> *fixList);
+  void init(const TrackData *track);
+  void append(int first);
   qreal value(int i) const;
  private:
 };
 
+/// Returns a B record extension (engine noise, airspeed, ...).
+/// Tracks whose file doesn't record the extension have all values zero.
+class ExtensionFixInfo : public FixInfo {
+ public:
+  /// \param code Three letter code of the extension from the I record.
+  /// \param scale Factor converting the recorded value to display units.
+  ExtensionFixInfo(const QByteArray &code, qreal scale);
+
+  /// The values are only decoded if the I record declares the extension.
+  void init(const TrackData *track);
+  void append(int first);
+  qreal value(int i) const;
+
+ private:
+  QByteArray code;
+  qreal scale;
+
+  /// Index of the extension in the fix table, or -1.
+  int column;
+};
+
 /// Class calculating information about a segment of
 /// flight between two time points.
 class SegmentInfo {
  public:
-  void init(const QList<TrackFix>* fixList_);
+  void init(const TrackData* track_);
   qreal avgSpeed(int startIndex, int endIndex);
   qreal avgRise(int startIndex, int endIndex);
   qreal distance(int startIndex, int endIndex);
   qreal heightDifference(int startIndex, int endIndex);
 
+  /// Return number of seconds between the two fixes.
+  qreal duration(int startIndex, int endIndex);
+
   QTime timestamp(int index);
 
  private:
-  const QList<TrackFix>* fixList;
+  const TrackData* track;
 };
 
 }  // End namespace IgcViewer
@@ -1,6 +1,11 @@
 #include "igcviewer.h"
 
 #include <QDebug>
+#include <QMessageBox>
+
+#include "igc/batchloader.h"
+#include "igc/flightcache.h"
+#include "igc/igc.h"
 #include "openedfile.h"
 
 namespace Updraft {
@@ -37,6 +42,13 @@ void IgcViewer::initialize(CoreInterface *coreInterface) {
 
   g_core->registerFiletype(registration);
 
+  // Compressed flights are decompressed while loading.
+  foreach(QString suffix, Util::DecompressingDevice::suffixes()) {
+    FileRegistration compressed(registration);
+    compressed.extension += suffix;
+    g_core->registerFiletype(compressed);
+  }
+
   mapLayerGroup = g_core->createMapLayerGroup(tr("IGC files"));
   mapLayerGroup->setId("igc");
   mapLayerGroup->connectCheckedToVisibility();
@@ -50,13 +62,76 @@ void IgcViewer::initialize(CoreInterface *coreInterface) {
   automaticColors.append(QPair<QColor, int>(Qt::gray, 0));
 
   currentColoring = 0;
+
+  flightCacheSetting = g_core->addSetting(
+    "igcviewer:flightCache",
+    tr("Cache parsed flights"),
+    QVariant(true),
+    GROUP_ADVANCED);
+  flightCacheSetting->setNeedsRestart(true);
+
+  flightCache = NULL;
+  if (flightCacheSetting->get().toBool()) {
+    QDir dir = g_core->getDataDirectory();
+    flightCache = new Igc::FlightCache(dir.absoluteFilePath("igccache"));
+  }
+
+  batchLoader = new Igc::BatchLoader(this);
+  connect(batchLoader, SIGNAL(itemLoaded(Updraft::Igc::BatchItem*)),
+    this, SLOT(batchItemLoaded(Updraft::Igc::BatchItem*)));
+  connect(batchLoader, SIGNAL(finished()),
+    this, SLOT(batchFinished()));
+
+  airspaceCheckSetting = g_core->addSetting(
+    "igcviewer:checkAirspaces",
+    tr("Check opened flights against the imported airspaces"),
+    QVariant(true),
+    GROUP_ADVANCED);
+  airspaceCheckSetting->setNeedsRestart(true);
+
+  airspaceChecker = NULL;
+  if (airspaceCheckSetting->get().toBool()) {
+    // Airspaces imported and compiled by the airspaces plugin,
+    // with the ground for the AGL limits from its terrain.
+    QString demDirectory;
+    SettingInterface* demDirectorySetting = g_core->findSetting(
+      OpenAirspace::DEM_DIRECTORY_SETTING, GROUP_ADVANCED);
+    if (demDirectorySetting) {
+      demDirectory = demDirectorySetting->get().toString();
+      delete demDirectorySetting;
+    }
+
+    QDir dir = g_core->getDataDirectory();
+    airspaceChecker = new AirspaceChecker(
+      QDir(dir.absoluteFilePath("airspaces")),
+      QDir(dir.absoluteFilePath(OpenAirspace::CACHE_DIRECTORY)),
+      demDirectory, this);
+    connect(airspaceChecker,
+      SIGNAL(checked(const QString&,
+        const QList<Updraft::IgcViewer::Infringement>&,
+        const QList<Updraft::IgcViewer::AirspaceSection>&)),
+      this, SLOT(airspacesChecked(const QString&,
+        const QList<Updraft::IgcViewer::Infringement>&,
+        const QList<Updraft::IgcViewer::AirspaceSection>&)));
+  }
 }
 
 void IgcViewer::deinitialize() {
+  // Waits for the running workers and drops files that weren't delivered.
+  delete batchLoader;
+  batchLoader = NULL;
+  delete airspaceChecker;
+  airspaceChecker = NULL;
+
   foreach(OpenedFile* f, opened) {
     delete f;
   }
 
+  delete flightCache;
+  flightCache = NULL;
+  delete flightCacheSetting;
+  delete airspaceCheckSetting;
+
   qDebug("igcviewer unloaded");
 }
 
@@ -79,28 +154,108 @@ bool IgcViewer::fileOpen(const QString &filename, int roleId) {
     return false;
   }
 
+  addOpenedFile(f);
+  updateScales();
+
+  return true;
+}
+
+bool IgcViewer::filesOpen(const QStringList &filenames, int roleId) {
+  const osg::EllipsoidModel* ellipsoid = g_core->getCurrentMapEllipsoid();
+
+  QList<Igc::BatchItem*> items;
+
+  foreach(QString filename, filenames) {
+    QString absFilename = QFileInfo(filename).absoluteFilePath();
+
+    if (opened.contains(absFilename)) {
+      qDebug() << "already opened, ignoring";
+      opened[absFilename]->selectTab();
+      continue;
+    }
+
+    if (loading.contains(absFilename)) {
+      continue;
+    }
+
+    loading.insert(absFilename);
+    items.append(new TrackBatchItem(absFilename, ellipsoid, flightCache));
+  }
+
+  batchLoader->start(items);
+
+  return true;
+}
+
+void IgcViewer::batchItemLoaded(Igc::BatchItem* item) {
+  QString absFilename = item->path();
+  loading.remove(absFilename);
+
+  if (!item->ok()) {
+    failedFiles.append(absFilename);
+    delete item;
+    return;
+  }
+
+  if (opened.contains(absFilename)) {
+    // Opened with fileOpen() in the meantime.
+    delete item;
+    return;
+  }
+
+  TrackBatchItem* trackItem = static_cast<TrackBatchItem*>(item);
+
+  OpenedFile* f = new OpenedFile();
+  f->init(this, absFilename, trackItem->takeFile(), trackItem->track(),
+    findAutomaticColor());
+  delete item;
+
+  addOpenedFile(f);
+}
+
+void IgcViewer::batchFinished() {
+  // Scales are merged only once for the whole batch.
+  updateScales();
+
+  if (!failedFiles.isEmpty()) {
+    QMessageBox::warning(NULL, tr("Error"),
+      tr("Could not open files:") + "\n" + failedFiles.join("\n"));
+    failedFiles.clear();
+  }
+}
+
+void IgcViewer::addOpenedFile(OpenedFile* f) {
+  QFileInfo info(f->fileName());
+
   IGCMapObject* mapObject = new IGCMapObject(info.fileName(), f);
   g_core->registerOsgNode(f->getNode(), mapObject);
   mapObjects.append(mapObject);
 
-  foreach(OpenedFile* other, opened) {
-    f->updateScales(other);
-    other->updateScales(f);
+  opened.insert(f->fileName(), f);
 
-    other->redraw();
+  if (airspaceChecker) {
+    airspaceChecker->check(f->fileName(), f->getTrackData());
   }
+}
 
-  opened.insert(absFilename, f);
-
-  return true;
+void IgcViewer::airspacesChecked(const QString& path,
+  const QList<Infringement>& infringements,
+  const QList<AirspaceSection>& sections) {
+  // The file may have been closed while it was checked.
+  if (opened.contains(path)) {
+    opened[path]->setAirspaces(infringements, sections);
+  }
 }
 
 void IgcViewer::fileClose(OpenedFile *f) {
-  QString str = f->fileName();
   opened.remove(f->fileName());
 
   freeAutomaticColor(f->getAutomaticColor());
 
+  updateScales();
+}
+
+void IgcViewer::updateScales() {
   foreach(OpenedFile *other, opened) {
     other->resetScales();
   }
@@ -170,11 +325,13 @@ void IgcViewer::handleClick(MapObject* obj, const EventInfo* evt) {
   static_cast<IGCMapObject*>(obj)->getFile()->trackClicked(evt);
 }
 
-/*void IgcViewer::fileIdentification(QStringList *roles,
+void IgcViewer::fileIdentification(QStringList *roles,
     QString *importDirectory, const QString &filename) {
   Igc::IgcFile igc;
-  if (!igc.load(filename)) {
-    qDebug() << "We couldn't load the igc file.";
+  Igc::FlightSummary summary;
+  if (!igc.probe(filename, &summary)) {
+    qDebug() << "We couldn't read the igc file headers.";
+    return;
   }
 
   QString ident = igc.gliderId().simplified();
@@ -191,9 +348,16 @@ void IgcViewer::handleClick(MapObject* obj, const EventInfo* evt) {
 
   ident.prepend(igc.date().toString());
 
+  if (summary.firstFix.isValid()) {
+    QTime duration = QTime(0, 0).addSecs(summary.duration);
+    ident.append("\n" + summary.firstFix.toString("hh:mm") + " - " +
+      summary.lastFix.toString("hh:mm") + " (" +
+      duration.toString("h:mm") + ")");
+  }
+
   if (roles != NULL)
     roles->append(ident);
-}*/
+}
 
 Q_EXPORT_PLUGIN2(igcviewer, IgcViewer)
 
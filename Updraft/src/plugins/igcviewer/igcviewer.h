@@ -4,10 +4,20 @@
 #include <QColor>
 #include <QList>
 #include <QPair>
+#include <QSet>
+#include <QStringList>
 #include "../../pluginbase.h"
 #include "../../mapobject.h"
+#include "airspacecheck.h"
 
 namespace Updraft {
+
+namespace Igc {
+  class BatchItem;
+  class BatchLoader;
+  class FlightCache;
+}
+
 namespace IgcViewer {
 
 class OpenedFile;
@@ -42,6 +52,15 @@ class Q_DECL_EXPORT IgcViewer: public QObject, public PluginBase {
   void deinitialize();
 
   bool fileOpen(const QString &filename, int roleId);
+
+  /// Open the files in parallel.
+  /// Files are parsed and projected on a thread pool and added one by one
+  /// as they are finished. Errors are reported when the whole batch is
+  /// done.
+  bool filesOpen(const QStringList &filenames, int roleId);
+
+  /// Describe the flight by the date, glider, pilot and flight time.
+  /// Only the headers and the last fix are read.
   void fileIdentification(QStringList *roles,
     QString *importDirectory, const QString &filename);
 
@@ -56,11 +75,28 @@ class Q_DECL_EXPORT IgcViewer: public QObject, public PluginBase {
   /// propagate this change to all of them.
   void coloringChanged(int i);
 
+  /// A file from filesOpen() is loaded.
+  void batchItemLoaded(Updraft::Igc::BatchItem* item);
+
+  /// All files from filesOpen() are loaded.
+  void batchFinished();
+
+  /// Airspace infringements and cross-section of a flight were found.
+  void airspacesChecked(const QString& path,
+    const QList<Updraft::IgcViewer::Infringement>& infringements,
+    const QList<Updraft::IgcViewer::AirspaceSection>& sections);
+
  private:
   /// Remove the opened file from the lists and notify recalculate
   /// all scales.
   void fileClose(OpenedFile* f);
 
+  /// Register the opened file in the map and in the list of files.
+  void addOpenedFile(OpenedFile* f);
+
+  /// Recalculate the global scales of all opened files and redraw them.
+  void updateScales();
+
   /// Finds a least used automatic color and increments its use count.
   QColor findAutomaticColor();
 
@@ -73,6 +109,24 @@ class Q_DECL_EXPORT IgcViewer: public QObject, public PluginBase {
   QList<QPair<QColor, int> > automaticColors;
 
   QMap<QString, OpenedFile*> opened;
+
+  /// Loader of the files opened through filesOpen().
+  Igc::BatchLoader* batchLoader;
+
+  /// Absolute paths of files that are being loaded by batchLoader.
+  QSet<QString> loading;
+
+  /// Files from the current batch that couldn't be opened.
+  QStringList failedFiles;
+
+  /// Cache of parsed flights, or NULL if caching is disabled.
+  Igc::FlightCache* flightCache;
+  SettingInterface* flightCacheSetting;
+
+  /// Checker of the airspace infringements, or NULL if it is disabled.
+  AirspaceChecker* airspaceChecker;
+  SettingInterface* airspaceCheckSetting;
+
   MapLayerGroupInterface* mapLayerGroup;
   QVector<MapObject*> mapObjects;
 
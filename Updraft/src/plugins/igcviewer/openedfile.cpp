@@ -1,11 +1,13 @@
 #include "openedfile.h"
 
 #include <QComboBox>
+#include <QDateTime>
 #include <QHBoxLayout>
 #include <QSplitter>
 #include <QVBoxLayout>
 #include <QGridLayout>
 #include <QDebug>
+#include <QHeaderView>
 
 #include <osg/Depth>
 #include <osg/Geode>
@@ -18,6 +20,7 @@
 
 #include "pluginbase.h"
 #include "igc/igc.h"
+#include "igc/tailreader.h"
 
 #include "plotwidget.h"
 
@@ -31,6 +34,7 @@ OpenedFile::~OpenedFile() {
     delete tmp;
   }
 
+  delete tailReader;
   delete igc;
 
   foreach(FixInfo* info, fixInfo) {
@@ -50,36 +54,12 @@ OpenedFile::~OpenedFile() {
 
 bool OpenedFile::loadIgc(const QString& filename) {
   igc = new Igc::IgcFile();
-  if (!igc->load(filename)) {
+  if (!trackData.load(igc, filename, g_core->getCurrentMapEllipsoid(),
+    viewer->flightCache)) {
     qDebug() << "Loading IGC file failed.";
     return false;
   }
 
-  const osg::EllipsoidModel* ellipsoid = g_core->getCurrentMapEllipsoid();
-
-  fixList.clear();
-
-  foreach(Igc::Event const* ev, igc->events()) {
-    if (ev->type != Igc::Event::FIX) {
-      continue;
-    }
-    Igc::Fix const* igcFix = static_cast<Igc::Fix const*>(ev);
-
-    if (!igcFix->valid) {
-      continue;
-    }
-
-    qreal x, y, z;
-
-    ellipsoid->convertLatLongHeightToXYZ(
-      igcFix->gpsLoc.lat_radians(), igcFix->gpsLoc.lon_radians(),
-      igcFix->gpsLoc.alt,
-      x, y, z);
-
-    /// \todo fill terrain height
-    fixList.append(TrackFix(ev->timestamp, igcFix->gpsLoc, x, y, z, 0));
-  }
-
   return true;
 }
 
@@ -88,11 +68,31 @@ bool OpenedFile::init(IgcViewer* viewer,
   this->viewer = viewer;
   fileInfo = QFileInfo(filename);
   automaticColor = color;
+  tailReader = NULL;
 
   if (!loadIgc(filename)) {
     return false;
   }
 
+  createDisplay();
+
+  return true;
+}
+
+void OpenedFile::init(IgcViewer* viewer, const QString& filename,
+  Igc::IgcFile* igc, const TrackData& track, QColor color) {
+  this->viewer = viewer;
+  fileInfo = QFileInfo(filename);
+  automaticColor = color;
+  tailReader = NULL;
+
+  this->igc = igc;
+  trackData = track;
+
+  createDisplay();
+}
+
+void OpenedFile::createDisplay() {
   colorsCombo = new QComboBox();
 
   gradient = Util::Gradient(Qt::blue, Qt::red, true);
@@ -100,7 +100,7 @@ bool OpenedFile::init(IgcViewer* viewer,
   #define ADD_IGCINFO(variable, pointer) \
     do { \
       fixInfo.append(pointer); \
-      fixInfo[fixInfo.count() - 1]->init(&fixList); \
+      fixInfo[fixInfo.count() - 1]->init(&trackData); \
       variable = fixInfo[fixInfo.count() - 1]; \
     } while (0)
 
@@ -109,8 +109,17 @@ bool OpenedFile::init(IgcViewer* viewer,
   ADD_IGCINFO(groundSpeedInfo, new GroundSpeedFixInfo());
   ADD_IGCINFO(timeInfo, new TimeFixInfo());
 
+  // The B record extensions are added even if the file doesn't record them,
+  // so that the colorings of all opened files stay in the same order.
+  // Nothing is decoded for the missing ones.
+  // True airspeed is recorded in km/h, converted to m/s like ground speed.
+  ADD_IGCINFO(engineNoiseInfo, new ExtensionFixInfo("ENL", 1));
+  ADD_IGCINFO(airspeedInfo, new ExtensionFixInfo("TAS", 1 / 3.6));
+  ADD_IGCINFO(fixAccuracyInfo, new ExtensionFixInfo("FXA", 1));
+  ADD_IGCINFO(satellitesInfo, new ExtensionFixInfo("SIU", 1));
+
   SegmentInfo* segmentInfo = new SegmentInfo();
-  segmentInfo->init(&fixList);
+  segmentInfo->init(&trackData);
 
   #define ADD_COLORING(name, pointer) \
     do { \
@@ -119,7 +128,7 @@ bool OpenedFile::init(IgcViewer* viewer,
     } while (0)
 
   ADD_COLORING(tr("Automatic"),
-    new ConstantColoring(color));
+    new ConstantColoring(automaticColor));
   ADD_COLORING(tr("Vertical Speed"),
     new SymmetricColoring(verticalSpeedInfo, &gradient));
   ADD_COLORING(tr("Ground Speed"),
@@ -128,6 +137,14 @@ bool OpenedFile::init(IgcViewer* viewer,
     new DefaultColoring(altitudeInfo, &gradient));
   ADD_COLORING(tr("Time"),
     new LocalColoring(timeInfo, &gradient));
+  ADD_COLORING(tr("Engine Noise"),
+    new DefaultColoring(engineNoiseInfo, &gradient));
+  ADD_COLORING(tr("True Airspeed"),
+    new DefaultColoring(airspeedInfo, &gradient));
+  ADD_COLORING(tr("Fix Accuracy"),
+    new DefaultColoring(fixAccuracyInfo, &gradient));
+  ADD_COLORING(tr("Satellites"),
+    new DefaultColoring(satellitesInfo, &gradient));
 
 
   QWidget* tabWidget = new QWidget();
@@ -145,11 +162,22 @@ bool OpenedFile::init(IgcViewer* viewer,
   QLabel* header = new QLabel();
   setHeaderText(header);
 
+  // Filled in when the airspace check of the flight is done.
+  infringementList = new QTreeWidget();
+  infringementList->setRootIsDecorated(false);
+  infringementList->setHeaderLabels(QStringList() << tr("Airspace") <<
+    tr("Class") << tr("Floor") << tr("Ceiling") << tr("Entry") <<
+    tr("Exit"));
+  infringementList->header()->setResizeMode(QHeaderView::ResizeToContents);
+  infringementList->setMaximumHeight(120);
+  infringementList->hide();
+
   tabWidget->setLayout(layout);
   layout->addWidget(colorsCombo, 0, 0);
   layout->addWidget(textBox, 1, 0);
   layout->addWidget(header, 0, 1);
   layout->addWidget(plotWidget, 1, 1);
+  layout->addWidget(infringementList, 2, 0, 1, 2);
 
   tab = g_core->createTab(tabWidget, fileInfo.fileName());
 
@@ -174,8 +202,8 @@ bool OpenedFile::init(IgcViewer* viewer,
     this, SLOT(fixIsPointedAt(int)));
   connect(plotWidget, SIGNAL(clearMarkers()),
     this, SLOT(clearMarkers()));
-
-  return true;
+  connect(infringementList, SIGNAL(itemClicked(QTreeWidgetItem*, int)),
+    this, SLOT(infringementClicked(QTreeWidgetItem*)));
 }
 
 void OpenedFile::redraw() {
@@ -203,6 +231,8 @@ void OpenedFile::createGroup() {
 
   sceneRoot->addChild(createTrack());
   sceneRoot->addChild(createSkirt());
+  sceneRoot->addChild(createInfringements());
+  addVertices(0);
 
   // create marker geometry
   trackPositionMarker = createMarker(25.);
@@ -243,12 +273,7 @@ osg::Node* OpenedFile::createTrack() {
   geom->setVertexArray(vertices);
   geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
 
-  foreach(TrackFix fix, fixList) {
-    vertices->push_back(osg::Vec3(fix.x, fix.y, fix.z));
-  }
-
   drawArrayLines->setFirst(0);
-  drawArrayLines->setCount(vertices->size());
 
   osg::StateSet* stateSet = trackGeode->getOrCreateStateSet();
   stateSet->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
@@ -262,7 +287,7 @@ osg::Node* OpenedFile::createTrack() {
 
 osg::Node* OpenedFile::createSkirt() {
   osg::Geode *geode = new osg::Geode();
-  osg::Geometry *skirtGeom = new osg::Geometry();
+  skirtGeom = new osg::Geometry();
 
   geode->addDrawable(skirtGeom);
 
@@ -275,20 +300,7 @@ osg::Node* OpenedFile::createSkirt() {
 
   skirtGeom->setColorBinding(osg::Geometry::BIND_OVERALL);
 
-  const osg::EllipsoidModel* ellipsoid =
-    g_core->getCurrentMapEllipsoid();
-  foreach(TrackFix fix, fixList) {
-    double x, y, z;
-    ellipsoid->convertLatLongHeightToXYZ(
-      fix.location.lat_radians(), fix.location.lon_radians(),
-      0,
-      x, y, z);
-    vertices->push_back(osg::Vec3(fix.x, fix.y, fix.z));
-    vertices->push_back(osg::Vec3(x, y, z));
-  }
-
   drawArray->setFirst(0);
-  drawArray->setCount(vertices->size());
 
   osg::Vec4Array* color = new osg::Vec4Array();
   color->push_back(osg::Vec4(0.5, 0.5, 0.5, 0.5));
@@ -309,12 +321,177 @@ osg::Node* OpenedFile::createSkirt() {
   return geode;
 }
 
+osg::Node* OpenedFile::createInfringements() {
+  osg::Geode* geode = new osg::Geode();
+  infringementGeom = new osg::Geometry();
+
+  geode->addDrawable(infringementGeom);
+
+  infringementGeom->setVertexArray(new osg::Vec3Array());
+
+  osg::Vec4Array* color = new osg::Vec4Array();
+  color->push_back(osg::Vec4(1.0, 0.0, 0.0, 1.0));
+  infringementGeom->setColorArray(color);
+  infringementGeom->setColorBinding(osg::Geometry::BIND_OVERALL);
+
+  osg::StateSet* stateSet = geode->getOrCreateStateSet();
+  stateSet->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+  stateSet->setMode(GL_LINE_SMOOTH, osg::StateAttribute::ON);
+  stateSet->setAttributeAndModes(new osg::LineWidth(6));
+
+  return geode;
+}
+
+osg::Vec3 OpenedFile::trackPosition(qreal position) {
+  int i = qBound(0, static_cast<int>(position), trackData.count() - 1);
+  int next = qMin(i + 1, trackData.count() - 1);
+  qreal t = position - i;
+
+  osg::Vec3 a(trackData.x(i), trackData.y(i), trackData.z(i));
+  osg::Vec3 b(trackData.x(next), trackData.y(next), trackData.z(next));
+  return a + (b - a) * t;
+}
+
+void OpenedFile::setAirspaces(const QList<Infringement>& list,
+  const QList<AirspaceSection>& sections) {
+  plotWidget->setAirspaceSections(sections);
+
+  infringements = list;
+
+  infringementList->clear();
+  foreach(const Infringement& infringement, infringements) {
+    QDateTime entry =
+      QDateTime::fromMSecsSinceEpoch(infringement.entryMsecs).toUTC();
+    QDateTime exit =
+      QDateTime::fromMSecsSinceEpoch(infringement.exitMsecs).toUTC();
+    QStringList texts;
+    texts << infringement.name << infringement.className <<
+      infringement.floor << infringement.ceiling <<
+      entry.toString("hh:mm:ss") << exit.toString("hh:mm:ss");
+    infringementList->addTopLevelItem(new QTreeWidgetItem(texts));
+  }
+  infringementList->setVisible(!infringements.isEmpty());
+
+  // One line strip per infringement, from the entry through the fixes
+  // inside to the exit.
+  osg::Vec3Array* vertices = new osg::Vec3Array();
+  infringementGeom->removePrimitiveSet(0,
+    infringementGeom->getNumPrimitiveSets());
+  foreach(const Infringement& infringement, infringements) {
+    int first = vertices->size();
+    vertices->push_back(trackPosition(infringement.entry));
+    for (int i = static_cast<int>(infringement.entry) + 1;
+      i < infringement.exit; ++i) {
+      vertices->push_back(osg::Vec3(trackData.x(i), trackData.y(i),
+        trackData.z(i)));
+    }
+    vertices->push_back(trackPosition(infringement.exit));
+
+    infringementGeom->addPrimitiveSet(new osg::DrawArrays(
+      osg::PrimitiveSet::LINE_STRIP, first, vertices->size() - first));
+  }
+  infringementGeom->setVertexArray(vertices);
+  infringementGeom->dirtyDisplayList();
+  infringementGeom->dirtyBound();
+}
+
+void OpenedFile::infringementClicked(QTreeWidgetItem* item) {
+  int index = infringementList->indexOfTopLevelItem(item);
+  if (index < 0) {
+    return;
+  }
+
+  int fix = qRound(infringements[index].entry);
+  plotWidget->addPickedFix(fix);
+  fixPicked(fix);
+}
+
+void OpenedFile::addVertices(int first) {
+  osg::Vec3Array* vertices =
+    static_cast<osg::Vec3Array*>(geom->getVertexArray());
+  osg::Vec3Array* skirtVertices =
+    static_cast<osg::Vec3Array*>(skirtGeom->getVertexArray());
+
+  vertices->reserve(trackData.count());
+  skirtVertices->reserve(2 * trackData.count());
+  for (int i = first; i < trackData.count(); ++i) {
+    osg::Vec3 vertex(trackData.x(i), trackData.y(i), trackData.z(i));
+
+    vertices->push_back(vertex);
+    skirtVertices->push_back(vertex);
+    skirtVertices->push_back(osg::Vec3(
+      trackData.groundX(i), trackData.groundY(i), trackData.groundZ(i)));
+  }
+
+  static_cast<osg::DrawArrays*>(geom->getPrimitiveSet(0))->setCount(
+    vertices->size());
+  static_cast<osg::DrawArrays*>(skirtGeom->getPrimitiveSet(0))->setCount(
+    skirtVertices->size());
+
+  vertices->dirty();
+  skirtVertices->dirty();
+  geom->dirtyDisplayList();
+  geom->dirtyBound();
+  skirtGeom->dirtyDisplayList();
+  skirtGeom->dirtyBound();
+}
+
+void OpenedFile::fixesAppended() {
+  int first = trackData.count();
+  if (trackData.append() == 0) {
+    return;
+  }
+
+  addVertices(first);
+
+  foreach(FixInfo* info, fixInfo) {
+    info->append(first);
+  }
+
+  // Colors of the previously last fix may change with the new neighbour.
+  osg::Vec4Array* colors =
+    static_cast<osg::Vec4Array*>(geom->getColorArray());
+  int firstColor = qMax(first - 1, 0);
+  colors->resize(firstColor);
+  for (int i = firstColor; i < trackData.count(); ++i) {
+    QColor color = currentColoring->color(i);
+    colors->push_back(osg::Vec4(
+      color.redF(), color.greenF(), color.blueF(), color.alphaF()));
+  }
+  colors->dirty();
+
+  plotWidget->appendFixes(first);
+}
+
+void OpenedFile::setFollowing(bool follow) {
+  if (!follow) {
+    delete tailReader;
+    tailReader = NULL;
+    return;
+  }
+
+  if (tailReader) {
+    return;
+  }
+
+  if (!Igc::TailReader::canFollow(fileInfo.absoluteFilePath())) {
+    qDebug() << fileInfo.absoluteFilePath() << "can't be followed.";
+    return;
+  }
+
+  tailReader = new Igc::TailReader(igc, fileInfo.absoluteFilePath());
+  connect(tailReader, SIGNAL(fixesAppended(int, int)),
+    this, SLOT(fixesAppended()));
+  tailReader->start();
+}
+
 void OpenedFile::setColors(Coloring *coloring) {
   currentColoring = coloring;
 
   osg::Vec4Array* colors = new osg::Vec4Array();
 
-  for (int i = 0; i < fixList.count(); ++i) {
+  colors->reserve(trackData.count());
+  for (int i = 0; i < trackData.count(); ++i) {
     QColor color = coloring->color(i);
     colors->push_back(osg::Vec4(
       color.redF(), color.greenF(), color.blueF(), color.alphaF()));
@@ -349,25 +526,10 @@ osg::Node* OpenedFile::getNode() {
 
 void OpenedFile::trackClicked(const EventInfo* eventInfo) {
     // find nearest fix:
-  if (fixList.empty()) return;
+  if (trackData.isEmpty()) return;
     // index of nearest trackFix
-  int nearest = 0;
-  float dx = fixList[nearest].x - eventInfo->intersection.x();
-  float dy = fixList[nearest].y - eventInfo->intersection.y();
-  float dz = fixList[nearest].z - eventInfo->intersection.z();
-  float distance = dx*dx + dy*dy + dz*dz;
-  float minDistance = distance;
-
-  for (int i = 0; i < fixList.count(); i++) {
-    dx = fixList[i].x - eventInfo->intersection.x();
-    dy = fixList[i].y - eventInfo->intersection.y();
-    dz = fixList[i].z - eventInfo->intersection.z();
-    distance = dx*dx + dy*dy + dz*dz;
-    if (distance < minDistance) {
-      minDistance = distance;
-      nearest = i;
-    }
-  }
+  int nearest = trackData.nearestFix(eventInfo->intersection.x(),
+    eventInfo->intersection.y(), eventInfo->intersection.z());
 
   plotWidget->addPickedFix(nearest);
 
@@ -380,13 +542,14 @@ void OpenedFile::trackClicked(const EventInfo* eventInfo) {
   currentMarkerTransform->addChild(trackPositionMarker);
   sceneRoot->addChild(currentMarkerTransform);
   currentMarkerTransform->setPosition(
-    osg::Vec3(fixList[nearest].x, fixList[nearest].y, fixList[nearest].z));
+    osg::Vec3(trackData.x(nearest), trackData.y(nearest),
+      trackData.z(nearest)));
   pickedMarkers.append(currentMarkerTransform);
 }
 
 void OpenedFile::fixPicked(int index) {
     // find fix with nearest time:
-  if (fixList.empty()) return;
+  if (trackData.isEmpty()) return;
 
   // create a new transform node:
   osg::AutoTransform* currentMarkerTransform = new osg::AutoTransform();
@@ -398,20 +561,20 @@ void OpenedFile::fixPicked(int index) {
   currentMarkerTransform->addChild(trackPositionMarker);
   sceneRoot->addChild(currentMarkerTransform);
   currentMarkerTransform->setPosition(
-    osg::Vec3(fixList[index].x, fixList[index].y, fixList[index].z));
+    osg::Vec3(trackData.x(index), trackData.y(index), trackData.z(index)));
   pickedMarkers.append(currentMarkerTransform);
 }
 
 void OpenedFile::fixIsPointedAt(int index) {
     // find fix with nearest time:
-  if ((index < 0) || (index >= fixList.count())) {
+  if ((index < 0) || (index >= trackData.count())) {
     // no fix was picked, hide the marker
     currentMarker->setNodeMask(0x0);
   } else {
     currentMarker->setNodeMask(0xffffffff);
       // set the position of the current marker node:
     currentMarker->setPosition(
-      osg::Vec3(fixList[index].x, fixList[index].y, fixList[index].z));
+      osg::Vec3(trackData.x(index), trackData.y(index), trackData.z(index)));
   }
 }
 
@@ -484,7 +647,21 @@ void OpenedFile::setHeaderText(QLabel* label) {
   }
   QString glider = igc->gliderType();
   if (!glider.isEmpty()) {
-    text += tr("Glider: ") + glider;
+    text += tr("Glider: ") + glider + "\t";
+  }
+  switch (igc->signatureStatus()) {
+    case Igc::SIGNATURE_NOT_CHECKED:
+      text += tr("Signature: not checked");
+      break;
+    case Igc::SIGNATURE_MISSING:
+      text += tr("Signature: missing");
+      break;
+    case Igc::SIGNATURE_VALID:
+      text += tr("Signature: valid");
+      break;
+    case Igc::SIGNATURE_INVALID:
+      text += tr("Signature: invalid");
+      break;
   }
   label->setText(text);
 }
@@ -499,7 +676,16 @@ void OpenedFile::clearMarkers() {
 void OpenedFile::contextMenuRequested(QPoint pos, MapLayerInterface* sender) {
   QMenu menu;
   menu.addAction(sender->getZoomAction());
-  menu.exec(pos);
+
+  QAction* followAction = menu.addAction(tr("Follow file"));
+  followAction->setCheckable(true);
+  followAction->setChecked(tailReader != NULL);
+  followAction->setEnabled(tailReader ||
+    Igc::TailReader::canFollow(fileInfo.absoluteFilePath()));
+
+  if (menu.exec(pos) == followAction) {
+    setFollowing(followAction->isChecked());
+  }
 }
 
 }  // End namespace IgcViewer
@@ -5,15 +5,18 @@
 #include <QFileInfo>
 #include <QList>
 #include <QTextEdit>
+#include <QTreeWidget>
 
 #include <osg/Geometry>
 #include <osg/Geode>
 #include <osg/AutoTransform>
 
+#include "airspacecheck.h"
 #include "colorings.h"
 #include "igcinfo.h"
 #include "igcviewer.h"
 #include "plotwidget.h"
+#include "trackdata.h"
 #include "../../eventinfo.h"
 
 class IGCViewer;
@@ -21,6 +24,7 @@ class IGCViewer;
 namespace Updraft {
 namespace Igc {
   class IgcFile;
+  class TailReader;
 }
 }
 
@@ -43,6 +47,15 @@ class OpenedFile: public QObject {
   /// \return Whether the file was successfully opened.
   bool init(IgcViewer* viewer, const QString& filename, QColor color);
 
+  /// Initialize the file from an already loaded igc file.
+  /// \param viewer The parent IgcViewer object
+  /// \param filename The name of the file
+  /// \param igc The loaded file. OpenedFile takes its ownership.
+  /// \param track Track data prepared from the fixes of igc.
+  /// \param color Color used for automatic coloring.
+  void init(IgcViewer* viewer, const QString& filename,
+    Igc::IgcFile* igc, const TrackData& track, QColor color);
+
   /// Force redraw of everything.
   void redraw();
 
@@ -61,6 +74,14 @@ class OpenedFile: public QObject {
   /// Return the absolute file name.
   QString fileName();
 
+  /// Return the valid fixes of the file.
+  const TrackData& getTrackData() const { return trackData; }
+
+  /// List the airspace infringements and highlight them on the track,
+  /// show the airspace cross-section in the plot.
+  void setAirspaces(const QList<Infringement>& list,
+    const QList<AirspaceSection>& sections);
+
   /// Set colors of the track according to the value selected in the viewer.
   void coloringChanged();
 
@@ -88,16 +109,26 @@ class OpenedFile: public QObject {
   /// One of the map layers has requested a context menu.
   void contextMenuRequested(QPoint pos, MapLayerInterface* sender);
 
+  /// Fixes were appended to the igc file.
+  /// Extends the track, the infos and the plots by the new fixes only.
+  void fixesAppended();
+
  private slots:
   /// Slot that gets called when the tab associated with this file is closed.
   /// Deletes the opened file.
   void close();
 
+  /// Pick the entry fix of the clicked infringement.
+  void infringementClicked(QTreeWidgetItem* item);
+
  private:
-  /// Load the igc file to our own representation and close it.
-  /// Fills fixList.
+  /// Load the igc file and prepare the track data.
+  /// Fills trackData.
   bool loadIgc(const QString& filename);
 
+  /// Create the info classes, colorings, the tab and the map geometry.
+  void createDisplay();
+
   /// Create whole track in map.
   void createGroup();
 
@@ -107,13 +138,28 @@ class OpenedFile: public QObject {
   /// Create the skirt under the track.
   osg::Node* createSkirt();
 
+  /// Create the highlight of the airspace infringements.
+  osg::Node* createInfringements();
+
+  /// Position on the track between two fixes.
+  /// \param position Index of a fix plus the part of the way to the next one.
+  osg::Vec3 trackPosition(qreal position);
+
+  /// Add vertices of the track and skirt, starting from fix first.
+  void addVertices(int first);
+
+  /// Start or stop following the igc file as it grows.
+  /// Compressed files can't be followed.
+  void setFollowing(bool follow);
+
   /// Set coloring of the track.
   void setColors(Coloring* coloring);
 
   /// Create the marker geometry.
   osg::Geode* createMarker(qreal scale);
 
-  /// Fill the header label information - name of the pilot, date, etc.
+  /// Fill the header label information - name of the pilot, date,
+  /// result of the signature check, etc.
   void setHeaderText(QLabel* label);
 
   QFileInfo fileInfo;
@@ -121,6 +167,7 @@ class OpenedFile: public QObject {
   QComboBox *colorsCombo;
   IgcTextWidget* textBox;
   PlotWidget* plotWidget;
+  QTreeWidget* infringementList;
 
   TabInterface *tab;
   MapLayerInterface* track;
@@ -131,9 +178,13 @@ class OpenedFile: public QObject {
   /// Geometry of the 3D track visualisation.
   /// Used for coloring.
   osg::Geometry* geom;
+  osg::Geometry* skirtGeom;
   osg::Group* sceneRoot;
   osg::Geode* trackGeode;
 
+  /// Parts of the track inside airspaces.
+  osg::Geometry* infringementGeom;
+
   /// The geometry of the track marker.
   osg::ref_ptr<osg::Geode> trackPositionMarker;
 
@@ -148,11 +199,17 @@ class OpenedFile: public QObject {
 
   Coloring* currentColoring;
 
+  /// Airspace infringements of the flight.
+  QList<Infringement> infringements;
+
   /// Igc file
   Igc::IgcFile* igc;
 
-  /// List of track points.
-  QList<TrackFix> fixList;
+  /// Valid fixes of the igc file, projected for display.
+  TrackData trackData;
+
+  /// Reader following the igc file, or NULL if the file isn't followed.
+  Igc::TailReader* tailReader;
 
   QList<Coloring*> colorings;
 
@@ -165,6 +222,10 @@ class OpenedFile: public QObject {
   FixInfo* verticalSpeedInfo;
   FixInfo* groundSpeedInfo;
   FixInfo* timeInfo;
+  FixInfo* engineNoiseInfo;
+  FixInfo* airspeedInfo;
+  FixInfo* fixAccuracyInfo;
+  FixInfo* satellitesInfo;
 
   Util::Gradient gradient;
 };
@@ -13,6 +13,9 @@ const QPen PlotAxes::TIME_TICKS_PEN = QPen(QBrush(Qt::gray), 1);
 
 static const qreal LN10 = qLn(10);
 
+/// Part of the range added to the limits when they are extended.
+static const qreal LIMITS_HEADROOM = 0.25;
+
 PlotAxes::PlotAxes(bool drawTimeTicks_, bool drawAxisX_) {
   this->drawTimeTicks = drawTimeTicks_;
   this->drawAxisX = drawAxisX_;
@@ -115,6 +118,30 @@ void PlotAxes::setLimits(qreal min, qreal max, qreal minTime, qreal maxTime) {
   setGeometry(rect);
 }
 
+bool PlotAxes::extendLimits(qreal min, qreal max, qreal maxTime) {
+  if (min >= this->min && max <= this->max && maxTime <= this->maxTime) {
+    return false;
+  }
+
+  qreal newMin = this->min;
+  qreal newMax = this->max;
+  qreal newMaxTime = this->maxTime;
+  qreal headroom = (max - min) * LIMITS_HEADROOM;
+
+  if (min < newMin) {
+    newMin = min - headroom;
+  }
+  if (max > newMax) {
+    newMax = max + headroom;
+  }
+  if (maxTime > newMaxTime) {
+    newMaxTime = maxTime + (maxTime - minTime) * LIMITS_HEADROOM;
+  }
+
+  setLimits(newMin, newMax, minTime, newMaxTime);
+  return true;
+}
+
 qreal PlotAxes::findTickIncrement(qreal range, qreal size,
   qreal minTickSpacing) {
   qreal tmp = minTickSpacing * range / size;
@@ -44,6 +44,12 @@ class PlotAxes : public QObject, public QLayoutItem {
   /// Set the limits for drawing and recalculate all cached values.
   void setLimits(qreal min, qreal max, qreal minTime, qreal maxTime);
 
+  /// Extend the limits so that they contain the given values.
+  /// Some headroom is added to the extended limits, so that a growing
+  /// track doesn't have to be rescaled with every new fix.
+  /// \return true if the limits were changed.
+  bool extendLimits(qreal min, qreal max, qreal maxTime);
+
   /// Draw the axes to the painter
   void draw(QPainter *painter);
 
@@ -9,6 +9,10 @@ const QBrush VerticalSpeedPlotPainter::POSITIVE_BRUSH =
 const QPen VerticalSpeedPlotPainter::POSITIVE_PEN = QPen(QColor(100, 100, 255));
 const QBrush VerticalSpeedPlotPainter::NEGATIVE_BRUSH = QBrush(Qt::red);
 const QPen VerticalSpeedPlotPainter::NEGATIVE_PEN = QPen(Qt::red);
+const QBrush AirspacePlotPainter::RESTRICTED_BRUSH =
+  QBrush(QColor(255, 80, 80, 90));
+const QBrush AirspacePlotPainter::OTHER_BRUSH =
+  QBrush(QColor(120, 160, 255, 60));
 
 void PlotPainter::init(PlotAxes *axes, FixInfo *info) {
   this->axes = axes;
@@ -38,17 +42,35 @@ void PlotPainter::updateBuffer() {
   computeDrawingData();
 }
 
+void PlotPainter::appendBuffer() {
+  if (indexes.isEmpty()) {
+    updateBuffer();
+    return;
+  }
+
+  // The last pixel column may get more fixes, so it is computed again.
+  buffer.remove(buffer.size() - 1);
+  dataValues.remove(dataValues.size() - 1);
+  addPoints(indexes.last());
+
+  computeDrawingData();
+}
+
 void PlotPainter::computePoints() {
   buffer.clear();
   dataValues.clear();
   indexes.clear();
-  int count = 1;
-  int x = qFloor(axes->placeX(info->absoluteTime(0)));
-  qreal sum = axes->placeY(info->value(0));
-  qreal dataSum = info->value(0);
   indexes.append(0);
+  addPoints(0);
+}
 
-  for (int i = 1; i < info->count(); ++i) {
+void PlotPainter::addPoints(int first) {
+  int count = 1;
+  int x = qFloor(axes->placeX(info->absoluteTime(first)));
+  qreal sum = axes->placeY(info->value(first));
+  qreal dataSum = info->value(first);
+
+  for (int i = first + 1; i < info->count(); ++i) {
     int newX = qFloor(axes->placeX(info->absoluteTime(i)));
 
     if (newX != x) {
@@ -164,5 +186,65 @@ void GroundSpeedPlotPainter::flushBuffer() {
   painter->drawPolyline(buffer);
 }
 
+void AirspacePlotPainter::init(PlotAxes *axes, FixInfo *info) {
+  this->axes = axes;
+  this->info = info;
+
+  connect(axes, SIGNAL(geometryChanged()), this, SLOT(updateBuffer()));
+}
+
+void AirspacePlotPainter::setSections(
+  const QList<AirspaceSection>& sections) {
+  this->sections = sections;
+  updateBuffer();
+}
+
+void AirspacePlotPainter::updateBuffer() {
+  polygons.clear();
+
+  // Unlimited ceilings and floors out of the plot stop at its edges.
+  QRect rect = axes->geometry();
+  qreal top = rect.top();
+  qreal bottom = rect.bottom();
+
+  foreach(const AirspaceSection& section, sections) {
+    // Along the ceiling and back along the floor,
+    // widened by half a pixel so that single fixes show.
+    QPolygonF ceiling;
+    QPolygonF floor;
+    int count = section.floor.count();
+    for (int k = 0; k < count; ++k) {
+      qreal x = axes->placeX(info->absoluteTime(section.firstFix + k));
+      qreal yCeiling = qBound(top, axes->placeY(section.ceiling[k]), bottom);
+      qreal yFloor = qBound(top, axes->placeY(section.floor[k]), bottom);
+
+      if (k == 0) {
+        ceiling << QPointF(x - 0.5, yCeiling);
+        floor << QPointF(x - 0.5, yFloor);
+      }
+      ceiling << QPointF(x, yCeiling);
+      floor << QPointF(x, yFloor);
+      if (k == count - 1) {
+        ceiling << QPointF(x + 0.5, yCeiling);
+        floor << QPointF(x + 0.5, yFloor);
+      }
+    }
+
+    for (int k = floor.size() - 1; k >= 0; --k) {
+      ceiling << floor[k];
+    }
+    polygons.append(ceiling);
+  }
+}
+
+void AirspacePlotPainter::draw(QPainter* painter) {
+  painter->setPen(Qt::NoPen);
+  for (int i = 0; i < polygons.size(); i++) {
+    painter->setBrush(sections[i].restricted ? RESTRICTED_BRUSH : OTHER_BRUSH);
+    painter->drawPolygon(polygons[i]);
+  }
+  painter->setBrush(Qt::NoBrush);
+}
+
 }  // End namespace IgcViewer
 }  // End namespace Updraft
@@ -4,6 +4,7 @@
 #include <QPolygonF>
 #include <QPointF>
 
+#include "airspacecheck.h"
 #include "igcinfo.h"
 #include "plotaxes.h"
 
@@ -37,12 +38,20 @@ class PlotPainter : public QObject {
  public slots:
   void updateBuffer();
 
+  /// Add points for the fixes appended to the info since the last update.
+  /// Only the last pixel column and the new fixes are processed.
+  void appendBuffer();
+
  protected:
   /// Draw points from the buffer.
   /// This method is called every time the graph crosses zero,
   /// at the end of the plot and maybe sometimes more.
   virtual void flushBuffer() = 0;
   virtual void computePoints();
+
+  /// Add the points starting from the fix first.
+  /// \pre first is the first fix of a new pixel column.
+  void addPoints(int first);
   virtual void computeDrawingData();
 
   QPainter *painter;
@@ -83,6 +92,38 @@ class GroundSpeedPlotPainter: public PlotPainter {
   void flushBuffer();
 };
 
+/// Painter of the airspace cross-section as shaded bands
+/// between the floors and ceilings.
+/// The sections are kept in metres and converted to polygons only when
+/// the axes change, redraws reuse the polygons.
+class AirspacePlotPainter : public QObject {
+  Q_OBJECT
+
+ public:
+  /// \param info Info giving the times of the fixes.
+  void init(PlotAxes *axes, FixInfo *info);
+
+  /// Replace the plotted sections.
+  void setSections(const QList<AirspaceSection>& sections);
+
+  void draw(QPainter* painter);
+
+ public slots:
+  void updateBuffer();
+
+ private:
+  PlotAxes *axes;
+  FixInfo *info;
+
+  QList<AirspaceSection> sections;
+
+  /// Polygon of each section in pixels.
+  QVector<QPolygonF> polygons;
+
+  static const QBrush RESTRICTED_BRUSH;
+  static const QBrush OTHER_BRUSH;
+};
+
 }  // End namespace IgcViewer
 }  // End namespace Updraft
 
@@ -61,6 +61,9 @@ PlotWidget::PlotWidget(SegmentInfo* segmentInfo, FixInfo* altitudeInfo,
   altitudePlotPainter = new AltitudePlotPainter();
   altitudePlotPainter->init(altitudeAxes, altitudeInfo);
 
+  airspacePlotPainter = new AirspacePlotPainter();
+  airspacePlotPainter->init(altitudeAxes, altitudeInfo);
+
   AxisLabel* altitudeLabel = new AxisLabel(altitudeAxes, "[m]");
   layout->addItem(altitudeLabel, 1, 0);
   labels.append(altitudeLabel);
@@ -111,6 +114,64 @@ PlotWidget::PlotWidget(SegmentInfo* segmentInfo, FixInfo* altitudeInfo,
   // ownership of layout is transfered to this.
 }
 
+void PlotWidget::appendFixes(int first) {
+  qreal maxTime = altitudeInfo->absoluteMaxTime();
+  bool rescaled = false;
+
+  // Painters of rescaled axes are updated through geometryChanged().
+  if (altitudeAxes->extendLimits(
+    altitudeInfo->min(), altitudeInfo->max(), maxTime)) {
+    rescaled = true;
+  } else {
+    altitudePlotPainter->appendBuffer();
+  }
+
+  if (groundSpeedAxes->extendLimits(
+    groundSpeedInfo->min(), groundSpeedInfo->max(), maxTime)) {
+    rescaled = true;
+  } else {
+    groundSpeedPlotPainter->appendBuffer();
+  }
+
+  if (verticalSpeedAxes->extendLimits(
+    verticalSpeedInfo->min(), verticalSpeedInfo->max(), maxTime)) {
+    rescaled = true;
+  } else {
+    verticalSpeedPlotPainter->appendBuffer();
+  }
+
+  if (rescaled) {
+    for (int i = 0; i < pickedFixes.size(); i++) {
+      qreal secs = altitudeInfo->absoluteTime(pickedFixes[i].fixIndex);
+      int x = altitudeAxes->placeX(secs);
+      pickedFixes[i].xLine = x;
+      pickedPositions[i] = x;
+    }
+  }
+
+  // If the end of the track was picked, it follows the new end.
+  int last = pickedFixes.size() - 1;
+  if (last > 0 && pickedFixes[last].fixIndex == first - 1) {
+    int index = altitudeInfo->count() - 1;
+    int x = altitudeAxes->placeX(altitudeInfo->absoluteTime(index));
+
+    pickedFixes[last] = PickData(x, index);
+    pickedPositions[last] = x;
+    pickedFixesStatTexts[last] = createPointStatText(x, index);
+    segmentsStatTexts[last - 1] = createSegmentStatText(
+      pickedFixes[last - 1].fixIndex, index);
+  }
+
+  emit updateText();
+  redrawGraphPicture();
+}
+
+void PlotWidget::setAirspaceSections(
+  const QList<AirspaceSection>& sections) {
+  airspacePlotPainter->setSections(sections);
+  redrawGraphPicture();
+}
+
 void PlotWidget::paintEvent(QPaintEvent* paintEvent) {
   QPainter painter(this);
   painter.drawImage(0, 0, *graphPicture);
@@ -141,6 +202,7 @@ void PlotWidget::redrawGraphPicture() {
 
   painter.fillRect(rect(), BG_COLOR);
 
+  airspacePlotPainter->draw(&painter);
   altitudePlotPainter->draw(&painter);
   verticalSpeedPlotPainter->draw(&painter);
   groundSpeedPlotPainter->draw(&painter);
@@ -324,8 +386,6 @@ QString PlotWidget::createPointStatText(int xLine, int index) {
 QString PlotWidget::createSegmentStatText(
   int startPointIndex, int endPointIndex) {
   QString text;
-  QTime startTime = segmentInfo->timestamp(startPointIndex);
-  QTime endTime = segmentInfo->timestamp(endPointIndex);
   qreal distance = segmentInfo->distance(startPointIndex, endPointIndex);
   qreal avgSpeed = segmentInfo->avgSpeed(startPointIndex, endPointIndex);
   qreal avgRise = segmentInfo->avgRise(startPointIndex, endPointIndex);
@@ -337,8 +397,8 @@ QString PlotWidget::createSegmentStatText(
   QString durationmins;
   QString durationsecs;
 
-  int durationSecs = startTime.secsTo(endTime);
-  if (durationSecs < 0) durationSecs += 24 * 3600;
+  int durationSecs = qRound(
+    segmentInfo->duration(startPointIndex, endPointIndex));
 
   QTime durationTime = getTimeFromSecs(durationSecs);
 
@@ -45,6 +45,15 @@ class PlotWidget : public QWidget {
   /// decided by the method chooseFixIndex(int start, int end);
   void addPickedLine(int x);
 
+  /// Fixes were appended to the end of the track.
+  /// Extends the plots without recomputing them if the new fixes fit
+  /// into the current scale.
+  /// \param first Index of the first new fix.
+  void appendFixes(int first);
+
+  /// Shade the airspaces along the flight behind the altitude plot.
+  void setAirspaceSections(const QList<AirspaceSection>& sections);
+
   QList<QString>* getSegmentsStatTexts();
   QList<QString>* getPointsStatTexts();
 
@@ -117,6 +126,7 @@ class PlotWidget : public QWidget {
   PlotAxes *groundSpeedAxes;
 
   AltitudePlotPainter* altitudePlotPainter;
+  AirspacePlotPainter* airspacePlotPainter;
   VerticalSpeedPlotPainter* verticalSpeedPlotPainter;
   GroundSpeedPlotPainter* groundSpeedPlotPainter;
 
@@ -0,0 +1,145 @@
+#include "trackdata.h"
+
+namespace Updraft {
+namespace IgcViewer {
+
+void TrackData::init(const Igc::IgcFile* file,
+  const osg::EllipsoidModel* ellipsoid) {
+  this->file = file;
+  this->fixes = &file->fixes();
+  this->ellipsoid = ellipsoid;
+
+  rows.clear();
+  timeline_.clear();
+  xyz.clear();
+  scannedRows = 0;
+
+  rows.reserve(fixes->count());
+  timeline_.reserve(fixes->count());
+  selectRows(0);
+  project(0);
+}
+
+void TrackData::init(const Igc::IgcFile* file,
+  const osg::EllipsoidModel* ellipsoid, const QVector<double>& projected) {
+  this->file = file;
+  this->fixes = &file->fixes();
+  this->ellipsoid = ellipsoid;
+
+  rows.clear();
+  timeline_.clear();
+  scannedRows = 0;
+
+  rows.reserve(fixes->count());
+  timeline_.reserve(fixes->count());
+  selectRows(0);
+
+  if (projected.count() == 6 * rows.count()) {
+    xyz = projected;
+  } else {
+    xyz.clear();
+    project(0);
+  }
+}
+
+/// Name of the projection stored in the flight cache.
+/// Coordinates projected to a different ellipsoid are not used.
+static QString projectionName(const osg::EllipsoidModel* ellipsoid) {
+  return Util::EcefProjector(ellipsoid).name() + " ground";
+}
+
+bool TrackData::load(Igc::IgcFile* file, const QString& path,
+  const osg::EllipsoidModel* ellipsoid, Igc::FlightCache* cache) {
+  if (!cache) {
+    if (!file->load(path)) {
+      return false;
+    }
+    init(file, ellipsoid);
+    return true;
+  }
+
+  QString projection = projectionName(ellipsoid);
+  QVector<double> cached;
+
+  if (cache->load(path, file, projection, &cached)) {
+    init(file, ellipsoid, cached);
+    if (cached.isEmpty()) {
+      // Projected for a different ellipsoid, store the new projection.
+      cache->store(path, *file, projection, xyz);
+    }
+    return true;
+  }
+
+  if (!file->load(path)) {
+    return false;
+  }
+
+  init(file, ellipsoid);
+  cache->store(path, *file, projection, xyz);
+  return true;
+}
+
+int TrackData::append() {
+  int oldCount = rows.count();
+  selectRows(scannedRows);
+  project(oldCount);
+  return rows.count() - oldCount;
+}
+
+void TrackData::selectRows(int firstRow) {
+  // Times in the fix table are already monotonic, they only have
+  // to be moved to the epoch.
+  qint64 start = file->startMsecsSinceEpoch();
+
+  for (int i = firstRow; i < fixes->count(); ++i) {
+    if (fixes->valid(i)) {
+      rows.append(i);
+      timeline_.append(start + static_cast<qint64>(fixes->seconds(i)) * 1000);
+    }
+  }
+  scannedRows = fixes->count();
+}
+
+void TrackData::project(int first) {
+  int count = rows.count() - first;
+  xyz.resize(6 * rows.count());
+  if (count <= 0) {
+    return;
+  }
+
+  // Gather the selected fixes into plain columns for the projector.
+  QVector<double> lat(count);
+  QVector<double> lon(count);
+  QVector<double> height(count);
+  for (int i = 0; i < count; ++i) {
+    int row = rows[first + i];
+    lat[i] = fixes->latitude(row);
+    lon[i] = fixes->longitude(row);
+    /// \todo fill terrain height
+    height[i] = fixes->gpsAltitude(row);
+  }
+
+  double *out = xyz.data() + 6 * first;
+  Util::EcefProjector(ellipsoid).project(lat.constData(), lon.constData(),
+    height.constData(), count, out, out + 3, 6);
+}
+
+int TrackData::nearestFix(double x, double y, double z) const {
+  if (fixIndex.count() != count()) {
+    QVector<Util::RTree<3>::Box> boxes(count());
+    for (int i = 0; i < count(); ++i) {
+      boxes[i] = Util::RTree<3>::Box::fromPoint(xyz.constData() + 6 * i);
+    }
+    fixIndex.build(boxes);
+  }
+
+  double point[] = {x, y, z};
+  return fixIndex.nearest(point);
+}
+
+bool TrackBatchItem::load(Igc::IgcFile *file) {
+  return track_.load(file, path(), ellipsoid, cache);
+}
+
+}  // End namespace IgcViewer
+}  // End namespace Updraft
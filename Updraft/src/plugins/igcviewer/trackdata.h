@@ -0,0 +1,174 @@
+#ifndef UPDRAFT_SRC_PLUGINS_IGCVIEWER_TRACKDATA_H_
+#define UPDRAFT_SRC_PLUGINS_IGCVIEWER_TRACKDATA_H_
+
+#include <QTime>
+#include <QVector>
+
+#include "igc/igc.h"
+#include "igc/batchloader.h"
+#include "igc/flightcache.h"
+#include "igc/timeline.h"
+#include "util/util.h"
+
+namespace osg {
+  class EllipsoidModel;
+}
+
+namespace Updraft {
+namespace IgcViewer {
+
+/// View of the valid fixes of an IGC file, already projected and prepared
+/// for displaying.
+/// Values are read directly from the fix table of the IgcFile, only the
+/// projected coordinates and the timeline are stored here. The IgcFile
+/// must outlive this object.
+/// Every fix is projected once, together with the point on the ellipsoid
+/// below it (used by the skirt of the track).
+class TrackData {
+ public:
+  TrackData() : file(NULL), fixes(NULL), ellipsoid(NULL), scannedRows(0) {}
+
+  /// Select the valid fixes from the file and project them.
+  void init(const Igc::IgcFile* file,
+    const osg::EllipsoidModel* ellipsoid);
+
+  /// Select the valid fixes from the file and use the already projected
+  /// coordinates, if they match the table.
+  /// \param projected Coordinates previously returned by projected().
+  void init(const Igc::IgcFile* file,
+    const osg::EllipsoidModel* ellipsoid, const QVector<double>& projected);
+
+  /// Load the file and initialize the track from it.
+  /// If a cache is given, the file and its projection are taken from it
+  /// when possible, otherwise the parsed file is stored there.
+  /// \param file File to load the data into. It must outlive this object.
+  /// \param path Path of the igc file.
+  /// \param cache Flight cache or NULL.
+  /// \return false if the file couldn't be loaded.
+  bool load(Igc::IgcFile* file, const QString& path,
+    const osg::EllipsoidModel* ellipsoid, Igc::FlightCache* cache);
+
+  /// Add the fixes appended to the fix table since the last call
+  /// of init() or append().
+  /// Only the new fixes are projected.
+  /// \return Number of the new track fixes.
+  int append();
+
+  /// Number of fixes of the track.
+  int count() const { return rows.count(); }
+
+  /// Return true if there are no fixes.
+  bool isEmpty() const { return rows.isEmpty(); }
+
+  /// Return times of the fixes.
+  const Igc::Timeline& timeline() const { return timeline_; }
+
+  /// Return time of fix i in seconds since the first fix of the track.
+  qreal time(int i) const { return timeline_.elapsed(i) / 1000.0; }
+
+  /// Return time of day of the first fix in seconds (UTC).
+  qint32 startSecondsOfDay() const { return timeline_.msecsOfDay(0) / 1000; }
+
+  /// Return time of day of fix i (UTC).
+  QTime timestamp(int i) const {
+    return QTime(0, 0).addMSecs(timeline_.msecsOfDay(i));
+  }
+
+  /// Return location of fix i.
+  Util::Location location(int i) const { return fixes->location(rows[i]); }
+
+  /// Return GNSS altitude of fix i.
+  qreal alt(int i) const { return fixes->gpsAltitude(rows[i]); }
+
+  /// Return pressure altitude of fix i, 0 if the logger has no barometer.
+  qreal pressureAlt(int i) const { return fixes->pressureAltitude(rows[i]); }
+
+  /// Return index of the B record extension with the given code,
+  /// or -1 if the file doesn't record it.
+  int extensionIndex(const QByteArray& code) const {
+    return fixes->extensionIndex(code);
+  }
+
+  /// Return value of an extension column for fix i.
+  /// The column is decoded on the first use.
+  qint32 extension(int column, int i) const {
+    return fixes->extension(column, rows[i]);
+  }
+
+  /// Projected location of fix i.
+  /// \{
+  qreal x(int i) const { return xyz[6 * i]; }
+  qreal y(int i) const { return xyz[6 * i + 1]; }
+  qreal z(int i) const { return xyz[6 * i + 2]; }
+  /// \}
+
+  /// Projected location of the point at zero height below fix i.
+  /// \{
+  qreal groundX(int i) const { return xyz[6 * i + 3]; }
+  qreal groundY(int i) const { return xyz[6 * i + 4]; }
+  qreal groundZ(int i) const { return xyz[6 * i + 5]; }
+  /// \}
+
+  /// Return all projected coordinates, six values for every fix
+  /// (the fix and the ground point below it).
+  const QVector<double>& projected() const { return xyz; }
+
+  /// Return index of the fix with projected location nearest to the
+  /// given point, or -1 if the track is empty.
+  /// The spatial index is built on the first call after the track
+  /// changed.
+  int nearestFix(double x, double y, double z) const;
+
+ private:
+  /// Select the valid fixes from the given table row onwards and add them
+  /// to the timeline.
+  void selectRows(int firstRow);
+
+  /// Project the selected fixes from the given track index onwards.
+  void project(int first);
+
+  const Igc::IgcFile* file;
+  const Igc::FixTable* fixes;
+  const osg::EllipsoidModel* ellipsoid;
+
+  /// Number of fix table rows already processed.
+  int scannedRows;
+
+  /// Indices of the valid fixes in the fix table.
+  QVector<int> rows;
+
+  /// Projected locations, three coordinates of the fix and three
+  /// coordinates of the ground point per fix.
+  QVector<double> xyz;
+
+  /// Times of the selected fixes.
+  Igc::Timeline timeline_;
+
+  /// Index of the projected fixes, for picking.
+  mutable Util::RTree<3> fixIndex;
+};
+
+/// Batch loader item that also projects the track on the worker thread.
+class TrackBatchItem : public Igc::BatchItem {
+ public:
+  TrackBatchItem(const QString &path, const osg::EllipsoidModel* ellipsoid,
+    Igc::FlightCache* cache)
+    : Igc::BatchItem(path), ellipsoid(ellipsoid), cache(cache) {}
+
+  /// Return the projected track.
+  /// It refers to the fixes of file(), which must be kept alive.
+  const TrackData& track() const { return track_; }
+
+ protected:
+  bool load(Igc::IgcFile *file);
+
+ private:
+  const osg::EllipsoidModel* ellipsoid;
+  Igc::FlightCache* cache;
+  TrackData track_;
+};
+
+}  // End namespace IgcViewer
+}  // End namespace Updraft
+
+#endif  // UPDRAFT_SRC_PLUGINS_IGCVIEWER_TRACKDATA_H_
@@ -1,6 +1,7 @@
 #include <math.h>
 
 #include <QDebug>
+#include <QVector>
 #include <QtXml/QDomDocument>
 #include <osg/CoordinateSystemNode>
 
@@ -183,9 +184,22 @@ qreal TaskData::distanceAzimuth(int i, int j, qreal *azimuth) const {
 }
 
 qreal TaskData::totalDistance() const {
+  if (size() < 2) {
+    return 0;
+  }
+
+  QVector<Util::Location> locations(size());
+  for (int i = 0; i < size(); ++i) {
+    locations[i] = taskPoints[i]->getLocation();
+  }
+
+  QVector<qreal> legs(size() - 1);
+  g_core->getEllipsoid()->legDistances(locations.constData(), size(),
+    legs.data());
+
   qreal sum = 0;
-  for (int i = 0; i < size() - 1; ++i) {
-    sum += distance(i, i + 1);
+  foreach(qreal leg, legs) {
+    sum += leg;
   }
   return sum;
 }
@@ -1,3 +1,4 @@
+#include <QVector>
 #include <osg/ShapeDrawable>
 #include <osg/Depth>
 #include <osg/Group>
@@ -14,6 +15,7 @@
 #include "taskdata.h"
 #include "taskpoint.h"
 #include "../turnpoints/turnpoint.h"
+#include "util/util.h"
 #include "pluginbase.h"
 
 namespace Updraft {
@@ -278,6 +280,35 @@ void TaskLayer::taskStorageStateChanged() {
   mapLayer->setTitle(getTitle());
 }
 
+/// Project all task points of the task.
+/// \param [out] xyz Three coordinates of each task point, lifted
+///   1000 m above its altitude.
+/// \param [out] ground If not NULL, three coordinates of the point on
+///   the ellipsoid below each task point.
+static void projectTaskPoints(const TaskData *taskData, QVector<double> *xyz,
+  QVector<double> *ground) {
+  int count = taskData->size();
+  QVector<double> lat(count);
+  QVector<double> lon(count);
+  QVector<double> height(count);
+  for (int i = 0; i < count; ++i) {
+    Util::Location location = taskData->getTaskPoint(i)->getLocation();
+    lat[i] = location.lat;
+    lon[i] = location.lon;
+    // TODO(Tom): correct altitude
+    height[i] = location.alt + 1000.0;
+  }
+
+  xyz->resize(3 * count);
+  if (ground != NULL) {
+    ground->resize(3 * count);
+  }
+
+  Util::EcefProjector(g_core->getCurrentMapEllipsoid()).project(
+    lat.constData(), lon.constData(), height.constData(), count,
+    xyz->data(), ground != NULL ? ground->data() : NULL);
+}
+
 void TaskLayer::drawLines(osg::Geode *geode) {
   // Creates geometry object and draw array.
   osg::Geometry* geom = new osg::Geometry();
@@ -297,26 +328,16 @@ void TaskLayer::drawLines(osg::Geode *geode) {
     return;
   }
 
-  const osg::EllipsoidModel* ellipsoid = g_core->getCurrentMapEllipsoid();
-
   // Reads all task points and fills draw array.
-  int pointIndex = 0;
-  const TaskPoint *point = NULL;
-  while ((point = taskData->getTaskPoint(pointIndex))) {
-    // TODO(Tom): correct altitude
-    double x, y, z;
-    ellipsoid->convertLatLongHeightToXYZ(
-      point->getLocation().lat_radians(),
-      point->getLocation().lon_radians(),
-      point->getLocation().alt + 1000.0,
-      x, y, z);
-
-    vertexData->push_back(osg::Vec3(x, y, z));
-    ++pointIndex;
-  }
+  QVector<double> xyz;
+  projectTaskPoints(taskData, &xyz, NULL);
 
   file->endRead();
 
+  for (int i = 0; i < xyz.count(); i += 3) {
+    vertexData->push_back(osg::Vec3(xyz[i], xyz[i + 1], xyz[i + 2]));
+  }
+
   drawArrayLines->setFirst(0);
   drawArrayLines->setCount(vertexData->size());
 
@@ -361,32 +382,19 @@ void TaskLayer::drawCurtain(osg::Geode *geode) {
     return;
   }
 
-  const osg::EllipsoidModel* ellipsoid = g_core->getCurrentMapEllipsoid();
-
   // Reads all task points and fills draw array.
-  int pointIndex = 0;
-  const TaskPoint *point = NULL;
-  while ((point = taskData->getTaskPoint(pointIndex))) {
-    double x, y, z;
-
-    ellipsoid->convertLatLongHeightToXYZ(
-      point->getLocation().lat_radians(),
-      point->getLocation().lon_radians(),
-      point->getLocation().alt + 1000.0,
-      x, y, z);
-    vertexData->push_back(osg::Vec3(x, y, z));
-
-    ellipsoid->convertLatLongHeightToXYZ(
-      point->getLocation().lat_radians(),
-      point->getLocation().lon_radians(),
-      0,
-      x, y, z);
-    vertexData->push_back(osg::Vec3(x, y, z));
-    ++pointIndex;
-  }
+  QVector<double> xyz;
+  QVector<double> ground;
+  projectTaskPoints(taskData, &xyz, &ground);
 
   file->endRead();
 
+  for (int i = 0; i < xyz.count(); i += 3) {
+    vertexData->push_back(osg::Vec3(xyz[i], xyz[i + 1], xyz[i + 2]));
+    vertexData->push_back(
+      osg::Vec3(ground[i], ground[i + 1], ground[i + 2]));
+  }
+
   drawArray->setFirst(0);
   drawArray->setCount(vertexData->size());
 
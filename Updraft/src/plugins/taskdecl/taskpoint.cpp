@@ -207,7 +207,7 @@ void TaskPoint::setTP(const TurnPoint *tp) {
 
   code = tp->code;
   name = tp->name;
-  location = tp->location;
+  location = tp->location.toLocation();
 }
 
 void TaskPoint::setLocation(const Util::Location &location_) {
@@ -194,12 +194,14 @@ TPLayer::TPLayer(bool displayed_, osgEarth::Util::ObjectPlacer* objectPlacer_,
 
     // Create matrix from TP's position.
     // Turn-point is placed 100 meters above it's position (terrain).
-    if (!objectPlacer->createPlacerMatrix(itPoint->location.lat,
-      itPoint->location.lon, itPoint->location.alt + 100.0 + d, matrix)) {
+    if (!objectPlacer->createPlacerMatrix(itPoint->location.lat(),
+      itPoint->location.lon(), itPoint->location.alt() + 100.0 + d,
+      matrix)) {
       continue;
     }
-    if (!objectPlacer->createPlacerMatrix(itPoint->location.lat,
-      itPoint->location.lon, itPoint->location.alt + 500.0 + d, labelMatrix)) {
+    if (!objectPlacer->createPlacerMatrix(itPoint->location.lat(),
+      itPoint->location.lon(), itPoint->location.alt() + 500.0 + d,
+      labelMatrix)) {
       continue;
     }
 
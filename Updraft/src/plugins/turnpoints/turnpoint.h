@@ -36,7 +36,7 @@ struct TurnPoint {
   QString name;
 
   /// Geographic position of turn-point
-  Util::Location location;
+  Util::PackedLocation location;
 
   /// Cupfile entry type
   WaypointStyle type;
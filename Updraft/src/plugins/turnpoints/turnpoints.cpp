@@ -1,5 +1,6 @@
 #include "turnpoints.h"
 #include "tpfilecupadapter.h"
+#include "util/util.h"
 
 namespace Updraft {
 
@@ -33,6 +34,13 @@ void TurnPoints::initialize(CoreInterface *coreInterface) {
   cupTPsReg.plugin = this;
   g_core->registerFiletype(cupTPsReg);
 
+  // Compressed files are imported as they are and decompressed on loading.
+  foreach(QString suffix, Util::DecompressingDevice::suffixes()) {
+    FileRegistration compressed(cupTPsReg);
+    compressed.extension += suffix;
+    g_core->registerFiletype(compressed);
+  }
+
   loadImportedFiles();
 
   qDebug("turnpoints loaded");
@@ -103,6 +111,9 @@ void TurnPoints::loadImportedFiles() {
 
   // Search for all cup files in import directory.
   QStringList filters("*" + cupTPsReg.extension);
+  foreach(QString suffix, Util::DecompressingDevice::suffixes()) {
+    filters.append("*" + cupTPsReg.extension + suffix);
+  }
   QStringList entries = dir.entryList(filters, QDir::Files, QDir::Time);
 
   // Load all listed files.